@@ -16,13 +16,26 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <vector>
 #include "robot_tool.hpp"
 #include "types.hpp"
 
 #define RETOOLING_TIME 1LL
+#define MAX_ACTION_COUNT (sizeof(capability_mask_t) * 8)
 
 using namespace cps_kitchen;
 
+/**
+ * @brief Returns the capability mask bit of an action.
+ *
+ * @param _action_id the interned action id.
+ * @return capability_mask_t the mask with only the action's bit set.
+ */
+constexpr capability_mask_t
+action_mask(action_id_t _action_id) {
+    return capability_mask_t(1) << _action_id;
+}
+
 /**
  * @brief Abstract base for any executable action.
  */
@@ -52,6 +65,7 @@ struct action {
 struct robot_action : public action {
     private:
         std::string name_; /**< the robot action name. */
+        action_id_t action_id_; /**< the interned action id. */
         robot_tool required_tool_; /**< the required tool. */
         std::string ingredients_; /**< the required ingredients. */
         duration_t duration_; /**< the action duration. */
@@ -60,11 +74,12 @@ struct robot_action : public action {
          * @brief Constructs a new robot action object.
          * 
          * @param _name the robot action name.
+         * @param _action_id the interned action id.
          * @param _required_tool the required tool.
          * @param _ingredients the required ingredients.
          * @param _duration the action duration.
          */
-        robot_action(std::string _name, robot_tool _required_tool, std::string _ingredients, duration_t _duration) : name_(_name), required_tool_(_required_tool), ingredients_(_ingredients), duration_(_duration) {
+        robot_action(std::string _name, action_id_t _action_id, robot_tool _required_tool, std::string _ingredients, duration_t _duration) : name_(_name), action_id_(_action_id), required_tool_(_required_tool), ingredients_(_ingredients), duration_(_duration) {
         }
         
         /**
@@ -84,6 +99,26 @@ struct robot_action : public action {
             return name_;
         }
 
+        /**
+         * @brief Returns the interned action id.
+         *
+         * @return action_id_t the action id.
+         */
+        action_id_t
+        get_action_id() const {
+            return action_id_;
+        }
+
+        /**
+         * @brief Returns the capability mask bit of the action.
+         *
+         * @return capability_mask_t the mask with only this action's bit set.
+         */
+        capability_mask_t
+        get_action_mask() const {
+            return action_mask(action_id_);
+        }
+
         /**
          * @brief Returns the required robot tool.
          * 
@@ -238,6 +273,45 @@ class robot_actions {
          * @return std::shared_ptr<action> the action.
          */
         std::shared_ptr<action> get_robot_action(const std::string _action_name);
+
+        /**
+         * @brief Returns the interned id of an action, assigned in registration order.
+         * 
+         * @param _action_name the action name.
+         * @return action_id_t the action id.
+         */
+        action_id_t get_action_id(const std::string _action_name) const;
+
+        /**
+         * @brief Returns the name of an interned action id.
+         * 
+         * @param _action_id the action id.
+         * @return std::string the action name.
+         */
+        std::string get_action_name(action_id_t _action_id) const;
+
+        /**
+         * @brief Returns the capability mask of the given actions.
+         * 
+         * @param _action_names the action names.
+         * @return capability_mask_t the mask with the bits of all given actions set.
+         */
+        template<typename Container>
+        capability_mask_t get_capability_mask(const Container& _action_names) const {
+            capability_mask_t mask = 0;
+            for (const std::string& action_name : _action_names) {
+                mask |= action_mask(get_action_id(action_name));
+            }
+            return mask;
+        }
+
+        /**
+         * @brief Returns the names of the actions in a capability mask in action id order.
+         * 
+         * @param _capability_mask the capability mask.
+         * @return std::vector<std::string> the action names.
+         */
+        std::vector<std::string> get_action_names(capability_mask_t _capability_mask) const;
     private:
         /**
          * @brief Constructs a new robot actions object.
@@ -268,6 +342,25 @@ class robot_actions {
          * 
          */
         std::unordered_map<std::string, std::shared_ptr<action>> action_map_;
+
+        /**
+         * @brief The interned action ids by action name.
+         * 
+         */
+        std::unordered_map<std::string, action_id_t> action_id_map_;
+
+        /**
+         * @brief The action names by interned action id.
+         * 
+         */
+        std::vector<std::string> action_names_;
+
+        /**
+         * @brief Adds an action to the registry and interns its name.
+         * 
+         * @param _action the action.
+         */
+        void add_action(std::shared_ptr<action> _action);
 };
 
 #endif // ROBOT_ACTIONS_HPP
\ No newline at end of file
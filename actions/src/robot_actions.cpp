@@ -1,4 +1,5 @@
 #include "../include/robot_actions.hpp"
+#include <stdexcept>
 
 #define PEEL "peel"
 #define CUT "cut"
@@ -41,21 +42,21 @@ robot_actions* robot_actions::get_instance() {
 
 robot_actions::robot_actions() {
     // autonomous timed actions
-    action_map_[PEEL] = std::make_shared<autonomous_action>(PEEL, robot_tool::PEELER, PEELING_TIME);
-    action_map_[CUT] = std::make_shared<autonomous_action>(CUT, robot_tool::CUTTER, CUTTING_TIME);
-    action_map_[BRAISE] = std::make_shared<autonomous_action>(BRAISE, robot_tool::PAN, BRAISING_TIME);
-    action_map_[MASH] = std::make_shared<autonomous_action>(MASH, robot_tool::MASHER, MASHING_TIME);
-    action_map_[STIR] = std::make_shared<autonomous_action>(STIR, robot_tool::STIRRER, STIRRING_TIME);
-    action_map_[SPRINKLE] = std::make_shared<autonomous_action>(SPRINKLE, robot_tool::INGREDIENT_DISPENSER, SPRINKLING_TIME);
-    action_map_[POUR] = std::make_shared<autonomous_action>(POUR, robot_tool::INGREDIENT_DISPENSER, POURING_TIME);
-    action_map_[WHIP] = std::make_shared<autonomous_action>(WHIP, robot_tool::WHISK, WHIPPING_TIME);
-    action_map_[MIX] = std::make_shared<autonomous_action>(MIX, robot_tool::MIXER, MIXING_TIME);
-    action_map_[CRUSH] = std::make_shared<autonomous_action>(CRUSH, robot_tool::CRUSHER, CRUSHING_TIME);
-    action_map_[LAYER] = std::make_shared<autonomous_action>(LAYER, robot_tool::LAYERING_DISPENSER, LAYERING_TIME);
-    action_map_[FRY] = std::make_shared<autonomous_action>(FRY, robot_tool::FRYER, FRYING_TIME);
+    add_action(std::make_shared<autonomous_action>(PEEL, robot_tool::PEELER, PEELING_TIME));
+    add_action(std::make_shared<autonomous_action>(CUT, robot_tool::CUTTER, CUTTING_TIME));
+    add_action(std::make_shared<autonomous_action>(BRAISE, robot_tool::PAN, BRAISING_TIME));
+    add_action(std::make_shared<autonomous_action>(MASH, robot_tool::MASHER, MASHING_TIME));
+    add_action(std::make_shared<autonomous_action>(STIR, robot_tool::STIRRER, STIRRING_TIME));
+    add_action(std::make_shared<autonomous_action>(SPRINKLE, robot_tool::INGREDIENT_DISPENSER, SPRINKLING_TIME));
+    add_action(std::make_shared<autonomous_action>(POUR, robot_tool::INGREDIENT_DISPENSER, POURING_TIME));
+    add_action(std::make_shared<autonomous_action>(WHIP, robot_tool::WHISK, WHIPPING_TIME));
+    add_action(std::make_shared<autonomous_action>(MIX, robot_tool::MIXER, MIXING_TIME));
+    add_action(std::make_shared<autonomous_action>(CRUSH, robot_tool::CRUSHER, CRUSHING_TIME));
+    add_action(std::make_shared<autonomous_action>(LAYER, robot_tool::LAYERING_DISPENSER, LAYERING_TIME));
+    add_action(std::make_shared<autonomous_action>(FRY, robot_tool::FRYER, FRYING_TIME));
     // recipe timed actions
-    action_map_[BOIL] = std::make_shared<recipe_timed_action>(BOIL, robot_tool::POT);
-    action_map_[BAKE] = std::make_shared<recipe_timed_action>(BAKE, robot_tool::OVEN);
+    add_action(std::make_shared<recipe_timed_action>(BOIL, robot_tool::POT));
+    add_action(std::make_shared<recipe_timed_action>(BAKE, robot_tool::OVEN));
 }
 
 robot_actions::~robot_actions() {
@@ -67,4 +68,29 @@ bool robot_actions::has_action(const std::string _action_name) const {
 
 std::shared_ptr<action> robot_actions::get_robot_action(const std::string _action_name) {
     return action_map_.at(_action_name);
+}
+
+action_id_t robot_actions::get_action_id(const std::string _action_name) const {
+    return action_id_map_.at(_action_name);
+}
+
+std::string robot_actions::get_action_name(action_id_t _action_id) const {
+    return action_names_.at(_action_id);
+}
+
+std::vector<std::string> robot_actions::get_action_names(capability_mask_t _capability_mask) const {
+    std::vector<std::string> action_names;
+    for (size_t action_id = 0; action_id < action_names_.size(); action_id++) {
+        if (_capability_mask & action_mask(action_id))
+            action_names.push_back(action_names_[action_id]);
+    }
+    return action_names;
+}
+
+void robot_actions::add_action(std::shared_ptr<action> _action) {
+    if (action_names_.size() >= MAX_ACTION_COUNT)
+        throw std::length_error("The capability mask holds at most " + std::to_string(MAX_ACTION_COUNT) + " actions");
+    action_id_map_[_action->get_name()] = action_names_.size();
+    action_names_.push_back(_action->get_name());
+    action_map_[_action->get_name()] = _action;
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef AGENT_TIMINGS_HPP
+#define AGENT_TIMINGS_HPP
+
+/* The timings of the agents in time units, shared by the agents, the MAPE strategies and the simulator */
+#define ROBOT_MOVE_TIME 5LL /**< the time a robot needs to move by one conveyor position. */
+#define ROBOT_RECONFIGURATION_TIME 5LL /**< the time a robot is unavailable while reconfiguring. */
+#define CONVEYOR_MOVE_TIME 1LL /**< the time a plate needs to move by one conveyor position. */
+#define CONVEYOR_DEBOUNCE_TIME 1LL /**< the time before the conveyor starts to move after the first robot notification. */
+#define KITCHEN_PLACING_RATE 5LL /**< the time between two orders placed by the kitchen. */
+
+#endif // AGENT_TIMINGS_HPP
@@ -27,6 +27,7 @@
 #define CURRENT_TOOL "CurrentTool"
 #define LAST_EQUIPPED_TOOL "LastEquippedTool"
 #define CAPABILITIES "Capabilities"
+#define CAPABILITIES_MASK "CapabilitiesMask"
 #define PROCESSED_STEPS "ProcessedSteps"
 #define PROCESSABLE_STEPS "ProcessableSteps"
 #define OVERALL_PROCESSED_STEPS "OverallProcessedSteps"
@@ -57,8 +58,11 @@
 // method nodes
 #define REGISTER_ROBOT "RegisterRobot"
 #define CHOOSE_NEXT_ROBOT "ChooseNextRobot"
+#define CHOOSE_NEXT_ROBOTS "ChooseNextRobots"
+#define PLAN_ROUTE "PlanRoute"
 // attribute nodes
 #define REGISTERED_ROBOTS "RegisteredRobots"
+#define ROUTING_CACHE_HIT_RATE "RoutingCacheHitRate"
 
 /* KITCHEN */
 // object type node
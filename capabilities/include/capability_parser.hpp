@@ -18,6 +18,7 @@ using namespace cps_kitchen;
 class capability_parser {
 private:
     std::unordered_set<std::string> capabilities_; /**< the capabilities set. */
+    capability_mask_t capabilities_mask_; /**< the capability mask of the capabilities set. */
 public:
     /**
      * @brief Constructs a new capability parser object.
@@ -41,12 +42,30 @@ public:
      */
     bool is_capable_to(std::string _action_name);
 
+    /**
+     * @brief Checks whether all actions of the given mask are present in the capabilities.
+     * 
+     * @param _actions_mask the capability mask of the actions to check for.
+     * @return true when all actions are present.
+     * @return false when an action is not available.
+     */
+    bool is_capable_to(capability_mask_t _actions_mask) const {
+        return (capabilities_mask_ & _actions_mask) == _actions_mask;
+    }
+
     /**
      * @brief Returns a copy of the capabilities set.
      * 
      * @return std::unordered_set<std::string> the capabilities set.
      */
     std::unordered_set<std::string> get_capabilities();
+
+    /**
+     * @brief Returns the capability mask.
+     * 
+     * @return capability_mask_t the capability mask.
+     */
+    capability_mask_t get_capabilities_mask() const;
 };
 
 #endif // CAPABILITY_PARSER_HPP
\ No newline at end of file
@@ -8,7 +8,7 @@
 #include <filesystem>
 #include <iostream>
 
-capability_parser::capability_parser(std::string _capabilities_file_name) {
+capability_parser::capability_parser(std::string _capabilities_file_name) : capabilities_mask_(0) {
     robot_actions* actions = robot_actions::get_instance();
     char buffer[PATH_MAX + 1];  // +1 for the null terminator
     ssize_t len = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
@@ -32,6 +32,7 @@ capability_parser::capability_parser(std::string _capabilities_file_name) {
             throw std::invalid_argument(error_string);
         }
         capabilities_.insert(capability.asString());
+        capabilities_mask_ |= action_mask(actions->get_action_id(capability.asString()));
     }
 }
 
@@ -39,9 +40,14 @@ capability_parser::~capability_parser() {
 }
 
 bool capability_parser::is_capable_to(std::string _action_name) {
-    return capabilities_.find(_action_name) != capabilities_.end();
+    robot_actions* actions = robot_actions::get_instance();
+    return actions->has_action(_action_name) && is_capable_to(action_mask(actions->get_action_id(_action_name)));
 }
 
 std::unordered_set<std::string> capability_parser::get_capabilities() {
     return capabilities_;
+}
+
+capability_mask_t capability_parser::get_capabilities_mask() const {
+    return capabilities_mask_;
 }
\ No newline at end of file
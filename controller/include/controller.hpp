@@ -16,6 +16,9 @@
 #include <thread>
 #include <map>
 #include <unordered_set>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
 #include <memory>
 #include <condition_variable>
 #include <atomic>
@@ -26,7 +29,9 @@
 #include "browsenames.h"
 #include "method_node_caller.hpp"
 #include "client_connection_establisher.hpp"
+#include "client_reactor.hpp"
 #include "types.hpp"
+#include "robot_registry.hpp"
 #include "recipe_parser.hpp"
 #include "robot_state.hpp"
 #include "robot_tool.hpp"
@@ -34,13 +39,18 @@
 #include "node_browser_helper.hpp"
 #include "discovery_util.hpp"
 #include "mape.hpp"
+#include "route_plan.hpp"
 #include "information_node_reader.hpp"
+#include "kitchen_clock.hpp"
 
 using namespace cps_kitchen;
 
 typedef std::function<void(position_t, position_t)> position_swapped_callback_t; /**< the callback declaration to notify about position change. */
 typedef std::function<void(position_t)> capabilities_reconfigured_callback_t; /**< the callback declaration to notify about position change. */
 
+struct remote_robot;
+typedef std::function<void(const remote_robot&)> robot_changed_callback_t; /**< the callback declaration to notify about a changed robot descriptor or a stopped robot. */
+
 /**
  * @brief Remote robot client to monitor kitchen robot attributes.
  * 
@@ -50,19 +60,20 @@ struct remote_robot {
         UA_Client* client_; /**< the OPC UA remote robot client pointer. */
         std::string endpoint_; /**< the endpoint address. */
         std::atomic<position_t> position_; /**< the position on the conveyor belt. */
-        std::unordered_set<std::string> capabilities_; /**< the capabilites. */
-        std::string capabilities_str_; /**< the string representation of the capabilites. */
+        std::atomic<capability_mask_t> capabilities_mask_; /**< the capability mask served from the subscription. */
         position_swapped_callback_t position_swapped_callback_; /**< the callback to notify about position change. */
         capabilities_reconfigured_callback_t capabilities_reconfigured_callback_; /**< the callback to notify about capabilitiy reconfgurations. */
+        robot_changed_callback_t robot_changed_callback_; /**< the callback to notify about changes of the robot descriptor. */
         std::unique_ptr<node_value_subscriber> nv_subscriber_; /**< the node value subscriber. */
+        monitoring_parameters overall_time_parameters_; /**< the monitoring parameters of the overall time. */
         std::unordered_map<std::string, UA_NodeId> attribute_id_map_; /**< the map holding the robot's attribute node ids. */
         std::unordered_map<std::string, object_method_info> method_id_map_; /**< the map holding the node ids of client methods. */
         std::atomic<robot_tool> last_equipped_tool_; /**< the last equipped tool. */
         std::atomic<duration_t> overall_time_; /**< the total time the robot will be in use. */
         std::atomic<bool> running_; /**< flag to indicate whether the client thread should run. */
-        std::thread client_iterate_thread_; /**< the client iteration thread. */
-        std::mutex client_mutex_; /**< the mutex to synchronize client method calls. */
         std::atomic<bool> adaptivity_is_pending_; /**< flag to indicate whether adaptivity is pending. */
+        std::atomic<UA_Boolean> available_; /**< the availability served from the subscription. */
+        std::atomic<UA_Boolean> new_position_commit_is_pending_; /**< the pending new position commit flag served from the subscription. */
         bool initial_position_subscription_; /**< flag to indicate initial position subscription notification. */
         bool initial_capabilities_subscription_; /**< flag to indicate initial capabilities subscription notification. */
 
@@ -72,15 +83,20 @@ struct remote_robot {
          * 
          * @param _endpoint the robot's endpoint url.
          * @param _position the position of the remote robot at the conveyor.
-         * @param _capabilities the capabilities.
+         * @param _capabilities_mask the capability mask.
          * @param _position_swapped_callback the position swapped callback.
          * @param _capabilities_reconfigured_callback the reconfigured callback.
+         * @param _robot_changed_callback the robot descriptor changed callback, called from the client thread.
+         * @param _overall_time_parameters the monitoring parameters of the overall time.
          */
-        remote_robot(std::string _endpoint, position_t _position, std::unordered_set<std::string> _capabilities,
-                    position_swapped_callback_t _position_swapped_callback, capabilities_reconfigured_callback_t _capabilities_reconfigured_callback) :
-                    endpoint_(_endpoint), position_(_position), capabilities_(_capabilities), client_(nullptr),
-                    running_(true), adaptivity_is_pending_(false), position_swapped_callback_(_position_swapped_callback),
+        remote_robot(std::string _endpoint, position_t _position, capability_mask_t _capabilities_mask,
+                    position_swapped_callback_t _position_swapped_callback, capabilities_reconfigured_callback_t _capabilities_reconfigured_callback,
+                    robot_changed_callback_t _robot_changed_callback, const monitoring_parameters& _overall_time_parameters) :
+                    endpoint_(_endpoint), position_(_position), capabilities_mask_(_capabilities_mask), client_(nullptr),
+                    running_(true), adaptivity_is_pending_(false), available_(false), new_position_commit_is_pending_(false),
+                    position_swapped_callback_(_position_swapped_callback),
                     capabilities_reconfigured_callback_(_capabilities_reconfigured_callback),
+                    robot_changed_callback_(_robot_changed_callback), overall_time_parameters_(_overall_time_parameters),
                     initial_position_subscription_(true), initial_capabilities_subscription_(true) {
         }
 
@@ -94,107 +110,37 @@ struct remote_robot {
             if (client_ != nullptr) {
                 return running_.load() ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BAD;
             }
-            client_connection_establisher robot_connection_establisher;
-            bool connected = robot_connection_establisher.establish_connection(client_, endpoint_);
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+            bool connected = client_reactor::get_instance()->connect(client_, endpoint_, [this] {
+                stop_running();
+            });
             if (!connected) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Error establishing robot client session for position %d", position_.load());
                 return UA_STATUSCODE_BAD;
             }
-            attribute_id_map_[AVAILABILITY] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, AVAILABILITY);
-            if (UA_NodeId_equal(&attribute_id_map_[AVAILABILITY], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, AVAILABILITY);
-                return UA_STATUSCODE_BAD;
-            }
-            attribute_id_map_[NEW_POSITION_COMMIT_IS_PENDING] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, NEW_POSITION_COMMIT_IS_PENDING);
-            if (UA_NodeId_equal(&attribute_id_map_[NEW_POSITION_COMMIT_IS_PENDING], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, NEW_POSITION_COMMIT_IS_PENDING);
-                return UA_STATUSCODE_BAD;
-            }
-            attribute_id_map_[POSITION] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, POSITION);
-            if (UA_NodeId_equal(&attribute_id_map_[POSITION], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, POSITION);
-                return UA_STATUSCODE_BAD;
-            }
-            nv_subscriber_ = std::make_unique<node_value_subscriber>(client_);
-            UA_StatusCode status = nv_subscriber_->subscribe_node_value(attribute_id_map_[POSITION], position_changed, this);
-            if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s at position %d", __FUNCTION__, POSITION, position_.load());
-                return UA_STATUSCODE_BAD;
-            }
-            attribute_id_map_[CAPABILITIES] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, CAPABILITIES);
-            if (UA_NodeId_equal(&attribute_id_map_[CAPABILITIES], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, CAPABILITIES);
-                return UA_STATUSCODE_BAD;
-            }
-            status = nv_subscriber_->subscribe_node_value(attribute_id_map_[CAPABILITIES], capabilities_reconfigured, this);
+            UA_StatusCode status = node_browser_helper().resolve_ids(client_, ROBOT_TYPE,
+                {AVAILABILITY, NEW_POSITION_COMMIT_IS_PENDING, POSITION, CAPABILITIES_MASK, OVERALL_TIME, LAST_EQUIPPED_TOOL},
+                {SWITCH_POSITION, RECONFIGURE, COMMIT_NEW_POSITION}, attribute_id_map_, method_id_map_);
             if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s at position %d", __FUNCTION__, CAPABILITIES, position_.load());
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not resolve the remote robot's node ids", __FUNCTION__);
                 return UA_STATUSCODE_BAD;
             }
-            attribute_id_map_[OVERALL_TIME] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, OVERALL_TIME);
-            if (UA_NodeId_equal(&attribute_id_map_[OVERALL_TIME], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, OVERALL_TIME);
-                return UA_STATUSCODE_BAD;
-            }
-            status = nv_subscriber_->subscribe_node_value(attribute_id_map_[OVERALL_TIME], overall_time_changed, this);
-            if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s at position %d", __FUNCTION__, OVERALL_TIME, position_.load());
-                return UA_STATUSCODE_BAD;
-            }
-            attribute_id_map_[LAST_EQUIPPED_TOOL] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, LAST_EQUIPPED_TOOL);
-            if (UA_NodeId_equal(&attribute_id_map_[LAST_EQUIPPED_TOOL], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, LAST_EQUIPPED_TOOL);
-                return UA_STATUSCODE_BAD;
-            }
-            status = nv_subscriber_->subscribe_node_value(attribute_id_map_[LAST_EQUIPPED_TOOL], last_equipped_tool_changed, this);
+            nv_subscriber_ = std::make_unique<node_value_subscriber>(client_);
+            status = nv_subscriber_->subscribe_node_values({
+                {attribute_id_map_[POSITION], position_changed, this},
+                {attribute_id_map_[CAPABILITIES_MASK], capabilities_reconfigured, this},
+                {attribute_id_map_[OVERALL_TIME], overall_time_changed, this, overall_time_parameters_},
+                {attribute_id_map_[LAST_EQUIPPED_TOOL], last_equipped_tool_changed, this},
+                {attribute_id_map_[AVAILABILITY], boolean_changed, &available_},
+                {attribute_id_map_[NEW_POSITION_COMMIT_IS_PENDING], boolean_changed, &new_position_commit_is_pending_}
+            });
             if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s at position %d", __FUNCTION__, LAST_EQUIPPED_TOOL, position_.load());
-                return UA_STATUSCODE_BAD;
-            }
-            if ((method_id_map_[SWITCH_POSITION] = node_browser_helper().get_method_id(client_, ROBOT_TYPE, SWITCH_POSITION)) == OBJECT_METHOD_INFO_NULL) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, SWITCH_POSITION);
-                return UA_STATUSCODE_BAD;
-            }
-            if ((method_id_map_[RECONFIGURE] = node_browser_helper().get_method_id(client_, ROBOT_TYPE, RECONFIGURE)) == OBJECT_METHOD_INFO_NULL) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, RECONFIGURE);
-                return UA_STATUSCODE_BAD;
-            }
-            if ((method_id_map_[COMMIT_NEW_POSITION] = node_browser_helper().get_method_id(client_, ROBOT_TYPE, COMMIT_NEW_POSITION)) == OBJECT_METHOD_INFO_NULL) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, COMMIT_NEW_POSITION);
-                return UA_STATUSCODE_BAD;
-            }
-            capabilities_str_ = "[";
-            for (auto capability : capabilities_) {
-                capabilities_str_ += capability + ", ";
-            }
-            capabilities_str_.erase(capabilities_str_.end()-2, capabilities_str_.end());
-            capabilities_str_ += "]";
-            try {
-                client_iterate_thread_ = std::thread([this]() {
-                    while(running_) {
-                        {
-                            std::lock_guard<std::mutex> lock(client_mutex_);
-                            UA_StatusCode status = UA_Client_run_iterate(client_, 1);
-                            if (status != UA_STATUSCODE_GOOD) {
-                                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running robot client at position %d (%s)", __FUNCTION__, position_.load(), UA_StatusCode_name(status));
-                                running_.store(false);
-                                return UA_STATUSCODE_BAD;
-                            }
-                        }
-                        if (usleep(1*1000)) {
-                            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error at robot client iterate sleep", __FUNCTION__);
-                            running_.store(false);
-                            return UA_STATUSCODE_BAD;
-                        }
-                        // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Starting the next client iterate", __FUNCTION__);
-                    }
-                    return UA_STATUSCODE_BAD;
-                });
-            } catch (...) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Error running the robot client iterate thread at position %d", __FUNCTION__, position_.load());
-                running_.store(false);
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's attributes at position %d (%s)", __FUNCTION__, position_.load(), UA_StatusCode_name(status));
                 return UA_STATUSCODE_BAD;
             }
+            /* Without heartbeat the flags are read synchronously */
+            if (nv_subscriber_->subscribe_heartbeat() != UA_STATUSCODE_GOOD)
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to the heartbeat of the remote robot at position %d", __FUNCTION__, position_.load());
             return UA_STATUSCODE_GOOD;
         }
 
@@ -204,10 +150,9 @@ struct remote_robot {
          */
         ~remote_robot() {
             running_.store(false);
-            if (client_iterate_thread_.joinable())
-                client_iterate_thread_.join();
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
             nv_subscriber_.reset();
-            UA_Client_delete(client_);
+            client_reactor::get_instance()->delete_client(client_);
         }
 
         /**
@@ -231,13 +176,13 @@ struct remote_robot {
         }
 
         /**
-         * @brief Returns the capabilities set.
+         * @brief Returns the capability mask.
          * 
-         * @return std::unordered_set<std::string> the capabilites.
+         * @return capability_mask_t the capability mask.
          */
-        std::unordered_set<std::string>
-        get_capabilities() const {
-            return capabilities_;
+        capability_mask_t
+        get_capabilities_mask() const {
+            return capabilities_mask_.load(std::memory_order_relaxed);
         }
 
         /**
@@ -247,19 +192,19 @@ struct remote_robot {
          */
         std::string
         get_capabilites_string() const {
-            return capabilities_str_;
+            return capabilities_to_string(get_capabilities_mask());
         }
 
         /**
-         * @brief Indicates if a robot is capable to perform the given action.
+         * @brief Indicates if a robot is capable to perform all actions of the given mask.
          * 
-         * @param _capability the action to check whether it can be performed.
-         * @return true if the remote is capable to perform the action.
-         * @return false if the remote is not capable to perform the action.
+         * @param _actions_mask the capability mask of the actions to check whether they can be performed.
+         * @return true if the remote is capable to perform the actions.
+         * @return false if the remote is not capable to perform the actions.
          */
         bool
-        is_capable_to(std::string _capability) const {
-            return capabilities_.find(_capability) != capabilities_.end();
+        is_capable_to(capability_mask_t _actions_mask) const {
+            return (get_capabilities_mask() & _actions_mask) == _actions_mask;
         }
 
         /**
@@ -289,10 +234,20 @@ struct remote_robot {
          * @return false if there is no adaptivity running.
          */
         bool
-        is_adaptivity_pending() {
+        is_adaptivity_pending() const {
             return adaptivity_is_pending_.load();
         }
 
+        /**
+         * @brief Returns the current state of the remote robot.
+         * 
+         * @return robot_descriptor the robot descriptor.
+         */
+        robot_descriptor
+        get_descriptor() const {
+            return {endpoint_, position_.load(), get_capabilities_mask(), overall_time_.load(), last_equipped_tool_.load(), adaptivity_is_pending_.load()};
+        }
+
     private:
         friend class controller;
         
@@ -313,11 +268,11 @@ struct remote_robot {
             object_method_info omi = method_id_map_[SWITCH_POSITION];
             UA_StatusCode status = UA_STATUSCODE_GOOD;
             {
-                std::lock_guard<std::mutex> lock(client_mutex_);
+                client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
                 status = switch_robot_position_caller.call_method_node(client_, omi.object_id_, omi.method_id_, _output_size, _output);
                 if(status != UA_STATUSCODE_GOOD) {
                     UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling %s method (%s)", __FUNCTION__, SWITCH_POSITION, UA_StatusCode_name(status));
-                    running_.store(false);
+                    stop_running();
                     return UA_STATUSCODE_BAD;
                 }
             }
@@ -342,12 +297,12 @@ struct remote_robot {
             object_method_info omi = method_id_map_[RECONFIGURE];
             UA_StatusCode status = UA_STATUSCODE_GOOD;
             {
-                std::lock_guard<std::mutex> lock(client_mutex_);
+                client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
                 status = reconfigure_robot_caller.call_method_node(client_, omi.object_id_, omi.method_id_, _output_size, _output);
                 if(status != UA_STATUSCODE_GOOD) {
                     UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling %s method (%s)", __FUNCTION__, RECONFIGURE, UA_StatusCode_name(status));
                     UA_String_clear(&new_capabilities_profile);
-                    running_.store(false);
+                    stop_running();
                     return UA_STATUSCODE_BAD;
                 }
                 UA_String_clear(&new_capabilities_profile);
@@ -370,11 +325,11 @@ struct remote_robot {
             object_method_info omi = method_id_map_[COMMIT_NEW_POSITION];
             UA_StatusCode status = UA_STATUSCODE_GOOD;
             {
-                std::lock_guard<std::mutex> lock(client_mutex_);
+                client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
                 status = commit_new_position_caller.call_method_node(client_, omi.object_id_, omi.method_id_, _output_size, _output);
                 if(status != UA_STATUSCODE_GOOD) {
                     UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling %s method (%s)", __FUNCTION__, COMMIT_NEW_POSITION, UA_StatusCode_name(status));
-                    running_.store(false);
+                    stop_running();
                     return UA_STATUSCODE_BAD;
                 }
             }
@@ -401,11 +356,12 @@ struct remote_robot {
             remote_robot* self = static_cast<remote_robot*>(_mon_context);
             if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_UINT32])) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
-                self->running_.store(false);
+                self->stop_running();
                 return;
             }
             UA_UInt32 old_position = self->position_.load();
             self->position_.store(*(UA_UInt32*) _value->value.data);
+            self->robot_changed_callback_(*self);
             if (self->initial_position_subscription_) {
                 self->initial_position_subscription_ = false;
                 return;
@@ -432,17 +388,13 @@ struct remote_robot {
                 return;
             }
             remote_robot* self = static_cast<remote_robot*>(_mon_context);
-            if (!UA_Variant_hasArrayType(&_value->value, &UA_TYPES[UA_TYPES_STRING])) {
+            if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_UINT64])) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
-                self->running_.store(false);
+                self->stop_running();
                 return;
             }
-            std::unordered_set<std::string> remote_robot_capabilities;
-            for (size_t i = 0; i < _value->value.arrayLength; i++) {
-                UA_String capability = ((UA_String*)_value->value.data)[i];
-                remote_robot_capabilities.insert(std::string((char*) capability.data, capability.length));
-            }
-            self->capabilities_ = remote_robot_capabilities;
+            self->capabilities_mask_.store(*(capability_mask_t*) _value->value.data, std::memory_order_relaxed);
+            self->robot_changed_callback_(*self);
             if (self->initial_capabilities_subscription_) {
                 self->initial_capabilities_subscription_ = false;
                 return;
@@ -470,10 +422,11 @@ struct remote_robot {
             remote_robot* self = static_cast<remote_robot*>(_mon_context);
             if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_UINT32])) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
-                self->running_.store(false);
+                self->stop_running();
                 return;
             }
             self->overall_time_.store(*(UA_UInt32*) _value->value.data);
+            self->robot_changed_callback_(*self);
             // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Remote robot's overall time at position %d is %ld", __FUNCTION__, self->position_.load(), self->overall_time_);
         }
 
@@ -497,13 +450,61 @@ struct remote_robot {
             remote_robot* self = static_cast<remote_robot*>(_mon_context);
             if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_UINT32])) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
-                self->running_.store(false);
+                self->stop_running();
                 return;
             }
             self->last_equipped_tool_.store(*(robot_tool*) _value->value.data);
+            self->robot_changed_callback_(*self);
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Remote robot's last equipped tool at position %d is %s", __FUNCTION__, self->position_.load(), robot_tool_to_string(self->last_equipped_tool_.load()));
         }
 
+        /**
+         * @brief The boolean attribute changed callback for the subscription, storing the value in the monitored flag.
+         * 
+         * @param _client the client issuing the subscription.
+         * @param _sub_id server-assigned subscription id that delivered this notification.
+         * @param _sub_context user-defined context data passed when creating the subscription.
+         * @param _mon_id server-assigned MonitoredItemId that produced the data change.
+         * @param _mon_context the std::atomic<UA_Boolean> flag to update.
+         * @param _value the reported UA_DataValue.
+         */
+        static void
+        boolean_changed(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context,
+            UA_UInt32 _mon_id, void* _mon_context, UA_DataValue* _value) {
+            if(_mon_context == NULL) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Monitor context is NULL", __FUNCTION__);
+                return;
+            }
+            if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_BOOLEAN])) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
+                return;
+            }
+            static_cast<std::atomic<UA_Boolean>*>(_mon_context)->store(*(UA_Boolean*) _value->value.data);
+        }
+
+        /**
+         * @brief Returns a boolean attribute from its subscribed flag while the subscription is fresh,
+         * otherwise reads it synchronously and refreshes the flag.
+         * 
+         * @param _attribute_name the attribute browsename.
+         * @param _flag the subscribed flag of the attribute.
+         * @return UA_Boolean the attribute value, false on read errors.
+         */
+        UA_Boolean
+        read_boolean_attribute(const char* _attribute_name, std::atomic<UA_Boolean>& _flag) {
+            if (nv_subscriber_ != nullptr && nv_subscriber_->is_fresh())
+                return _flag.load();
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+            information_node_reader inr;
+            if (inr.read_information_node(client_, attribute_id_map_[_attribute_name]) != UA_STATUSCODE_GOOD) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not read the %s attribute id", __FUNCTION__, _attribute_name);
+                stop_running();
+                return false;
+            }
+            _flag.store(*(UA_Boolean*)inr.get_variant()->data);
+            return _flag.load();
+        }
+
         /**
          * @brief Returns whether the robot is available.
          * 
@@ -512,14 +513,7 @@ struct remote_robot {
          */
         UA_Boolean
         is_available() {
-            std::lock_guard<std::mutex> lock(client_mutex_);
-            information_node_reader inr;
-            if (inr.read_information_node(client_, attribute_id_map_[AVAILABILITY]) != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not read the %s attribute id", __FUNCTION__, AVAILABILITY);
-                running_.store(false);
-                return false;
-            }
-            return *(UA_Boolean*)inr.get_variant()->data;
+            return read_boolean_attribute(AVAILABILITY, available_);
         }
 
         /**
@@ -530,14 +524,7 @@ struct remote_robot {
          */
         UA_Boolean
         has_pending_new_position_commit() {
-            std::lock_guard<std::mutex> lock(client_mutex_);
-            information_node_reader inr;
-            if (inr.read_information_node(client_, attribute_id_map_[NEW_POSITION_COMMIT_IS_PENDING]) != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not read the %s attribute id", __FUNCTION__, NEW_POSITION_COMMIT_IS_PENDING);
-                running_.store(false);
-                return false;
-            }
-            return *(UA_Boolean*)inr.get_variant()->data;
+            return read_boolean_attribute(NEW_POSITION_COMMIT_IS_PENDING, new_position_commit_is_pending_);
         }
 
         /**
@@ -563,9 +550,20 @@ struct remote_robot {
          * @return false if robot is still running.
          */
         bool
-        is_stopped() {
+        is_stopped() const {
             return !running_.load();
         }
+
+    private:
+        /**
+         * @brief Marks the remote robot as stopped and notifies about it once.
+         * 
+         */
+        void
+        stop_running() {
+            if (running_.exchange(false))
+                robot_changed_callback_(*this);
+        }
 };
 
 /**
@@ -579,8 +577,6 @@ struct next_robot_receiver {
         std::string type_; /**< the agent type. */
         std::unordered_map<std::string, object_method_info> method_id_map_; /**< the map holding the node ids of client methods. */
         std::atomic<bool> running_; /**< flag to indicate whether the client thread should run. */
-        std::thread client_iterate_thread_; /**< the client iteration thread. */
-        std::mutex client_mutex_; /**< the mutex to synchronize client method calls. */
     public:
         next_robot_receiver(std::string _endpoint, std::string _type) :
         client_(nullptr), endpoint_(_endpoint), type_(_type), running_(true) {
@@ -596,8 +592,10 @@ struct next_robot_receiver {
             if (client_ != nullptr) {
                 return running_.load() ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BAD;
             }
-            client_connection_establisher connection_establisher;
-            bool connected = connection_establisher.establish_connection(client_, endpoint_);
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+            bool connected = client_reactor::get_instance()->connect(client_, endpoint_, [this] {
+                running_.store(false);
+            });
             if (!connected) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Error establishing next robot receiver client session (%s,%s)", endpoint_.c_str(), type_.c_str());
                 return UA_STATUSCODE_BAD;
@@ -606,33 +604,6 @@ struct next_robot_receiver {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, RECEIVE_NEXT_ROBOT);
                 return UA_STATUSCODE_BAD;
             }
-
-            try {
-                client_iterate_thread_ = std::thread([this]() {
-                    while(running_) {
-                        {
-                            std::lock_guard<std::mutex> lock(client_mutex_);
-                            UA_StatusCode status = UA_Client_run_iterate(client_, 1);
-                            if (status != UA_STATUSCODE_GOOD) {
-                                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running next robot receiver client (%s,%s) (%s)", __FUNCTION__, endpoint_.c_str(), type_.c_str(), UA_StatusCode_name(status));
-                                running_.store(false);
-                                return UA_STATUSCODE_BAD;
-                            }
-                        }
-                        if (usleep(1*1000)) {
-                            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error at robot client iterate sleep", __FUNCTION__);
-                            running_.store(false);
-                            return UA_STATUSCODE_BAD;
-                        }
-                        // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Starting the next client iterate", __FUNCTION__);
-                    }
-                    return UA_STATUSCODE_BAD;
-                });
-            } catch (...) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running next robot receiver client (%s,%s)", __FUNCTION__, endpoint_.c_str(), type_.c_str());
-                running_.store(false);
-                return UA_STATUSCODE_BAD;
-            }
             return UA_STATUSCODE_GOOD;
         }
 
@@ -657,38 +628,29 @@ struct next_robot_receiver {
         }
 
         /**
-         * @brief Sends the next robot for a request for a recipe id.
+         * @brief Sends the next robot for a request for a recipe id without blocking the calling io_context.
+         * The receiver must not be accessed after resumption since it may have been removed meanwhile.
          * 
          * @param _robot_position the robot position.
          * @param _robot_endpoint the robot endpoint.
          * @param _recipe_id the recipe id the response is for.
-         * @param _output_size the count of returned output values.
-         * @param _output the variant containing the output values.
-         * @return UA_StatusCode the status whether method call was successful.
+         * @return boost::asio::awaitable<method_call_result> the awaitable completing with the method call result.
          */
-        UA_StatusCode
-        receive_next_robot(position_t _robot_position, std::string _robot_endpoint, recipe_id_t _recipe_id, size_t* _output_size, UA_Variant** _output) {
+        boost::asio::awaitable<method_call_result>
+        async_receive_next_robot(position_t _robot_position, std::string _robot_endpoint, recipe_id_t _recipe_id) {
             // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RECEIVE NEXT ROBOT: Respond to next robot receiver (%s,%s) with robot position %d for recipe id %d", endpoint_.c_str(), type_.c_str(), _robot_position, _recipe_id);
             method_node_caller receive_next_robot_caller;
             receive_next_robot_caller.add_scalar_input_argument(&_robot_position, UA_TYPES_UINT32);
             UA_String robot_endpoint = UA_STRING_ALLOC(_robot_endpoint.c_str());
             receive_next_robot_caller.add_scalar_input_argument(&robot_endpoint, UA_TYPES_STRING);
+            UA_String_clear(&robot_endpoint);
             receive_next_robot_caller.add_scalar_input_argument(&_recipe_id, UA_TYPES_UINT32);
             object_method_info omi = method_id_map_[RECEIVE_NEXT_ROBOT];
-            UA_StatusCode status = UA_STATUSCODE_GOOD;
-            {
-                std::lock_guard<std::mutex> lock(client_mutex_);
-                status = receive_next_robot_caller.call_method_node(client_, omi.object_id_, omi.method_id_, _output_size, _output);
-                if(status != UA_STATUSCODE_GOOD) {
-                    UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling %s method (%s)", __FUNCTION__, RECEIVE_NEXT_ROBOT, UA_StatusCode_name(status));
-                    running_.store(false);
-                    UA_String_clear(&robot_endpoint);
-                    return UA_STATUSCODE_BAD;
-                }
-                UA_String_clear(&robot_endpoint);
-            }
-            return status;
+            method_call_result result = co_await receive_next_robot_caller.async_call(client_, omi.object_id_, omi.method_id_, [] {
+                return client_reactor::get_instance()->lock();
+            });
+            co_return result;
         }
 
         /**
@@ -697,9 +659,8 @@ struct next_robot_receiver {
          */
         ~next_robot_receiver() {
             running_.store(false);
-            if (client_iterate_thread_.joinable())
-                client_iterate_thread_.join();
-            UA_Client_delete(client_);
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+            client_reactor::get_instance()->delete_client(client_);
         }
 };
 
@@ -726,26 +687,71 @@ struct swap_state {
 };
 
 using swap_key = std::tuple<UA_UInt32, UA_UInt32>;
+
+/**
+ * @brief A cached routing decision of the MAPE.
+ * 
+ */
+struct routing_decision {
+    position_t position_; /**< the position of the appointed robot, 0 if no robot was suitable. */
+    uint64_t registry_version_; /**< the registry version the decision was made at. */
+};
+
+using routing_key = std::tuple<recipe_id_t, UA_UInt32>;
+
+/**
+ * @brief An agent requesting next robots, whose requests are handled in order on its own strand.
+ * 
+ */
+struct next_robot_requester {
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_; /**< the strand serializing the requester's requests. */
+    std::unique_ptr<next_robot_receiver> receiver_; /**< the receiver of the responses, only accessed on the strand. */
+
+    /**
+     * @brief Constructs a new next robot requester object.
+     * 
+     * @param _io_context the io context the requests are handled on.
+     */
+    explicit next_robot_requester(boost::asio::io_context& _io_context) : strand_(boost::asio::make_strand(_io_context)), receiver_(nullptr) {
+    }
+};
+
+using requester_key = std::pair<std::string, std::string>;
 class controller {
 private:
     /* controller related member variables. */
     UA_Server* server_; /**< the OPC UA controller server pointer. */
     object_type_node_inserter controller_type_inserter_; /**< the controller type insert for adding the controller's methods and attributes to the address space. */
+    std::atomic<UA_UInt32> registered_robots_; /**< the number of registered robots, served through the registered robots data source. */
+    std::atomic<UA_Double> routing_cache_hit_rate_; /**< the share of routing decisions served from the cache, served through the routing cache hit rate data source. */
     std::atomic<bool> running_; /**< flag to indicate whether the server thread should run. */
     std::thread server_iterate_thread_; /**< the server iteration thread. */
     discovery_util discovery_util_; /**< the discovery utility. */
-    std::thread worker_thread_; /**< the worker thread. */
-    boost::asio::io_context io_context_; /**< the io context managing the worker thread. */
+    std::vector<std::thread> worker_threads_; /**< the worker thread pool. */
+    boost::asio::io_context io_context_; /**< the io context managing the worker threads. */
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type, void, void> work_guard_; /**< the work guard for the io_context_. */
-    std::map<std::pair<std::string,std::string>, std::unique_ptr<next_robot_receiver>> next_robot_receiver_map_; /**< the map holding the next robot receivers. */
+    std::map<requester_key, next_robot_requester> requesters_; /**< the next robot requesters by endpoint and type, never erased. */
+    std::mutex requesters_mutex_; /**< the mutex protecting the requesters map. */
+    /* registry related member variables: the remote robots are updated under the registry lock and published as snapshots. */
+    std::mutex registry_mutex_; /**< the mutex guarding the remote robots and pending swaps. */
+    boost::asio::strand<boost::asio::io_context::executor_type> registry_strand_; /**< the strand applying the posted registry updates in order. */
+    robot_registry robot_registry_; /**< the registry publishing the robot descriptor snapshots read by the routing decisions. */
     /* robot related member variables. */
     std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>> position_remote_robot_map_; /**< the map holding the remote robot instances. */
     /* recipe related member variables. */
     recipe_parser recipe_parser_; /**< the recipe parser. */
     /* mape interface related member variables */
     std::unique_ptr<mape> kitchen_mape_; /**< the kitchen mape. */
+    std::mutex mape_mutex_; /**< the mutex serializing the decisions of the kitchen mape. */
+    kitchen_timer layout_review_timer_; /**< the timer of the kitchen mape's layout reviews. */
+    monitoring_parameters overall_time_parameters_; /**< the monitoring parameters of the robots' overall time, every change is reported by default. */
     /* adaptivity related member variables */
     std::unordered_map<swap_key, swap_state, tuple_hash> pending_swaps_;
+    /* routing cache related member variables */
+    std::unordered_map<routing_key, routing_decision, tuple_hash> routing_cache_; /**< the routing decisions by recipe ID and processed steps. */
+    std::shared_mutex routing_cache_mutex_; /**< the mutex guarding the routing cache. */
+    std::atomic<uint64_t> routing_cache_lookups_; /**< the count of routing cache lookups. */
+    std::atomic<uint64_t> routing_cache_hits_; /**< the count of routing cache hits. */
  
     /**
      * @brief Extracts the received robot registration parameters.
@@ -776,10 +782,11 @@ private:
      * 
      * @param _endpoint the robot's endpoint url.
      * @param _position the position of the remote robot.
-     * @param _remote_robot_capabilities the capabilities of the remote robot.
+     * @param _remote_robot_capabilities_mask the capability mask of the remote robot.
+     * @param _conveyor_size the count of conveyor positions known to the remote robot.
      */
     void
-    handle_robot_registration(std::string _endpoint, position_t _position, std::unordered_set<std::string> _remote_robot_capabilities);
+    handle_robot_registration(std::string _endpoint, position_t _position, capability_mask_t _remote_robot_capabilities_mask, position_t _conveyor_size);
 
     /**
      * @brief Checks if the position is involved in a position swap and returns the corresponding map key.
@@ -816,16 +823,66 @@ private:
             size_t _input_size, const UA_Variant* _input,
             size_t _output_size, UA_Variant* _output);
 
+    /**
+     * @brief Chooses the next suitable robots for a batch of orders jointly and returns them in the response.
+     * 
+     * @param _server the server instance from which this method is called.
+     * @param _session_id the client session id.
+     * @param _session_context user-defined context data passed via the access control/plugin.
+     * @param _method_id the node id of this method.
+     * @param _method_context user-defined context data passed to the method node.
+     * @param _object_id node id of the object or object type on which the method is called (the “parent” that hasComponent to the method).
+     * @param _object_context user-defined context data passed to that object/ObjectType node. Use for instance-specific state.
+     * @param _input_size the count of the input parameters.
+     * @param _input the input pointer of the input parameters.
+     * @param _output_size the allocated output size.
+     * @param _output the output pointer to store return parameters.
+     * @return UA_StatusCode the status code.
+     */
+    static UA_StatusCode
+    choose_next_robots(UA_Server* _server,
+            const UA_NodeId* _session_id, void* _session_context,
+            const UA_NodeId* _method_id, void* _method_context,
+            const UA_NodeId* _object_id, void* _object_context,
+            size_t _input_size, const UA_Variant* _input,
+            size_t _output_size, UA_Variant* _output);
+
+    /**
+     * @brief Plans the route of robots for the remaining steps of an order and returns it in the response.
+     * 
+     * @param _server the server instance from which this method is called.
+     * @param _session_id the client session id.
+     * @param _session_context user-defined context data passed via the access control/plugin.
+     * @param _method_id the node id of this method.
+     * @param _method_context user-defined context data passed to the method node.
+     * @param _object_id node id of the object or object type on which the method is called (the “parent” that hasComponent to the method).
+     * @param _object_context user-defined context data passed to that object/ObjectType node. Use for instance-specific state.
+     * @param _input_size the count of the input parameters.
+     * @param _input the input pointer of the input parameters.
+     * @param _output_size the allocated output size.
+     * @param _output the output pointer to store return parameters.
+     * @return UA_StatusCode the status code.
+     */
+    static UA_StatusCode
+    plan_route(UA_Server* _server,
+            const UA_NodeId* _session_id, void* _session_context,
+            const UA_NodeId* _method_id, void* _method_context,
+            const UA_NodeId* _object_id, void* _object_context,
+            size_t _input_size, const UA_Variant* _input,
+            size_t _output_size, UA_Variant* _output);
+
     /**
      * @brief Chooses the next suitable robot.
      * 
      * @param _recipe_id the recipe id of the partial finished order.
      * @param _processed_steps the steps until the recipe is processed.
+     * @param _plate_position the conveyor position of the order's plate, 0 for new orders.
      * @param _endpoint the requester's endpoint.
      * @param _type the requester's type.
+     * @return boost::asio::awaitable<void> the request handling coroutine.
      */
-    void
-    handle_next_robot_request(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, std::string _endpoint, std::string _type);
+    boost::asio::awaitable<void>
+    handle_next_robot_request(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _plate_position, std::string _endpoint, std::string _type);
 
     /**
      * @brief Extracts return values of receive next robot call.
@@ -839,14 +896,80 @@ private:
     receive_next_robot_called(size_t _output_size, UA_Variant* _output);
 
     /**
-     * @brief Returns a suitable robot for the given recipe ID starting from the next step to be processed.
+     * @brief Returns the requester with the given endpoint and type, adding it on its first request.
+     * 
+     * @param _endpoint the requester's endpoint.
+     * @param _type the requester's type.
+     * @return next_robot_requester& the requester, valid for the lifetime of the controller.
+     */
+    next_robot_requester&
+    get_requester(const std::string& _endpoint, const std::string& _type);
+
+    /**
+     * @brief Looks up the cached routing decision for the given recipe ID and processed steps.
+     * 
+     * @param _snapshot the registry snapshot the decision must be valid for.
+     * @param _recipe_id the recipe ID.
+     * @param _processed_steps the steps until the recipe is processed.
+     * @param _position the position of the cached suitable robot, 0 if no robot was suitable.
+     * @return true if a valid decision is cached.
+     * @return false if the decision has to be made by the MAPE.
+     */
+    bool
+    find_cached_robot(const robot_registry_snapshot& _snapshot, recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t& _position);
+
+    /**
+     * @brief Returns the position of a suitable robot for the given recipe ID starting from the next step to be processed
+     * and caches the decision. The decision is made on the latest registry snapshot.
      * 
      * @param _recipe_id the recipe ID.
      * @param _processed_steps the steps until the recipe is processed.
-     * @return remote_robot* the suitable robot.
+     * @param _plate_position the conveyor position of the order's plate, 0 for new orders.
+     * @return position_t the position of the suitable robot, 0 if no robot is suitable.
      */
-    remote_robot*
-    find_suitable_robot(recipe_id_t _recipe_id, UA_UInt32 _processed_steps);
+    position_t
+    find_suitable_robot(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _plate_position);
+
+    /**
+     * @brief Returns suitable robots for a batch of orders, assigned jointly by the MAPE on the latest registry snapshot.
+     * The decisions are not cached.
+     * 
+     * @param _recipe_ids the recipe IDs of the orders.
+     * @param _processed_steps the processed steps of the orders.
+     * @param _snapshot the registry snapshot the returned descriptors belong to.
+     * @return std::vector<order_assignment> the suitable robot of every order in the sequence to instruct them.
+     */
+    std::vector<order_assignment>
+    find_suitable_robots(const std::vector<recipe_id_t>& _recipe_ids, const std::vector<UA_UInt32>& _processed_steps, std::shared_ptr<const robot_registry_snapshot>& _snapshot);
+
+    /**
+     * @brief Returns the route of robots for the remaining steps of an order, planned by the MAPE on the latest registry snapshot.
+     * The routes are not cached.
+     * 
+     * @param _recipe_id the recipe ID.
+     * @param _processed_steps the processed steps of the order.
+     * @param _plate_position the conveyor position of the order's plate, 0 for new orders.
+     * @return route_plan the planned robots, empty if no route is found.
+     */
+    route_plan
+    find_route(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _plate_position);
+
+    /**
+     * @brief Publishes a registry snapshot of the running remote robots, which invalidates all cached routing decisions.
+     * Must be called holding the registry lock on every registration, removal, position swap and adaptivity flag change.
+     * 
+     */
+    void
+    publish_registry_snapshot();
+
+    /**
+     * @brief Called when a remote robot's descriptor changed or the robot stopped. Publishes the change without
+     * taking the registry lock, since it is called from the client thread.
+     * 
+     * @param _robot the changed remote robot.
+     */
+    void
+    robot_changed_callback(const remote_robot& _robot);
 
     /**
      * @brief Instructs a remote robot to swap its position with another robot.
@@ -918,14 +1041,12 @@ private:
     remove_stopped_robots();
 
     /**
-     * @brief Helper method for incrementing or decrementing a numerical UA_UINT32 attribute node (increments by default).
+     * @brief Schedules the next layout review of the kitchen mape, if it reviews the layout. The review runs on the
+     * worker threads without the decisions' mape lock, so it never delays a request.
      * 
-     * @param _attribute_name the attribute name.
-     * @param _increment indicator for incrementing or decrementing.
-     * @return UA_StatusCode the status code indicating whether incrementing/decrementing succeeded.
      */
-    UA_StatusCode
-    increment_or_decrement_counter_node(std::string _attribute_name, bool increment = true);
+    void
+    arm_layout_review();
 
     /**
      * @brief Joins all started threads.
@@ -938,8 +1059,10 @@ public:
     /**
      * @brief Construct a new controller object.
      * 
+     * @param _kitchen_mape the kitchen mape deciding the next robots and adaptations.
+     * @param _overall_time_parameters the monitoring parameters of the robots' overall time, e.g. a deadband for coarse load updates.
      */
-    controller(std::unique_ptr<mape> _kitchen_mape);
+    controller(std::unique_ptr<mape> _kitchen_mape, monitoring_parameters _overall_time_parameters = monitoring_parameters());
 
     /**
      * @brief Destroy the controller object.
@@ -960,6 +1083,14 @@ public:
      */
     void
     stop();
+
+    /**
+     * @brief Returns the latest registry snapshot without blocking.
+     * 
+     * @return std::shared_ptr<const robot_registry_snapshot> the registry snapshot.
+     */
+    std::shared_ptr<const robot_registry_snapshot>
+    get_registry_snapshot() const;
 };
 
 #endif // CONTROLLER_HPP
\ No newline at end of file
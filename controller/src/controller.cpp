@@ -2,12 +2,15 @@
 #include <open62541/server_config_default.h>
 #include <string>
 #include <chrono>
+#include <algorithm>
 #include "filtered_logger.hpp"
+#include "time_unit.hpp"
 
 #define INSTANCE_NAME "KitchenController"
 
-controller::controller(std::unique_ptr<mape> _kitchen_mape) : server_(UA_Server_new()), controller_type_inserter_(server_, CONTROLLER_TYPE), running_(true),
-                                                            work_guard_(boost::asio::make_work_guard(io_context_)), recipe_parser_(), kitchen_mape_(std::move(_kitchen_mape)) {
+controller::controller(std::unique_ptr<mape> _kitchen_mape, monitoring_parameters _overall_time_parameters) : server_(UA_Server_new()), controller_type_inserter_(server_, CONTROLLER_TYPE), registered_robots_(0), routing_cache_hit_rate_(0.0), running_(true),
+                                                            work_guard_(boost::asio::make_work_guard(io_context_)), registry_strand_(boost::asio::make_strand(io_context_)), recipe_parser_(), kitchen_mape_(std::move(_kitchen_mape)),
+                                                            layout_review_timer_(io_context_), overall_time_parameters_(_overall_time_parameters), routing_cache_lookups_(0), routing_cache_hits_(0) {
     /* Setup controller */
     UA_ServerConfig* server_config = UA_Server_getConfig(server_);
     UA_StatusCode status = UA_ServerConfig_setMinimal(server_config, 0, NULL);
@@ -25,6 +28,7 @@ controller::controller(std::unique_ptr<mape> _kitchen_mape) : server_(UA_Server_
     choose_next_robot_arguments.add_input_argument("the processed steps", "processed_steps", UA_TYPES_UINT32);
     choose_next_robot_arguments.add_input_argument("the requester's endpoint", "endpoint", UA_TYPES_STRING);
     choose_next_robot_arguments.add_input_argument("the requester's type", "type", UA_TYPES_STRING);
+    choose_next_robot_arguments.add_input_argument("the plate position, 0 for new orders", "plate_position", UA_TYPES_UINT32);
     choose_next_robot_arguments.add_output_argument("the result", "result", UA_TYPES_BOOLEAN);
     status = controller_type_inserter_.add_method(CONTROLLER_TYPE, CHOOSE_NEXT_ROBOT, choose_next_robot, choose_next_robot_arguments, this);
     if(status != UA_STATUSCODE_GOOD) {
@@ -32,11 +36,38 @@ controller::controller(std::unique_ptr<mape> _kitchen_mape) : server_(UA_Server_
         running_.store(false);
         return;
     }
+    /* Add choose next robots method node */
+    method_arguments choose_next_robots_arguments;
+    choose_next_robots_arguments.add_input_argument("the recipe ids", "recipe_ids", UA_TYPES_UINT32);
+    choose_next_robots_arguments.add_input_argument("the processed steps", "processed_steps", UA_TYPES_UINT32);
+    choose_next_robots_arguments.add_output_argument("the order indices in the sequence to instruct the robots", "order_indices", UA_TYPES_UINT32);
+    choose_next_robots_arguments.add_output_argument("the positions of the next robots, 0 if no robot is suitable", "robot_positions", UA_TYPES_UINT32);
+    choose_next_robots_arguments.add_output_argument("the endpoints of the next robots", "robot_endpoints", UA_TYPES_STRING);
+    status = controller_type_inserter_.add_method(CONTROLLER_TYPE, CHOOSE_NEXT_ROBOTS, choose_next_robots, choose_next_robots_arguments, this);
+    if(status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error adding the %s method node", __FUNCTION__, CHOOSE_NEXT_ROBOTS);
+        running_.store(false);
+        return;
+    }
+    /* Add plan route method node */
+    method_arguments plan_route_arguments;
+    plan_route_arguments.add_input_argument("the recipe id", "recipe_id", UA_TYPES_UINT32);
+    plan_route_arguments.add_input_argument("the processed steps", "processed_steps", UA_TYPES_UINT32);
+    plan_route_arguments.add_input_argument("the plate position, 0 for new orders", "plate_position", UA_TYPES_UINT32);
+    plan_route_arguments.add_output_argument("the positions of the planned robots, empty if no route is found", "robot_positions", UA_TYPES_UINT32);
+    plan_route_arguments.add_output_argument("the endpoints of the planned robots", "robot_endpoints", UA_TYPES_STRING);
+    status = controller_type_inserter_.add_method(CONTROLLER_TYPE, PLAN_ROUTE, plan_route, plan_route_arguments, this);
+    if(status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error adding the %s method node", __FUNCTION__, PLAN_ROUTE);
+        running_.store(false);
+        return;
+    }
     /* Add register robot method node */
     method_arguments register_robot_arguments;
     register_robot_arguments.add_input_argument("the robot endpoint", "robot_endpoint", UA_TYPES_STRING);
     register_robot_arguments.add_input_argument("the robot position", "robot_position", UA_TYPES_UINT32);
     register_robot_arguments.add_input_argument("the robot capabilities", "robot_capabilities", UA_TYPES_STRING);
+    register_robot_arguments.add_input_argument("the conveyor size", "conveyor_size", UA_TYPES_UINT32);
     register_robot_arguments.add_output_argument("indicates whether the capabilities are received", "capabilities_received", UA_TYPES_BOOLEAN);
     status = controller_type_inserter_.add_method(CONTROLLER_TYPE, REGISTER_ROBOT, register_robot, register_robot_arguments, this);
     if(status != UA_STATUSCODE_GOOD) {
@@ -46,12 +77,24 @@ controller::controller(std::unique_ptr<mape> _kitchen_mape) : server_(UA_Server_
     }
     /* Add controller attributes */
     controller_type_inserter_.add_attribute(CONTROLLER_TYPE, REGISTERED_ROBOTS);
+    controller_type_inserter_.add_attribute(CONTROLLER_TYPE, ROUTING_CACHE_HIT_RATE);
     /* Add controller type constructor */
     controller_type_inserter_.add_object_type_constructor(server_, controller_type_inserter_.get_object_type_id(CONTROLLER_TYPE));
     /* Instantiate controller type */
     controller_type_inserter_.add_object_instance(INSTANCE_NAME, CONTROLLER_TYPE);
-    UA_UInt32 initial_registered_robots = 0;
-    controller_type_inserter_.set_scalar_attribute(INSTANCE_NAME, REGISTERED_ROBOTS, &initial_registered_robots, UA_TYPES_UINT32);
+    /* Bind the registered robots counter to its data source */
+    status = controller_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, REGISTERED_ROBOTS, registered_robots_, UA_TYPES_UINT32);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error binding the %s attribute", __FUNCTION__, REGISTERED_ROBOTS);
+        running_.store(false);
+        return;
+    }
+    status = controller_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, ROUTING_CACHE_HIT_RATE, routing_cache_hit_rate_, UA_TYPES_DOUBLE);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error binding the %s attribute", __FUNCTION__, ROUTING_CACHE_HIT_RATE);
+        running_.store(false);
+        return;
+    }
     /* Run the controller server */
     status = UA_Server_run_startup(server_);
     if (status != UA_STATUSCODE_GOOD) {
@@ -102,14 +145,15 @@ controller::register_robot(UA_Server* _server,
         size_t _input_size, const UA_Variant* _input,
         size_t _output_size, UA_Variant* _output) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    if(_input_size != 3) {
+    if(_input_size != 4) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input size", __FUNCTION__);
         return UA_STATUSCODE_BAD;
     }
     
     if(!UA_Variant_hasScalarType(&_input[0], &UA_TYPES[UA_TYPES_STRING])
       || !UA_Variant_hasScalarType(&_input[1], &UA_TYPES[UA_TYPES_UINT32])
-      || !UA_Variant_hasArrayType(&_input[2], &UA_TYPES[UA_TYPES_STRING])) {
+      || !UA_Variant_hasArrayType(&_input[2], &UA_TYPES[UA_TYPES_STRING])
+      || !UA_Variant_hasScalarType(&_input[3], &UA_TYPES[UA_TYPES_UINT32])) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input argument type", __FUNCTION__);
         return UA_STATUSCODE_BAD;
     }
@@ -124,10 +168,21 @@ controller::register_robot(UA_Server* _server,
     UA_String endpoint_tmp = *(UA_String*)_input[0].data;
     std::string endpoint((char*) endpoint_tmp.data, endpoint_tmp.length);
     position_t position = *(position_t*)_input[1].data;
-    std::unordered_set<std::string> remote_robot_capabilities;
+    robot_actions* actions = robot_actions::get_instance();
+    capability_mask_t remote_robot_capabilities_mask = 0;
     for (size_t i = 0; i < _input[2].arrayLength; i++) {
         UA_String capability = ((UA_String*)_input[2].data)[i];
-        remote_robot_capabilities.insert(std::string((char*) capability.data, capability.length));
+        std::string action_name((char*) capability.data, capability.length);
+        if (!actions->has_action(action_name)) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Unknown capability %s of robot at position %d", __FUNCTION__, action_name.c_str(), position);
+            return UA_STATUSCODE_BADINVALIDARGUMENT;
+        }
+        remote_robot_capabilities_mask |= action_mask(actions->get_action_id(action_name));
+    }
+    position_t conveyor_size = *(position_t*)_input[3].data;
+    if (conveyor_size <= position) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Conveyor size %d of robot at position %d is too small", __FUNCTION__, conveyor_size, position);
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
     }
 
     UA_Boolean result = true;
@@ -138,34 +193,33 @@ controller::register_robot(UA_Server* _server,
         return UA_STATUSCODE_BAD;
     }
 
-    self->io_context_.post([self, endpoint, position, remote_robot_capabilities] {
-        self->handle_robot_registration(endpoint, position, remote_robot_capabilities);
-    });
+    boost::asio::post(self->registry_strand_, kitchen_clock::tracked([self, endpoint, position, remote_robot_capabilities_mask, conveyor_size] {
+        self->handle_robot_registration(endpoint, position, remote_robot_capabilities_mask, conveyor_size);
+    }));
     return UA_STATUSCODE_GOOD;
 }
 
 void
-controller::handle_robot_registration(std::string _endpoint, position_t _position, std::unordered_set<std::string> _remote_robot_capabilities) {
+controller::handle_robot_registration(std::string _endpoint, position_t _position, capability_mask_t _remote_robot_capabilities_mask, position_t _conveyor_size) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    std::string capabilites_str = "REGISTRATION: Capabilities of robot at position " + std::to_string(_position) + " [";
-    for (std::string capability : _remote_robot_capabilities) {
-        capabilites_str += capability + ", ";
-    }
-    capabilites_str.erase(capabilites_str.end()-2, capabilites_str.end());
-    capabilites_str += "]";
+    std::string capabilites_str = "REGISTRATION: Capabilities of robot at position " + std::to_string(_position) + " " + capabilities_to_string(_remote_robot_capabilities_mask);
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: %s", __FUNCTION__, capabilites_str.c_str());
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
     remove_stopped_robots();
     erase_stale_pending_swap_entries();
     swap_key sk = std::make_tuple(0,0);
     if (is_robot_position_swapping(_position, sk)) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Position is currently involved in a swap (%d,%d)", __FUNCTION__, std::get<0>(sk), std::get<1>(sk));
     } else if (position_remote_robot_map_.find(_position) == position_remote_robot_map_.end()) {
-        std::unique_ptr<remote_robot> robot = std::make_unique<remote_robot>(_endpoint, _position, _remote_robot_capabilities,
+        std::unique_ptr<remote_robot> robot = std::make_unique<remote_robot>(_endpoint, _position, _remote_robot_capabilities_mask,
                                                                             std::bind(&controller::position_swapped_callback, this, std::placeholders::_1, std::placeholders::_2),
-                                                                            std::bind(&controller::capabilities_reconfigured_callback, this, std::placeholders::_1));
+                                                                            std::bind(&controller::capabilities_reconfigured_callback, this, std::placeholders::_1),
+                                                                            std::bind(&controller::robot_changed_callback, this, std::placeholders::_1), overall_time_parameters_);
         if (robot->initialize_and_start() == UA_STATUSCODE_GOOD) {
             position_remote_robot_map_[_position] = std::move(robot);
-            increment_or_decrement_counter_node(REGISTERED_ROBOTS);
+            registered_robots_++;
+            robot_registry_.set_conveyor_size(_conveyor_size);
+            publish_registry_snapshot();
             resolve_missed_new_position_commit(_position);
         }
     } else {
@@ -193,7 +247,7 @@ controller::choose_next_robot(UA_Server* _server,
         size_t _input_size, const UA_Variant* _input,
         size_t _output_size, UA_Variant* _output) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    if(_input_size != 4) {
+    if(_input_size != 5) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input size", __FUNCTION__);
         return UA_STATUSCODE_BAD;
     }
@@ -201,7 +255,8 @@ controller::choose_next_robot(UA_Server* _server,
     if(!UA_Variant_hasScalarType(&_input[0], &UA_TYPES[UA_TYPES_UINT32])
     || !UA_Variant_hasScalarType(&_input[1], &UA_TYPES[UA_TYPES_UINT32])
     || !UA_Variant_hasScalarType(&_input[2], &UA_TYPES[UA_TYPES_STRING])
-    || !UA_Variant_hasScalarType(&_input[3], &UA_TYPES[UA_TYPES_STRING])) {
+    || !UA_Variant_hasScalarType(&_input[3], &UA_TYPES[UA_TYPES_STRING])
+    || !UA_Variant_hasScalarType(&_input[4], &UA_TYPES[UA_TYPES_UINT32])) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input argument type", __FUNCTION__);
         return UA_STATUSCODE_BAD;
     }
@@ -211,6 +266,7 @@ controller::choose_next_robot(UA_Server* _server,
     UA_UInt32 processed_steps = *(UA_UInt32*)_input[1].data;
     UA_String endpoint = *(UA_String*)_input[2].data;
     UA_String type = *(UA_String*)_input[3].data;
+    position_t plate_position = *(position_t*)_input[4].data;
     /* Extract method context */
     if(_method_context == NULL) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Method context is NULL", __FUNCTION__);
@@ -226,49 +282,184 @@ controller::choose_next_robot(UA_Server* _server,
     }
     std::string endpoint_str((char*) endpoint.data, endpoint.length);
     std::string type_str((char*) type.data, type.length);
-    self->io_context_.post([self, recipe_id, processed_steps, endpoint_str, type_str] {
-        self->handle_next_robot_request(recipe_id, processed_steps, endpoint_str, type_str);
-    });
+    boost::asio::co_spawn(self->get_requester(endpoint_str, type_str).strand_, self->handle_next_robot_request(recipe_id, processed_steps, plate_position, endpoint_str, type_str),
+                          kitchen_clock::tracked([recipe_id, endpoint_str](std::exception_ptr _exception) {
+        if (!_exception)
+            return;
+        try {
+            std::rethrow_exception(_exception);
+        } catch (const std::exception& _error) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed handling the request for recipe id %d of %s (%s)", __FUNCTION__, recipe_id, endpoint_str.c_str(), _error.what());
+        } catch (...) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed handling the request for recipe id %d of %s", __FUNCTION__, recipe_id, endpoint_str.c_str());
+        }
+    }));
     return UA_STATUSCODE_GOOD;
 }
 
-void
-controller::handle_next_robot_request(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, std::string _endpoint, std::string _type) {
+UA_StatusCode
+controller::choose_next_robots(UA_Server* _server,
+        const UA_NodeId* _session_id, void* _session_context,
+        const UA_NodeId* _method_id, void* _method_context,
+        const UA_NodeId* _object_id, void* _object_context,
+        size_t _input_size, const UA_Variant* _input,
+        size_t _output_size, UA_Variant* _output) {
+    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    if(_input_size != 2) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input size", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+
+    if(!UA_Variant_hasArrayType(&_input[0], &UA_TYPES[UA_TYPES_UINT32])
+    || !UA_Variant_hasArrayType(&_input[1], &UA_TYPES[UA_TYPES_UINT32])
+    || _input[0].arrayLength != _input[1].arrayLength) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input argument type", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+
+    /* Extract input arguments */
+    size_t order_count = _input[0].arrayLength;
+    std::vector<recipe_id_t> recipe_ids((recipe_id_t*)_input[0].data, (recipe_id_t*)_input[0].data + order_count);
+    std::vector<UA_UInt32> processed_steps((UA_UInt32*)_input[1].data, (UA_UInt32*)_input[1].data + order_count);
+    /* Extract method context */
+    if(_method_context == NULL) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Method context is NULL", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+    controller* self = static_cast<controller*>(_method_context);
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOTS: Requested suitable robots for a batch of %zu orders", order_count);
+    /* The batch decision triggers no adaptations, so it is answered directly */
+    std::shared_ptr<const robot_registry_snapshot> snapshot;
+    std::vector<order_assignment> assignments = self->find_suitable_robots(recipe_ids, processed_steps, snapshot);
+    if (assignments.size() != order_count) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: The MAPE did not assign every order", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+    std::vector<UA_UInt32> order_indices(order_count, 0);
+    std::vector<position_t> robot_positions(order_count, 0);
+    UA_String* robot_endpoints = (UA_String*) UA_Array_new(order_count, &UA_TYPES[UA_TYPES_STRING]);
+    if (robot_endpoints == nullptr && order_count > 0) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error allocating output parameters", __FUNCTION__);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    for (size_t sequence = 0; sequence < order_count; sequence++) {
+        order_indices[sequence] = assignments[sequence].order_;
+        if (assignments[sequence].robot_ == nullptr)
+            continue;
+        robot_positions[sequence] = assignments[sequence].robot_->get_position();
+        robot_endpoints[sequence] = UA_STRING_ALLOC(assignments[sequence].robot_->get_endpoint().c_str());
+    }
+    UA_StatusCode status = UA_Variant_setArrayCopy(&_output[0], order_indices.data(), order_count, &UA_TYPES[UA_TYPES_UINT32]);
+    status |= UA_Variant_setArrayCopy(&_output[1], robot_positions.data(), order_count, &UA_TYPES[UA_TYPES_UINT32]);
+    if(status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting output parameters", __FUNCTION__);
+        UA_Array_delete(robot_endpoints, order_count, &UA_TYPES[UA_TYPES_STRING]);
+        return UA_STATUSCODE_BAD;
+    }
+    UA_Variant_setArray(&_output[2], robot_endpoints, order_count, &UA_TYPES[UA_TYPES_STRING]);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+controller::plan_route(UA_Server* _server,
+        const UA_NodeId* _session_id, void* _session_context,
+        const UA_NodeId* _method_id, void* _method_context,
+        const UA_NodeId* _object_id, void* _object_context,
+        size_t _input_size, const UA_Variant* _input,
+        size_t _output_size, UA_Variant* _output) {
+    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    if(_input_size != 3) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input size", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+
+    if(!UA_Variant_hasScalarType(&_input[0], &UA_TYPES[UA_TYPES_UINT32])
+    || !UA_Variant_hasScalarType(&_input[1], &UA_TYPES[UA_TYPES_UINT32])
+    || !UA_Variant_hasScalarType(&_input[2], &UA_TYPES[UA_TYPES_UINT32])) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input argument type", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+
+    /* Extract input arguments */
+    recipe_id_t recipe_id = *(recipe_id_t*)_input[0].data;
+    UA_UInt32 processed_steps = *(UA_UInt32*)_input[1].data;
+    position_t plate_position = *(position_t*)_input[2].data;
+    /* Extract method context */
+    if(_method_context == NULL) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Method context is NULL", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+    controller* self = static_cast<controller*>(_method_context);
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "PLAN ROUTE: Requested route for recipe %d after step %d from position %d", recipe_id, processed_steps, plate_position);
+    /* The route triggers no adaptations, so it is answered directly */
+    route_plan route = self->find_route(recipe_id, processed_steps, plate_position);
+    if (route_to_variants(route, &_output[0], &_output[1]) != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting output parameters", __FUNCTION__);
+        return UA_STATUSCODE_BAD;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+boost::asio::awaitable<void>
+controller::handle_next_robot_request(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _plate_position, std::string _endpoint, std::string _type) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    remove_stopped_robots();
-    erase_stale_pending_swap_entries();
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: Next robot receiver (%s,%s) requests suitable robot for recipe id %d processed with %d steps already", _endpoint.c_str(), _type.c_str(), _recipe_id, _processed_steps);
-    std::pair nrr_key = std::make_pair(_endpoint, _type);
-    if (next_robot_receiver_map_.find(nrr_key) == next_robot_receiver_map_.end()) {
+    /* Running on the requester's strand, the receiver is not accessed concurrently */
+    next_robot_requester& requester = get_requester(_endpoint, _type);
+    if (requester.receiver_ == nullptr) {
         std::unique_ptr<next_robot_receiver> nrr = std::make_unique<next_robot_receiver>(_endpoint, _type);
         if (nrr->initialize_and_start() == UA_STATUSCODE_GOOD) 
-            next_robot_receiver_map_[nrr_key] = std::move(nrr);
+            requester.receiver_ = std::move(nrr);
+    }
+    /* Cached decisions are served from the snapshot without locking the registry */
+    std::shared_ptr<const robot_registry_snapshot> snapshot = robot_registry_.get_snapshot();
+    position_t suitable_position = 0;
+    bool is_cached = find_cached_robot(*snapshot, _recipe_id, _processed_steps, suitable_position);
+    if (!is_cached) {
+        {
+            std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+            remove_stopped_robots();
+            erase_stale_pending_swap_entries();
+        }
+        suitable_position = find_suitable_robot(_recipe_id, _processed_steps, _plate_position);
+        /* The decision may have triggered an adaptation of the suitable robot */
+        snapshot = robot_registry_.get_snapshot();
     }
-    remote_robot* next_suitable_robot = find_suitable_robot(_recipe_id, _processed_steps);
+    const robot_descriptor* next_suitable_robot = suitable_position == 0 ? nullptr : snapshot->find(suitable_position);
     std::string next_suitable_robot_endpoint = "";
     position_t next_suitable_robot_position = 0;
     if (next_suitable_robot != nullptr && !next_suitable_robot->is_adaptivity_pending()) {
         next_suitable_robot_position = next_suitable_robot->get_position();
         next_suitable_robot_endpoint = next_suitable_robot->get_endpoint();
-        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: Next robot is at position %d (%s)", next_suitable_robot_position, next_suitable_robot->get_endpoint().c_str());
+    }
+    uint64_t lookups = ++routing_cache_lookups_;
+    uint64_t hits = is_cached ? ++routing_cache_hits_ : routing_cache_hits_.load();
+    routing_cache_hit_rate_.store((UA_Double) hits / lookups);
+    if (next_suitable_robot_position != 0) {
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: Next robot is at position %d (%s)", next_suitable_robot_position, next_suitable_robot_endpoint.c_str());
     } else {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: No next suitable robot found");
     }
-    if (next_robot_receiver_map_.find(nrr_key) != next_robot_receiver_map_.end()) {
-        size_t output_size = 0;
-        UA_Variant* output = nullptr;
-        UA_StatusCode status = next_robot_receiver_map_[nrr_key]->receive_next_robot(next_suitable_robot_position, next_suitable_robot_endpoint, _recipe_id, &output_size, &output);
-        if (status != UA_STATUSCODE_GOOD) {
-            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: Failed calling %s method for remote robot (%s)", RECEIVE_NEXT_ROBOT, UA_StatusCode_name(status));
-            if (output != nullptr)
-                UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
-            return;
+    if (requester.receiver_ != nullptr) {
+        /* Other requests are handled while the response is outstanding */
+        method_call_result call_result = co_await requester.receiver_->async_receive_next_robot(next_suitable_robot_position, next_suitable_robot_endpoint, _recipe_id);
+        if (call_result.status_ != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: Failed calling %s method for remote robot (%s)", RECEIVE_NEXT_ROBOT, UA_StatusCode_name(call_result.status_));
+            if (call_result.output_ != nullptr)
+                UA_Array_delete(call_result.output_, call_result.output_size_, &UA_TYPES[UA_TYPES_VARIANT]);
+            co_return;
         }
-        bool result = receive_next_robot_called(output_size, output);
+        bool result = receive_next_robot_called(call_result.output_size_, call_result.output_);
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: Next robot receiver returned %s", result ? "true" : "false");
     }
 }
 
+next_robot_requester&
+controller::get_requester(const std::string& _endpoint, const std::string& _type) {
+    std::lock_guard<std::mutex> lock(requesters_mutex_);
+    return requesters_.try_emplace(std::make_pair(_endpoint, _type), io_context_).first->second;
+}
+
 bool
 controller::receive_next_robot_called(size_t _output_size, UA_Variant* _output) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
@@ -290,19 +481,98 @@ controller::receive_next_robot_called(size_t _output_size, UA_Variant* _output)
     return next_robot_received;
 }
 
-remote_robot*
-controller::find_suitable_robot(recipe_id_t _recipe_id, UA_UInt32 _processed_steps) {
+bool
+controller::find_cached_robot(const robot_registry_snapshot& _snapshot, recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t& _position) {
+    std::shared_lock<std::shared_mutex> cache_lock(routing_cache_mutex_);
+    auto cached = routing_cache_.find(std::make_tuple(_recipe_id, _processed_steps));
+    if (cached == routing_cache_.end() || cached->second.registry_version_ != _snapshot.registry_version_)
+        return false;
+    if (cached->second.position_ != 0 && _snapshot.find(cached->second.position_) == nullptr)
+        return false;
+    _position = cached->second.position_;
+    return true;
+}
+
+position_t
+controller::find_suitable_robot(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _plate_position) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    std::queue<robot_action> recipe_action_queue = recipe_parser_.get_recipe(_recipe_id).get_action_queue();
-    for (size_t i = 0; i < _processed_steps; i++) {
-        recipe_action_queue.pop();
+    if (!recipe_parser_.has_recipe(_recipe_id)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Unknown recipe id %d", __FUNCTION__, _recipe_id);
+        return 0;
+    }
+    std::lock_guard<std::mutex> mape_lock(mape_mutex_);
+    std::shared_ptr<const robot_registry_snapshot> snapshot = robot_registry_.get_snapshot();
+    const robot_descriptor* suitable_robot = kitchen_mape_->on_new_order(*snapshot, recipe_parser_.get_remaining_steps(_recipe_id, _processed_steps), _plate_position);
+    position_t suitable_position = suitable_robot == nullptr ? 0 : suitable_robot->get_position();
+    /* Decisions that triggered an adaptation are outdated once the adaptation completes */
+    if (robot_registry_.get_snapshot()->registry_version_ == snapshot->registry_version_ && kitchen_mape_->is_decision_cacheable()) {
+        std::unique_lock<std::shared_mutex> cache_lock(routing_cache_mutex_);
+        routing_cache_[std::make_tuple(_recipe_id, _processed_steps)] = {suitable_position, snapshot->registry_version_};
+    }
+    return suitable_position;
+}
+
+std::vector<order_assignment>
+controller::find_suitable_robots(const std::vector<recipe_id_t>& _recipe_ids, const std::vector<UA_UInt32>& _processed_steps, std::shared_ptr<const robot_registry_snapshot>& _snapshot) {
+    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    std::vector<recipe_steps> recipe_action_queues;
+    for (size_t order = 0; order < _recipe_ids.size(); order++) {
+        if (recipe_parser_.has_recipe(_recipe_ids[order]))
+            recipe_action_queues.push_back(recipe_parser_.get_remaining_steps(_recipe_ids[order], _processed_steps[order]));
+        else
+            recipe_action_queues.push_back(recipe_steps());
     }
-    return kitchen_mape_->on_new_order(position_remote_robot_map_, recipe_action_queue);
+    std::lock_guard<std::mutex> mape_lock(mape_mutex_);
+    _snapshot = robot_registry_.get_snapshot();
+    return kitchen_mape_->on_new_orders(*_snapshot, recipe_action_queues);
+}
+
+route_plan
+controller::find_route(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _plate_position) {
+    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    if (!recipe_parser_.has_recipe(_recipe_id))
+        return {};
+    route_plan route;
+    std::lock_guard<std::mutex> mape_lock(mape_mutex_);
+    std::shared_ptr<const robot_registry_snapshot> snapshot = robot_registry_.get_snapshot();
+    for (const robot_descriptor* robot : kitchen_mape_->on_new_route(*snapshot, recipe_parser_.get_remaining_steps(_recipe_id, _processed_steps), _plate_position)) {
+        route.push_back({robot->get_position(), robot->get_endpoint()});
+    }
+    return route;
+}
+
+void
+controller::publish_registry_snapshot() {
+    /* The descriptors are read in the registry's writer lock, so a concurrent robot change is not overwritten by older values */
+    robot_registry_.replace_robots([this] {
+        robot_descriptor_map robots;
+        for (const auto& entry : position_remote_robot_map_) {
+            if (!entry.second->is_stopped())
+                robots.emplace(entry.first, entry.second->get_descriptor());
+        }
+        return robots;
+    });
+}
+
+void
+controller::robot_changed_callback(const remote_robot& _robot) {
+    if (_robot.is_stopped())
+        robot_registry_.remove_robot(_robot.get_endpoint());
+    else
+        robot_registry_.update_robot([&_robot] {
+            return _robot.get_descriptor();
+        });
+}
+
+std::shared_ptr<const robot_registry_snapshot>
+controller::get_registry_snapshot() const {
+    return robot_registry_.get_snapshot();
 }
 
 void
 controller::swap_robot_positions(position_t _from, position_t _to) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "REARRANGING: Initiating swap for the positions (%d,%d)", _from, _to);
     if (_from == _to) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Position swaps to the same position are ignored (%d,%d)", __FUNCTION__, _from, _to);
@@ -344,6 +614,7 @@ controller::swap_robot_positions(position_t _from, position_t _to) {
         return;
     }
     first_robot->set_adaptivity_flag();
+    publish_registry_snapshot();
     // second robot switch position call
     swap_state swap_states;
     output_size = 0;
@@ -370,6 +641,7 @@ controller::swap_robot_positions(position_t _from, position_t _to) {
             }
         }
         second_robot->set_adaptivity_flag();
+        publish_registry_snapshot();
     } else {
         /* there is no other robot at the target position (note: this simulates as if the robot at the target position has acked his position switch.
         i.e. the acks signalize based on robots original positions a successful switch) 
@@ -408,8 +680,9 @@ controller::adaptivity_action_called(size_t _output_size, UA_Variant* _output) {
 void
 controller::position_swapped_callback(position_t _old_position, position_t _new_position) {
     constexpr const char* func_name = __FUNCTION__;
-    io_context_.post([this, _old_position, _new_position, func_name] {
+    boost::asio::post(registry_strand_, kitchen_clock::tracked([this, _old_position, _new_position, func_name] {
         // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", func_name);
+        std::lock_guard<std::mutex> registry_lock(registry_mutex_);
         remove_stopped_robots();
         erase_stale_pending_swap_entries();
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "REARRANGING(Controller): Robot from its old position %d acknowledged swap to the new position %d", _old_position, _new_position);
@@ -466,8 +739,9 @@ controller::position_swapped_callback(position_t _old_position, position_t _new_
             }
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "REARRANGING: Position swap successfully completed for (%d,%d)", std::get<0>(sk), std::get<1>(sk));
             pending_swaps_.erase(sk);
+            publish_registry_snapshot();
         }
-    });
+    }));
 }
 
 void
@@ -487,6 +761,7 @@ controller::erase_stale_pending_swap_entries() {
 void
 controller::reconfigure_robot_capability(position_t _robot_position, std::string _new_capabilities_profile) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
     if (position_remote_robot_map_.find(_robot_position) == position_remote_robot_map_.end()) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: There is no robot at position %d", __FUNCTION__, _robot_position);
         return;
@@ -511,18 +786,21 @@ controller::reconfigure_robot_capability(position_t _robot_position, std::string
         return;
     }
     position_remote_robot_map_[_robot_position]->set_adaptivity_flag();
+    publish_registry_snapshot();
 }
 
 void
 controller::capabilities_reconfigured_callback(position_t _robot_position) {
     constexpr const char* func_name = __FUNCTION__;
-    io_context_.post([this, _robot_position, func_name] {
+    boost::asio::post(registry_strand_, kitchen_clock::tracked([this, _robot_position, func_name] {
         // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", func_name);
+        std::lock_guard<std::mutex> registry_lock(registry_mutex_);
         remove_stopped_robots();
         if (position_remote_robot_map_.find(_robot_position) != position_remote_robot_map_.end()) {
             position_remote_robot_map_[_robot_position]->reset_adaptivity_flag();
         }
-    });
+        publish_registry_snapshot();
+    }));
 }
 
 void
@@ -554,7 +832,8 @@ controller::remove_stopped_robots() {
         if (it->second->is_stopped()) {
             position_t position = it->first;
             it = position_remote_robot_map_.erase(it);
-            increment_or_decrement_counter_node(REGISTERED_ROBOTS, false);
+            registered_robots_--;
+            publish_registry_snapshot();
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Removed remote robot at position %d", position);
             swap_key sk;
             if(is_robot_position_swapping(position, sk)) {
@@ -569,55 +848,44 @@ controller::remove_stopped_robots() {
     }
 }
 
-UA_StatusCode
-controller::increment_or_decrement_counter_node(std::string _attribute_name, bool increment) {
-    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    UA_StatusCode status = UA_STATUSCODE_GOOD;
-    UA_Variant value;
-    UA_Variant_init(&value);
-    if ((status = controller_type_inserter_.get_attribute(INSTANCE_NAME, _attribute_name.c_str(), value)) != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error getting attribute (%s)", __FUNCTION__, UA_StatusCode_name(status));
-        UA_Variant_clear(&value);
-        return status;
-    }
-    UA_UInt32 counter_value = 0;
-    if (UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT32]) && value.data) {
-        counter_value = *(UA_UInt32*) value.data;
-    } else {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Unexpected attribute type for %s", __FUNCTION__, _attribute_name.c_str());
-        UA_Variant_clear(&value);
-        return UA_STATUSCODE_BADTYPEMISMATCH;
-    }
-    if (increment)
-        counter_value++;
-    else
-        counter_value--;
-    if ((status = controller_type_inserter_.set_scalar_attribute(INSTANCE_NAME, _attribute_name.c_str(), &counter_value, UA_TYPES_UINT32)) != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting attribute (%s)", __FUNCTION__, UA_StatusCode_name(status));
-        UA_Variant_clear(&value);
-        return status;
-    }
-    UA_Variant_clear(&value);
-    return status;
+void
+controller::arm_layout_review() {
+    duration_t review_period = kitchen_mape_->get_layout_review_period();
+    if (review_period == 0)
+        return;
+    layout_review_timer_.expires_after(std::chrono::milliseconds(review_period * TIME_UNIT));
+    layout_review_timer_.async_wait([this](const boost::system::error_code& _error) {
+        if (_error || !running_.load())
+            return;
+        std::shared_ptr<const robot_registry_snapshot> snapshot = robot_registry_.get_snapshot();
+        kitchen_mape_->on_layout_review(*snapshot);
+        arm_layout_review();
+    });
 }
 
 void
 controller::join_threads() {
     if (server_iterate_thread_.joinable())
         server_iterate_thread_.join();
-    if (worker_thread_.joinable())
-        worker_thread_.join();
+    for (std::thread& worker_thread : worker_threads_) {
+        if (worker_thread.joinable())
+            worker_thread.join();
+    }
 }
 
 void
 controller::start() {
     if (!running_.load())
         stop();
-    /* Setup worker thread */        
-    worker_thread_ = std::thread([this]() {
-        io_context_.run();
-        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Exited io_context", __FUNCTION__);
-    });
+    arm_layout_review();
+    /* Setup worker thread pool, requests of different requesters are handled concurrently */
+    unsigned int worker_count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < worker_count; i++) {
+        worker_threads_.emplace_back([this]() {
+            io_context_.run();
+            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Exited io_context", __FUNCTION__);
+        });
+    }
     join_threads();
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Exited start method", __FUNCTION__);
 }
@@ -34,14 +34,17 @@
 #include <boost/asio.hpp>
 #include "method_node_caller.hpp"
 #include "client_connection_establisher.hpp"
+#include "client_reactor.hpp"
 #include "types.hpp"
 #include "browsenames.h"
 #include "node_value_subscriber.hpp"
+#include "route_plan.hpp"
 #include "robot_tool.hpp"
 #include "object_type_node_inserter.hpp"
 #include "node_browser_helper.hpp"
 #include "discovery_util.hpp"
 #include "information_node_reader.hpp"
+#include "kitchen_clock.hpp"
 
 using namespace cps_kitchen;
 
@@ -51,7 +54,7 @@ typedef std::function<void(position_t, position_t)> position_swapped_callback_t;
  * @brief Remote robot client to pass and retrieve dishes to/from kitchen robots and maintaining the connectivity.
  * 
  */
-struct remote_robot {
+struct conveyor_remote_robot {
     private:
         UA_Client* client_; /**< the OPC UA remote robot client pointer. */
         std::string endpoint_; /**< the endpoint address. */
@@ -61,8 +64,7 @@ struct remote_robot {
         std::unordered_map<std::string, object_method_info> method_id_map_; /**< the map holding the node ids of client methods. */
         std::unordered_map<std::string, UA_NodeId> attribute_id_map_; /**< the map holding the ids of remote robot attributes. */
         std::atomic<bool> running_; /**< flag to indicate whether the client thread should run. */
-        std::thread client_iterate_thread_; /**< the client iteration thread. */
-        std::mutex client_mutex_; /**< the mutex to synchronize client method calls. */
+        std::atomic<UA_Boolean> available_; /**< the availability served from the subscription. */
         bool initial_subscription_; /**< flag to indicate initial subscription notification. */
 
     public:
@@ -73,8 +75,8 @@ struct remote_robot {
          * @param _position the position of the remote robot.
          * @param _position_swapped_callback the position swapped callback.
          */
-        remote_robot(std::string _endpoint, position_t _position, position_swapped_callback_t _position_swapped_callback) :
-                    endpoint_(_endpoint), cached_position_(_position), client_(nullptr), running_(true),
+        conveyor_remote_robot(std::string _endpoint, position_t _position, position_swapped_callback_t _position_swapped_callback) :
+                    endpoint_(_endpoint), cached_position_(_position), client_(nullptr), running_(true), available_(false),
                     position_swapped_callback_(_position_swapped_callback), initial_subscription_(true) {
             // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
         }
@@ -90,63 +92,32 @@ struct remote_robot {
             if (client_ != nullptr) {
                 return running_.load() ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BAD;
             }
-            client_connection_establisher robot_client_connection_establisher;
-            bool connected = robot_client_connection_establisher.establish_connection(client_, endpoint_);
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+            bool connected = client_reactor::get_instance()->connect(client_, endpoint_, [this] {
+                running_.store(false);
+            });
             if (!connected) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Error establishing robot client session");
                 return UA_STATUSCODE_BAD;
             }
-            
-            attribute_id_map_[AVAILABILITY] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, AVAILABILITY);
-            if (UA_NodeId_equal(&attribute_id_map_[AVAILABILITY], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, AVAILABILITY);
-                return UA_STATUSCODE_BAD;
-            }
-            attribute_id_map_[POSITION] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, POSITION);
-            if (UA_NodeId_equal(&attribute_id_map_[POSITION], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, POSITION);
+            UA_StatusCode status = node_browser_helper().resolve_ids(client_, ROBOT_TYPE, {AVAILABILITY, POSITION},
+                {HANDOVER_FINISHED_ORDER, RECEIVE_TASK}, attribute_id_map_, method_id_map_);
+            if (status != UA_STATUSCODE_GOOD) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not resolve the remote robot's node ids", __FUNCTION__);
                 return UA_STATUSCODE_BAD;
             }
             nv_subscriber_ = std::make_unique<node_value_subscriber>(client_);
-            UA_StatusCode status = nv_subscriber_->subscribe_node_value(attribute_id_map_[POSITION], position_changed, this);
+            status = nv_subscriber_->subscribe_node_values({
+                {attribute_id_map_[POSITION], position_changed, this},
+                {attribute_id_map_[AVAILABILITY], availability_changed, this}
+            });
             if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s", __FUNCTION__, POSITION);
-                return UA_STATUSCODE_BAD;
-            }
-            if ((method_id_map_[HANDOVER_FINISHED_ORDER] = node_browser_helper().get_method_id(client_, ROBOT_TYPE, HANDOVER_FINISHED_ORDER)) == OBJECT_METHOD_INFO_NULL) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, HANDOVER_FINISHED_ORDER);
-                return UA_STATUSCODE_BAD;
-            }
-            if ((method_id_map_[RECEIVE_TASK] = node_browser_helper().get_method_id(client_, ROBOT_TYPE, RECEIVE_TASK)) == OBJECT_METHOD_INFO_NULL) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, RECEIVE_TASK);
-                return UA_STATUSCODE_BAD;
-            }
-            try {
-                client_iterate_thread_ = std::thread([this]() {
-                    while(running_.load()) {
-                        {
-                            std::lock_guard<std::mutex> lock(client_mutex_);
-                            UA_StatusCode status = UA_Client_run_iterate(client_, 1);
-                            if (status != UA_STATUSCODE_GOOD) {
-                                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running robot client at position %d (%s)", __FUNCTION__, cached_position_.load(), UA_StatusCode_name(status));
-                                running_.store(false);
-                                return UA_STATUSCODE_BAD;
-                            }
-                        }
-                        if (usleep(1*1000)) {
-                            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error at robot client iterate sleep", __FUNCTION__);
-                            running_.store(false);
-                            return UA_STATUSCODE_BAD;
-                        }
-                        // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Starting the next client iterate", __FUNCTION__);
-                    }
-                    return UA_STATUSCODE_BAD;
-                });
-            } catch (...) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running the robot client iterate thread at position %d", __FUNCTION__, cached_position_.load());
-                running_.store(false);
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s and %s (%s)", __FUNCTION__, POSITION, AVAILABILITY, UA_StatusCode_name(status));
                 return UA_STATUSCODE_BAD;
             }
+            /* Without heartbeat position and availability are read synchronously */
+            if (nv_subscriber_->subscribe_heartbeat() != UA_STATUSCODE_GOOD)
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to the remote robot's heartbeat", __FUNCTION__);
             return UA_STATUSCODE_GOOD;
         }
 
@@ -154,12 +125,11 @@ struct remote_robot {
          * @brief Destroys the remote robot object.
          * 
          */
-        ~remote_robot() {
+        ~conveyor_remote_robot() {
             running_.store(false);
-            if (client_iterate_thread_.joinable())
-                client_iterate_thread_.join();
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
             nv_subscriber_.reset();
-            UA_Client_delete(client_);
+            client_reactor::get_instance()->delete_client(client_);
         }
 
         /**
@@ -173,12 +143,15 @@ struct remote_robot {
         }
 
         /**
-         * @brief Returns the robot's position at the conveyor.
+         * @brief Returns the robot's position at the conveyor, served from the subscription while it is fresh.
          * 
          * @return position_t the robot's position at the conveyor.
          */
         position_t get_position() {
-            std::lock_guard<std::mutex> lock(client_mutex_);
+            if (nv_subscriber_ != nullptr && nv_subscriber_->is_fresh())
+                return cached_position_.load();
+            /* The cached position is left to the subscription, which reports swaps relative to it */
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
             information_node_reader inr;
             if (inr.read_information_node(client_, attribute_id_map_[POSITION]) != UA_STATUSCODE_GOOD) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not read the %s attribute id", __FUNCTION__, POSITION);
@@ -205,7 +178,7 @@ struct remote_robot {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Monitor context is NULL", __FUNCTION__);
                 return;
             }
-            remote_robot* self = static_cast<remote_robot*>(_mon_context);
+            conveyor_remote_robot* self = static_cast<conveyor_remote_robot*>(_mon_context);
             if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_UINT32])) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
                 self->running_.store(false);
@@ -222,21 +195,50 @@ struct remote_robot {
         }
 
         /**
-         * @brief Returns whether the robot is available.
+         * @brief The availability changed callback for the subscription.
+         *
+         * @param _client the client issuing the subscription.
+         * @param _sub_id server-assigned subscription id that delivered this notification.
+         * @param _sub_context user-defined context data passed when creating the subscription.
+         * @param _mon_id server-assigned MonitoredItemId that produced the data change.
+         * @param _mon_context user-defined context data passed when creating the monitored item.
+         * @param _value the reported UA_DataValue.
+         */
+        static void
+        availability_changed(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context,
+            UA_UInt32 _mon_id, void* _mon_context, UA_DataValue* _value) {
+            if(_mon_context == NULL) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Monitor context is NULL", __FUNCTION__);
+                return;
+            }
+            conveyor_remote_robot* self = static_cast<conveyor_remote_robot*>(_mon_context);
+            if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_BOOLEAN])) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
+                self->running_.store(false);
+                return;
+            }
+            self->available_.store(*(UA_Boolean*)_value->value.data);
+        }
+
+        /**
+         * @brief Returns whether the robot is available, served from the subscription while it is fresh.
          * 
          * @return true if robot is available.
          * @return false of robot is not available.
          */
         UA_Boolean
         is_available() {
-            std::lock_guard<std::mutex> lock(client_mutex_);
+            if (nv_subscriber_ != nullptr && nv_subscriber_->is_fresh())
+                return available_.load();
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
             information_node_reader inr;
             if (inr.read_information_node(client_, attribute_id_map_[AVAILABILITY]) != UA_STATUSCODE_GOOD) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not read the %s attribute id", __FUNCTION__, AVAILABILITY);
                 running_.store(false);
                 return false;
             }
-            return *(UA_Boolean*)inr.get_variant()->data;
+            available_.store(*(UA_Boolean*)inr.get_variant()->data);
+            return available_.load();
         }
 
         /**
@@ -254,7 +256,7 @@ struct remote_robot {
             object_method_info omi = method_id_map_[HANDOVER_FINISHED_ORDER];
             UA_StatusCode status = UA_STATUSCODE_GOOD;
             {
-                std::lock_guard<std::mutex> lock(client_mutex_);
+                client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
                 status = handover_finished_order_caller.call_method_node(client_, omi.object_id_, omi.method_id_, _output_size, _output);
                 if(status != UA_STATUSCODE_GOOD) {
                     UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling %s method (%s)", __FUNCTION__, HANDOVER_FINISHED_ORDER, UA_StatusCode_name(status));
@@ -266,35 +268,76 @@ struct remote_robot {
         }
 
         /**
-         * @brief Instructs the remote robot to process a partially processed dish.
+         * @brief Adds the handover of the finished order to a batch for this robot's session.
+         * 
+         * @param _batch the batch of calls to this robot.
+         */
+        void
+        add_handover_finished_order(method_call_batch& _batch) {
+            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "HANDOVER: Retrieve finished order from robot on position %d", cached_position_.load());
+            object_method_info omi = method_id_map_[HANDOVER_FINISHED_ORDER];
+            _batch.add_call(omi.object_id_, omi.method_id_);
+        }
+
+        /**
+         * @brief Adds the instruction to process a partially processed dish to a batch for this robot's session.
          * 
+         * @param _batch the batch of calls to this robot.
          * @param _recipe_id the recipe ID of the dish.
          * @param _processed_steps the processed steps of the recipe ID so far.
          * @param _addressed_position the addressed position.
-         * @param _output_size the count of returned output values.
-         * @param _output the variant containing the output values.
+         * @param _remaining_route the planned robots after this robot, empty if the next robot is chosen on handover.
+         */
+        void
+        add_instruct(method_call_batch& _batch, recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _addressed_position, const route_plan& _remaining_route) {
+            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "INSTRUCTIONS: Instruct robot on position %d to cook recipe %d after step %d", cached_position_.load(), _recipe_id, _processed_steps);
+            object_method_info omi = method_id_map_[RECEIVE_TASK];
+            method_node_caller& receive_robot_task_caller = _batch.add_call(omi.object_id_, omi.method_id_);
+            receive_robot_task_caller.add_scalar_input_argument(&_recipe_id, UA_TYPES_UINT32);
+            receive_robot_task_caller.add_scalar_input_argument(&_processed_steps, UA_TYPES_UINT32);
+            receive_robot_task_caller.add_scalar_input_argument(&_addressed_position, UA_TYPES_UINT32);
+            add_route_input_arguments(receive_robot_task_caller, _remaining_route);
+        }
+
+        /**
+         * @brief Sends a batch of calls to this robot with a single request without blocking the calling io_context.
+         * The remote robot must not be accessed after resumption since it may have been removed meanwhile.
          * 
-         * @return UA_StatusCode the status whether the method call was successful.
+         * @param _batch the batch of calls to this robot, which must outlive the returned awaitable.
+         * @return boost::asio::awaitable<std::vector<method_call_result>> the awaitable completing with one result per call.
+         */
+        boost::asio::awaitable<std::vector<method_call_result>>
+        async_call_batch(method_call_batch& _batch) {
+            std::vector<method_call_result> results = co_await _batch.async_call(client_, [] {
+                return client_reactor::get_instance()->lock();
+            });
+            co_return results;
+        }
+
+        /**
+         * @brief Instructs the remote robot to process a partially processed dish without blocking the calling io_context.
+         * The remote robot must not be accessed after resumption since it may have been removed meanwhile.
+         * 
+         * @param _recipe_id the recipe ID of the dish.
+         * @param _processed_steps the processed steps of the recipe ID so far.
+         * @param _addressed_position the addressed position.
+         * @param _remaining_route the planned robots after this robot, empty if the next robot is chosen on handover.
+         * @return boost::asio::awaitable<method_call_result> the awaitable completing with the method call result.
          */
-        UA_StatusCode instruct(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _addressed_position, size_t* _output_size, UA_Variant** _output) {
+        boost::asio::awaitable<method_call_result>
+        async_instruct(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _addressed_position, route_plan _remaining_route) {
             // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "INSTRUCTIONS: Instruct robot on position %d to cook recipe %d after step %d", cached_position_.load(), _recipe_id, _processed_steps);
             method_node_caller receive_robot_task_caller;
             receive_robot_task_caller.add_scalar_input_argument(&_recipe_id, UA_TYPES_UINT32);
             receive_robot_task_caller.add_scalar_input_argument(&_processed_steps, UA_TYPES_UINT32);
             receive_robot_task_caller.add_scalar_input_argument(&_addressed_position, UA_TYPES_UINT32);
+            add_route_input_arguments(receive_robot_task_caller, _remaining_route);
             object_method_info omi = method_id_map_[RECEIVE_TASK];
-            UA_StatusCode status = UA_STATUSCODE_GOOD;
-            {
-                std::lock_guard<std::mutex> lock(client_mutex_);
-                status = receive_robot_task_caller.call_method_node(client_, omi.object_id_, omi.method_id_, _output_size, _output);
-                if(status != UA_STATUSCODE_GOOD) {
-                    UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling %s method (%s)", __FUNCTION__, RECEIVE_TASK, UA_StatusCode_name(status));
-                    running_.store(false);
-                    return UA_STATUSCODE_BAD;
-                }
-            }
-            return status;
+            method_call_result result = co_await receive_robot_task_caller.async_call(client_, omi.object_id_, omi.method_id_, [] {
+                return client_reactor::get_instance()->lock();
+            });
+            co_return result;
         }
 
         /**
@@ -322,8 +365,13 @@ struct plate {
         UA_Boolean occupied_; /**< indicates whether the plate is occupied or free. */
         UA_Boolean is_dish_finished_; /**< indicates whether it holds a completed dish or a partially finished dish when occupied. */
         position_t target_position_; /**< the target position for the next preparation steps or the output when finished. */
+        route_plan planned_route_; /**< the planned robots for the remaining steps, without the robot at the target position. */
+        UA_Boolean route_invalidated_; /**< indicates whether the planned route has to be planned anew. */
         std::string instance_name_id_; /**< the instance name id in the address space. */
         object_type_node_inserter& plate_type_inserter_; /**< the plate type inserter for adding the plate's attributes to the address space. */
+        attribute_handle position_handle_; /**< the resolved handle of the plate position attribute. */
+        attribute_handle recipe_id_handle_; /**< the resolved handle of the plate recipe id attribute. */
+        attribute_handle occupied_handle_; /**< the resolved handle of the plate occupied attribute. */
     public:
         /**
          * @brief Setup the plate object type.
@@ -353,18 +401,26 @@ struct plate {
          * @param _plate_type_inserter the plate type inserter.
          */
         plate(plate_id_t _id, position_t _position, UA_NodeId _conveyor_instance_id, object_type_node_inserter& _plate_type_inserter) : id_(_id), position_(_position), placed_recipe_id_(0),
-                processed_steps_of_placed_recipe_id_(0), occupied_(false), is_dish_finished_(false), target_position_(0), instance_name_id_(std::string(PLATE_INSTANCE_NAME) + " " + std::to_string(id_)), plate_type_inserter_(_plate_type_inserter) {
+                processed_steps_of_placed_recipe_id_(0), occupied_(false), is_dish_finished_(false), target_position_(0), route_invalidated_(false), instance_name_id_(std::string(PLATE_INSTANCE_NAME) + " " + std::to_string(id_)), plate_type_inserter_(_plate_type_inserter) {
             /* Instantiate plate type. */
             UA_StatusCode status = plate_type_inserter_.add_object_instance(instance_name_id_.c_str(), PLATE_TYPE, _conveyor_instance_id, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT));
             if (status != UA_STATUSCODE_GOOD) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error adding plate object instance (%s)", __FUNCTION__, UA_StatusCode_name(status));
                 return;
             }
+            /* Resolve attribute handles. */
+            status = plate_type_inserter_.resolve_attribute(instance_name_id_, PLATE_POSITION, position_handle_);
+            status |= plate_type_inserter_.resolve_attribute(instance_name_id_, PLATE_RECIPE_ID, recipe_id_handle_);
+            status |= plate_type_inserter_.resolve_attribute(instance_name_id_, PLATE_OCCUPIED, occupied_handle_);
+            if (status != UA_STATUSCODE_GOOD) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error resolving plate attributes (%s)", __FUNCTION__, UA_StatusCode_name(status));
+                return;
+            }
             /* Set attribute values. */
             status = plate_type_inserter_.set_scalar_attribute(instance_name_id_, PLATE_ID, const_cast<plate_id_t*>(&id_), UA_TYPES_UINT32);
-            status |= plate_type_inserter_.set_scalar_attribute(instance_name_id_, PLATE_POSITION, &position_, UA_TYPES_UINT32);
-            status |= plate_type_inserter_.set_scalar_attribute(instance_name_id_, PLATE_RECIPE_ID, &placed_recipe_id_, UA_TYPES_UINT32);
-            status |= plate_type_inserter_.set_scalar_attribute(instance_name_id_, PLATE_OCCUPIED, &occupied_, UA_TYPES_BOOLEAN);
+            status |= plate_type_inserter_.set_scalar_attribute(position_handle_, &position_, UA_TYPES_UINT32);
+            status |= plate_type_inserter_.set_scalar_attribute(recipe_id_handle_, &placed_recipe_id_, UA_TYPES_UINT32);
+            status |= plate_type_inserter_.set_scalar_attribute(occupied_handle_, &occupied_, UA_TYPES_BOOLEAN);
             if (status != UA_STATUSCODE_GOOD) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting plate attributes (%s)", __FUNCTION__, UA_StatusCode_name(status));
             }
@@ -383,7 +439,9 @@ struct plate {
          * @param _plate the plate.
          */
         plate(const plate& _plate) : id_(_plate.id_), position_(_plate.position_), placed_recipe_id_(_plate.placed_recipe_id_), processed_steps_of_placed_recipe_id_(_plate.processed_steps_of_placed_recipe_id_),
-            occupied_(_plate.occupied_), is_dish_finished_(_plate.is_dish_finished_), target_position_(_plate.target_position_), instance_name_id_(_plate.instance_name_id_), plate_type_inserter_(_plate.plate_type_inserter_) {
+            occupied_(_plate.occupied_), is_dish_finished_(_plate.is_dish_finished_), target_position_(_plate.target_position_), planned_route_(_plate.planned_route_),
+            route_invalidated_(_plate.route_invalidated_), instance_name_id_(_plate.instance_name_id_), plate_type_inserter_(_plate.plate_type_inserter_),
+            position_handle_(_plate.position_handle_), recipe_id_handle_(_plate.recipe_id_handle_), occupied_handle_(_plate.occupied_handle_) {
         }
 
         /**
@@ -402,7 +460,7 @@ struct plate {
          */
         void set_position(position_t _position) {
             position_ = _position;
-            plate_type_inserter_.set_scalar_attribute(instance_name_id_, PLATE_POSITION, &position_, UA_TYPES_UINT32);
+            plate_type_inserter_.set_scalar_attribute(position_handle_, &position_, UA_TYPES_UINT32);
         }
 
         /**
@@ -421,7 +479,7 @@ struct plate {
          */
         void place_recipe_id(recipe_id_t _placed_recipe_id) {
             placed_recipe_id_ = _placed_recipe_id;
-            plate_type_inserter_.set_scalar_attribute(instance_name_id_, PLATE_RECIPE_ID, &placed_recipe_id_, UA_TYPES_UINT32);
+            plate_type_inserter_.set_scalar_attribute(recipe_id_handle_, &placed_recipe_id_, UA_TYPES_UINT32);
         }
 
         /**
@@ -476,7 +534,7 @@ struct plate {
          */
         void set_occupied(UA_Boolean _occupied) {
             occupied_ = _occupied;
-            plate_type_inserter_.set_scalar_attribute(instance_name_id_, PLATE_OCCUPIED, &occupied_, UA_TYPES_BOOLEAN);
+            plate_type_inserter_.set_scalar_attribute(occupied_handle_, &occupied_, UA_TYPES_BOOLEAN);
         }
 
         /**
@@ -505,6 +563,42 @@ struct plate {
         UA_Boolean is_dish_finished() const {
             return is_dish_finished_;
         }
+
+        /**
+         * @brief Sets the planned route for the remaining steps.
+         * 
+         * @param _planned_route the planned robots in processing order.
+         */
+        void set_planned_route(route_plan _planned_route) {
+            planned_route_ = std::move(_planned_route);
+        }
+
+        /**
+         * @brief Returns the planned route for the remaining steps.
+         * 
+         * @return route_plan& the planned robots in processing order, empty if the next robot is requested from the controller.
+         */
+        route_plan& get_planned_route() {
+            return planned_route_;
+        }
+
+        /**
+         * @brief Sets whether the planned route has to be planned anew.
+         * 
+         * @param _route_invalidated the route invalidated state.
+         */
+        void set_route_invalidated(UA_Boolean _route_invalidated) {
+            route_invalidated_ = _route_invalidated;
+        }
+
+        /**
+         * @brief Returns whether the planned route has to be planned anew.
+         * 
+         * @return UA_Boolean indicates whether a swap, reconfiguration or failed delivery invalidated the route.
+         */
+        UA_Boolean is_route_invalidated() const {
+            return route_invalidated_;
+        }
 };
 
 class conveyor {
@@ -526,6 +620,7 @@ private:
     UA_String type_; /**< the conveyor's agent type. */
     object_type_node_inserter conveyor_type_inserter_; /**< the conveyor type inserter for adding the conveyor's attributes and methods to the address space. */
     object_type_node_inserter plate_type_inserter_; /**< the plate type inserter for adding the plate's attributes to the address space. */
+    attribute_handle occupied_plates_handle_; /**< the resolved handle of the occupied plates attribute. */
     std::atomic<bool> running_; /**< flag to indicate whether the server and client threads should run. */
     state state_status_; /**< the current state of the conveyor. */
     std::vector<plate> plates_; /**< the plates on the conveyor. */
@@ -534,12 +629,13 @@ private:
     std::thread worker_thread_; /**< the worker thread. */
     boost::asio::io_context io_context_; /**< the io context managing the worker thread. */
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type, void, void> work_guard_; /**< the work guard for the io_context_. */
-    boost::asio::steady_timer steady_timer_; /**< the steady timer for action time simulation. */
+    kitchen_timer steady_timer_; /**< the timer for action time simulation. */
     std::unordered_set<plate_id_t> occupied_plates_; /**< the currently occupied plates. */
     std::unordered_map<position_t, plate_id_t> position_plate_id_map_; /**< the map tracking the current positions of the plates. */
     std::unordered_map<position_t, std::string> notifications_map_; /**< the notifications received by the robots. */
-    std::unordered_map<position_t, std::unique_ptr<remote_robot>> position_remote_robot_map_; /**< the map tracking the current positions of robots. */
+    std::unordered_map<position_t, std::unique_ptr<conveyor_remote_robot>> position_remote_robot_map_; /**< the map tracking the current positions of robots. */
     std::unordered_map<std::string, object_method_info> method_id_map_; /**< the map holding the node ids of client methods. */
+    prepared_method_call choose_next_robot_call_; /**< the prepared choose next robot call, guarded by the client mutex. */
     std::queue<position_t> next_robot_request_queue_; /**< the queue holding the order of next robot requests. */
     /* controller related member variables. */
     std::mutex client_mutex_; /**< the mutex to synchronize client method calls. */
@@ -547,6 +643,7 @@ private:
     UA_Client* controller_client_; /**< the OPC UA controller client pointer. */
     /* kitchen related member variables. */
     UA_Client* kitchen_client_; /**< the OPC UA kitchen client pointer. */
+    bool batch_calls_; /**< flag to indicate whether calls to a robot are gathered per step and sent in one request. */
 
     /**
      * @brief Extracts the remote robot port and position on which a finished order is ready to be retrieved.
@@ -589,6 +686,24 @@ private:
     void
     handle_retrieve_finished_orders();
 
+    /**
+     * @brief Retrieves all retrievable finished orders with one request per robot session, all sessions in flight concurrently.
+     * Requests the next robots once all retrievals completed.
+     * 
+     */
+    void
+    retrieve_finished_orders_batched();
+
+    /**
+     * @brief Retrieves the finished order of a robot with a batched request. The robot is looked up when the coroutine runs.
+     * 
+     * @param _robot_position the position of the robot handing over the finished order.
+     * @param _robot_endpoint the endpoint of the robot handing over the finished order.
+     * @return boost::asio::awaitable<void> the retrieval coroutine.
+     */
+    boost::asio::awaitable<void>
+    retrieve_from_robot(position_t _robot_position, std::string _robot_endpoint);
+
     /**
      * @brief Moves the conveyor and updates plate position accordingly.
      * 
@@ -598,12 +713,55 @@ private:
     move_conveyor(steps_t _steps);
 
     /**
-     * @brief Delivers the finished order on the output position.
+     * @brief Delivers the finished orders on the output position and partially prepared orders to their target robots.
+     * The deliveries of all plates are in flight concurrently, the next movement is determined once all completed.
      * 
      */
     void
     deliver_finished_order();
 
+    /**
+     * @brief Delivers the finished order of a plate at the output position to the kitchen.
+     * 
+     * @param _plate_id the plate id.
+     * @return boost::asio::awaitable<void> the delivery coroutine.
+     */
+    boost::asio::awaitable<void>
+    deliver_to_output(plate_id_t _plate_id);
+
+    /**
+     * @brief Delivers the partially prepared order of a plate to the robot at its target position. The robot is looked up
+     * when the coroutine runs, the delivery fails if it is not known with the endpoint anymore.
+     * 
+     * @param _plate_id the plate id.
+     * @param _robot_position the plate's target position.
+     * @param _robot_endpoint the endpoint of the robot at the plate's target position.
+     * @return boost::asio::awaitable<void> the delivery coroutine.
+     */
+    boost::asio::awaitable<void>
+    deliver_to_robot(plate_id_t _plate_id, position_t _robot_position, std::string _robot_endpoint);
+
+    /**
+     * @brief Delivers the partially prepared orders of several plates to their target robot with a single request. The robot
+     * is looked up when the coroutine runs, the deliveries fail if it is not known with the endpoint anymore.
+     * 
+     * @param _plate_ids the plate ids.
+     * @param _robot_position the plates' target position.
+     * @param _robot_endpoint the endpoint of the robot at the plates' target position.
+     * @return boost::asio::awaitable<void> the delivery coroutine.
+     */
+    boost::asio::awaitable<void>
+    deliver_batch_to_robot(std::vector<plate_id_t> _plate_ids, position_t _robot_position, std::string _robot_endpoint);
+
+    /**
+     * @brief Completes the delivery of a plate to a robot with the result of the robot's receive task call.
+     * 
+     * @param _plate_id the plate id.
+     * @param _result the result of the receive task call.
+     */
+    void
+    complete_delivery_to_robot(plate_id_t _plate_id, method_call_result _result);
+
     /**
      * @brief Extracts the returned result to indicate whether the completed dish is delivered successfully.
      * 
@@ -638,9 +796,11 @@ private:
      * @param _finished_recipe the recipe id of the finished dish.
      * @param _processed_steps the steps count processed so far.
      * @param _is_dish_finished indicates if the dish is finished partially or completely.
+     * @param _planned_route the planned robots for the remaining steps, empty if the next robot is requested from the controller.
      */
     void
-    handle_handover_finished_order(std::string _remote_robot_endpoint, position_t _remote_robot_position, recipe_id_t _finished_recipe, UA_UInt32 _processed_steps, UA_Boolean _is_dish_finished);
+    handle_handover_finished_order(std::string _remote_robot_endpoint, position_t _remote_robot_position, recipe_id_t _finished_recipe, UA_UInt32 _processed_steps, UA_Boolean _is_dish_finished,
+        route_plan _planned_route);
 
     /**
      * @brief Initiates next robot requests for occupied plates.
@@ -656,6 +816,65 @@ private:
     void
     request_next_robot(plate& _plate);
 
+    /**
+     * @brief Sets the target position of a plate to the next robot of its planned route without asking the controller.
+     * A route whose next robot moved or left, or which was invalidated, is planned anew with the controller.
+     * 
+     * @param _plate the plate.
+     * @return true if the target position is set.
+     * @return false if the plate has no route, the next robot has to be requested.
+     */
+    bool
+    follow_planned_route(plate& _plate);
+
+    /**
+     * @brief Plans the route for the remaining steps of a plate's dish anew with the controller.
+     * 
+     * @param _plate the plate.
+     * @return route_plan the planned robots in processing order, empty if the controller couldn't plan a route.
+     */
+    route_plan
+    plan_route(plate& _plate);
+
+    /**
+     * @brief Drops the planned route of a plate and marks it to be planned anew, if the plate follows a route.
+     * 
+     * @param _plate the plate.
+     */
+    void
+    invalidate_route(plate& _plate);
+
+    /**
+     * @brief Logs the exception a handover coroutine ended with and resets the affected plates, so they are routed anew.
+     * 
+     * @param _exception the exception of the coroutine, nullptr if it completed.
+     * @param _plate_ids the plates affected by the handover.
+     * @param _handover the description of the handover for the log.
+     */
+    void
+    reset_failed_handover(std::exception_ptr _exception, const std::vector<plate_id_t>& _plate_ids, const std::string& _handover);
+
+    /**
+     * @brief Looks up the robot at a position.
+     * 
+     * @param _robot_position the robot position.
+     * @param _robot_endpoint the robot endpoint.
+     * @return conveyor_remote_robot* the robot, nullptr if no robot with the endpoint is known at the position.
+     */
+    conveyor_remote_robot*
+    find_remote_robot(position_t _robot_position, const std::string& _robot_endpoint);
+
+    /**
+     * @brief Connects to the robot at a position unless it is known with the same endpoint.
+     * 
+     * @param _robot_position the robot position.
+     * @param _robot_endpoint the robot endpoint.
+     * @return true if the robot is connected.
+     * @return false if the connection failed.
+     */
+    bool
+    connect_remote_robot(position_t _robot_position, const std::string& _robot_endpoint);
+
    /**
      * @brief Receives the next suitable robot for a requested recipe.
      * 
@@ -738,8 +957,9 @@ public:
      * @brief Construct a new conveyor object.
      * 
      * @param _robot_count the robot count.
+     * @param _batch_calls flag to indicate whether pickups and deliveries are batched per robot session.
      */
-    conveyor(UA_UInt32 _robot_count);
+    conveyor(UA_UInt32 _robot_count, bool _batch_calls = false);
 
     /**
      * @brief Destroy the conveyor object.
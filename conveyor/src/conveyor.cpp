@@ -5,16 +5,18 @@
 #include <memory>
 #include "callback_scheduler.hpp"
 #include "time_unit.hpp"
+#include "agent_timings.hpp"
 #include "filtered_logger.hpp"
 #include "discovery_and_connection.hpp"
 
 #define CONVEYOR_INSTANCE_NAME "KitchenConveyor"
-#define DEBOUNCE_TIME 1LL
-#define MOVE_TIME 1LL
+#define CHOOSE_NEXT_ROBOT_RECIPE_ID_ARGUMENT 0
+#define CHOOSE_NEXT_ROBOT_PROCESSED_STEPS_ARGUMENT 1
+#define CHOOSE_NEXT_ROBOT_PLATE_POSITION_ARGUMENT 4
 
-conveyor::conveyor(UA_UInt32 _robot_count) : server_(UA_Server_new()), conveyor_uri_("urn:kitchen:conveyor"), conveyor_type_inserter_(server_, CONVEYOR_TYPE), plate_type_inserter_(server_, PLATE_TYPE),
+conveyor::conveyor(UA_UInt32 _robot_count, bool _batch_calls) : server_(UA_Server_new()), conveyor_uri_("urn:kitchen:conveyor"), conveyor_type_inserter_(server_, CONVEYOR_TYPE), plate_type_inserter_(server_, PLATE_TYPE),
                                             running_(true), state_status_(conveyor::state::IDLING), work_guard_(boost::asio::make_work_guard(io_context_)), steady_timer_(io_context_),
-                                            controller_client_(nullptr), kitchen_client_(nullptr) {
+                                            controller_client_(nullptr), kitchen_client_(nullptr), batch_calls_(_batch_calls) {
     UA_ServerConfig* server_config = UA_Server_getConfig(server_);
     UA_StatusCode status = UA_ServerConfig_setMinimal(server_config, 0, NULL);
     if(status != UA_STATUSCODE_GOOD) {
@@ -56,8 +58,9 @@ conveyor::conveyor(UA_UInt32 _robot_count) : server_(UA_Server_new()), conveyor_
     conveyor_type_inserter_.add_object_instance(CONVEYOR_INSTANCE_NAME, CONVEYOR_TYPE);
     UA_UInt32 total_plates_count = _robot_count + 1;
     conveyor_type_inserter_.set_scalar_attribute(CONVEYOR_INSTANCE_NAME, TOTAL_PLATES, &total_plates_count, UA_TYPES_UINT32);
+    conveyor_type_inserter_.resolve_attribute(CONVEYOR_INSTANCE_NAME, OCCUPIED_PLATES, occupied_plates_handle_);
     UA_UInt32 initially_occupied_plates = 0;
-    conveyor_type_inserter_.set_scalar_attribute(CONVEYOR_INSTANCE_NAME, OCCUPIED_PLATES, &initially_occupied_plates, UA_TYPES_UINT32);
+    conveyor_type_inserter_.set_scalar_attribute(occupied_plates_handle_, &initially_occupied_plates, UA_TYPES_UINT32);
     /* Setup plates */
     plate::setup_plate_object_type(plate_type_inserter_, server_);
     for (size_t i = 0; i < total_plates_count; i++) {
@@ -105,6 +108,11 @@ conveyor::conveyor(UA_UInt32 _robot_count) : server_(UA_Server_new()), conveyor_
         stop();
         return;        
     }
+    if ((method_id_map_[PLAN_ROUTE] = node_browser_helper().get_method_id(controller_endpoint, CONTROLLER_TYPE, PLAN_ROUTE)) == OBJECT_METHOD_INFO_NULL) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, PLAN_ROUTE);
+        stop();
+        return;        
+    }
     /* Setup kitchen client */
     std::string kitchen_endpoint;
     while((status = discover_and_connect(kitchen_client_, discovery_util_, kitchen_endpoint, KITCHEN_TYPE)) != UA_STATUSCODE_GOOD) {
@@ -125,9 +133,9 @@ conveyor::conveyor(UA_UInt32 _robot_count) : server_(UA_Server_new()), conveyor_
 conveyor::~conveyor() {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
     stop();
-    io_context_.post([this] {
+    io_context_.post(kitchen_clock::tracked([this] {
         position_remote_robot_map_.clear();
-    });
+    }));
     join_threads();
     {
         std::lock_guard<std::mutex> lock(client_mutex_);
@@ -173,9 +181,9 @@ conveyor::receive_finished_order_notification(UA_Server *_server,
     UA_Boolean finished_order_notification_received = true;
     UA_Variant_setScalarCopy(_output, &finished_order_notification_received, &UA_TYPES[UA_TYPES_BOOLEAN]);
     conveyor* self = static_cast<conveyor*>(_method_context);
-    self->io_context_.post([self, robot_endpoint_std_str, robot_position] {
+    self->io_context_.post(kitchen_clock::tracked([self, robot_endpoint_std_str, robot_position] {
         self->handle_finished_order_notification(robot_endpoint_std_str, robot_position);
-    });
+    }));
     return UA_STATUSCODE_GOOD;
 }
 
@@ -184,21 +192,12 @@ conveyor::handle_finished_order_notification(std::string _robot_endpoint, positi
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "FINISHED_ORDER_NOTIFICATION: Received notification from robot at position %d with endpoint %s", _robot_position, _robot_endpoint.c_str());
     remove_stopped_robots();
-    if (position_remote_robot_map_.find(_robot_position) == position_remote_robot_map_.end() || _robot_endpoint.compare(position_remote_robot_map_[_robot_position]->get_endpoint())) {
-        position_remote_robot_map_.erase(_robot_position);
-        std::unique_ptr<remote_robot> robot = std::make_unique<remote_robot>(_robot_endpoint, _robot_position,
-                                                                            std::bind(&conveyor::position_swapped_callback, this, std::placeholders::_1, std::placeholders::_2));
-        if (robot->initialize_and_start() == UA_STATUSCODE_GOOD) {
-            position_remote_robot_map_[_robot_position] = std::move(robot);
-        } else {
-            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Robot client initialitation/start failed", __FUNCTION__);
-            return;
-        }
-    }
+    if (!connect_remote_robot(_robot_position, _robot_endpoint))
+        return;
     notifications_map_[_robot_position] = _robot_endpoint;
     if (state_status_ == conveyor::state::IDLING) {
         state_status_ = conveyor::state::MOVING;
-        steady_timer_.expires_from_now(std::chrono::milliseconds(DEBOUNCE_TIME * TIME_UNIT));
+        steady_timer_.expires_from_now(std::chrono::milliseconds(CONVEYOR_DEBOUNCE_TIME * TIME_UNIT));
         steady_timer_.async_wait([this](const boost::system::error_code& _error) {
             if (_error) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling finished orders retrieval", __FUNCTION__);
@@ -213,6 +212,10 @@ conveyor::handle_finished_order_notification(std::string _robot_endpoint, positi
 void
 conveyor::handle_retrieve_finished_orders() {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    if (batch_calls_) {
+        retrieve_finished_orders_batched();
+        return;
+    }
     remove_stopped_robots();
     for (auto notification = notifications_map_.begin(); notification != notifications_map_.end();) {
         if (!plates_[position_plate_id_map_[notification->first]].is_occupied()) {
@@ -240,17 +243,72 @@ conveyor::handle_retrieve_finished_orders() {
     request_next_robots();
 }
 
+void
+conveyor::retrieve_finished_orders_batched() {
+    remove_stopped_robots();
+    /* Hold one pending retrieval until all retrievals are spawned */
+    std::shared_ptr<size_t> pending_retrievals = std::make_shared<size_t>(1);
+    auto retrieval_completed = [this, pending_retrievals]() {
+        if (--(*pending_retrievals) > 0)
+            return;
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RETRIEVAL: All retrievable dishes passed by robots.");
+        request_next_robots();
+    };
+    for (auto notification = notifications_map_.begin(); notification != notifications_map_.end();) {
+        if (plates_[position_plate_id_map_[notification->first]].is_occupied()) {
+            notification++;
+            continue;
+        }
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RETRIEVAL: Dish at position %d(%s) is retrievable", notification->first, notification->second.c_str());
+        if (position_remote_robot_map_.find(notification->first) == position_remote_robot_map_.end()) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RETRIEVAL: Robot at position %d(%s) is not known", notification->first, notification->second.c_str());
+        } else {
+            (*pending_retrievals)++;
+            plate_id_t plate_id = position_plate_id_map_[notification->first];
+            std::string handover = "RETRIEVAL: Retrieval from robot at position " + std::to_string(notification->first) + "(" + notification->second + ")";
+            boost::asio::co_spawn(io_context_, retrieve_from_robot(notification->first, notification->second),
+                                  kitchen_clock::tracked([this, retrieval_completed, plate_id, handover](std::exception_ptr _exception) {
+                reset_failed_handover(_exception, {plate_id}, handover);
+                retrieval_completed();
+            }));
+        }
+        notification = notifications_map_.erase(notification);
+    }
+    retrieval_completed();
+}
+
+boost::asio::awaitable<void>
+conveyor::retrieve_from_robot(position_t _robot_position, std::string _robot_endpoint) {
+    /* The robot may have been removed or replaced until the coroutine runs */
+    conveyor_remote_robot* target_robot = find_remote_robot(_robot_position, _robot_endpoint);
+    if (target_robot == nullptr) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RETRIEVAL: Robot at position %d(%s) is not known anymore", _robot_position, _robot_endpoint.c_str());
+        co_return;
+    }
+    method_call_batch batch;
+    target_robot->add_handover_finished_order(batch);
+    std::vector<method_call_result> results = co_await target_robot->async_call_batch(batch);
+    method_call_result& result = results[0];
+    if (result.status_ != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RETRIEVAL: Retrieving finished order failed (%s)", UA_StatusCode_name(result.status_));
+        if (result.output_ != nullptr)
+            UA_Array_delete(result.output_, result.output_size_, &UA_TYPES[UA_TYPES_VARIANT]);
+        co_return;
+    }
+    handover_finished_order_called(result.output_size_, result.output_);
+}
+
 void
 conveyor::request_next_robots() {
     for (plate_id_t plate_id : occupied_plates_) {
         plate& p = plates_[plate_id];
-        if (!p.is_dish_finished() && p.get_target_position() == 0) {
+        if (!p.is_dish_finished() && p.get_target_position() == 0 && !follow_planned_route(p)) {
             request_next_robot(p);
         }
     }
     if (next_robot_request_queue_.empty()) {
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: No next robots requested. ");
-        steady_timer_.expires_from_now(std::chrono::milliseconds(MOVE_TIME * TIME_UNIT));
+        steady_timer_.expires_from_now(std::chrono::milliseconds(CONVEYOR_MOVE_TIME * TIME_UNIT));
         steady_timer_.async_wait([this](const boost::system::error_code& _error) {
             if (_error) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling conveyor movement", __FUNCTION__);
@@ -265,7 +323,7 @@ conveyor::request_next_robots() {
 void
 conveyor::handover_finished_order_called(size_t _output_size, UA_Variant* _output) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    if(_output_size != 5) {
+    if(_output_size != 7) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output size", __FUNCTION__);
         if (_output != nullptr)
             UA_Array_delete(_output, _output_size, &UA_TYPES[UA_TYPES_VARIANT]);
@@ -273,11 +331,13 @@ conveyor::handover_finished_order_called(size_t _output_size, UA_Variant* _outpu
         return;
     }
 
+    route_plan planned_route;
     if(!UA_Variant_hasScalarType(&_output[0], &UA_TYPES[UA_TYPES_STRING])
       || !UA_Variant_hasScalarType(&_output[1], &UA_TYPES[UA_TYPES_UINT32])
       || !UA_Variant_hasScalarType(&_output[2], &UA_TYPES[UA_TYPES_UINT32])
       || !UA_Variant_hasScalarType(&_output[3], &UA_TYPES[UA_TYPES_UINT32])
-      || !UA_Variant_hasScalarType(&_output[4], &UA_TYPES[UA_TYPES_BOOLEAN])) {
+      || !UA_Variant_hasScalarType(&_output[4], &UA_TYPES[UA_TYPES_BOOLEAN])
+      || route_from_variants(_output[5], _output[6], planned_route) != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
         if (_output != nullptr)
             UA_Array_delete(_output, _output_size, &UA_TYPES[UA_TYPES_VARIANT]);
@@ -293,11 +353,12 @@ conveyor::handover_finished_order_called(size_t _output_size, UA_Variant* _outpu
     std::string remote_robot_endpoint_str = std::string((char*) remote_robot_endpoint.data, remote_robot_endpoint.length);
     if (_output != nullptr)
         UA_Array_delete(_output, _output_size, &UA_TYPES[UA_TYPES_VARIANT]);
-    handle_handover_finished_order(remote_robot_endpoint_str, remote_robot_position, finished_recipe, processed_steps, is_dish_finished);
+    handle_handover_finished_order(remote_robot_endpoint_str, remote_robot_position, finished_recipe, processed_steps, is_dish_finished, std::move(planned_route));
 }
 
 void
-conveyor::handle_handover_finished_order(std::string _remote_robot_endpoint, position_t _remote_robot_position, recipe_id_t _finished_recipe, UA_UInt32 _processed_steps, UA_Boolean _is_dish_finished) {
+conveyor::handle_handover_finished_order(std::string _remote_robot_endpoint, position_t _remote_robot_position, recipe_id_t _finished_recipe, UA_UInt32 _processed_steps, UA_Boolean _is_dish_finished,
+        route_plan _planned_route) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
     if (_finished_recipe == 0) {
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UNCOORDINATED HANDOVER: Robot at position %d passed recipe ID %d with processed steps of %d (%s)", _remote_robot_position, _finished_recipe, _processed_steps, (_is_dish_finished ? "completely" : "partially"));
@@ -309,9 +370,11 @@ conveyor::handle_handover_finished_order(std::string _remote_robot_endpoint, pos
     p.set_occupied(true);
     p.set_dish_finished(_is_dish_finished);
     p.set_processed_steps(_processed_steps);
+    p.set_planned_route(std::move(_planned_route));
+    p.set_route_invalidated(false);
     occupied_plates_.insert(p.get_plate_id());
     UA_UInt32 occupied_plates_count = occupied_plates_.size();
-    conveyor_type_inserter_.set_scalar_attribute(CONVEYOR_INSTANCE_NAME, OCCUPIED_PLATES, &occupied_plates_count, UA_TYPES_UINT32);
+    conveyor_type_inserter_.set_scalar_attribute(occupied_plates_handle_, &occupied_plates_count, UA_TYPES_UINT32);
 }
 
 void
@@ -320,20 +383,18 @@ conveyor::request_next_robot(plate& _plate) {
     /* Request next robot */
     recipe_id_t finished_recipe = _plate.get_placed_recipe_id();
     UA_UInt32 processed_steps = _plate.get_processed_steps();
+    position_t plate_position = _plate.get_position();
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "CHOOSE NEXT ROBOT: Request next robot for recipe %d with processed steps %d", finished_recipe, processed_steps);
-    method_node_caller choose_next_robot_caller;
-    choose_next_robot_caller.add_scalar_input_argument(&finished_recipe, UA_TYPES_UINT32);
-    choose_next_robot_caller.add_scalar_input_argument(&processed_steps, UA_TYPES_UINT32);
-    choose_next_robot_caller.add_scalar_input_argument(&server_endpoint_, UA_TYPES_STRING);
-    choose_next_robot_caller.add_scalar_input_argument(&type_, UA_TYPES_STRING);
-    object_method_info omi = method_id_map_[CHOOSE_NEXT_ROBOT];
     size_t output_size = 0;
     UA_Variant* output = nullptr;
     UA_StatusCode status = UA_STATUSCODE_UNCERTAIN;
     {
         std::lock_guard<std::mutex> lock(client_mutex_);
-        if (controller_client_ != nullptr)
-            status = choose_next_robot_caller.call_method_node(controller_client_, omi.object_id_, omi.method_id_, &output_size, &output);
+        choose_next_robot_call_.set_scalar_input_argument(CHOOSE_NEXT_ROBOT_RECIPE_ID_ARGUMENT, &finished_recipe);
+        choose_next_robot_call_.set_scalar_input_argument(CHOOSE_NEXT_ROBOT_PROCESSED_STEPS_ARGUMENT, &processed_steps);
+        choose_next_robot_call_.set_scalar_input_argument(CHOOSE_NEXT_ROBOT_PLATE_POSITION_ARGUMENT, &plate_position);
+        if (controller_client_ != nullptr && choose_next_robot_call_.is_prepared())
+            status = choose_next_robot_call_.call(controller_client_, &output_size, &output);
     }
     if (status != UA_STATUSCODE_GOOD) {
         if (output != nullptr)
@@ -363,6 +424,120 @@ conveyor::request_next_robot(plate& _plate) {
         UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
 }
 
+bool
+conveyor::follow_planned_route(plate& _plate) {
+    route_plan& route = _plate.get_planned_route();
+    if (route.empty() && !_plate.is_route_invalidated())
+        return false;
+    if (!_plate.is_route_invalidated()) {
+        route_hop& next_hop = route.front();
+        /* A robot known at the planned position with another endpoint moved there after planning */
+        bool unknown = position_remote_robot_map_.find(next_hop.position_) == position_remote_robot_map_.end();
+        if ((unknown && connect_remote_robot(next_hop.position_, next_hop.endpoint_))
+            || (!unknown && next_hop.endpoint_ == position_remote_robot_map_[next_hop.position_]->get_endpoint())) {
+            if (position_remote_robot_map_[next_hop.position_]->get_position() == next_hop.position_) {
+                UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "ROUTE: Plate at position %d follows its route to robot at position %d (%zu robots left)", _plate.get_position(), next_hop.position_, route.size() - 1);
+                _plate.set_target_position(next_hop.position_);
+                route.erase(route.begin());
+                return true;
+            }
+        }
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "ROUTE: Robot at position %d left the route of the plate at position %d", next_hop.position_, _plate.get_position());
+    }
+    /* Plan the remaining steps anew, the controller decides on the current registry */
+    route_plan new_route = plan_route(_plate);
+    _plate.set_route_invalidated(false);
+    if (new_route.empty() || !connect_remote_robot(new_route.front().position_, new_route.front().endpoint_)) {
+        _plate.set_planned_route({});
+        return false;
+    }
+    _plate.set_target_position(new_route.front().position_);
+    new_route.erase(new_route.begin());
+    _plate.set_planned_route(std::move(new_route));
+    return true;
+}
+
+route_plan
+conveyor::plan_route(plate& _plate) {
+    recipe_id_t recipe_id = _plate.get_placed_recipe_id();
+    UA_UInt32 processed_steps = _plate.get_processed_steps();
+    position_t plate_position = _plate.get_position();
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "ROUTE: Plan route anew for recipe %d with processed steps %d", recipe_id, processed_steps);
+    method_node_caller plan_route_caller;
+    plan_route_caller.add_scalar_input_argument(&recipe_id, UA_TYPES_UINT32);
+    plan_route_caller.add_scalar_input_argument(&processed_steps, UA_TYPES_UINT32);
+    plan_route_caller.add_scalar_input_argument(&plate_position, UA_TYPES_UINT32);
+    object_method_info omi = method_id_map_[PLAN_ROUTE];
+    size_t output_size = 0;
+    UA_Variant* output = nullptr;
+    UA_StatusCode status = UA_STATUSCODE_UNCERTAIN;
+    {
+        std::lock_guard<std::mutex> lock(client_mutex_);
+        if (controller_client_ != nullptr)
+            status = plan_route_caller.call_method_node(controller_client_, omi.object_id_, omi.method_id_, &output_size, &output);
+    }
+    route_plan route;
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling %s method (%s)", __FUNCTION__, PLAN_ROUTE, UA_StatusCode_name(status));
+    } else if (output_size != 2 || route_from_variants(output[0], output[1], route) != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
+    }
+    if (output != nullptr)
+        UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
+    return route;
+}
+
+void
+conveyor::invalidate_route(plate& _plate) {
+    if (_plate.get_planned_route().empty())
+        return;
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "ROUTE: Route of plate at position %d is invalidated", _plate.get_position());
+    _plate.set_planned_route({});
+    _plate.set_route_invalidated(true);
+}
+
+conveyor_remote_robot*
+conveyor::find_remote_robot(position_t _robot_position, const std::string& _robot_endpoint) {
+    auto position_robot = position_remote_robot_map_.find(_robot_position);
+    if (position_robot == position_remote_robot_map_.end() || position_robot->second->get_endpoint() != _robot_endpoint)
+        return nullptr;
+    return position_robot->second.get();
+}
+
+void
+conveyor::reset_failed_handover(std::exception_ptr _exception, const std::vector<plate_id_t>& _plate_ids, const std::string& _handover) {
+    if (!_exception)
+        return;
+    std::string reason = "unknown exception";
+    try {
+        std::rethrow_exception(_exception);
+    } catch (const std::exception& _error) {
+        reason = _error.what();
+    } catch (...) {
+    }
+    for (plate_id_t plate_id : _plate_ids) {
+        plate& p = plates_[plate_id];
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s of plate %d at position %d failed (%s)", _handover.c_str(), plate_id, p.get_position(), reason.c_str());
+        p.set_target_position(0);
+        invalidate_route(p);
+    }
+}
+
+bool
+conveyor::connect_remote_robot(position_t _robot_position, const std::string& _robot_endpoint) {
+    if (position_remote_robot_map_.find(_robot_position) != position_remote_robot_map_.end() && !_robot_endpoint.compare(position_remote_robot_map_[_robot_position]->get_endpoint()))
+        return true;
+    position_remote_robot_map_.erase(_robot_position);
+    std::unique_ptr<conveyor_remote_robot> robot = std::make_unique<conveyor_remote_robot>(_robot_endpoint, _robot_position,
+                                            std::bind(&conveyor::position_swapped_callback, this, std::placeholders::_1, std::placeholders::_2));
+    if (robot->initialize_and_start() != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Robot client initialitation/start failed", __FUNCTION__);
+        return false;
+    }
+    position_remote_robot_map_[_robot_position] = std::move(robot);
+    return true;
+}
+
 UA_StatusCode
 conveyor::receive_next_robot(UA_Server* _server,
             const UA_NodeId* _session_id, void* _session_context,
@@ -403,9 +578,9 @@ conveyor::receive_next_robot(UA_Server* _server,
     }
 
     std::string robot_endpoint_str((char*) robot_endpoint.data, robot_endpoint.length);
-    self->io_context_.post([self, robot_position, robot_endpoint_str, recipe_id] {
+    self->io_context_.post(kitchen_clock::tracked([self, robot_position, robot_endpoint_str, recipe_id] {
         self->handle_receive_next_robot(robot_position, robot_endpoint_str, recipe_id);
-    });
+    }));
     return UA_STATUSCODE_GOOD;
 }
 
@@ -416,20 +591,8 @@ conveyor::handle_receive_next_robot(position_t _robot_position, std::string _rob
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: Unexpected response with no outstanding requests (recipe id %d). Ignoring.", _recipe_id);
         return;
     }
-    if (_robot_position != 0
-        && !_robot_endpoint.empty()
-        && (position_remote_robot_map_.find(_robot_position) == position_remote_robot_map_.end()
-            || _robot_endpoint.compare(position_remote_robot_map_[_robot_position]->get_endpoint())
-    )) {
-        position_remote_robot_map_.erase(_robot_position);
-        std::unique_ptr<remote_robot> robot = std::make_unique<remote_robot>(_robot_endpoint, _robot_position,
-                                                std::bind(&conveyor::position_swapped_callback, this, std::placeholders::_1, std::placeholders::_2));
-        if (robot->initialize_and_start() == UA_STATUSCODE_GOOD) {
-            position_remote_robot_map_[_robot_position] = std::move(robot);
-        } else {
-            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Robot client initialitation/start failed", __FUNCTION__);
-        }
-    }
+    if (_robot_position != 0 && !_robot_endpoint.empty())
+        connect_remote_robot(_robot_position, _robot_endpoint);
     // Sanity check
     position_t position_requested_from = next_robot_request_queue_.front();
     plate& p = plates_[position_plate_id_map_[position_requested_from]];
@@ -448,7 +611,7 @@ conveyor::handle_receive_next_robot(position_t _robot_position, std::string _rob
         return;
     }
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: Received all next robot responses");
-    steady_timer_.expires_from_now(std::chrono::milliseconds(MOVE_TIME * TIME_UNIT));
+    steady_timer_.expires_from_now(std::chrono::milliseconds(CONVEYOR_MOVE_TIME * TIME_UNIT));
     steady_timer_.async_wait([this](const boost::system::error_code& _error) {
         if (_error) {
             UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling conveyor movement", __FUNCTION__);
@@ -475,85 +638,146 @@ void
 conveyor::deliver_finished_order() {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
     remove_stopped_robots();
-    for (auto occupied_plate_id = occupied_plates_.begin(); occupied_plate_id != occupied_plates_.end();) {
-        plate& p = plates_[*occupied_plate_id];
-        if (!p.is_dish_finished() && p.get_target_position() == 0) {
-            occupied_plate_id++;
+    /* Hold one pending delivery until all deliveries are spawned */
+    std::shared_ptr<size_t> pending_deliveries = std::make_shared<size_t>(1);
+    auto delivery_completed = [this, pending_deliveries]() {
+        if (--(*pending_deliveries) == 0)
+            determine_next_movement();
+    };
+    auto delivery_handler = [this, delivery_completed](std::vector<plate_id_t> _plate_ids, std::string _handover) {
+        return kitchen_clock::tracked([this, delivery_completed, _plate_ids, _handover](std::exception_ptr _exception) {
+            reset_failed_handover(_exception, _plate_ids, _handover);
+            delivery_completed();
+        });
+    };
+    std::unordered_map<position_t, std::vector<plate_id_t>> robot_deliveries;
+    std::vector<plate_id_t> occupied_plate_ids(occupied_plates_.begin(), occupied_plates_.end());
+    for (plate_id_t occupied_plate_id : occupied_plate_ids) {
+        plate& p = plates_[occupied_plate_id];
+        if (!p.is_dish_finished() && p.get_target_position() == 0)
             continue;
-        }
         /* Deliver finished orders */
         if (p.is_dish_finished() && p.get_position() == OUTPUT_POSITION) {
-            method_node_caller receive_completed_order_caller;
-            recipe_id_t completed_recipe = p.get_placed_recipe_id();
-            receive_completed_order_caller.add_scalar_input_argument(&completed_recipe, UA_TYPES_UINT32);
-            object_method_info omi = method_id_map_[RECEIVE_COMPLETED_ORDER];
-            size_t output_size = 0;
-            UA_Variant* output = nullptr;
-            UA_StatusCode status = UA_STATUSCODE_UNCERTAIN;
-            {
-                std::lock_guard<std::mutex> lock(client_mutex_);
-                if (kitchen_client_ != nullptr)
-                    status = receive_completed_order_caller.call_method_node(kitchen_client_, omi.object_id_, omi.method_id_, &output_size, &output);
-            }
-            if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "OUTPUT DELIVERY: Failed to call %s method (%s)", RECEIVE_COMPLETED_ORDER, UA_StatusCode_name(status));
-                if (output != nullptr)
-                    UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
-                occupied_plate_id++;
-                continue;
-            }
-            if ((status = receive_completed_order_called(output_size, output)) != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "OUTPUT DELIVERY: Delivery failed because Kitchen returned bad result");
-                occupied_plate_id++;
-                continue;
-            }
-            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "OUTPUT DELIVERY: Finished dish with recipe id %d delivered at output (%s)", p.get_placed_recipe_id(), UA_StatusCode_name(status));
-            reset_plate(p);
-            occupied_plate_id = occupied_plates_.erase(occupied_plate_id);
-            UA_UInt32 occupied_plates_count = occupied_plates_.size();
-            conveyor_type_inserter_.set_scalar_attribute(CONVEYOR_INSTANCE_NAME, OCCUPIED_PLATES, &occupied_plates_count, UA_TYPES_UINT32);
+            (*pending_deliveries)++;
+            boost::asio::co_spawn(io_context_, deliver_to_output(occupied_plate_id), delivery_handler({occupied_plate_id}, "OUTPUT DELIVERY: Delivery to the kitchen"));
             continue;
         }
         /* Deliver partially prepared orders to next suitable robot */
         if (!p.is_dish_finished() && p.get_position() == p.get_target_position()) {
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "PREPARE DELIVERY: Dish at position %d is deliverable", p.get_position());
-            size_t output_size = 0;
-            UA_Variant* output = nullptr;
             if (position_remote_robot_map_.find(p.get_position()) == position_remote_robot_map_.end()) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "PREPARE DELIVERY: Robot at position %d is not known", p.get_position());
                 p.set_target_position(0);
-                occupied_plate_id++;
+                invalidate_route(p);
                 continue;
             }
-
-            remote_robot* target_robot = position_remote_robot_map_[p.get_position()].get();
+            conveyor_remote_robot* target_robot = position_remote_robot_map_[p.get_position()].get();
             if (target_robot->get_position() != p.get_position() || !target_robot->is_available()) {
                 p.set_target_position(0);
-                occupied_plate_id++;
+                invalidate_route(p);
                 continue;
             }
-            UA_StatusCode status = target_robot->instruct(p.get_placed_recipe_id(), p.get_processed_steps(), p.get_position(), &output_size, &output);
-            if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "DELIVERY: Failed to deliver dish at position %d", p.get_position());
-                if (output != nullptr)
-                    UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
-                p.set_target_position(0);
-                occupied_plate_id++;
+            if (batch_calls_) {
+                robot_deliveries[p.get_position()].push_back(occupied_plate_id);
                 continue;
             }
-            if (receive_robot_task_called(output_size, output, p)) {
-                reset_plate(p);
-                occupied_plate_id = occupied_plates_.erase(occupied_plate_id);
-                UA_UInt32 occupied_plates_count = occupied_plates_.size();
-                conveyor_type_inserter_.set_scalar_attribute(CONVEYOR_INSTANCE_NAME, OCCUPIED_PLATES, &occupied_plates_count, UA_TYPES_UINT32);
-                continue;
-            } else {
-                p.set_target_position(0);
-            }
+            (*pending_deliveries)++;
+            boost::asio::co_spawn(io_context_, deliver_to_robot(occupied_plate_id, p.get_position(), target_robot->get_endpoint()),
+                                  delivery_handler({occupied_plate_id}, "DELIVERY: Delivery to robot at position " + std::to_string(p.get_position()) + "(" + target_robot->get_endpoint() + ")"));
         }
-        occupied_plate_id++;
     }
-    determine_next_movement();
+    /* Send the deliveries per target robot in one request each */
+    for (auto& [robot_position, plate_ids] : robot_deliveries) {
+        (*pending_deliveries)++;
+        std::string robot_endpoint = position_remote_robot_map_[robot_position]->get_endpoint();
+        auto handler = delivery_handler(plate_ids, "DELIVERY: Batched delivery to robot at position " + std::to_string(robot_position) + "(" + robot_endpoint + ")");
+        boost::asio::co_spawn(io_context_, deliver_batch_to_robot(std::move(plate_ids), robot_position, robot_endpoint), std::move(handler));
+    }
+    delivery_completed();
+}
+
+boost::asio::awaitable<void>
+conveyor::deliver_to_output(plate_id_t _plate_id) {
+    method_node_caller receive_completed_order_caller;
+    recipe_id_t completed_recipe = plates_[_plate_id].get_placed_recipe_id();
+    receive_completed_order_caller.add_scalar_input_argument(&completed_recipe, UA_TYPES_UINT32);
+    object_method_info omi = method_id_map_[RECEIVE_COMPLETED_ORDER];
+    method_call_result result = co_await receive_completed_order_caller.async_call(kitchen_client_, omi.object_id_, omi.method_id_, [this] {
+        return std::unique_lock<std::mutex>(client_mutex_);
+    });
+    if (result.status_ != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "OUTPUT DELIVERY: Failed to call %s method (%s)", RECEIVE_COMPLETED_ORDER, UA_StatusCode_name(result.status_));
+        if (result.output_ != nullptr)
+            UA_Array_delete(result.output_, result.output_size_, &UA_TYPES[UA_TYPES_VARIANT]);
+        co_return;
+    }
+    UA_StatusCode status = receive_completed_order_called(result.output_size_, result.output_);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "OUTPUT DELIVERY: Delivery failed because Kitchen returned bad result");
+        co_return;
+    }
+    plate& p = plates_[_plate_id];
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "OUTPUT DELIVERY: Finished dish with recipe id %d delivered at output (%s)", p.get_placed_recipe_id(), UA_StatusCode_name(status));
+    reset_plate(p);
+    occupied_plates_.erase(_plate_id);
+    UA_UInt32 occupied_plates_count = occupied_plates_.size();
+    conveyor_type_inserter_.set_scalar_attribute(occupied_plates_handle_, &occupied_plates_count, UA_TYPES_UINT32);
+}
+
+boost::asio::awaitable<void>
+conveyor::deliver_to_robot(plate_id_t _plate_id, position_t _robot_position, std::string _robot_endpoint) {
+    /* The robot may have been removed or replaced until the coroutine runs */
+    conveyor_remote_robot* target_robot = find_remote_robot(_robot_position, _robot_endpoint);
+    if (target_robot == nullptr) {
+        complete_delivery_to_robot(_plate_id, {UA_STATUSCODE_BADNOTCONNECTED, 0, nullptr});
+        co_return;
+    }
+    plate& p = plates_[_plate_id];
+    method_call_result result = co_await target_robot->async_instruct(p.get_placed_recipe_id(), p.get_processed_steps(), p.get_position(), p.get_planned_route());
+    complete_delivery_to_robot(_plate_id, result);
+}
+
+boost::asio::awaitable<void>
+conveyor::deliver_batch_to_robot(std::vector<plate_id_t> _plate_ids, position_t _robot_position, std::string _robot_endpoint) {
+    /* The robot may have been removed or replaced until the coroutine runs */
+    conveyor_remote_robot* target_robot = find_remote_robot(_robot_position, _robot_endpoint);
+    if (target_robot == nullptr) {
+        for (plate_id_t plate_id : _plate_ids) {
+            complete_delivery_to_robot(plate_id, {UA_STATUSCODE_BADNOTCONNECTED, 0, nullptr});
+        }
+        co_return;
+    }
+    method_call_batch batch;
+    for (plate_id_t plate_id : _plate_ids) {
+        plate& p = plates_[plate_id];
+        target_robot->add_instruct(batch, p.get_placed_recipe_id(), p.get_processed_steps(), p.get_position(), p.get_planned_route());
+    }
+    std::vector<method_call_result> results = co_await target_robot->async_call_batch(batch);
+    for (size_t i = 0; i < _plate_ids.size(); i++) {
+        complete_delivery_to_robot(_plate_ids[i], results[i]);
+    }
+}
+
+void
+conveyor::complete_delivery_to_robot(plate_id_t _plate_id, method_call_result _result) {
+    plate& p = plates_[_plate_id];
+    if (_result.status_ != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "DELIVERY: Failed to deliver dish at position %d (%s)", p.get_position(), UA_StatusCode_name(_result.status_));
+        if (_result.output_ != nullptr)
+            UA_Array_delete(_result.output_, _result.output_size_, &UA_TYPES[UA_TYPES_VARIANT]);
+        p.set_target_position(0);
+        invalidate_route(p);
+        return;
+    }
+    if (receive_robot_task_called(_result.output_size_, _result.output_, p)) {
+        reset_plate(p);
+        occupied_plates_.erase(_plate_id);
+        UA_UInt32 occupied_plates_count = occupied_plates_.size();
+        conveyor_type_inserter_.set_scalar_attribute(occupied_plates_handle_, &occupied_plates_count, UA_TYPES_UINT32);
+    } else {
+        p.set_target_position(0);
+        invalidate_route(p);
+    }
 }
 
 UA_StatusCode
@@ -642,11 +866,11 @@ conveyor::receive_robot_task_called(size_t _output_size, UA_Variant* _output, pl
 void
 conveyor::position_swapped_callback(position_t _old_position, position_t _new_position) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    io_context_.post([this, _old_position, _new_position] {
+    io_context_.post(kitchen_clock::tracked([this, _old_position, _new_position] {
         remove_stopped_robots();
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "REARRANGING(Conveyor): Reflecting position swap/switch from %d to %d", _old_position, _new_position);
-        remote_robot* first = nullptr;
-        remote_robot* second = nullptr;
+        conveyor_remote_robot* first = nullptr;
+        conveyor_remote_robot* second = nullptr;
         if (position_remote_robot_map_.find(_old_position) != position_remote_robot_map_.end()) {
             first = position_remote_robot_map_[_old_position].get();
         }
@@ -663,7 +887,17 @@ conveyor::position_swapped_callback(position_t _old_position, position_t _new_po
         if (position_remote_robot_map_[_new_position] == nullptr) {
             position_remote_robot_map_.erase(_new_position);
         }
-    });
+        /* Routes planned over the swapped positions name robots that are not there anymore */
+        for (plate_id_t plate_id : occupied_plates_) {
+            plate& p = plates_[plate_id];
+            for (const route_hop& hop : p.get_planned_route()) {
+                if (hop.position_ == _old_position || hop.position_ == _new_position) {
+                    invalidate_route(p);
+                    break;
+                }
+            }
+        }
+    }));
 }
 
 void
@@ -688,6 +922,8 @@ conveyor::reset_plate(plate& _plate) {
     _plate.set_target_position(0);
     _plate.set_occupied(false);
     _plate.set_dish_finished(false);
+    _plate.set_planned_route({});
+    _plate.set_route_invalidated(false);
 }
 
 void
@@ -725,6 +961,19 @@ conveyor::start() {
     /* Set type member variable */
     UA_String_init(&type_);
     type_ = UA_STRING_ALLOC(const_cast<char*>(CONVEYOR_TYPE));
+    /* Prepare the choose next robot call with the constant endpoint and type arguments */
+    {
+        std::lock_guard<std::mutex> lock(client_mutex_);
+        recipe_id_t recipe_id = 0;
+        UA_UInt32 processed_steps = 0;
+        position_t plate_position = 0;
+        choose_next_robot_call_.set_method(method_id_map_[CHOOSE_NEXT_ROBOT].object_id_, method_id_map_[CHOOSE_NEXT_ROBOT].method_id_);
+        choose_next_robot_call_.add_scalar_input_argument(&recipe_id, UA_TYPES_UINT32);
+        choose_next_robot_call_.add_scalar_input_argument(&processed_steps, UA_TYPES_UINT32);
+        choose_next_robot_call_.add_scalar_input_argument(&server_endpoint_, UA_TYPES_STRING);
+        choose_next_robot_call_.add_scalar_input_argument(&type_, UA_TYPES_STRING);
+        choose_next_robot_call_.add_scalar_input_argument(&plate_position, UA_TYPES_UINT32);
+    }
     /* Run the client iterate thread */
     try {
         client_iterate_thread_ = std::thread([this]() {
@@ -743,12 +992,12 @@ conveyor::start() {
                         std::string controller_endpoint;
                         if (discover_and_connect(controller_client_, discovery_util_, controller_endpoint, CONTROLLER_TYPE) == UA_STATUSCODE_GOOD) {
                             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Re-established connection to controller", __FUNCTION__);
-                            io_context_.post([this] {
+                            io_context_.post(kitchen_clock::tracked([this] {
                                 if (state_status_ == conveyor::state::MOVING && !next_robot_request_queue_.empty()) {
                                     std::queue<position_t>().swap(next_robot_request_queue_);
                                     determine_next_movement();
                                 }
-                            });
+                            }));
                         }
                     }
                     /* Handle kitchen client iterate */
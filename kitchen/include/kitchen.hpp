@@ -28,6 +28,8 @@
 #include <memory>
 #include <random>
 #include <functional>
+#include <queue>
+#include <vector>
 #include <unistd.h>
 #include <boost/asio.hpp>
 #include <boost/unordered_set.hpp>
@@ -35,6 +37,7 @@
 
 #include "object_type_node_inserter.hpp"
 #include "client_connection_establisher.hpp"
+#include "client_reactor.hpp"
 #include "node_browser_helper.hpp"
 #include "discovery_util.hpp"
 #include "browsenames.h"
@@ -44,22 +47,23 @@
 #include "recipe_parser.hpp"
 #include "robot_state.hpp"
 #include "information_node_reader.hpp"
+#include "kitchen_clock.hpp"
+#include "route_plan.hpp"
 
 using namespace cps_kitchen;
 
 typedef std::function<void(position_t, position_t)> position_swapped_callback_t; /**< the callback declaration to notify about position change. */
 
-struct remote_robot {
+struct kitchen_remote_robot {
     private:
         UA_Client* client_; /**< the OPC UA remote robot client pointer. */
         std::string endpoint_; /**< the remote robot's endpoint address. */
         std::atomic<position_t> cached_position_; /**< the remote robot's position on the conveyor belt. */
         std::atomic<bool> running_; /**< flag to indicate whether the client thread should run. */
+        std::atomic<UA_Boolean> available_; /**< the remote robot's availability served from the subscription. */
         object_type_node_inserter& remote_robot_type_inserter_; /**< the remote robot type inserter for adding the remote robot's attributes to the address space. */
         position_swapped_callback_t position_swapped_callback_; /**< the callback to notify about position change. */
         std::unique_ptr<node_value_subscriber> nv_subscriber_; /**< the node value subscriber. */
-        std::thread client_iterate_thread_; /**< the client iteration thread. */
-        std::mutex client_mutex_; /**< the mutex to synchronize client method calls. */
         std::unordered_map<std::string, object_method_info> method_id_map_; /**< the map holding the ids of remote robot methods. */
         std::unordered_map<std::string, UA_NodeId> attribute_id_map_; /**< the map holding the ids of remote robot attributes. */
         bool initial_subscription_; /**< flag to indicate initial subscription notification. */
@@ -89,9 +93,9 @@ struct remote_robot {
          * @param _remote_robot_type_inserter the remote robot type inserter.
          * @param _position_swapped_callback the position swapped callback.
          */
-        remote_robot(std::string _endpoint, UA_UInt32 _position, object_type_node_inserter& _remote_robot_type_inserter,
+        kitchen_remote_robot(std::string _endpoint, UA_UInt32 _position, object_type_node_inserter& _remote_robot_type_inserter,
                     position_swapped_callback_t _position_swapped_callback) :
-                    client_(nullptr), endpoint_(_endpoint), cached_position_(_position), running_(true),
+                    client_(nullptr), endpoint_(_endpoint), cached_position_(_position), running_(true), available_(false),
                     remote_robot_type_inserter_(_remote_robot_type_inserter),
                     position_swapped_callback_(_position_swapped_callback), initial_subscription_(true) {
         }
@@ -106,62 +110,34 @@ struct remote_robot {
             if (client_ != nullptr) {
                 return running_.load() ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BAD;
             }
-            client_connection_establisher robot_client_connection_establisher;
-            bool connected = robot_client_connection_establisher.establish_connection(client_, endpoint_);
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+            bool connected = client_reactor::get_instance()->connect(client_, endpoint_, [this] {
+                running_.store(false);
+            });
             if (!connected) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error establishing robot client session", __FUNCTION__);
                 return UA_STATUSCODE_BAD;
             }
-            /* Get the position attribute id. */
-            attribute_id_map_[POSITION] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, POSITION);
-            if (UA_NodeId_equal(&attribute_id_map_[POSITION], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, POSITION);
-                return UA_STATUSCODE_BAD;
-            }
-            /* Get the availablility attribute id. */
-            attribute_id_map_[AVAILABILITY] = node_browser_helper().get_attribute_id(client_, ROBOT_TYPE, AVAILABILITY);
-            if (UA_NodeId_equal(&attribute_id_map_[AVAILABILITY], &UA_NODEID_NULL)) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s attribute id", __FUNCTION__, AVAILABILITY);
+            /* Get the attribute and method ids. */
+            UA_StatusCode status = node_browser_helper().resolve_ids(client_, ROBOT_TYPE, {POSITION, AVAILABILITY},
+                {RECEIVE_TASK}, attribute_id_map_, method_id_map_);
+            if (status != UA_STATUSCODE_GOOD) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not resolve the remote robot's node ids", __FUNCTION__);
                 return UA_STATUSCODE_BAD;
             }
-            /* Subscribe to position changes. */
+            /* Subscribe to position and availability changes. */
             nv_subscriber_ = std::make_unique<node_value_subscriber>(client_);
-            UA_StatusCode status = nv_subscriber_->subscribe_node_value(attribute_id_map_[POSITION], position_changed, this);
+            status = nv_subscriber_->subscribe_node_values({
+                {attribute_id_map_[POSITION], position_changed, this},
+                {attribute_id_map_[AVAILABILITY], availability_changed, this}
+            });
             if (status != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s", __FUNCTION__, POSITION);
-                return UA_STATUSCODE_BAD;
-            }
-            /* Get receive task method id. */
-            if ((method_id_map_[RECEIVE_TASK] = node_browser_helper().get_method_id(client_, ROBOT_TYPE, RECEIVE_TASK)) == OBJECT_METHOD_INFO_NULL) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, RECEIVE_TASK);
-                return UA_STATUSCODE_BAD;
-            }
-            try {
-                client_iterate_thread_ = std::thread([this]() {
-                    while(running_.load()) {
-                        {
-                            std::lock_guard<std::mutex> lock(client_mutex_);
-                            UA_StatusCode status = UA_Client_run_iterate(client_, 1);
-                            if (status != UA_STATUSCODE_GOOD) {
-                                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running robot client at position %d (%s)", __FUNCTION__, cached_position_.load(), UA_StatusCode_name(status));
-                                running_.store(false);
-                                return UA_STATUSCODE_BAD;
-                            }
-                        }
-                        if (usleep(1*1000)) {
-                            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error at robot client iterate sleep", __FUNCTION__);
-                            running_.store(false);
-                            return UA_STATUSCODE_BAD;
-                        }
-                        // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Starting the next client iterate", __FUNCTION__);
-                    }
-                    return UA_STATUSCODE_BAD;
-                });
-            } catch (...) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running the robot client iterate thread at position %d", __FUNCTION__, cached_position_.load());
-                running_.store(false);
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to remote robot's %s and %s (%s)", __FUNCTION__, POSITION, AVAILABILITY, UA_StatusCode_name(status));
                 return UA_STATUSCODE_BAD;
             }
+            /* Without heartbeat position and availability are read synchronously. */
+            if (nv_subscriber_->subscribe_heartbeat() != UA_STATUSCODE_GOOD)
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error subscribing to the remote robot's heartbeat", __FUNCTION__);
             return UA_STATUSCODE_GOOD;
         }
 
@@ -171,23 +147,25 @@ struct remote_robot {
          * @param _recipe_id the recipe ID of the dish.
          * @param _processed_steps the processed steps of the recipe ID so far.
          * @param _addressed_position the addressed position.
+         * @param _remaining_route the planned robots after this robot, empty if the next robot is chosen on handover.
          * @param _output_size the count of returned output values.
          * @param _output the variant containing the output values.
          * 
          * @return UA_StatusCode the status whether the method call was successful.
          */
         UA_StatusCode
-        instruct(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _addressed_position, size_t* _output_size, UA_Variant** _output) {
+        instruct(recipe_id_t _recipe_id, UA_UInt32 _processed_steps, position_t _addressed_position, const route_plan& _remaining_route, size_t* _output_size, UA_Variant** _output) {
             // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "remote robot %s called on port", __FUNCTION__, port_);
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "INSTRUCTIONS: Instruct robot on position %d to cook recipe %d from step %d", cached_position_.load(), _recipe_id, _processed_steps);
             method_node_caller receive_robot_task_caller;
             receive_robot_task_caller.add_scalar_input_argument(&_recipe_id, UA_TYPES_UINT32);
             receive_robot_task_caller.add_scalar_input_argument(&_processed_steps, UA_TYPES_UINT32);
             receive_robot_task_caller.add_scalar_input_argument(&_addressed_position, UA_TYPES_UINT32);
+            add_route_input_arguments(receive_robot_task_caller, _remaining_route);
             object_method_info omi = method_id_map_[RECEIVE_TASK];
             UA_StatusCode status = UA_STATUSCODE_GOOD;
             {
-                std::lock_guard<std::mutex> lock(client_mutex_);
+                client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
                 status = receive_robot_task_caller.call_method_node(client_, omi.object_id_, omi.method_id_, _output_size, _output);
                 if(status != UA_STATUSCODE_GOOD) {
                     UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling instruct method (%s)", __FUNCTION__, UA_StatusCode_name(status));
@@ -209,13 +187,16 @@ struct remote_robot {
         }
 
         /**
-         * @brief Returns the remote robot's position.
+         * @brief Returns the remote robot's position, served from the subscription while it is fresh.
          * 
          * @return position_t the remote robot position.
          */
         position_t
         get_position() {
-            std::lock_guard<std::mutex> lock(client_mutex_);
+            if (nv_subscriber_ != nullptr && nv_subscriber_->is_fresh())
+                return cached_position_.load();
+            /* The cached position is left to the subscription, which reports swaps relative to it. */
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
             information_node_reader inr;
             if (inr.read_information_node(client_, attribute_id_map_[POSITION]) != UA_STATUSCODE_GOOD) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not read the %s attribute id", __FUNCTION__, POSITION);
@@ -225,16 +206,25 @@ struct remote_robot {
             return *(position_t*)inr.get_variant()->data;
         }
 
+        /**
+         * @brief Returns whether the remote robot is available, served from the subscription while it is fresh.
+         * 
+         * @return true if the remote robot is available.
+         * @return false if the remote robot is not available.
+         */
         bool
         is_available() {
-            std::lock_guard<std::mutex> lock(client_mutex_);
+            if (nv_subscriber_ != nullptr && nv_subscriber_->is_fresh())
+                return available_.load();
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
             information_node_reader inr;
             if (inr.read_information_node(client_, attribute_id_map_[AVAILABILITY]) != UA_STATUSCODE_GOOD) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not read the %s attribute id", __FUNCTION__, AVAILABILITY);
                 running_.store(false);
                 return false;
             }
-            return *(UA_Boolean*)inr.get_variant()->data;
+            available_.store(*(UA_Boolean*)inr.get_variant()->data);
+            return available_.load();
         }
 
         /**
@@ -254,7 +244,7 @@ struct remote_robot {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Monitor context is NULL", __FUNCTION__);
                 return;
             }
-            remote_robot* self = static_cast<remote_robot*>(_mon_context);
+            kitchen_remote_robot* self = static_cast<kitchen_remote_robot*>(_mon_context);
             if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_UINT32])) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
                 self->running_.store(false);
@@ -270,6 +260,32 @@ struct remote_robot {
             // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Remote robot's position updated/changed to %d ", __FUNCTION__, self->cached_position_);
         }
 
+        /**
+         * @brief The availability changed callback for the subscription.
+         *
+         * @param _client the client issuing the subscription.
+         * @param _sub_id server-assigned subscription id that delivered this notification.
+         * @param _sub_context user-defined context data passed when creating the subscription.
+         * @param _mon_id server-assigned MonitoredItemId that produced the data change.
+         * @param _mon_context user-defined context data passed when creating the monitored item.
+         * @param _value the reported UA_DataValue.
+         */
+        static void
+        availability_changed(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context,
+            UA_UInt32 _mon_id, void* _mon_context, UA_DataValue* _value) {
+            if(_mon_context == NULL) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Monitor context is NULL", __FUNCTION__);
+                return;
+            }
+            kitchen_remote_robot* self = static_cast<kitchen_remote_robot*>(_mon_context);
+            if (!UA_Variant_hasScalarType(&_value->value, &UA_TYPES[UA_TYPES_BOOLEAN])) {
+                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
+                self->running_.store(false);
+                return;
+            }
+            self->available_.store(*(UA_Boolean*)_value->value.data);
+        }
+
         /**
          * @brief Helper method for self defined remote robot instance names according to their position.
          * 
@@ -295,12 +311,11 @@ struct remote_robot {
          * @brief Destroys the remote robot object.
          * 
          */
-        ~remote_robot() {
+        ~kitchen_remote_robot() {
             running_.store(false);
-            if (client_iterate_thread_.joinable())
-                client_iterate_thread_.join();
+            client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
             nv_subscriber_.reset();
-            UA_Client_delete(client_);
+            client_reactor::get_instance()->delete_client(client_);
         }
 };
 
@@ -312,21 +327,29 @@ private:
     UA_String server_endpoint_; /**< the kitchen's endpoint address. */
     UA_String type_; /**< the kitchen's agent type. */
     object_type_node_inserter kitchen_type_inserter_; /**< the kitchen type inserter for adding the kitchen's attributes and methods to the address space. */
+    std::atomic<UA_UInt32> received_orders_; /**< the number of received orders, served through the received orders data source. */
+    std::atomic<UA_UInt32> assigned_orders_; /**< the number of assigned orders, served through the assigned orders data source. */
+    std::atomic<UA_UInt32> dropped_orders_; /**< the number of dropped orders, served through the dropped orders data source. */
+    std::atomic<UA_UInt32> completed_orders_; /**< the number of completed orders, served through the completed orders data source. */
     std::atomic<bool> running_; /**< flag to indicate whether the server and client threads should run. */
     discovery_util discovery_util_; /**< the discovery utility. */
     std::unordered_map<std::string, object_method_info> method_id_map_; /**< the map holding the node ids of client methods. */
+    prepared_method_call choose_next_robot_call_; /**< the prepared choose next robot call, guarded by the client mutex. */
     std::thread server_iterate_thread_; /**< the server iteration thread. */
     std::mutex client_mutex_; /**< the mutex to synchronize client method calls. */
     std::thread client_iterate_thread_; /**< the client iteration thread. */
     std::thread worker_thread_; /**< the worker thread for assigning placed orders to remote robots. */
     boost::asio::io_context io_context_; /**< the io context managing the worker thread. */
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type, void, void> work_guard_; /**< the work guard for the io_context_. */
-    boost::asio::steady_timer placing_timer_; /**< the placing timer. */
+    kitchen_timer placing_timer_; /**< the placing timer. */
     bool placing_gate_open_; /**< the placing gate. */
     std::queue<std::function<void()>> placing_queue_ /**< the placing queue. */;
+    bool batch_orders_; /**< flag to indicate whether queued orders are assigned jointly in batches. */
+    bool plan_routes_; /**< flag to indicate whether the whole route of an order is planned when it is placed. */
+    std::vector<recipe_id_t> batched_orders_; /**< the recipe ids of the orders waiting for the next batch. */
     /* remote robot related member variables. */
     std::thread cyclic_remote_robot_discovery_thread_; /**< the thread updating the connectivity status of remote robots in the address space. */
-    std::unordered_map<position_t, std::unique_ptr<remote_robot>> position_remote_robot_map_; /**< the map holding the remote robot instances. */
+    std::unordered_map<position_t, std::unique_ptr<kitchen_remote_robot>> position_remote_robot_map_; /**< the map holding the remote robot instances. */
     object_type_node_inserter remote_robot_type_inserter_; /**< the remote robot type inserter for adding the robot's attributes to the address space. */
     uint32_t robot_count_; /**< the total robot count in the kitchen. */
     /* controller related member variables. */
@@ -405,6 +428,35 @@ private:
     void
     handle_random_order_request();
 
+    /**
+     * @brief Calls the controller under the client mutex, waiting for reconnects until the call succeeds or the kitchen stops.
+     * 
+     * @param _call the call on the connected controller client.
+     * @param _output_size the count of returned output values.
+     * @param _output the variant containing the output values.
+     * @return true if the call succeeded.
+     * @return false if the kitchen stopped before.
+     */
+    bool
+    call_controller(const std::function<UA_StatusCode(UA_Client*, size_t*, UA_Variant**)>& _call, size_t* _output_size, UA_Variant** _output);
+
+    /**
+     * @brief Places the next batch of queued orders, which the controller assigns jointly, and instructs the returned robots.
+     * 
+     */
+    void
+    place_order_batch();
+
+    /**
+     * @brief Extracts the returned robots of a batch and instructs them.
+     * 
+     * @param _output_size the count of returned output values.
+     * @param _output the variant containing the output values.
+     * @param _recipe_ids the recipe ids of the batch in request order.
+     */
+    void
+    choose_next_robots_called(size_t _output_size, UA_Variant* _output, const std::vector<recipe_id_t>& _recipe_ids);
+
     /**
      * @brief Extracts the returned remote robot parameters.
      * 
@@ -416,6 +468,16 @@ private:
     bool
     choose_next_robot_called(size_t _output_size, UA_Variant *_output);
 
+    /**
+     * @brief Plans the whole route of a new order with the controller and instructs the first robot of the route.
+     * 
+     * @param _recipe_id the recipe id of the order.
+     * @return true if the first robot was instructed or the order was dropped.
+     * @return false if the controller couldn't plan a route and the next robot has to be chosen instead.
+     */
+    bool
+    place_order_with_route(recipe_id_t _recipe_id);
+
     /**
      * @brief Receives the next suitable robot for a requested recipe.
      * 
@@ -446,9 +508,10 @@ private:
      * @param _robot_position the robot position.
      * @param _robot_endpoint the robot endpoint.
      * @param _recipe_id the recipe id.
+     * @param _remaining_route the planned robots after the next robot, empty if the next robot is chosen on handover.
      */
     void
-    handle_receive_next_robot(position_t _robot_position, std::string _robot_endpoint, recipe_id_t _recipe_id);
+    handle_receive_next_robot(position_t _robot_position, std::string _robot_endpoint, recipe_id_t _recipe_id, const route_plan& _remaining_route = {});
 
     /**
      * @brief Extracts the returned robot state parameters.
@@ -470,15 +533,6 @@ private:
     void
     position_swapped_callback(position_t _old_position, position_t _new_position);
 
-    /**
-     * @brief Helper method for incrementing X_ORDERS attribute nodes.
-     * 
-     * @param _attribute_name the attribute name.
-     * @return UA_StatusCode the status code indicating whether incrementing succeeded.
-     */
-    UA_StatusCode
-    increment_orders_counter(std::string _attribute_name);
-
     /**
      * @brief Removes all stopped robots from the kitchen.
      * 
@@ -498,8 +552,10 @@ public:
      * @brief Constructs a new kitchen object
      * 
      * @param _robot_count the total robot count in the kitchen.
+     * @param _batch_orders flag to indicate whether queued orders are assigned jointly in batches.
+     * @param _plan_routes flag to indicate whether the whole route of an order is planned when it is placed.
      */
-    kitchen(uint32_t _robot_count);
+    kitchen(uint32_t _robot_count, bool _batch_orders = false, bool _plan_routes = false);
 
     /**
      * @brief Destroys the kitchen object.
@@ -7,17 +7,20 @@
 #include "filtered_logger.hpp"
 #include "discovery_and_connection.hpp"
 #include "time_unit.hpp"
+#include "agent_timings.hpp"
 
 #define INSTANCE_NAME "CpsKitchen"
 #define REMOTE_CONTROLLER_INSTANCE_NAME "RemoteKitchenController"
 #define REMOTE_CONVEYOR_INSTANCE_NAME "RemoteKitchenConveyor"
-#define PlACING_RATE 5LL
+#define ORDER_BATCH_SIZE 16
 #define REDISCOVER_INTERVAL 1LL
+#define CHOOSE_NEXT_ROBOT_RECIPE_ID_ARGUMENT 0
+#define CHOOSE_NEXT_ROBOT_PROCESSED_STEPS_ARGUMENT 1
 
-kitchen::kitchen(uint32_t _robot_count) : server_(UA_Server_new()), kitchen_uri_("urn:kitchen:env"), kitchen_type_inserter_(server_, KITCHEN_TYPE), running_(true), remote_robot_type_inserter_(server_, REMOTE_ROBOT_TYPE),
+kitchen::kitchen(uint32_t _robot_count, bool _batch_orders, bool _plan_routes) : server_(UA_Server_new()), kitchen_uri_("urn:kitchen:env"), kitchen_type_inserter_(server_, KITCHEN_TYPE), received_orders_(0), assigned_orders_(0), dropped_orders_(0), completed_orders_(0), running_(true), remote_robot_type_inserter_(server_, REMOTE_ROBOT_TYPE),
                                         robot_count_(_robot_count), remote_controller_type_inserter_(server_, REMOTE_CONTROLLER_TYPE), remote_conveyor_type_inserter_(server_, REMOTE_CONVEYOR_TYPE), recipe_parser_(),
                                         mersenne_twister_(random_device_()), uniform_int_distribution_(1,recipe_parser_.get_recipe_count()), controller_client_(nullptr), conveyor_client_(nullptr),
-                                        work_guard_(boost::asio::make_work_guard(io_context_)), placing_timer_(io_context_), placing_gate_open_(true) {
+                                        work_guard_(boost::asio::make_work_guard(io_context_)), placing_timer_(io_context_), placing_gate_open_(true), batch_orders_(_batch_orders), plan_routes_(_plan_routes) {
     /* Setup kitchen environment */
     UA_StatusCode status = UA_STATUSCODE_GOOD;
     UA_ServerConfig* server_config = UA_Server_getConfig(server_);
@@ -67,11 +70,16 @@ kitchen::kitchen(uint32_t _robot_count) : server_(UA_Server_new()), kitchen_uri_
     kitchen_type_inserter_.add_object_type_constructor(server_, kitchen_type_inserter_.get_object_type_id(KITCHEN_TYPE));
     /* Instantiate kitchen type */
     kitchen_type_inserter_.add_object_instance(INSTANCE_NAME, KITCHEN_TYPE);
-    UA_UInt32 initial_orders_count = 0;
-    kitchen_type_inserter_.set_scalar_attribute(INSTANCE_NAME, ASSIGNED_ORDERS, &initial_orders_count, UA_TYPES_UINT32);
-    kitchen_type_inserter_.set_scalar_attribute(INSTANCE_NAME, DROPPED_ORDERS, &initial_orders_count, UA_TYPES_UINT32);
-    kitchen_type_inserter_.set_scalar_attribute(INSTANCE_NAME, RECEIVED_ORDERS, &initial_orders_count, UA_TYPES_UINT32);
-    kitchen_type_inserter_.set_scalar_attribute(INSTANCE_NAME, COMPLETED_ORDERS, &initial_orders_count, UA_TYPES_UINT32);
+    /* Bind the order counters to their data sources */
+    status = kitchen_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, ASSIGNED_ORDERS, assigned_orders_, UA_TYPES_UINT32);
+    status |= kitchen_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, DROPPED_ORDERS, dropped_orders_, UA_TYPES_UINT32);
+    status |= kitchen_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, RECEIVED_ORDERS, received_orders_, UA_TYPES_UINT32);
+    status |= kitchen_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, COMPLETED_ORDERS, completed_orders_, UA_TYPES_UINT32);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error binding the order counters", __FUNCTION__);
+        running_.store(false);
+        return;
+    }
     /* Add the remote controller type */
     UA_Boolean initial_connectivity_state = false;
     remote_controller_type_inserter_.add_attribute(REMOTE_CONTROLLER_TYPE, CONNECTIVITY);
@@ -84,16 +92,16 @@ kitchen::kitchen(uint32_t _robot_count) : server_(UA_Server_new()), kitchen_uri_
     remote_conveyor_type_inserter_.add_object_instance(REMOTE_CONVEYOR_INSTANCE_NAME, REMOTE_CONVEYOR_TYPE, kitchen_type_inserter_.get_instance_id(INSTANCE_NAME), UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT));
     remote_conveyor_type_inserter_.set_scalar_attribute(REMOTE_CONVEYOR_INSTANCE_NAME, CONNECTIVITY, &initial_connectivity_state, UA_TYPES_BOOLEAN);
     /* Add remote robot type constructor */
-    if (remote_robot::setup_remote_robot_object_type(remote_robot_type_inserter_, server_) != UA_STATUSCODE_GOOD) {
+    if (kitchen_remote_robot::setup_remote_robot_object_type(remote_robot_type_inserter_, server_) != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error adding the remote robot type constructor", __FUNCTION__);
         stop();
         return;
     }
     /* Add remote robot instances to the address space */
     for (position_t position = 1; position <= robot_count_; position++) {
-        status = remote_robot_type_inserter_.add_object_instance(remote_robot::remote_robot_instance_name(position).c_str(), REMOTE_ROBOT_TYPE, kitchen_type_inserter_.get_instance_id(INSTANCE_NAME), UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT));
-        status |= remote_robot_type_inserter_.set_scalar_attribute(remote_robot::remote_robot_instance_name(position), POSITION, &position, UA_TYPES_UINT32);
-        status |= remote_robot_type_inserter_.set_scalar_attribute(remote_robot::remote_robot_instance_name(position), CONNECTIVITY, &initial_connectivity_state, UA_TYPES_BOOLEAN);
+        status = remote_robot_type_inserter_.add_object_instance(kitchen_remote_robot::remote_robot_instance_name(position).c_str(), REMOTE_ROBOT_TYPE, kitchen_type_inserter_.get_instance_id(INSTANCE_NAME), UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT));
+        status |= remote_robot_type_inserter_.set_scalar_attribute(kitchen_remote_robot::remote_robot_instance_name(position), POSITION, &position, UA_TYPES_UINT32);
+        status |= remote_robot_type_inserter_.set_scalar_attribute(kitchen_remote_robot::remote_robot_instance_name(position), CONNECTIVITY, &initial_connectivity_state, UA_TYPES_BOOLEAN);
         if (status != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error adding remote robot object and setting initial attributes (%s)", __FUNCTION__, UA_StatusCode_name(status));
             stop();
@@ -143,6 +151,16 @@ kitchen::kitchen(uint32_t _robot_count) : server_(UA_Server_new()), kitchen_uri_
         stop();
         return;        
     }
+    if (batch_orders_ && (method_id_map_[CHOOSE_NEXT_ROBOTS] = node_browser_helper().get_method_id(controller_endpoint, CONTROLLER_TYPE, CHOOSE_NEXT_ROBOTS)) == OBJECT_METHOD_INFO_NULL) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, CHOOSE_NEXT_ROBOTS);
+        stop();
+        return;
+    }
+    if (plan_routes_ && (method_id_map_[PLAN_ROUTE] = node_browser_helper().get_method_id(controller_endpoint, CONTROLLER_TYPE, PLAN_ROUTE)) == OBJECT_METHOD_INFO_NULL) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s method id", __FUNCTION__, PLAN_ROUTE);
+        stop();
+        return;
+    }
     /* Setup conveyor client */
     std::string conveyor_endpoint;
     while((status = discover_and_connect(conveyor_client_, discovery_util_, conveyor_endpoint, CONVEYOR_TYPE)) != UA_STATUSCODE_GOOD) {
@@ -163,8 +181,8 @@ kitchen::~kitchen() {
     join_threads();
 
     /* Destroy remote robot instances BEFORE deleting the UA server
-    to avoid remote_robot::~remote_robot() touching a freed UA_Server */
-    position_remote_robot_map_.clear(); // remote_robot dtors run here
+    to avoid kitchen_remote_robot::~kitchen_remote_robot() touching a freed UA_Server */
+    position_remote_robot_map_.clear(); // kitchen_remote_robot dtors run here
 
     {
         std::lock_guard<std::mutex> lock(client_mutex_);
@@ -203,9 +221,7 @@ kitchen::receive_completed_order(UA_Server* _server,
         return UA_STATUSCODE_BAD;
     }
     kitchen* self = static_cast<kitchen*>(_method_context);
-    self->io_context_.post([self] {
-        self->increment_orders_counter(COMPLETED_ORDERS);
-    });
+    self->completed_orders_++;
     UA_Boolean result = true;
     UA_Variant_setScalarCopy(_output, &result, &UA_TYPES[UA_TYPES_BOOLEAN]);
     return UA_STATUSCODE_GOOD;
@@ -228,59 +244,77 @@ kitchen::place_random_order(UA_Server* _server,
         return UA_STATUSCODE_BAD;
     }
     kitchen* self = static_cast<kitchen*>(_method_context);
-    self->io_context_.post([self] {
+    self->io_context_.post(kitchen_clock::tracked([self] {
         self->handle_random_order_request();
-    });
+    }));
     UA_Boolean result = true;
     UA_Variant_setScalarCopy(_output, &result, &UA_TYPES[UA_TYPES_BOOLEAN]);
     return UA_STATUSCODE_GOOD;
 }
 
+bool
+kitchen::call_controller(const std::function<UA_StatusCode(UA_Client*, size_t*, UA_Variant**)>& _call, size_t* _output_size, UA_Variant** _output) {
+    std::unique_lock<std::mutex> lock(client_mutex_);
+    UA_StatusCode status = UA_STATUSCODE_UNCERTAIN;
+    while (status != UA_STATUSCODE_GOOD) {
+        if (controller_client_ != nullptr)
+            status = _call(controller_client_, _output_size, _output);
+        if (running_.load() && status != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling the controller (%s)", __FUNCTION__, UA_StatusCode_name(status));
+            if (*_output != nullptr ) {
+                UA_Array_delete(*_output, *_output_size, &UA_TYPES[UA_TYPES_VARIANT]);
+                *_output = nullptr;
+                *_output_size = 0;
+            }
+            UA_Client_delete(controller_client_);
+            controller_client_ = nullptr;
+            remote_controller_connected_cv_.wait(lock, [this] {
+                return !running_.load() || controller_client_ != nullptr;
+            });
+        }
+        if (!running_.load()) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed to call the controller", __FUNCTION__);
+            if (*_output != nullptr ) {
+                UA_Array_delete(*_output, *_output_size, &UA_TYPES[UA_TYPES_VARIANT]);
+                *_output = nullptr;
+                *_output_size = 0;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
 void
 kitchen::handle_random_order_request() {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
     remove_stopped_robots();
+    if (batch_orders_) {
+        /* Orders arriving while the gate is closed are placed together with the next batch */
+        batched_orders_.push_back(uniform_int_distribution_(mersenne_twister_));
+        if (placing_gate_open_) {
+            placing_gate_open_ = false;
+            place_order_batch();
+            arm_placing_gate();
+        }
+        return;
+    }
     auto do_place = [this] {
-        increment_orders_counter(RECEIVED_ORDERS);
-        bool instructed = false;
+        received_orders_++;
         recipe_id_t recipe_id = uniform_int_distribution_(mersenne_twister_);
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RANDOM ORDER: Generated recipe with the ID %d", recipe_id);
-        object_method_info omi = method_id_map_[CHOOSE_NEXT_ROBOT];
+        if (plan_routes_ && place_order_with_route(recipe_id))
+            return;
         UA_Variant* output = nullptr;
         size_t output_size = 0;
-        {
-            std::unique_lock<std::mutex> lock(client_mutex_);
-            method_node_caller choose_next_robot_caller;
+        bool called = call_controller([this, recipe_id](UA_Client* _client, size_t* _output_size, UA_Variant** _output) {
             UA_UInt32 processed_steps = 0;
-            choose_next_robot_caller.add_scalar_input_argument(&recipe_id, UA_TYPES_UINT32);
-            choose_next_robot_caller.add_scalar_input_argument(&processed_steps, UA_TYPES_UINT32);
-            choose_next_robot_caller.add_scalar_input_argument(&server_endpoint_, UA_TYPES_STRING);
-            choose_next_robot_caller.add_scalar_input_argument(&type_, UA_TYPES_STRING);
-            UA_StatusCode status = UA_STATUSCODE_UNCERTAIN;
-            while (status != UA_STATUSCODE_GOOD) {
-                if (controller_client_ != nullptr)
-                    status = choose_next_robot_caller.call_method_node(controller_client_, omi.object_id_, omi.method_id_, &output_size, &output);
-                if (running_.load() && status != UA_STATUSCODE_GOOD) {
-                    UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error calling choose next robot (%s)", __FUNCTION__, UA_StatusCode_name(status));
-                    if (output != nullptr ) {
-                        UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
-                        output = nullptr;
-                        output_size = 0;
-                    }
-                    UA_Client_delete(controller_client_);
-                    controller_client_ = nullptr;
-                    remote_controller_connected_cv_.wait(lock, [this] {
-                        return !running_.load() || controller_client_ != nullptr;
-                    });
-                }
-                if (!running_.load()) {
-                    UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed to call choose next robot", __FUNCTION__);
-                    if (output != nullptr )
-                        UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
-                    return;
-                }
-            }
-        }
+            choose_next_robot_call_.set_scalar_input_argument(CHOOSE_NEXT_ROBOT_RECIPE_ID_ARGUMENT, &recipe_id);
+            choose_next_robot_call_.set_scalar_input_argument(CHOOSE_NEXT_ROBOT_PROCESSED_STEPS_ARGUMENT, &processed_steps);
+            return choose_next_robot_call_.call(_client, _output_size, _output);
+        }, &output_size, &output);
+        if (!called)
+            return;
         bool result = choose_next_robot_called(output_size, output);
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RANDOM ORDER: Controller returned %s for next robot request.", result ? "true" : "false");
     };
@@ -294,9 +328,33 @@ kitchen::handle_random_order_request() {
     }
 }
 
+void
+kitchen::place_order_batch() {
+    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    size_t order_count = std::min<size_t>(batched_orders_.size(), ORDER_BATCH_SIZE);
+    std::vector<recipe_id_t> recipe_ids(batched_orders_.begin(), batched_orders_.begin() + order_count);
+    batched_orders_.erase(batched_orders_.begin(), batched_orders_.begin() + order_count);
+    std::vector<UA_UInt32> processed_steps(order_count, 0);
+    received_orders_ += order_count;
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RANDOM ORDER: Placing a batch of %zu orders", order_count);
+    UA_Variant* output = nullptr;
+    size_t output_size = 0;
+    bool called = call_controller([this, &recipe_ids, &processed_steps](UA_Client* _client, size_t* _output_size, UA_Variant** _output) {
+        method_node_caller choose_next_robots_caller;
+        choose_next_robots_caller.add_array_input_argument(recipe_ids.data(), recipe_ids.size(), UA_TYPES_UINT32);
+        choose_next_robots_caller.add_array_input_argument(processed_steps.data(), processed_steps.size(), UA_TYPES_UINT32);
+        return choose_next_robots_caller.call_method_node(_client, method_id_map_[CHOOSE_NEXT_ROBOTS].object_id_, method_id_map_[CHOOSE_NEXT_ROBOTS].method_id_, _output_size, _output);
+    }, &output_size, &output);
+    if (!called) {
+        dropped_orders_ += order_count;
+        return;
+    }
+    choose_next_robots_called(output_size, output, recipe_ids);
+}
+
 void
 kitchen::arm_placing_gate() {
-    placing_timer_.expires_after(std::chrono::milliseconds(PlACING_RATE * TIME_UNIT));
+    placing_timer_.expires_after(std::chrono::milliseconds(KITCHEN_PLACING_RATE * TIME_UNIT));
     placing_timer_.async_wait([this](const boost::system::error_code& ec){
         if (ec) {
             // timer cancelled on shutdown; ignore
@@ -307,6 +365,9 @@ kitchen::arm_placing_gate() {
             placing_queue_.pop();
             task();
             arm_placing_gate();
+        } else if (!batched_orders_.empty()) {
+            place_order_batch();
+            arm_placing_gate();
         } else {
             placing_gate_open_ = true;
         }
@@ -336,6 +397,70 @@ kitchen::choose_next_robot_called(size_t _output_size, UA_Variant *_output) {
     return result;
 }
 
+void
+kitchen::choose_next_robots_called(size_t _output_size, UA_Variant* _output, const std::vector<recipe_id_t>& _recipe_ids) {
+    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
+    if(_output_size != 3
+       || !UA_Variant_hasArrayType(&_output[0], &UA_TYPES[UA_TYPES_UINT32])
+       || !UA_Variant_hasArrayType(&_output[1], &UA_TYPES[UA_TYPES_UINT32])
+       || !UA_Variant_hasArrayType(&_output[2], &UA_TYPES[UA_TYPES_STRING])
+       || _output[0].arrayLength != _recipe_ids.size()
+       || _output[1].arrayLength != _recipe_ids.size()
+       || _output[2].arrayLength != _recipe_ids.size()) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output", __FUNCTION__);
+        if (_output != nullptr)
+            UA_Array_delete(_output, _output_size, &UA_TYPES[UA_TYPES_VARIANT]);
+        dropped_orders_ += _recipe_ids.size();
+        return;
+    }
+    UA_UInt32* order_indices = (UA_UInt32*) _output[0].data;
+    position_t* robot_positions = (position_t*) _output[1].data;
+    UA_String* robot_endpoints = (UA_String*) _output[2].data;
+    /* Instruct in the returned sequence, which the joint assignment is based on */
+    for (size_t sequence = 0; sequence < _recipe_ids.size(); sequence++) {
+        if (order_indices[sequence] >= _recipe_ids.size()) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad order index %d", __FUNCTION__, order_indices[sequence]);
+            dropped_orders_++;
+            continue;
+        }
+        handle_receive_next_robot(robot_positions[sequence], std::string((char*) robot_endpoints[sequence].data, robot_endpoints[sequence].length), _recipe_ids[order_indices[sequence]]);
+    }
+    UA_Array_delete(_output, _output_size, &UA_TYPES[UA_TYPES_VARIANT]);
+}
+
+bool
+kitchen::place_order_with_route(recipe_id_t _recipe_id) {
+    UA_Variant* output = nullptr;
+    size_t output_size = 0;
+    bool called = call_controller([this, &_recipe_id](UA_Client* _client, size_t* _output_size, UA_Variant** _output) {
+        UA_UInt32 processed_steps = 0;
+        position_t plate_position = 0;
+        method_node_caller plan_route_caller;
+        plan_route_caller.add_scalar_input_argument(&_recipe_id, UA_TYPES_UINT32);
+        plan_route_caller.add_scalar_input_argument(&processed_steps, UA_TYPES_UINT32);
+        plan_route_caller.add_scalar_input_argument(&plate_position, UA_TYPES_UINT32);
+        return plan_route_caller.call_method_node(_client, method_id_map_[PLAN_ROUTE].object_id_, method_id_map_[PLAN_ROUTE].method_id_, _output_size, _output);
+    }, &output_size, &output);
+    if (!called)
+        return true;
+    route_plan route;
+    if (output_size != 2 || route_from_variants(output[0], output[1], route) != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad output argument type", __FUNCTION__);
+        route.clear();
+    }
+    if (output != nullptr)
+        UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
+    if (route.empty()) {
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "ROUTE: The controller couldn't plan a route for recipe id %d", _recipe_id);
+        return false;
+    }
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "ROUTE: The controller planned a route of %zu robots for recipe id %d", route.size(), _recipe_id);
+    route_hop first_hop = route.front();
+    route.erase(route.begin());
+    handle_receive_next_robot(first_hop.position_, first_hop.endpoint_, _recipe_id, route);
+    return true;
+}
+
 UA_StatusCode
 kitchen::receive_next_robot(UA_Server* _server,
             const UA_NodeId* _session_id, void* _session_context,
@@ -376,26 +501,26 @@ kitchen::receive_next_robot(UA_Server* _server,
     }
 
     std::string robot_endpoint_str((char*) robot_endpoint.data, robot_endpoint.length);
-    self->io_context_.post([self, robot_position, robot_endpoint_str, recipe_id] {
+    self->io_context_.post(kitchen_clock::tracked([self, robot_position, robot_endpoint_str, recipe_id] {
         self->handle_receive_next_robot(robot_position, robot_endpoint_str, recipe_id);
-    });
+    }));
     return UA_STATUSCODE_GOOD;
 }
 
 void
-kitchen::handle_receive_next_robot(position_t _robot_position, std::string _robot_endpoint, recipe_id_t _recipe_id) {
+kitchen::handle_receive_next_robot(position_t _robot_position, std::string _robot_endpoint, recipe_id_t _recipe_id, const route_plan& _remaining_route) {
     remove_stopped_robots();
     if (_robot_position == 0 || _robot_endpoint.empty()) {
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: The controller couldn't return a suitable robot. Dropping order with recipe id %d", _recipe_id);
-        increment_orders_counter(DROPPED_ORDERS);
+        dropped_orders_++;
         return;
     }
     if (position_remote_robot_map_.find(_robot_position) == position_remote_robot_map_.end() || _robot_endpoint.compare(position_remote_robot_map_[_robot_position]->get_endpoint())) {
         position_remote_robot_map_.erase(_robot_position);
-        std::unique_ptr<remote_robot> robot = std::make_unique<remote_robot>(_robot_endpoint, _robot_position, remote_robot_type_inserter_,
+        std::unique_ptr<kitchen_remote_robot> robot = std::make_unique<kitchen_remote_robot>(_robot_endpoint, _robot_position, remote_robot_type_inserter_,
                                                                             std::bind(&kitchen::position_swapped_callback, this, std::placeholders::_1, std::placeholders::_2));
         if (robot->initialize_and_start() != UA_STATUSCODE_GOOD) {
-            increment_orders_counter(DROPPED_ORDERS);
+            dropped_orders_++;
             return;
         }
         position_remote_robot_map_[_robot_position] = std::move(robot);
@@ -403,24 +528,24 @@ kitchen::handle_receive_next_robot(position_t _robot_position, std::string _robo
     size_t output_size = 0;
     UA_Variant* output = nullptr;
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: The controller returned the robot at position %d (%s) for recipe id %d", _robot_position, _robot_endpoint.c_str(), _recipe_id);
-    remote_robot* target_robot = position_remote_robot_map_[_robot_position].get();
+    kitchen_remote_robot* target_robot = position_remote_robot_map_[_robot_position].get();
     if (target_robot->get_position() != _robot_position || !target_robot->is_available()) {
-        increment_orders_counter(DROPPED_ORDERS);
+        dropped_orders_++;
         return;
     }
-    UA_StatusCode status = target_robot->instruct(_recipe_id, 0, _robot_position, &output_size, &output);
+    UA_StatusCode status = target_robot->instruct(_recipe_id, 0, _robot_position, _remaining_route, &output_size, &output);
     if (status != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: Failed calling %s method", RECEIVE_TASK);
         if (output != nullptr)
             UA_Array_delete(output, output_size, &UA_TYPES[UA_TYPES_VARIANT]);
-        increment_orders_counter(DROPPED_ORDERS);
+        dropped_orders_++;
         return;
     }
     if (receive_robot_task_called(output_size, output)) {
-        increment_orders_counter(ASSIGNED_ORDERS);
+        assigned_orders_++;
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: Assigned the next robot at position %d (%s) with recipe id %d", _robot_position, _robot_endpoint.c_str(), _recipe_id);
     } else {
-        increment_orders_counter(DROPPED_ORDERS);
+        dropped_orders_++;
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "NEXT ROBOT: Dropped order for the next robot at position %d (%s) with recipe id %d", _robot_position, _robot_endpoint.c_str(), _recipe_id);
     }
 }
@@ -460,10 +585,10 @@ kitchen::receive_robot_task_called(size_t _output_size, UA_Variant* _output) {
 void
 kitchen::position_swapped_callback(position_t _old_position, position_t _new_position) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    io_context_.post([this, _old_position, _new_position] {
+    io_context_.post(kitchen_clock::tracked([this, _old_position, _new_position] {
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "REARRANGING(Kitchen): Reflecting position swap/switch from %d to %d", _old_position, _new_position);
-        remote_robot* first = nullptr;
-        remote_robot* second = nullptr;
+        kitchen_remote_robot* first = nullptr;
+        kitchen_remote_robot* second = nullptr;
         if (position_remote_robot_map_.find(_old_position) != position_remote_robot_map_.end()) {
             first = position_remote_robot_map_[_old_position].get();
         }
@@ -479,36 +604,7 @@ kitchen::position_swapped_callback(position_t _old_position, position_t _new_pos
 
         if (position_remote_robot_map_[_new_position] == nullptr)
             position_remote_robot_map_.erase(_new_position);
-    });
-}
-
-UA_StatusCode
-kitchen::increment_orders_counter(std::string _attribute_name) {
-    // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    UA_StatusCode status = UA_STATUSCODE_GOOD;
-    UA_Variant value;
-    UA_Variant_init(&value);
-    if ((status = kitchen_type_inserter_.get_attribute(INSTANCE_NAME, _attribute_name.c_str(), value)) != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error getting attribute (%s)", __FUNCTION__, UA_StatusCode_name(status));
-        UA_Variant_clear(&value);
-        return status;
-    }
-    UA_UInt32 dishes_counter = 0;
-    if (UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT32]) && value.data) {
-        dishes_counter = *(UA_UInt32*) value.data;
-    } else {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Unexpected attribute type for %s", __FUNCTION__, _attribute_name.c_str());
-        UA_Variant_clear(&value);
-        return UA_STATUSCODE_BADTYPEMISMATCH;
-    }
-    dishes_counter++;
-    if ((status = kitchen_type_inserter_.set_scalar_attribute(INSTANCE_NAME, _attribute_name.c_str(), &dishes_counter, UA_TYPES_UINT32)) != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting attribute (%s)", __FUNCTION__, UA_StatusCode_name(status));
-        UA_Variant_clear(&value);
-        return status;
-    }
-    UA_Variant_clear(&value);
-    return status;
+    }));
 }
 
 void
@@ -562,6 +658,20 @@ kitchen::start() {
     /* Set type member variable */
     UA_String_init(&type_);
     type_ = UA_STRING_ALLOC(const_cast<char*>(KITCHEN_TYPE));
+    /* Prepare the choose next robot call with the constant endpoint, type and plate position arguments */
+    {
+        std::lock_guard<std::mutex> lock(client_mutex_);
+        recipe_id_t recipe_id = 0;
+        UA_UInt32 processed_steps = 0;
+        choose_next_robot_call_.set_method(method_id_map_[CHOOSE_NEXT_ROBOT].object_id_, method_id_map_[CHOOSE_NEXT_ROBOT].method_id_);
+        choose_next_robot_call_.add_scalar_input_argument(&recipe_id, UA_TYPES_UINT32);
+        choose_next_robot_call_.add_scalar_input_argument(&processed_steps, UA_TYPES_UINT32);
+        choose_next_robot_call_.add_scalar_input_argument(&server_endpoint_, UA_TYPES_STRING);
+        choose_next_robot_call_.add_scalar_input_argument(&type_, UA_TYPES_STRING);
+        /* New orders are placed on a plate at the input position */
+        position_t plate_position = 0;
+        choose_next_robot_call_.add_scalar_input_argument(&plate_position, UA_TYPES_UINT32);
+    }
     /* Run the client iterate thread */
     try {
         client_iterate_thread_ = std::thread([this]() {
@@ -663,14 +773,14 @@ kitchen::start() {
                             continue;
                         }
                         position_t remote_robot_position = *(position_t*)inr.get_variant()->data;
-                        remote_robot_type_inserter_.set_scalar_attribute(remote_robot::remote_robot_instance_name(remote_robot_position), CONNECTIVITY, &connectivity_state, UA_TYPES_BOOLEAN);
+                        remote_robot_type_inserter_.set_scalar_attribute(kitchen_remote_robot::remote_robot_instance_name(remote_robot_position), CONNECTIVITY, &connectivity_state, UA_TYPES_BOOLEAN);
                         offline_positions.erase(remote_robot_position);
                         UA_Client_delete(remote_robot_client);
                     }
                 }
                 connectivity_state = false;
                 for (position_t remote_robot_position : offline_positions) {
-                    remote_robot_type_inserter_.set_scalar_attribute(remote_robot::remote_robot_instance_name(remote_robot_position), CONNECTIVITY, &connectivity_state, UA_TYPES_BOOLEAN);
+                    remote_robot_type_inserter_.set_scalar_attribute(kitchen_remote_robot::remote_robot_instance_name(remote_robot_position), CONNECTIVITY, &connectivity_state, UA_TYPES_BOOLEAN);
                 }
                 std::this_thread::sleep_for(std::chrono::seconds(REDISCOVER_INTERVAL));
             }
@@ -0,0 +1,349 @@
+/**
+ * @file kitchen_clock.hpp
+ * @brief Pluggable clock for the simulated durations of the agents, running in real or virtual time.
+ *
+ * @details
+ * In real time the clock follows std::chrono::steady_clock. In virtual time the clock only advances while
+ * the agents are quiescent, i.e. no timer handler is due and no tracked handler or call is outstanding.
+ * It then jumps to the earliest pending timer deadline, so simulated durations take no wall-clock time
+ * while the agents still react to each event in the same order as in real time. Agents therefore have to
+ * post their handlers wrapped by kitchen_clock::tracked and hold a kitchen_clock::activity while a call to
+ * another agent is in flight. Data change notifications of subscriptions are not tracked, so decisions
+ * must not depend on their timing. Agents sharing a virtual clock must run in the same process.
+ */
+#ifndef KITCHEN_CLOCK_HPP
+#define KITCHEN_CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+
+#define VIRTUAL_TIME_POLL_INTERVAL 1
+
+/**
+ * @brief Clock of the simulated durations, satisfying the Clock requirements of Boost.Asio timers.
+ */
+struct kitchen_clock {
+    typedef std::chrono::steady_clock::duration duration; /**< the clock duration. */
+    typedef duration::rep rep; /**< the tick representation. */
+    typedef duration::period period; /**< the tick period. */
+    typedef std::chrono::time_point<kitchen_clock> time_point; /**< the clock time point. */
+    typedef std::multimap<time_point, uint64_t> deadline_map; /**< the deadline ids ordered by expiry. */
+    static constexpr bool is_steady = true; /**< the clock never goes backwards. */
+
+    private:
+        static inline std::atomic<bool> virtual_time_{false}; /**< flag to indicate whether the clock runs in virtual time. */
+        static inline std::atomic<rep> virtual_now_{0}; /**< the current virtual time. */
+        static inline std::atomic<size_t> outstanding_{0}; /**< the count of outstanding handlers and calls, including handlers of cancelled timers. */
+        static inline std::mutex deadlines_mutex_; /**< the mutex protecting the pending and cancelled deadlines. */
+        static inline deadline_map deadlines_; /**< the pending timer deadlines, the earliest first. */
+        static inline std::unordered_map<uint64_t, deadline_map::iterator> deadline_entries_; /**< the pending deadlines by id. */
+        static inline std::unordered_set<uint64_t> cancelled_deadlines_; /**< the ids of cancelled deadlines whose handler is outstanding. */
+        static inline uint64_t next_deadline_id_ = 0; /**< the id of the next registered deadline. */
+
+        /**
+         * @brief Advances the virtual time to the earliest pending deadline whenever the agents are quiescent.
+         *
+         */
+        static void
+        advance() {
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(VIRTUAL_TIME_POLL_INTERVAL));
+                if (outstanding_.load() > 0)
+                    continue;
+                std::lock_guard<std::mutex> lock(deadlines_mutex_);
+                /* Expired deadlines first have to fire, their handlers register follow-up work before removing them */
+                if (!deadlines_.empty() && deadlines_.begin()->first.time_since_epoch().count() > virtual_now_.load())
+                    virtual_now_.store(deadlines_.begin()->first.time_since_epoch().count());
+            }
+        }
+
+    public:
+        /**
+         * @brief Outstanding work deferring the advance of the virtual time while the object lives.
+         */
+        class activity {
+            public:
+                /**
+                 * @brief Constructs a new activity object, counting it as outstanding.
+                 *
+                 */
+                activity() {
+                    begin_activity();
+                }
+
+                /**
+                 * @brief Destroys the activity object, ending the outstanding work.
+                 *
+                 */
+                ~activity() {
+                    end_activity();
+                }
+
+                activity(const activity&) = delete;
+                activity& operator=(const activity&) = delete;
+        };
+
+        /**
+         * @brief Returns the current time.
+         *
+         * @return time_point the current real or virtual time.
+         */
+        static time_point
+        now() noexcept {
+            if (!virtual_time_.load(std::memory_order_relaxed))
+                return time_point(std::chrono::steady_clock::now().time_since_epoch());
+            return time_point(duration(virtual_now_.load()));
+        }
+
+        /**
+         * @brief Switches the clock to virtual time. Must be called once before any agent starts.
+         *
+         */
+        static void
+        use_virtual_time() {
+            if (virtual_time_.exchange(true))
+                return;
+            std::thread(advance).detach();
+        }
+
+        /**
+         * @brief Returns whether the clock runs in virtual time.
+         *
+         * @return true if the clock runs in virtual time.
+         * @return false if the clock runs in real time.
+         */
+        static bool
+        is_virtual() {
+            return virtual_time_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Begins outstanding work, e.g. a call in flight. Must be ended by end_activity.
+         *
+         */
+        static void
+        begin_activity() {
+            outstanding_.fetch_add(1);
+        }
+
+        /**
+         * @brief Ends outstanding work begun by begin_activity.
+         *
+         */
+        static void
+        end_activity() {
+            outstanding_.fetch_sub(1);
+        }
+
+        /**
+         * @brief Wraps a handler so that it is outstanding from now until its invocation returned or it is destroyed.
+         * Work it schedules has to be tracked as well before it returns.
+         *
+         * @param _handler the handler to post or to complete an asynchronous operation with.
+         * @return auto the tracked handler.
+         */
+        template<typename Handler>
+        static auto
+        tracked(Handler&& _handler) {
+            return [activity = std::make_shared<kitchen_clock::activity>(), handler = std::forward<Handler>(_handler)](auto&&... _args) mutable {
+                return handler(std::forward<decltype(_args)>(_args)...);
+            };
+        }
+
+        /**
+         * @brief Registers a pending timer deadline the virtual time may advance to.
+         *
+         * @param _deadline the timer expiry.
+         * @return uint64_t the deadline id.
+         */
+        static uint64_t
+        add_deadline(time_point _deadline) {
+            std::lock_guard<std::mutex> lock(deadlines_mutex_);
+            deadline_entries_[next_deadline_id_] = deadlines_.emplace(_deadline, next_deadline_id_);
+            return next_deadline_id_++;
+        }
+
+        /**
+         * @brief Withdraws the deadline of a cancelled timer wait, whose handler stays outstanding until it is removed.
+         * Deadlines already removed are ignored.
+         *
+         * @param _deadline_id the deadline id.
+         */
+        static void
+        cancel_deadline(uint64_t _deadline_id) {
+            std::lock_guard<std::mutex> lock(deadlines_mutex_);
+            auto deadline_entry = deadline_entries_.find(_deadline_id);
+            if (deadline_entry == deadline_entries_.end())
+                return;
+            deadlines_.erase(deadline_entry->second);
+            deadline_entries_.erase(deadline_entry);
+            cancelled_deadlines_.insert(_deadline_id);
+            begin_activity();
+        }
+
+        /**
+         * @brief Removes the deadline of a fired or cancelled timer wait after its handler ran.
+         *
+         * @param _deadline_id the deadline id.
+         */
+        static void
+        remove_deadline(uint64_t _deadline_id) {
+            std::lock_guard<std::mutex> lock(deadlines_mutex_);
+            auto deadline_entry = deadline_entries_.find(_deadline_id);
+            if (deadline_entry != deadline_entries_.end()) {
+                deadlines_.erase(deadline_entry->second);
+                deadline_entries_.erase(deadline_entry);
+            } else if (cancelled_deadlines_.erase(_deadline_id) > 0) {
+                end_activity();
+            }
+        }
+
+        /**
+         * @brief Returns whether the handler of a deadline is still pending.
+         *
+         * @param _deadline_id the deadline id.
+         * @return true if the deadline is pending or cancelled and its handler did not run yet.
+         * @return false if its handler ran.
+         */
+        static bool
+        is_deadline_pending(uint64_t _deadline_id) {
+            std::lock_guard<std::mutex> lock(deadlines_mutex_);
+            return deadline_entries_.count(_deadline_id) > 0 || cancelled_deadlines_.count(_deadline_id) > 0;
+        }
+};
+
+/**
+ * @brief Wait traits letting Asio poll the virtual time instead of sleeping until a real time deadline.
+ */
+struct kitchen_clock_wait_traits {
+    /**
+     * @brief Returns the real time to wait for the given clock duration.
+     *
+     * @param _duration the clock duration until expiry.
+     * @return kitchen_clock::duration the real time to wait.
+     */
+    static kitchen_clock::duration
+    to_wait_duration(const kitchen_clock::duration& _duration) {
+        if (!kitchen_clock::is_virtual())
+            return _duration;
+        return std::min<kitchen_clock::duration>(_duration, std::chrono::milliseconds(VIRTUAL_TIME_POLL_INTERVAL));
+    }
+
+    /**
+     * @brief Returns the real time to wait until the given clock time point.
+     *
+     * @param _time_point the expiry.
+     * @return kitchen_clock::duration the real time to wait.
+     */
+    static kitchen_clock::duration
+    to_wait_duration(const kitchen_clock::time_point& _time_point) {
+        return to_wait_duration(_time_point - kitchen_clock::now());
+    }
+};
+
+/**
+ * @brief Timer on the kitchen clock for the simulated durations of the agents.
+ */
+class kitchen_timer {
+    private:
+        boost::asio::basic_waitable_timer<kitchen_clock, kitchen_clock_wait_traits> timer_; /**< the Asio timer on the kitchen clock. */
+        std::vector<uint64_t> deadline_ids_; /**< the deadline ids of the waits in virtual time, whose handlers may not have run yet. */
+
+        /**
+         * @brief Withdraws the deadlines of the pending waits, which are about to be cancelled.
+         *
+         */
+        void
+        cancel_deadlines() {
+            for (uint64_t deadline_id : deadline_ids_) {
+                kitchen_clock::cancel_deadline(deadline_id);
+            }
+            deadline_ids_.clear();
+        }
+
+    public:
+        /**
+         * @brief Constructs a new kitchen timer object.
+         *
+         * @param _io_context the io context the handlers are executed on.
+         */
+        explicit kitchen_timer(boost::asio::io_context& _io_context) : timer_(_io_context) {
+        }
+
+        /**
+         * @brief Destroys the kitchen timer object, cancelling any pending wait.
+         *
+         */
+        ~kitchen_timer() {
+            cancel_deadlines();
+        }
+
+        /**
+         * @brief Sets the expiry relative to now, cancelling any pending wait.
+         *
+         * @param _duration the duration until expiry.
+         */
+        template<typename Rep, typename Period>
+        void
+        expires_after(const std::chrono::duration<Rep, Period>& _duration) {
+            cancel_deadlines();
+            timer_.expires_after(std::chrono::duration_cast<kitchen_clock::duration>(_duration));
+        }
+
+        /**
+         * @brief Sets the expiry relative to now, cancelling any pending wait.
+         *
+         * @param _duration the duration until expiry.
+         */
+        template<typename Rep, typename Period>
+        void
+        expires_from_now(const std::chrono::duration<Rep, Period>& _duration) {
+            expires_after(_duration);
+        }
+
+        /**
+         * @brief Cancels any pending wait.
+         *
+         * @return size_t the number of cancelled waits.
+         */
+        size_t
+        cancel() {
+            cancel_deadlines();
+            return timer_.cancel();
+        }
+
+        /**
+         * @brief Waits asynchronously for the expiry. In virtual time the expiry is registered as pending deadline.
+         *
+         * @param _handler the handler invoked with the error code on expiry or cancellation.
+         */
+        template<typename WaitHandler>
+        void
+        async_wait(WaitHandler&& _handler) {
+            if (!kitchen_clock::is_virtual()) {
+                timer_.async_wait(std::forward<WaitHandler>(_handler));
+                return;
+            }
+            std::erase_if(deadline_ids_, [](uint64_t _deadline_id) {
+                return !kitchen_clock::is_deadline_pending(_deadline_id);
+            });
+            uint64_t deadline_id = kitchen_clock::add_deadline(timer_.expiry());
+            deadline_ids_.push_back(deadline_id);
+            timer_.async_wait([deadline_id, handler = std::forward<WaitHandler>(_handler)](const boost::system::error_code& _error) mutable {
+                handler(_error);
+                /* Removed after the handler so that a follow-up deadline is registered before the clock may advance */
+                kitchen_clock::remove_deadline(deadline_id);
+            });
+        }
+};
+
+#endif // KITCHEN_CLOCK_HPP
@@ -0,0 +1,18 @@
+/**
+ * @file log_compile_level.h
+ * @brief Raises the compile-time level of the UA_LOG_* calls to strip lower levels from the binaries.
+ *
+ * The prebuilt open62541 config fixes UA_LOGLEVEL, so this header is force-included before every
+ * translation unit when LOG_COMPILE_LEVEL is set (100 trace, 200 debug, 300 info, 400 warning, 500 error, 600 fatal).
+ */
+#ifndef LOG_COMPILE_LEVEL_H
+#define LOG_COMPILE_LEVEL_H
+
+#include <open62541/config.h>
+
+#ifdef LOG_COMPILE_LEVEL
+#undef UA_LOGLEVEL
+#define UA_LOGLEVEL LOG_COMPILE_LEVEL
+#endif
+
+#endif // LOG_COMPILE_LEVEL_H
@@ -0,0 +1,180 @@
+/**
+ * @file capability_planner.hpp
+ * @brief Plans the capability profiles of the robot positions from the recent recipe demand.
+ *
+ * @details
+ * The planner keeps the recipes of a sliding window of recent orders and the demanded duration of every action
+ * within the window. Periodically it searches the assignment of capability profiles to robot positions with the
+ * least expected conveyor moves and retools for the windowed orders, without overloading the robots of an action
+ * with its demand, starting from the current assignment and
+ * changing, exchanging or shifting the profiles of positions while the expectation improves. The new assignment is only
+ * proposed if its gain over the window exceeds the time the robots are reconfiguring by the hysteresis, so the
+ * robots are not reconfigured back and forth on small demand shifts. The arrangement of the robots around the
+ * conveyor is planned the same way by exchanging and shifting the robots only, and reached by swapping positions.
+ */
+#ifndef CAPABILITY_PLANNER_HPP
+#define CAPABILITY_PLANNER_HPP
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "mape.hpp"
+
+/**
+ * @brief A capability profile as available for reconfigurations.
+ */
+struct capability_profile {
+    std::string name_; /**< the capabilities file name. */
+    capability_mask_t mask_; /**< the capability mask. */
+};
+
+class capability_planner {
+private:
+    std::vector<capability_profile> profiles_; /**< the available profiles ordered by name. */
+    std::unordered_map<capability_mask_t, std::vector<size_t>> action_profiles_; /**< the indices of the profiles capable of every action. */
+    size_t window_size_; /**< the count of recent orders the demand is taken from. */
+    size_t planning_period_; /**< the count of orders between two plannings. */
+    duration_t hysteresis_; /**< the time units the gain must exceed the reconfiguration time by. */
+    std::deque<recipe_steps> window_; /**< the recipes of the recent orders, oldest first. */
+    std::unordered_map<const robot_action*, std::pair<recipe_steps, size_t>> recipe_demand_; /**< the recipes within the window and their order counts, by first step. */
+    std::unordered_map<capability_mask_t, duration_t> action_demand_; /**< the summed durations of every action within the window. */
+    size_t orders_since_planning_; /**< the count of orders recorded since the last planning. */
+
+    /**
+     * @brief Estimates the conveyor moves and retools of an order on a layout. The kitchen hands the order to the
+     * capable robot at the lowest position, every next run goes to the next capable robot downstream and the
+     * finished dish to the output.
+     *
+     * @param _recipe_action_queue the steps of the order.
+     * @param _layout the capability masks by position, 0 for the output position.
+     * @return duration_t the estimated time of the moves and retools, INFEASIBLE_ORDER_COST if a step has no capable robot.
+     */
+    static duration_t
+    estimate_order_cost(recipe_steps _recipe_action_queue, const std::vector<capability_mask_t>& _layout);
+
+    /**
+     * @brief Estimates the moves and retools of all orders within the window on a layout, plus the demand of the
+     * busiest robot if every action's demand is shared evenly by the capable robots.
+     *
+     * @param _layout the capability masks by position, 0 for the output position.
+     * @return duration_t the estimated time of the moves and retools and the busiest robot's demand.
+     */
+    duration_t
+    estimate_window_cost(const std::vector<capability_mask_t>& _layout) const;
+
+    /**
+     * @brief Improves a layout for the window by local search, applying the best change of a position's profile,
+     * exchange or shift of movable positions until no move improves the layout.
+     *
+     * @param _layout the capability masks by position, improved in place.
+     * @param _movable the flags by position whether the position may change.
+     * @param _profile_masks the capability masks a movable position may change to, empty to only rearrange the positions.
+     * @return duration_t the estimated cost of the improved layout.
+     */
+    duration_t
+    search_layout(std::vector<capability_mask_t>& _layout, const std::vector<bool>& _movable, const std::vector<capability_mask_t>& _profile_masks) const;
+
+public:
+    /**
+     * @brief Constructs a new capability planner object and indexes the profiles by action.
+     *
+     * @param _profiles the available profiles by capabilities file name.
+     * @param _window_size the count of recent orders the demand is taken from.
+     * @param _planning_period the count of orders between two plannings.
+     * @param _hysteresis the time units the gain of a new layout must exceed the reconfiguration time by.
+     */
+    capability_planner(const std::unordered_map<std::string, capability_parser>& _profiles, size_t _window_size, size_t _planning_period, duration_t _hysteresis);
+
+    /**
+     * @brief Returns the profiles capable of an action.
+     *
+     * @param _action_mask the capability mask of the action.
+     * @return const std::vector<size_t>& the indices of the capable profiles ordered by name.
+     */
+    const std::vector<size_t>&
+    get_profiles_capable_to(capability_mask_t _action_mask) const;
+
+    /**
+     * @brief Returns a profile.
+     *
+     * @param _profile the index of the profile.
+     * @return const capability_profile& the profile.
+     */
+    const capability_profile&
+    get_profile(size_t _profile) const;
+
+    /**
+     * @brief Finds the first profile with the given capabilities.
+     *
+     * @param _capabilities_mask the capability mask.
+     * @return size_t the index of the profile, the count of profiles if no profile has the capabilities.
+     */
+    size_t
+    find_profile(capability_mask_t _capabilities_mask) const;
+
+    /**
+     * @brief Records the recipe of a new order and drops the oldest order from the window if it is full.
+     *
+     * @param _recipe_action_queue the steps of the new order.
+     */
+    void
+    record_order(recipe_steps _recipe_action_queue);
+
+    /**
+     * @brief Indicates whether a planning period passed since the last planning.
+     *
+     * @return true if the layout is to be planned.
+     * @return false if the last planning is recent.
+     */
+    bool
+    is_planning_due() const;
+
+    /**
+     * @brief Plans the profiles of the robots for the windowed demand. The planning is postponed while a robot has
+     * pending adaptivity, robots whose profile is not available keep their capabilities.
+     *
+     * @param _snapshot the registry snapshot of the robots.
+     * @return std::vector<std::pair<position_t, std::string>> the reconfigurations worth their time by position and new profile,
+     * empty if the current layout is kept or the planning is postponed.
+     */
+    std::vector<std::pair<position_t, std::string>>
+    plan(const robot_registry_snapshot& _snapshot);
+
+    /**
+     * @brief Plans the arrangement of the robots around the conveyor for the windowed demand. The planning is
+     * postponed while a robot has pending adaptivity.
+     *
+     * @param _snapshot the registry snapshot of the robots.
+     * @return std::vector<capability_mask_t> the capability masks by position after the rearrangement, 0 for the output
+     * position and positions without robot, empty if the current arrangement is kept or the planning is postponed.
+     */
+    std::vector<capability_mask_t>
+    plan_arrangement(const robot_registry_snapshot& _snapshot) const;
+
+    /**
+     * @brief Returns the capability masks of the robots by position.
+     *
+     * @param _snapshot the registry snapshot of the robots.
+     * @return std::vector<capability_mask_t> the capability masks by position, 0 for the output position and positions
+     * without robot, empty without robots.
+     */
+    static std::vector<capability_mask_t>
+    get_layout(const robot_registry_snapshot& _snapshot);
+
+    /**
+     * @brief Determines the position swaps rearranging a layout. Every swap places at least one robot at its planned
+     * position and places both if possible, so the count of swaps is minimal for distinct profiles. Swaps sharing a
+     * position have to be performed in sequence.
+     *
+     * @param _layout the current capability masks by position.
+     * @param _arrangement the planned capability masks by position.
+     * @return std::vector<std::pair<position_t, position_t>> the swaps in sequence by robot position and target position,
+     * empty if the arrangement is reached or no rearrangement of the layout.
+     */
+    static std::vector<std::pair<position_t, position_t>>
+    get_arrangement_swaps(std::vector<capability_mask_t> _layout, const std::vector<capability_mask_t>& _arrangement);
+};
+
+#endif // CAPABILITY_PLANNER_HPP
@@ -1,25 +1,161 @@
 #ifndef KITCHEN_MAPE_HPP
 #define KITCHEN_MAPE_HPP
 
+#include <mutex>
 #include "mape.hpp"
+#include "capability_planner.hpp"
+
+/**
+ * @brief The robot selection strategies of the kitchen mape.
+ * 
+ */
+enum class kitchen_mape_strategy {
+    SIMPLE_CAPABILITY_CHECK, /**< the first capable robot in descending position order without adaptations. */
+    SIMPLE_REARRANGING, /**< the first capable robot in descending position order, swapping the positions of misordered robots. */
+    SIMPLE_RECONFIGURATION, /**< the first capable robot in descending position order, swapping capability profiles of misordered robots. */
+    EARLIEST_COMPLETION_TIME, /**< the capable robot with the earliest estimated completion of the next steps. */
+    DEMAND_DRIVEN_RECONFIGURATION, /**< the earliest completion time, reconfiguring the robots periodically for the recent demand. */
+    LAYOUT_OPTIMIZATION /**< the earliest completion time, rearranging the robots in the background for the recent demand. */
+};
 
 class kitchen_mape : public mape {
 private:
+    kitchen_mape_strategy strategy_; /**< the robot selection strategy. */
+    capability_planner capability_planner_; /**< the planner of the robots' profiles, also indexing the profiles by action. */
+    std::mutex capability_planner_mutex_; /**< the mutex guarding the demand of the capability planner against the layout reviews. */
+    std::vector<capability_mask_t> planned_arrangement_; /**< the arrangement the robots are being rearranged to, only accessed by the layout reviews. */
 
 private:
-    remote_robot*
-    simple_capability_check(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue);
+    /**
+     * @brief Records the demand of a new order for the strategies planning the layout.
+     * 
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     */
+    void
+    record_demand(recipe_steps _recipe_action_queue);
+
+    const robot_descriptor*
+    simple_capability_check(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue);
+
+    const robot_descriptor*
+    simple_rearranging(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue);
+
+    const robot_descriptor*
+    simple_reconfiguration(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue);
+
+    /**
+     * @brief Records the demand of new orders, reconfigures the robots when the planner finds a layout worth the
+     * reconfiguration and selects the capable robot with the earliest estimated completion among the robots not reconfigured.
+     * 
+     * @param _snapshot the registry snapshot of the robots.
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     * @param _plate_position the conveyor position of the order's plate.
+     * @return const robot_descriptor* the selected robot, nullptr if no available robot is capable of the next step.
+     */
+    const robot_descriptor*
+    demand_driven_reconfiguration(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position);
 
-    remote_robot*
-    simple_rearranging(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue);
+    /**
+     * @brief Selects the capable robot with the earliest estimated completion time of the next steps.
+     * 
+     * @param _snapshot the registry snapshot of the robots.
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     * @param _plate_position the conveyor position of the order's plate.
+     * @return const robot_descriptor* the selected robot, nullptr if no robot is capable of the next step.
+     */
+    const robot_descriptor*
+    earliest_completion_time(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position);
 
-    remote_robot*
-    simple_reconfiguration(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue);
+    /**
+     * @brief Plans every run of steps on the capable robot with the earliest estimated completion, starting each run
+     * when the plate is estimated to be ready after the previous one.
+     * 
+     * @param _snapshot the registry snapshot of the robots.
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     * @param _plate_position the conveyor position of the order's plate.
+     * @return std::vector<const robot_descriptor*> the planned robots in processing order, empty if a step has no capable robot.
+     */
+    std::vector<const robot_descriptor*>
+    earliest_completion_route(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position);
+
+    /**
+     * @brief Returns the robots without pending adaptivity capable of the next step.
+     * 
+     * @param _snapshot the registry snapshot of the robots.
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     * @param _horizon the longest run of next steps one of the robots is capable of.
+     * @return std::vector<const robot_descriptor*> the capable robots in descending position order.
+     */
+    static std::vector<const robot_descriptor*>
+    get_capable_robots(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, size_t& _horizon);
+
+    /**
+     * @brief Estimates when a robot can start on a plate, after its queued work and the plate's travel to it.
+     * 
+     * @param _robot the robot.
+     * @param _plate_position the conveyor position of the order's plate.
+     * @param _conveyor_size the count of conveyor positions.
+     * @return duration_t the estimated start time from now.
+     */
+    static duration_t
+    estimate_ready_time(const robot_descriptor& _robot, position_t _plate_position, position_t _conveyor_size);
+
+    /**
+     * @brief Estimates the time a robot needs for its run of capable next steps including retooling, and removes the run from the steps.
+     * 
+     * @param _robot the robot.
+     * @param _recipe_action_queue the view of the remaining steps, advanced past the run.
+     * @return duration_t the estimated run time.
+     */
+    static duration_t
+    estimate_run_time(const robot_descriptor& _robot, recipe_steps& _recipe_action_queue);
+
+    /**
+     * @brief Sums the durations of the given number of next steps without retooling.
+     * 
+     * @param _recipe_action_queue the view of the remaining steps.
+     * @param _steps the count of next steps.
+     * @return duration_t the summed durations.
+     */
+    static duration_t
+    estimate_bare_time(recipe_steps _recipe_action_queue, size_t _steps);
 
 public:
-    using mape::mape;
+    /**
+     * @brief Constructs a new kitchen mape object.
+     * 
+     * @param _strategy the robot selection strategy.
+     */
+    explicit kitchen_mape(kitchen_mape_strategy _strategy = kitchen_mape_strategy::SIMPLE_RECONFIGURATION);
     ~kitchen_mape() override = default;
-    virtual remote_robot* on_new_order(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue) override;
+    virtual const robot_descriptor* on_new_order(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) override;
+    virtual std::vector<order_assignment> on_new_orders(const robot_registry_snapshot& _snapshot, const std::vector<recipe_steps>& _recipe_action_queues) override;
+    virtual std::vector<const robot_descriptor*> on_new_route(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) override;
+    virtual bool is_decision_cacheable() const override;
+    virtual duration_t get_layout_review_period() const override;
+
+    /**
+     * @brief Continues the rearrangement to the planned arrangement, or plans the arrangement for the recent demand
+     * once it is reached. The swaps of every review are disjoint, the swaps sharing a robot follow in later reviews.
+     * 
+     * @param _snapshot the registry snapshot of the robots.
+     */
+    virtual void on_layout_review(const robot_registry_snapshot& _snapshot) override;
+
+    /**
+     * @brief Estimates when a robot completes the given number of next steps of an order. The plate travels to the
+     * robot while the robot works off its queued work, then the robot processes its run of capable steps with
+     * retooling. Steps beyond the run are counted with their bare duration, as done by the next robots.
+     * 
+     * @param _robot the robot capable of the next step.
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     * @param _plate_position the conveyor position of the order's plate.
+     * @param _conveyor_size the count of conveyor positions.
+     * @param _horizon the count of next steps to estimate.
+     * @return duration_t the estimated completion time from now.
+     */
+    static duration_t
+    estimate_completion_time(const robot_descriptor& _robot, recipe_steps _recipe_action_queue, position_t _plate_position, position_t _conveyor_size, size_t _horizon);
 };
 
-#endif // KITCHEN_MAPE_HPP
\ No newline at end of file
+#endif // KITCHEN_MAPE_HPP
@@ -0,0 +1,281 @@
+#include "../include/capability_planner.hpp"
+#include <algorithm>
+#include "agent_timings.hpp"
+
+/* The cost of an order with a step no robot is capable of, exceeding the cost of any feasible window */
+#define INFEASIBLE_ORDER_COST (1LL << 40)
+
+capability_planner::capability_planner(const std::unordered_map<std::string, capability_parser>& _profiles, size_t _window_size, size_t _planning_period, duration_t _hysteresis)
+    : window_size_(_window_size), planning_period_(_planning_period), hysteresis_(_hysteresis), orders_since_planning_(0) {
+    for (const auto& [name, profile] : _profiles) {
+        profiles_.push_back({name, profile.get_capabilities_mask()});
+    }
+    std::sort(profiles_.begin(), profiles_.end(), [](const capability_profile& _first, const capability_profile& _second) {
+        return _first.name_ < _second.name_;
+    });
+    for (size_t profile = 0; profile < profiles_.size(); profile++) {
+        for (capability_mask_t actions = profiles_[profile].mask_; actions != 0; actions &= actions - 1) {
+            action_profiles_[actions & -actions].push_back(profile);
+        }
+    }
+}
+
+const std::vector<size_t>&
+capability_planner::get_profiles_capable_to(capability_mask_t _action_mask) const {
+    static const std::vector<size_t> no_profiles;
+    auto action_profiles = action_profiles_.find(_action_mask);
+    return action_profiles == action_profiles_.end() ? no_profiles : action_profiles->second;
+}
+
+const capability_profile&
+capability_planner::get_profile(size_t _profile) const {
+    return profiles_[_profile];
+}
+
+size_t
+capability_planner::find_profile(capability_mask_t _capabilities_mask) const {
+    for (size_t profile = 0; profile < profiles_.size(); profile++) {
+        if (profiles_[profile].mask_ == _capabilities_mask)
+            return profile;
+    }
+    return profiles_.size();
+}
+
+void
+capability_planner::record_order(recipe_steps _recipe_action_queue) {
+    if (_recipe_action_queue.empty() || window_size_ == 0)
+        return;
+    window_.push_back(_recipe_action_queue);
+    recipe_demand_.try_emplace(_recipe_action_queue.begin(), _recipe_action_queue, 0).first->second.second++;
+    for (const robot_action& step : _recipe_action_queue) {
+        action_demand_[step.get_action_mask()] += step.get_action_duration();
+    }
+    orders_since_planning_++;
+    if (window_.size() <= window_size_)
+        return;
+    recipe_steps oldest = window_.front();
+    window_.pop_front();
+    if (--recipe_demand_[oldest.begin()].second == 0)
+        recipe_demand_.erase(oldest.begin());
+    for (const robot_action& step : oldest) {
+        if ((action_demand_[step.get_action_mask()] -= step.get_action_duration()) == 0)
+            action_demand_.erase(step.get_action_mask());
+    }
+}
+
+bool
+capability_planner::is_planning_due() const {
+    return orders_since_planning_ >= planning_period_ && !window_.empty();
+}
+
+duration_t
+capability_planner::estimate_order_cost(recipe_steps _recipe_action_queue, const std::vector<capability_mask_t>& _layout) {
+    const position_t conveyor_size = _layout.size();
+    position_t position = 0;
+    duration_t moves = 0;
+    duration_t retools = 0;
+    while (!_recipe_action_queue.empty()) {
+        capability_mask_t next_action = _recipe_action_queue.front().get_action_mask();
+        position_t distance = 1;
+        while (distance < conveyor_size && (_layout[(position + distance) % conveyor_size] & next_action) != next_action) {
+            distance++;
+        }
+        if (distance == conveyor_size)
+            return INFEASIBLE_ORDER_COST;
+        /* The kitchen hands new orders to the robot directly */
+        moves += position == 0 ? 0 : distance;
+        position = (position + distance) % conveyor_size;
+        robot_tool first_tool = _recipe_action_queue.front().get_required_tool();
+        robot_tool last_tool = first_tool;
+        while (!_recipe_action_queue.empty() && (_layout[position] & _recipe_action_queue.front().get_action_mask()) == _recipe_action_queue.front().get_action_mask()) {
+            retools += last_tool != _recipe_action_queue.front().get_required_tool() ? 1 : 0;
+            last_tool = _recipe_action_queue.front().get_required_tool();
+            _recipe_action_queue.pop();
+        }
+        /* The robot's previous order of the same recipe ended with the last tool of the run */
+        retools += last_tool != first_tool ? 1 : 0;
+    }
+    moves += (conveyor_size - position) % conveyor_size;
+    return moves * CONVEYOR_MOVE_TIME + retools * RETOOLING_TIME;
+}
+
+duration_t
+capability_planner::estimate_window_cost(const std::vector<capability_mask_t>& _layout) const {
+    duration_t cost = 0;
+    for (const auto& [first_step, recipe_orders] : recipe_demand_) {
+        cost += estimate_order_cost(recipe_orders.first, _layout) * recipe_orders.second;
+    }
+    /* Every action's demand is shared by its capable robots, the busiest robot bounds the window's makespan */
+    std::vector<double> robot_loads(_layout.size(), 0);
+    for (const auto& [action, demand] : action_demand_) {
+        size_t capable_robots = 0;
+        for (capability_mask_t capabilities : _layout) {
+            capable_robots += (capabilities & action) == action ? 1 : 0;
+        }
+        for (position_t position = 0; position < _layout.size() && capable_robots > 0; position++) {
+            if ((_layout[position] & action) == action)
+                robot_loads[position] += static_cast<double>(demand) / capable_robots;
+        }
+    }
+    return cost + static_cast<duration_t>(*std::max_element(robot_loads.begin(), robot_loads.end()));
+}
+
+duration_t
+capability_planner::search_layout(std::vector<capability_mask_t>& _layout, const std::vector<bool>& _movable, const std::vector<capability_mask_t>& _profile_masks) const {
+    const position_t conveyor_size = _layout.size();
+    duration_t cost = estimate_window_cost(_layout);
+    /* Apply the best profile change, exchange or shift of positions until no move improves the layout */
+    for (size_t iteration = 0; iteration < conveyor_size * (conveyor_size + _profile_masks.size()); iteration++) {
+        std::vector<capability_mask_t> best = _layout;
+        duration_t best_cost = cost;
+        auto try_move = [&](const std::vector<capability_mask_t>& _move) {
+            duration_t move_cost = estimate_window_cost(_move);
+            if (move_cost < best_cost) {
+                best = _move;
+                best_cost = move_cost;
+            }
+        };
+        for (position_t position = 1; position < conveyor_size; position++) {
+            if (!_movable[position])
+                continue;
+            for (capability_mask_t profile_mask : _profile_masks) {
+                if (profile_mask == _layout[position])
+                    continue;
+                std::vector<capability_mask_t> move = _layout;
+                move[position] = profile_mask;
+                try_move(move);
+            }
+            bool shiftable = true;
+            for (position_t other = position + 1; other < conveyor_size; other++) {
+                /* Fixed positions are exchanged across but never shifted */
+                if (!_movable[other]) {
+                    shiftable = false;
+                    continue;
+                }
+                if (_layout[other] == _layout[position])
+                    continue;
+                std::vector<capability_mask_t> move = _layout;
+                std::swap(move[position], move[other]);
+                try_move(move);
+                if (!shiftable)
+                    continue;
+                /* Moving a profile up or down the conveyor shifts the profiles in between */
+                move = _layout;
+                std::rotate(move.begin() + position, move.begin() + position + 1, move.begin() + other + 1);
+                try_move(move);
+                move = _layout;
+                std::rotate(move.begin() + position, move.begin() + other, move.begin() + other + 1);
+                try_move(move);
+            }
+        }
+        if (best_cost >= cost)
+            break;
+        _layout = best;
+        cost = best_cost;
+    }
+    return cost;
+}
+
+std::vector<capability_mask_t>
+capability_planner::get_layout(const robot_registry_snapshot& _snapshot) {
+    if (_snapshot.robots_.empty())
+        return {};
+    std::vector<capability_mask_t> layout(_snapshot.get_conveyor_size(), 0);
+    for (const auto& [position, robot] : _snapshot.robots_) {
+        layout[position] = robot.get_capabilities_mask();
+    }
+    return layout;
+}
+
+std::vector<std::pair<position_t, std::string>>
+capability_planner::plan(const robot_registry_snapshot& _snapshot) {
+    if (_snapshot.robots_.empty())
+        return {};
+    /* The layout is still changing while robots adapt */
+    for (const auto& [position, robot] : _snapshot.robots_) {
+        if (robot.is_adaptivity_pending())
+            return {};
+    }
+    orders_since_planning_ = 0;
+    std::vector<capability_mask_t> layout = get_layout(_snapshot);
+    /* Positions without robot or with an unknown profile keep their capabilities */
+    std::vector<bool> movable(layout.size(), false);
+    for (position_t position = 1; position < layout.size(); position++) {
+        movable[position] = find_profile(layout[position]) != profiles_.size();
+    }
+    /* Only profiles covering demanded actions are worth a position */
+    std::vector<capability_mask_t> candidates;
+    for (const capability_profile& profile : profiles_) {
+        for (const auto& [action, demand] : action_demand_) {
+            if ((profile.mask_ & action) == action) {
+                candidates.push_back(profile.mask_);
+                break;
+            }
+        }
+    }
+    const duration_t current_cost = estimate_window_cost(layout);
+    std::vector<capability_mask_t> planned = layout;
+    const duration_t planned_cost = search_layout(planned, movable, candidates);
+    std::vector<std::pair<position_t, std::string>> reconfigurations;
+    for (position_t position = 1; position < layout.size(); position++) {
+        if (planned[position] != layout[position])
+            reconfigurations.emplace_back(position, profiles_[find_profile(planned[position])].name_);
+    }
+    /* Reconfigure only if the gain over the window outweighs the robots' downtime by the hysteresis */
+    if (current_cost - planned_cost <= reconfigurations.size() * ROBOT_RECONFIGURATION_TIME + hysteresis_)
+        return {};
+    return reconfigurations;
+}
+
+std::vector<capability_mask_t>
+capability_planner::plan_arrangement(const robot_registry_snapshot& _snapshot) const {
+    if (_snapshot.robots_.empty() || window_.empty())
+        return {};
+    for (const auto& [position, robot] : _snapshot.robots_) {
+        if (robot.is_adaptivity_pending())
+            return {};
+    }
+    std::vector<capability_mask_t> layout = get_layout(_snapshot);
+    /* Every robot may move, positions without robot move like robots without capabilities */
+    std::vector<bool> movable(layout.size(), true);
+    movable[0] = false;
+    std::vector<capability_mask_t> arrangement = layout;
+    const duration_t gain = estimate_window_cost(layout) - search_layout(arrangement, movable, {});
+    /* Both robots of a swap are unavailable while they move to each other's position */
+    duration_t downtime = 0;
+    for (const auto& [from, to] : get_arrangement_swaps(layout, arrangement)) {
+        position_t distance = std::max(from, to) - std::min(from, to);
+        downtime += 2 * std::min<duration_t>(distance, layout.size() - distance) * ROBOT_MOVE_TIME;
+    }
+    if (gain <= downtime + hysteresis_)
+        return {};
+    return arrangement;
+}
+
+std::vector<std::pair<position_t, position_t>>
+capability_planner::get_arrangement_swaps(std::vector<capability_mask_t> _layout, const std::vector<capability_mask_t>& _arrangement) {
+    if (_layout.size() != _arrangement.size() || !std::is_permutation(_layout.begin(), _layout.end(), _arrangement.begin()))
+        return {};
+    std::vector<std::pair<position_t, position_t>> swaps;
+    for (position_t position = 1; position < _layout.size(); position++) {
+        if (_layout[position] == _arrangement[position])
+            continue;
+        /* Prefer the robot whose planned position is this one's, which places both robots with a single swap */
+        position_t partner = 0;
+        for (position_t other = position + 1; other < _layout.size(); other++) {
+            if (_layout[other] != _arrangement[position] || _layout[other] == _arrangement[other])
+                continue;
+            if (partner == 0 || _arrangement[other] == _layout[position])
+                partner = other;
+            if (_arrangement[other] == _layout[position])
+                break;
+        }
+        /* Only robots can initiate a swap, with a robot or to a position without robot */
+        if (_layout[position] == 0)
+            swaps.emplace_back(partner, position);
+        else
+            swaps.emplace_back(position, partner);
+        std::swap(_layout[position], _layout[partner]);
+    }
+    return swaps;
+}
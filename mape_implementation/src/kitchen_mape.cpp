@@ -1,19 +1,99 @@
 #include "../include/kitchen_mape.hpp"
 #include <open62541/plugin/log_stdout.h>
-#include "controller.hpp"
+#include <algorithm>
+#include <limits>
+#include "agent_timings.hpp"
 
-remote_robot*
-kitchen_mape::on_new_order(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue) {
-    return simple_reconfiguration(_position_remote_robot_map, _recipe_action_queue);
+/* The cost of assigning an order to an incapable robot, exceeding any estimated completion time */
+#define ASSIGNMENT_INFEASIBLE_COST (1LL << 48)
+/* The count of recent orders the demand-driven reconfiguration plans for */
+#define DEMAND_WINDOW_SIZE 32
+/* The count of orders between two plannings of the demand-driven reconfiguration */
+#define DEMAND_PLANNING_PERIOD 8
+/* The time units the gain of a new layout must exceed the reconfiguration time by */
+#define RECONFIGURATION_HYSTERESIS 20LL
+/* The time units between two layout reviews of the layout optimization */
+#define LAYOUT_REVIEW_PERIOD 50LL
+
+kitchen_mape::kitchen_mape(kitchen_mape_strategy _strategy) : mape(), strategy_(_strategy),
+    capability_planner_(get_capabilites(), DEMAND_WINDOW_SIZE, DEMAND_PLANNING_PERIOD, RECONFIGURATION_HYSTERESIS) {
+}
+
+const robot_descriptor*
+kitchen_mape::on_new_order(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) {
+    switch (strategy_) {
+        case kitchen_mape_strategy::SIMPLE_CAPABILITY_CHECK:
+            return simple_capability_check(_snapshot, _recipe_action_queue);
+        case kitchen_mape_strategy::SIMPLE_REARRANGING:
+            return simple_rearranging(_snapshot, _recipe_action_queue);
+        case kitchen_mape_strategy::EARLIEST_COMPLETION_TIME:
+            return earliest_completion_time(_snapshot, _recipe_action_queue, _plate_position);
+        case kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION:
+            return demand_driven_reconfiguration(_snapshot, _recipe_action_queue, _plate_position);
+        case kitchen_mape_strategy::LAYOUT_OPTIMIZATION:
+            if (!_recipe_action_queue.empty() && _recipe_action_queue.get_offset() == 0)
+                record_demand(_recipe_action_queue);
+            return earliest_completion_time(_snapshot, _recipe_action_queue, _plate_position);
+        default:
+            return simple_reconfiguration(_snapshot, _recipe_action_queue);
+    }
+}
+
+bool
+kitchen_mape::is_decision_cacheable() const {
+    return strategy_ != kitchen_mape_strategy::EARLIEST_COMPLETION_TIME && strategy_ != kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION
+        && strategy_ != kitchen_mape_strategy::LAYOUT_OPTIMIZATION;
+}
+
+duration_t
+kitchen_mape::get_layout_review_period() const {
+    return strategy_ == kitchen_mape_strategy::LAYOUT_OPTIMIZATION ? LAYOUT_REVIEW_PERIOD : 0;
+}
+
+// Background rearrangement of the robots for the recent demand
+void
+kitchen_mape::on_layout_review(const robot_registry_snapshot& _snapshot) {
+    if (strategy_ != kitchen_mape_strategy::LAYOUT_OPTIMIZATION)
+        return;
+    // Swaps in progress are committed first
+    for (const auto& [position, robot] : _snapshot.robots_) {
+        if (robot.is_adaptivity_pending())
+            return;
+    }
+    std::vector<capability_mask_t> layout = capability_planner::get_layout(_snapshot);
+    std::vector<std::pair<position_t, position_t>> swaps = capability_planner::get_arrangement_swaps(layout, planned_arrangement_);
+    if (swaps.empty()) {
+        // The search runs on a copy of the demand, so decisions only wait for the copy
+        std::unique_lock<std::mutex> planner_lock(capability_planner_mutex_);
+        capability_planner planner = capability_planner_;
+        planner_lock.unlock();
+        planned_arrangement_ = planner.plan_arrangement(_snapshot);
+        swaps = capability_planner::get_arrangement_swaps(layout, planned_arrangement_);
+    }
+    std::vector<bool> swapping(layout.size(), false);
+    for (const auto& [from, to] : swaps) {
+        if (!swapping[from] && !swapping[to]) {
+            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Swap robot at position %d to position %d for the recent demand", from, to);
+            swap_robot_positions_callback_(from, to);
+        }
+        swapping[from] = true;
+        swapping[to] = true;
+    }
+}
+
+void
+kitchen_mape::record_demand(recipe_steps _recipe_action_queue) {
+    std::lock_guard<std::mutex> planner_lock(capability_planner_mutex_);
+    capability_planner_.record_order(_recipe_action_queue);
 }
 
 // Simple capability check
-remote_robot*
-kitchen_mape::simple_capability_check(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue) {
-    remote_robot* suitable_robot = nullptr;
-    std::string next_action = _recipe_action_queue.front().get_name();
-    for (auto position_remote_robot = _position_remote_robot_map.begin(); position_remote_robot != _position_remote_robot_map.end(); position_remote_robot++) {
-        remote_robot* robot = position_remote_robot->second.get();
+const robot_descriptor*
+kitchen_mape::simple_capability_check(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue) {
+    const robot_descriptor* suitable_robot = nullptr;
+    capability_mask_t next_action = _recipe_action_queue.front().get_action_mask();
+    for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+        const robot_descriptor* robot = &position_robot->second;
         if (!robot->is_adaptivity_pending() && robot->is_capable_to(next_action)) {
             suitable_robot = robot;
             break;
@@ -23,17 +103,17 @@ kitchen_mape::simple_capability_check(const std::map<position_t, std::unique_ptr
 }
 
 // Simple rearranging if suitable robot after next is positioned before next suitable robot
-remote_robot*
-kitchen_mape::simple_rearranging(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue) {
+const robot_descriptor*
+kitchen_mape::simple_rearranging(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue) {
     if (_recipe_action_queue.empty()) {
         return nullptr;
     }
-    remote_robot* suitable_robot = nullptr;
-    std::string next_action = _recipe_action_queue.front().get_name();
-    std::queue<robot_action> action_queue_copy = _recipe_action_queue;
+    const robot_descriptor* suitable_robot = nullptr;
+    capability_mask_t next_action = _recipe_action_queue.front().get_action_mask();
+    recipe_steps action_queue_copy = _recipe_action_queue;
     // Determine capable robot
-    for (auto position_remote_robot = _position_remote_robot_map.begin(); position_remote_robot != _position_remote_robot_map.end(); position_remote_robot++) {
-        remote_robot* robot = position_remote_robot->second.get();
+    for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+        const robot_descriptor* robot = &position_robot->second;
         if (!robot->is_adaptivity_pending() && robot->is_capable_to(next_action)) {
             suitable_robot = robot;
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found next suitable robot at position %d %s", suitable_robot->get_position(), suitable_robot->get_capabilites_string().c_str());
@@ -48,13 +128,13 @@ kitchen_mape::simple_rearranging(const std::map<position_t, std::unique_ptr<remo
     // Filter out all actions the suitable robot can do
     do {
         action_queue_copy.pop();
-    } while (!action_queue_copy.empty() && suitable_robot->is_capable_to(action_queue_copy.front().get_name()));
+    } while (!action_queue_copy.empty() && suitable_robot->is_capable_to(action_queue_copy.front().get_action_mask()));
     // Determine suitable robot after next
-    remote_robot* suitable_robot_after_next = nullptr;
+    const robot_descriptor* suitable_robot_after_next = nullptr;
     if (suitable_robot != nullptr && !action_queue_copy.empty()) {
-        for (auto position_remote_robot = _position_remote_robot_map.begin(); position_remote_robot != _position_remote_robot_map.end(); position_remote_robot++) {
-            remote_robot* robot = position_remote_robot->second.get();
-            if (!robot->is_adaptivity_pending() && robot->is_capable_to(action_queue_copy.front().get_name())) {
+        for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+            const robot_descriptor* robot = &position_robot->second;
+            if (!robot->is_adaptivity_pending() && robot->is_capable_to(action_queue_copy.front().get_action_mask())) {
                 suitable_robot_after_next = robot;
                 UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found next suitable robot after next at position %d %s", suitable_robot_after_next->get_position(), suitable_robot_after_next->get_capabilites_string().c_str());
                 break;
@@ -70,19 +150,19 @@ kitchen_mape::simple_rearranging(const std::map<position_t, std::unique_ptr<remo
 }
 
 // Simple reconfiguring by swaping capability profiles if suitable robot after next is positioned before next suitable robot
-remote_robot*
-kitchen_mape::simple_reconfiguration(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue) {
+const robot_descriptor*
+kitchen_mape::simple_reconfiguration(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue) {
     if (_recipe_action_queue.empty()) {
         return nullptr;
     }
-    remote_robot* suitable_robot = nullptr;
-    const std::string first_action = _recipe_action_queue.front().get_name();
+    const robot_descriptor* suitable_robot = nullptr;
+    const capability_mask_t first_action = _recipe_action_queue.front().get_action_mask();
     std::string new_possible_profile_for_robot_after_next = "";
     std::string new_possible_profile_for_suitable_robot = "";
-    std::queue<robot_action> action_queue_copy = _recipe_action_queue;
+    recipe_steps action_queue_copy = _recipe_action_queue;
     // Determine capable robot
-    for (auto position_remote_robot = _position_remote_robot_map.begin(); position_remote_robot != _position_remote_robot_map.end(); position_remote_robot++) {
-        remote_robot* robot = position_remote_robot->second.get();
+    for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+        const robot_descriptor* robot = &position_robot->second;
         if (!robot->is_adaptivity_pending() && robot->is_capable_to(first_action)) {
             suitable_robot = robot;
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found next suitable robot at position %d %s", suitable_robot->get_position(), suitable_robot->get_capabilites_string().c_str());
@@ -94,24 +174,22 @@ kitchen_mape::simple_reconfiguration(const std::map<position_t, std::unique_ptr<
         return nullptr;
     }
 
-    for (auto it : get_capabilites()) {
-        if (it.second.is_capable_to(first_action)) {
-            new_possible_profile_for_robot_after_next = it.first;
-            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found possible capabilities profile %s for robot after next", it.first.c_str());
-            break;
-        }
+    const std::vector<size_t>& first_action_profiles = capability_planner_.get_profiles_capable_to(first_action);
+    if (!first_action_profiles.empty()) {
+        new_possible_profile_for_robot_after_next = capability_planner_.get_profile(first_action_profiles.front()).name_;
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found possible capabilities profile %s for robot after next", new_possible_profile_for_robot_after_next.c_str());
     }
 
     // Filter out all actions the suitable robot can do
     do {
         action_queue_copy.pop();
-    } while (!action_queue_copy.empty() && suitable_robot->is_capable_to(action_queue_copy.front().get_name()));
+    } while (!action_queue_copy.empty() && suitable_robot->is_capable_to(action_queue_copy.front().get_action_mask()));
     // Determine suitable robot after next
-    const std::string after_next_action = !action_queue_copy.empty() ? action_queue_copy.front().get_name() : "";
-    remote_robot* suitable_robot_after_next = nullptr;
+    const capability_mask_t after_next_action = !action_queue_copy.empty() ? action_queue_copy.front().get_action_mask() : 0;
+    const robot_descriptor* suitable_robot_after_next = nullptr;
     if (suitable_robot != nullptr && !action_queue_copy.empty()) {
-        for (auto position_remote_robot = _position_remote_robot_map.begin(); position_remote_robot != _position_remote_robot_map.end(); position_remote_robot++) {
-            remote_robot* robot = position_remote_robot->second.get();
+        for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+            const robot_descriptor* robot = &position_robot->second;
             if (!robot->is_adaptivity_pending() && robot->is_capable_to(after_next_action)) {
                 suitable_robot_after_next = robot;
                 UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found next suitable robot after next at position %d %s", suitable_robot_after_next->get_position(), suitable_robot_after_next->get_capabilites_string().c_str());
@@ -122,17 +200,314 @@ kitchen_mape::simple_reconfiguration(const std::map<position_t, std::unique_ptr<
     
     if (suitable_robot != nullptr && suitable_robot_after_next != nullptr
         && (suitable_robot->get_position() > suitable_robot_after_next->get_position())) {
-        for (auto it : get_capabilites()) {
-            if (it.second.is_capable_to(after_next_action)) {
-                new_possible_profile_for_suitable_robot = it.first;
-                UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found possible capabilities profile %s for suitable robot", it.first.c_str());
-                break;
-            }
+        const std::vector<size_t>& after_next_action_profiles = capability_planner_.get_profiles_capable_to(after_next_action);
+        if (!after_next_action_profiles.empty()) {
+            new_possible_profile_for_suitable_robot = capability_planner_.get_profile(after_next_action_profiles.front()).name_;
+            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found possible capabilities profile %s for suitable robot", new_possible_profile_for_suitable_robot.c_str());
         }
-        if (!after_next_action.empty() && (first_action.compare(after_next_action)) && !new_possible_profile_for_suitable_robot.empty() && !new_possible_profile_for_robot_after_next.empty())
+        if (after_next_action != 0 && first_action != after_next_action && !new_possible_profile_for_suitable_robot.empty() && !new_possible_profile_for_robot_after_next.empty())
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Swap capability profiles at position %d and %d with %s and %s, respectively", suitable_robot->get_position(), suitable_robot_after_next->get_position(), new_possible_profile_for_suitable_robot.c_str(), new_possible_profile_for_robot_after_next.c_str());
         reconfigure_robot_callback_(suitable_robot->get_position(), new_possible_profile_for_suitable_robot);
         reconfigure_robot_callback_(suitable_robot_after_next->get_position(), new_possible_profile_for_robot_after_next);
     }
     return suitable_robot;
-}
\ No newline at end of file
+}
+// Demand-driven reconfiguration of the robots' profiles with the earliest completion time among the other robots
+const robot_descriptor*
+kitchen_mape::demand_driven_reconfiguration(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) {
+    if (_recipe_action_queue.empty()) {
+        return nullptr;
+    }
+    std::vector<std::pair<position_t, std::string>> reconfigurations;
+    {
+        std::lock_guard<std::mutex> planner_lock(capability_planner_mutex_);
+        if (_recipe_action_queue.get_offset() == 0)
+            capability_planner_.record_order(_recipe_action_queue);
+        if (capability_planner_.is_planning_due())
+            reconfigurations = capability_planner_.plan(_snapshot);
+    }
+    if (reconfigurations.empty())
+        return earliest_completion_time(_snapshot, _recipe_action_queue, _plate_position);
+    // Reconfigured robots are unavailable until they adopted their new profile
+    robot_registry_snapshot adapted_snapshot = _snapshot;
+    for (const auto& [position, profile] : reconfigurations) {
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Reconfigure robot at position %d to %s for the recent demand", position, profile.c_str());
+        reconfigure_robot_callback_(position, profile);
+        adapted_snapshot.robots_.at(position).adaptivity_is_pending_ = true;
+    }
+    const robot_descriptor* suitable_robot = earliest_completion_time(adapted_snapshot, _recipe_action_queue, _plate_position);
+    return suitable_robot == nullptr ? nullptr : _snapshot.find(suitable_robot->get_position());
+}
+
+// Earliest completion time of the next steps considering queued work, retooling and conveyor travel
+const robot_descriptor*
+kitchen_mape::earliest_completion_time(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) {
+    size_t horizon = 0;
+    std::vector<const robot_descriptor*> candidates = get_capable_robots(_snapshot, _recipe_action_queue, horizon);
+    // Compare all candidates on the same steps
+    const position_t conveyor_size = _snapshot.get_conveyor_size();
+    const robot_descriptor* suitable_robot = nullptr;
+    duration_t earliest_completion = 0;
+    for (const robot_descriptor* robot : candidates) {
+        duration_t completion = estimate_completion_time(*robot, _recipe_action_queue, _plate_position, conveyor_size, horizon);
+        if (suitable_robot == nullptr || completion < earliest_completion) {
+            suitable_robot = robot;
+            earliest_completion = completion;
+        }
+    }
+    if (suitable_robot != nullptr)
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Found next suitable robot at position %d completing the next %zu steps in %lu", suitable_robot->get_position(), horizon, (unsigned long) earliest_completion);
+    return suitable_robot;
+}
+
+/**
+ * @brief Solves the rectangular assignment problem with the Hungarian method.
+ * 
+ * @param _costs the cost matrix with at most as many rows as columns.
+ * @return std::vector<size_t> the assigned column of every row with minimal total cost.
+ */
+static std::vector<size_t>
+solve_assignment(const std::vector<std::vector<int64_t>>& _costs) {
+    const size_t rows = _costs.size();
+    const size_t columns = rows == 0 ? 0 : _costs[0].size();
+    const int64_t infinity = std::numeric_limits<int64_t>::max();
+    // Potentials and matching are 1-based, column 0 holds the row being inserted
+    std::vector<int64_t> row_potentials(rows + 1, 0);
+    std::vector<int64_t> column_potentials(columns + 1, 0);
+    std::vector<size_t> column_rows(columns + 1, 0);
+    std::vector<size_t> previous_columns(columns + 1, 0);
+    for (size_t row = 1; row <= rows; row++) {
+        column_rows[0] = row;
+        size_t column = 0;
+        std::vector<int64_t> min_slacks(columns + 1, infinity);
+        std::vector<bool> visited(columns + 1, false);
+        do {
+            visited[column] = true;
+            const size_t visited_row = column_rows[column];
+            int64_t delta = infinity;
+            size_t next_column = 0;
+            for (size_t j = 1; j <= columns; j++) {
+                if (visited[j])
+                    continue;
+                int64_t slack = _costs[visited_row - 1][j - 1] - row_potentials[visited_row] - column_potentials[j];
+                if (slack < min_slacks[j]) {
+                    min_slacks[j] = slack;
+                    previous_columns[j] = column;
+                }
+                if (min_slacks[j] < delta) {
+                    delta = min_slacks[j];
+                    next_column = j;
+                }
+            }
+            for (size_t j = 0; j <= columns; j++) {
+                if (visited[j]) {
+                    row_potentials[column_rows[j]] += delta;
+                    column_potentials[j] -= delta;
+                } else {
+                    min_slacks[j] -= delta;
+                }
+            }
+            column = next_column;
+        } while (column_rows[column] != 0);
+        // Augment along the alternating path
+        do {
+            size_t previous_column = previous_columns[column];
+            column_rows[column] = column_rows[previous_column];
+            column = previous_column;
+        } while (column != 0);
+    }
+    std::vector<size_t> assignment(rows, 0);
+    for (size_t j = 1; j <= columns; j++) {
+        if (column_rows[j] != 0)
+            assignment[column_rows[j] - 1] = j - 1;
+    }
+    return assignment;
+}
+
+// Joint assignment minimizing the total estimated completion time of the orders
+std::vector<order_assignment>
+kitchen_mape::on_new_orders(const robot_registry_snapshot& _snapshot, const std::vector<recipe_steps>& _recipe_action_queues) {
+    if (strategy_ == kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION || strategy_ == kitchen_mape_strategy::LAYOUT_OPTIMIZATION) {
+        for (const recipe_steps& recipe_action_queue : _recipe_action_queues) {
+            record_demand(recipe_action_queue);
+        }
+    }
+    std::vector<order_assignment> assignments;
+    std::vector<const robot_descriptor*> robots;
+    for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+        if (!position_robot->second.is_adaptivity_pending())
+            robots.push_back(&position_robot->second);
+    }
+    std::vector<size_t> orders;
+    std::vector<size_t> horizons;
+    std::vector<order_assignment> unassigned;
+    for (size_t order = 0; order < _recipe_action_queues.size(); order++) {
+        size_t horizon = 0;
+        if (!get_capable_robots(_snapshot, _recipe_action_queues[order], horizon).empty()) {
+            orders.push_back(order);
+            horizons.push_back(horizon);
+        } else {
+            unassigned.push_back({order, nullptr});
+        }
+    }
+    if (orders.empty())
+        return unassigned;
+    /* Every robot offers a slot per order, the k-th slot from the last one delays k orders by the order's run on the robot,
+    which makes minimizing the total completion time an assignment problem */
+    const position_t conveyor_size = _snapshot.get_conveyor_size();
+    const size_t slots = orders.size();
+    std::vector<std::vector<int64_t>> costs(orders.size(), std::vector<int64_t>(robots.size() * slots, ASSIGNMENT_INFEASIBLE_COST));
+    for (size_t row = 0; row < orders.size(); row++) {
+        const recipe_steps& recipe_action_queue = _recipe_action_queues[orders[row]];
+        for (size_t robot = 0; robot < robots.size(); robot++) {
+            if (!robots[robot]->is_capable_to(recipe_action_queue.front().get_action_mask()))
+                continue;
+            recipe_steps remaining_steps = recipe_action_queue;
+            duration_t ready_time = estimate_ready_time(*robots[robot], 0, conveyor_size);
+            duration_t run_time = estimate_run_time(*robots[robot], remaining_steps);
+            size_t run_steps = recipe_action_queue.size() - remaining_steps.size();
+            duration_t tail_time = estimate_bare_time(remaining_steps, horizons[row] - run_steps);
+            for (size_t slot = 0; slot < slots; slot++) {
+                costs[row][robot * slots + slot] = ready_time + (slot + 1) * run_time + tail_time;
+            }
+        }
+    }
+    std::vector<size_t> assignment = solve_assignment(costs);
+    // Instruct the orders in the sequence of their slots, the slot furthest from the last one first
+    std::vector<size_t> rows(orders.size());
+    for (size_t row = 0; row < rows.size(); row++) {
+        rows[row] = row;
+    }
+    std::stable_sort(rows.begin(), rows.end(), [&assignment, slots](size_t _first, size_t _second) {
+        return assignment[_first] % slots > assignment[_second] % slots;
+    });
+    for (size_t row : rows) {
+        if (costs[row][assignment[row]] >= ASSIGNMENT_INFEASIBLE_COST) {
+            unassigned.push_back({orders[row], nullptr});
+            continue;
+        }
+        assignments.push_back({orders[row], robots[assignment[row] / slots]});
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Assigned order %zu of the batch to the robot at position %d", orders[row], assignments.back().robot_->get_position());
+    }
+    assignments.insert(assignments.end(), unassigned.begin(), unassigned.end());
+    return assignments;
+}
+
+std::vector<const robot_descriptor*>
+kitchen_mape::on_new_route(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) {
+    if (strategy_ == kitchen_mape_strategy::EARLIEST_COMPLETION_TIME)
+        return earliest_completion_route(_snapshot, _recipe_action_queue, _plate_position);
+    if ((strategy_ == kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION || strategy_ == kitchen_mape_strategy::LAYOUT_OPTIMIZATION) && _recipe_action_queue.get_offset() == 0)
+        record_demand(_recipe_action_queue);
+    return mape::on_new_route(_snapshot, _recipe_action_queue, _plate_position);
+}
+
+// Earliest completion time of every run of steps along the planned timeline of the order
+std::vector<const robot_descriptor*>
+kitchen_mape::earliest_completion_route(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) {
+    const position_t conveyor_size = _snapshot.get_conveyor_size();
+    std::vector<const robot_descriptor*> route;
+    // Robots planned twice start their second run after the first
+    std::unordered_map<position_t, robot_descriptor> planned_robots;
+    auto planned_robot = [&planned_robots](const robot_descriptor& _robot) {
+        auto planned = planned_robots.find(_robot.get_position());
+        return planned == planned_robots.end() ? _robot : planned->second;
+    };
+    duration_t plate_ready_time = 0;
+    while (!_recipe_action_queue.empty()) {
+        size_t horizon = 0;
+        std::vector<const robot_descriptor*> candidates = get_capable_robots(_snapshot, _recipe_action_queue, horizon);
+        const robot_descriptor* suitable_robot = nullptr;
+        duration_t earliest_completion = 0;
+        for (const robot_descriptor* robot : candidates) {
+            // Estimate relative to the time the plate is ready for its next run
+            robot_descriptor planned = planned_robot(*robot);
+            planned.overall_time_ = planned.overall_time_ > plate_ready_time ? planned.overall_time_ - plate_ready_time : 0;
+            duration_t completion = estimate_completion_time(planned, _recipe_action_queue, _plate_position, conveyor_size, horizon);
+            if (suitable_robot == nullptr || completion < earliest_completion) {
+                suitable_robot = robot;
+                earliest_completion = completion;
+            }
+        }
+        if (suitable_robot == nullptr) {
+            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: No capable robot to plan the route after %zu robots", route.size());
+            return {};
+        }
+        // Book the run on the chosen robot
+        robot_descriptor planned = planned_robot(*suitable_robot);
+        planned.overall_time_ = planned.overall_time_ > plate_ready_time ? planned.overall_time_ - plate_ready_time : 0;
+        duration_t run_completion_time = plate_ready_time + estimate_ready_time(planned, _plate_position, conveyor_size);
+        while (!_recipe_action_queue.empty() && planned.is_capable_to(_recipe_action_queue.front().get_action_mask())) {
+            run_completion_time += planned.last_equipped_tool_ != _recipe_action_queue.front().get_required_tool() ? RETOOLING_TIME : 0;
+            run_completion_time += _recipe_action_queue.front().get_action_duration();
+            planned.last_equipped_tool_ = _recipe_action_queue.front().get_required_tool();
+            _recipe_action_queue.pop();
+        }
+        planned.overall_time_ = run_completion_time;
+        planned_robots.insert_or_assign(planned.get_position(), planned);
+        plate_ready_time = run_completion_time;
+        _plate_position = suitable_robot->get_position();
+        route.push_back(suitable_robot);
+    }
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "MAPE: Planned route of %zu robots completing in %lu", route.size(), (unsigned long) plate_ready_time);
+    return route;
+}
+
+std::vector<const robot_descriptor*>
+kitchen_mape::get_capable_robots(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, size_t& _horizon) {
+    std::vector<const robot_descriptor*> candidates;
+    _horizon = 0;
+    if (_recipe_action_queue.empty())
+        return candidates;
+    const capability_mask_t first_action = _recipe_action_queue.front().get_action_mask();
+    for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+        const robot_descriptor* robot = &position_robot->second;
+        if (robot->is_adaptivity_pending() || !robot->is_capable_to(first_action))
+            continue;
+        candidates.push_back(robot);
+        size_t run = 0;
+        while (run < _recipe_action_queue.size() && robot->is_capable_to(_recipe_action_queue[run].get_action_mask())) {
+            run++;
+        }
+        _horizon = std::max(_horizon, run);
+    }
+    return candidates;
+}
+
+duration_t
+kitchen_mape::estimate_ready_time(const robot_descriptor& _robot, position_t _plate_position, position_t _conveyor_size) {
+    duration_t travel_time = ((_robot.get_position() + _conveyor_size - _plate_position % _conveyor_size) % _conveyor_size) * CONVEYOR_MOVE_TIME;
+    return std::max(_robot.get_overall_time(), travel_time);
+}
+
+duration_t
+kitchen_mape::estimate_run_time(const robot_descriptor& _robot, recipe_steps& _recipe_action_queue) {
+    duration_t run_time = 0;
+    robot_tool equipped_tool = _robot.get_last_equipped_tool();
+    while (!_recipe_action_queue.empty() && _robot.is_capable_to(_recipe_action_queue.front().get_action_mask())) {
+        run_time += equipped_tool != _recipe_action_queue.front().get_required_tool() ? RETOOLING_TIME : 0;
+        run_time += _recipe_action_queue.front().get_action_duration();
+        equipped_tool = _recipe_action_queue.front().get_required_tool();
+        _recipe_action_queue.pop();
+    }
+    return run_time;
+}
+
+duration_t
+kitchen_mape::estimate_bare_time(recipe_steps _recipe_action_queue, size_t _steps) {
+    duration_t bare_time = 0;
+    for (size_t step = 0; step < _steps && !_recipe_action_queue.empty(); step++) {
+        bare_time += _recipe_action_queue.front().get_action_duration();
+        _recipe_action_queue.pop();
+    }
+    return bare_time;
+}
+
+duration_t
+kitchen_mape::estimate_completion_time(const robot_descriptor& _robot, recipe_steps _recipe_action_queue, position_t _plate_position, position_t _conveyor_size, size_t _horizon) {
+    const size_t steps = _recipe_action_queue.size();
+    duration_t completion_time = estimate_ready_time(_robot, _plate_position, _conveyor_size);
+    completion_time += estimate_run_time(_robot, _recipe_action_queue);
+    size_t run_steps = steps - _recipe_action_queue.size();
+    return completion_time + estimate_bare_time(_recipe_action_queue, _horizon > run_steps ? _horizon - run_steps : 0);
+}
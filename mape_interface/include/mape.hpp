@@ -6,21 +6,31 @@
 #include <cstdio>
 #include <queue>
 #include <memory>
+#include <vector>
 #include <functional>
 #include <filesystem>
 #include <limits.h>
 #include <unistd.h>
 #include "types.hpp"
 #include "robot_actions.hpp"
+#include "recipe_parser.hpp"
 #include "capability_parser.hpp"
+#include "robot_registry.hpp"
 
 using namespace cps_kitchen;
 
-struct remote_robot;
-
 typedef std::function<void(position_t, position_t)> swap_robot_positions_callback_t; /**< the callback declaration to swap robot positions pair-wise. */
 typedef std::function<void(position_t, std::string)> reconfigure_robot_callback_t; /**< the callback declaration to reconfigure a robot. */
 
+/**
+ * @brief The robot assigned to an order of a batch.
+ * 
+ */
+struct order_assignment {
+    size_t order_; /**< the index of the order within the batch. */
+    const robot_descriptor* robot_; /**< the descriptor within the snapshot of the assigned robot, nullptr if no robot is capable. */
+};
+
 class mape {
 private:
     std::unordered_map<std::string, capability_parser> capabilites_map_; /**< the capabilities map holding all available profiles. */
@@ -68,11 +78,102 @@ public:
     /**
      * @brief Callback when new order is placed.
      * 
-     * @param _position_remote_robot_map the position remote robot map by the controller.
-     * @param _recipe_action_queue the action queue with remaining steps to perform on the order.
-     * @return remote_robot* the remote robot for the next order steps.
+     * @param _snapshot the registry snapshot of the robots, unchanged during the decision.
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     * @param _plate_position the conveyor position of the order's plate, 0 for new orders.
+     * @return const robot_descriptor* the descriptor within the snapshot of the robot for the next order steps.
+     */
+    virtual const robot_descriptor* on_new_order(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) = 0;
+
+    /**
+     * @brief Callback when a batch of orders is placed at once. The orders are assigned jointly on the same snapshot
+     * and the decisions are returned within one response, so no adaptations must be triggered. By default every order
+     * is assigned to the capable robot at the last position in request order.
+     * 
+     * @param _snapshot the registry snapshot of the robots, unchanged during the decision.
+     * @param _recipe_action_queues the views of the remaining steps to perform on the orders.
+     * @return std::vector<order_assignment> the assignment of every order in the sequence the robots are to be instructed.
+     */
+    virtual std::vector<order_assignment> on_new_orders(const robot_registry_snapshot& _snapshot, const std::vector<recipe_steps>& _recipe_action_queues) {
+        std::vector<order_assignment> assignments;
+        for (size_t order = 0; order < _recipe_action_queues.size(); order++) {
+            assignments.push_back({order, nullptr});
+            if (_recipe_action_queues[order].empty())
+                continue;
+            for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+                const robot_descriptor* robot = &position_robot->second;
+                if (!robot->is_adaptivity_pending() && robot->is_capable_to(_recipe_action_queues[order].front().get_action_mask())) {
+                    assignments.back().robot_ = robot;
+                    break;
+                }
+            }
+        }
+        return assignments;
+    }
+
+    /**
+     * @brief Callback when the whole route of an order is planned at once. The route is returned within one response
+     * and followed without asking again until it is invalidated, so no adaptations must be triggered. By default every
+     * run of steps is planned on the capable robot at the last position.
+     *
+     * @param _snapshot the registry snapshot of the robots, unchanged during the decision.
+     * @param _recipe_action_queue the view of the remaining steps to perform on the order.
+     * @param _plate_position the conveyor position of the order's plate, 0 for new orders.
+     * @return std::vector<const robot_descriptor*> the descriptors within the snapshot of the robots in processing order, one per run of steps,
+     * empty if a step has no capable robot.
+     */
+    virtual std::vector<const robot_descriptor*> on_new_route(const robot_registry_snapshot& _snapshot, recipe_steps _recipe_action_queue, position_t _plate_position) {
+        std::vector<const robot_descriptor*> route;
+        while (!_recipe_action_queue.empty()) {
+            const robot_descriptor* next_robot = nullptr;
+            for (auto position_robot = _snapshot.robots_.begin(); position_robot != _snapshot.robots_.end(); position_robot++) {
+                const robot_descriptor* robot = &position_robot->second;
+                if (!robot->is_adaptivity_pending() && robot->is_capable_to(_recipe_action_queue.front().get_action_mask())) {
+                    next_robot = robot;
+                    break;
+                }
+            }
+            if (next_robot == nullptr)
+                return {};
+            while (!_recipe_action_queue.empty() && next_robot->is_capable_to(_recipe_action_queue.front().get_action_mask())) {
+                _recipe_action_queue.pop();
+            }
+            route.push_back(next_robot);
+        }
+        return route;
+    }
+
+    /**
+     * @brief Indicates if the decisions of on_new_order only depend on the recipe steps and the robots' positions,
+     * capabilities and adaptivity flags, so that the controller may reuse them until one of these changes.
+     * Decisions depending on the plate position or the robots' load must not be cached.
+     * 
+     * @return true if the decisions may be cached.
+     * @return false if every order has to be decided anew.
+     */
+    virtual bool is_decision_cacheable() const {
+        return true;
+    }
+
+    /**
+     * @brief Returns the period of the layout reviews. The layout is reviewed in the background, off the request path,
+     * so reviews may take longer than decisions.
+     *
+     * @return duration_t the time units between two layout reviews, 0 if the layout is not reviewed.
+     */
+    virtual duration_t get_layout_review_period() const {
+        return 0;
+    }
+
+    /**
+     * @brief Callback when the layout is reviewed periodically. The review may trigger rearrangements or reconfigurations
+     * and runs concurrently to the decisions of the other callbacks, so state shared with them has to be guarded.
+     * By default the layout is kept.
+     *
+     * @param _snapshot the registry snapshot of the robots, unchanged during the review.
      */
-    virtual remote_robot* on_new_order(const std::map<position_t, std::unique_ptr<remote_robot>, std::greater<position_t>>& _position_remote_robot_map, std::queue<robot_action> _recipe_action_queue) = 0;
+    virtual void on_layout_review(const robot_registry_snapshot& _snapshot) {
+    }
 
     /**
      * @brief Sets the swap robot positions callback.
@@ -0,0 +1,312 @@
+/**
+ * @file robot_registry.hpp
+ * @brief Copy-on-write registry of immutable robot descriptor snapshots for the MAPE and other readers.
+ *
+ * @details
+ * Writers copy the current snapshot, apply their change and publish the copy with the next epoch. Readers
+ * take a reference to the published snapshot without blocking writers, and a snapshot never changes while
+ * it is referenced. Writers are serialized among each other, they never wait for readers.
+ */
+#ifndef ROBOT_REGISTRY_HPP
+#define ROBOT_REGISTRY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "types.hpp"
+#include "robot_actions.hpp"
+#include "robot_tool.hpp"
+
+using namespace cps_kitchen;
+
+/**
+ * @brief Returns the string representation of a capability mask.
+ *
+ * @param _capabilities_mask the capability mask.
+ * @return std::string the action names in brackets.
+ */
+inline std::string
+capabilities_to_string(capability_mask_t _capabilities_mask) {
+    std::string capabilities_str = "[";
+    for (const std::string& action_name : robot_actions::get_instance()->get_action_names(_capabilities_mask)) {
+        capabilities_str += capabilities_str.size() > 1 ? ", " + action_name : action_name;
+    }
+    return capabilities_str + "]";
+}
+
+/**
+ * @brief The state of a registered robot at the time of a snapshot.
+ *
+ */
+struct robot_descriptor {
+    std::string endpoint_; /**< the endpoint address. */
+    position_t position_; /**< the position on the conveyor belt reported by the robot. */
+    capability_mask_t capabilities_mask_; /**< the capability mask. */
+    duration_t overall_time_; /**< the total time the robot will be in use. */
+    robot_tool last_equipped_tool_; /**< the last equipped tool. */
+    bool adaptivity_is_pending_; /**< flag to indicate whether adaptivity is pending. */
+
+    /**
+     * @brief Returns the robot's endpoint.
+     *
+     * @return std::string the endpoint url.
+     */
+    std::string
+    get_endpoint() const {
+        return endpoint_;
+    }
+
+    /**
+     * @brief Returns the robot's position.
+     *
+     * @return position_t the robot position.
+     */
+    position_t
+    get_position() const {
+        return position_;
+    }
+
+    /**
+     * @brief Returns the capability mask.
+     *
+     * @return capability_mask_t the capability mask.
+     */
+    capability_mask_t
+    get_capabilities_mask() const {
+        return capabilities_mask_;
+    }
+
+    /**
+     * @brief Returns the capabilites string representation.
+     *
+     * @return std::string the string representation.
+     */
+    std::string
+    get_capabilites_string() const {
+        return capabilities_to_string(capabilities_mask_);
+    }
+
+    /**
+     * @brief Indicates if the robot is capable to perform all actions of the given mask.
+     *
+     * @param _actions_mask the capability mask of the actions to check whether they can be performed.
+     * @return true if the robot is capable to perform the actions.
+     * @return false if the robot is not capable to perform the actions.
+     */
+    bool
+    is_capable_to(capability_mask_t _actions_mask) const {
+        return (capabilities_mask_ & _actions_mask) == _actions_mask;
+    }
+
+    /**
+     * @brief Returns the robot's overall time.
+     *
+     * @return duration_t the robot's overall time.
+     */
+    duration_t
+    get_overall_time() const {
+        return overall_time_;
+    }
+
+    /**
+     * @brief Returns the robot's last equipped tool.
+     *
+     * @return robot_tool the last equipped tool.
+     */
+    robot_tool
+    get_last_equipped_tool() const {
+        return last_equipped_tool_;
+    }
+
+    /**
+     * @brief Returns the adaptivity flag value.
+     *
+     * @return true if adaptivity is still pending.
+     * @return false if there is no adaptivity running.
+     */
+    bool
+    is_adaptivity_pending() const {
+        return adaptivity_is_pending_;
+    }
+};
+
+typedef std::map<position_t, robot_descriptor, std::greater<position_t>> robot_descriptor_map; /**< the robot descriptors by registered position, the last position first. */
+
+/**
+ * @brief An immutable state of all registered robots.
+ *
+ */
+struct robot_registry_snapshot {
+    uint64_t epoch_ = 0; /**< the epoch incremented by every publication. */
+    uint64_t registry_version_ = 0; /**< the version incremented by every change routing decisions depend on, i.e. registrations, removals, positions, capabilities and adaptivity flags. */
+    robot_descriptor_map robots_; /**< the robot descriptors. */
+    position_t conveyor_size_ = 0; /**< the count of conveyor positions reported by the robots, 0 while unknown. */
+
+    /**
+     * @brief Returns the descriptor of the robot registered at the given position.
+     *
+     * @param _position the registered position.
+     * @return const robot_descriptor* the descriptor, nullptr if no robot is registered at the position.
+     */
+    const robot_descriptor*
+    find(position_t _position) const {
+        auto robot = robots_.find(_position);
+        return robot == robots_.end() ? nullptr : &robot->second;
+    }
+
+    /**
+     * @brief Returns the count of conveyor positions including the output position 0. Positions without robot
+     * are counted as well, so the conveyor size may exceed the last robot position by more than one.
+     *
+     * @return position_t the reported conveyor size, at least one more than the last robot position.
+     */
+    position_t
+    get_conveyor_size() const {
+        return std::max<position_t>(conveyor_size_, robots_.empty() ? 1 : robots_.begin()->first + 1);
+    }
+};
+
+/**
+ * @brief Publishes robot registry snapshots for lock-free readers.
+ *
+ */
+class robot_registry {
+private:
+    std::atomic<std::shared_ptr<const robot_registry_snapshot>> snapshot_; /**< the published snapshot. */
+    std::mutex writer_mutex_; /**< the mutex serializing the writers. */
+
+    /**
+     * @brief Publishes a copy of the current snapshot modified by the given update.
+     *
+     * @param _update the update applied to the copy, returns whether routing decisions are affected.
+     */
+    void
+    publish(const std::function<bool(robot_registry_snapshot&)>& _update) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        std::shared_ptr<robot_registry_snapshot> next = std::make_shared<robot_registry_snapshot>(*snapshot_.load());
+        next->epoch_++;
+        if (_update(*next))
+            next->registry_version_++;
+        snapshot_.store(std::move(next));
+    }
+
+public:
+    /**
+     * @brief Constructs a new robot registry object with an empty snapshot.
+     *
+     */
+    robot_registry() : snapshot_(std::make_shared<const robot_registry_snapshot>()) {
+    }
+
+    /**
+     * @brief Returns the published snapshot without blocking.
+     *
+     * @return std::shared_ptr<const robot_registry_snapshot> the snapshot, unchanged while referenced.
+     */
+    std::shared_ptr<const robot_registry_snapshot>
+    get_snapshot() const {
+        return snapshot_.load();
+    }
+
+    /**
+     * @brief Publishes the given robot descriptors, replacing all registered robots.
+     *
+     * @param _robots the robot descriptors by registered position.
+     */
+    void
+    replace_robots(robot_descriptor_map _robots) {
+        publish([&_robots](robot_registry_snapshot& _snapshot) {
+            _snapshot.robots_ = std::move(_robots);
+            return true;
+        });
+    }
+
+    /**
+     * @brief Publishes the robot descriptors built within the writer lock, replacing all registered robots.
+     * Building them in the lock keeps concurrent publications of the same source in order, so no change is lost.
+     *
+     * @param _build_robots returns the robot descriptors by registered position.
+     */
+    void
+    replace_robots(const std::function<robot_descriptor_map()>& _build_robots) {
+        publish([&_build_robots](robot_registry_snapshot& _snapshot) {
+            _snapshot.robots_ = _build_robots();
+            return true;
+        });
+    }
+
+    /**
+     * @brief Publishes the conveyor size reported by the robots, if it changed.
+     *
+     * @param _conveyor_size the count of conveyor positions including the output position 0.
+     */
+    void
+    set_conveyor_size(position_t _conveyor_size) {
+        if (snapshot_.load()->conveyor_size_ == _conveyor_size)
+            return;
+        publish([_conveyor_size](robot_registry_snapshot& _snapshot) {
+            _snapshot.conveyor_size_ = _conveyor_size;
+            return true;
+        });
+    }
+
+    /**
+     * @brief Publishes the changed descriptor of a registered robot, identified by its endpoint.
+     * Unregistered robots are ignored.
+     *
+     * @param _robot the changed robot descriptor.
+     */
+    void
+    update_robot(const robot_descriptor& _robot) {
+        update_robot([&_robot] {
+            return _robot;
+        });
+    }
+
+    /**
+     * @brief Publishes the changed descriptor of a registered robot built within the writer lock, identified by its endpoint.
+     * Unregistered robots are ignored.
+     *
+     * @param _build_robot returns the changed robot descriptor.
+     */
+    void
+    update_robot(const std::function<robot_descriptor()>& _build_robot) {
+        publish([&_build_robot](robot_registry_snapshot& _snapshot) {
+            robot_descriptor robot = _build_robot();
+            for (std::pair<const position_t, robot_descriptor>& entry : _snapshot.robots_) {
+                if (entry.second.endpoint_ != robot.endpoint_)
+                    continue;
+                bool routing_changed = entry.second.position_ != robot.position_
+                    || entry.second.capabilities_mask_ != robot.capabilities_mask_
+                    || entry.second.adaptivity_is_pending_ != robot.adaptivity_is_pending_;
+                entry.second = robot;
+                return routing_changed;
+            }
+            return false;
+        });
+    }
+
+    /**
+     * @brief Publishes the removal of a registered robot, identified by its endpoint.
+     *
+     * @param _endpoint the endpoint of the removed robot.
+     */
+    void
+    remove_robot(const std::string& _endpoint) {
+        publish([&_endpoint](robot_registry_snapshot& _snapshot) {
+            for (auto entry = _snapshot.robots_.begin(); entry != _snapshot.robots_.end(); entry++) {
+                if (entry->second.endpoint_ == _endpoint) {
+                    _snapshot.robots_.erase(entry);
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+};
+
+#endif // ROBOT_REGISTRY_HPP
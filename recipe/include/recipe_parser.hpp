@@ -3,19 +3,136 @@
  * @brief Declarations for building executable cooking plans from JSON recipes.
  *
  * The recipe_parser reads recipes.json located one directory above the binary’s
- * directory and validates each instruction to build a queue of robot action steps.
+ * directory and validates each instruction to build an immutable array of robot action steps.
+ * The recipes are parsed once per process and shared by all recipe parsers. The remaining
+ * steps of a recipe are handed out as recipe_steps views without copying any step.
  *
  * It computes:
  * - cooking_time: total of all action durations
  * - retooling_time: adds RETOOLING_TIME when consecutive actions require different tools
+ * - required_capabilities: the capability mask of all actions
  */
 #ifndef RECIPE_PARSER_HPP
 #define RECIPE_PARSER_HPP
 
-#include <queue>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "robot_actions.hpp"
 
+typedef std::vector<robot_action> recipe_plan; /**< the immutable steps of a recipe. */
+
+/**
+ * @brief View of the remaining steps of a recipe plan, consisting of the plan address and the offset of the
+ * first remaining step. Copying and advancing a view never allocates. Views stay valid while a recipe_parser exists.
+ */
+class recipe_steps {
+    private:
+        const recipe_plan* plan_; /**< the viewed plan. */
+        size_t offset_; /**< the offset of the first remaining step. */
+    public:
+        /**
+         * @brief Constructs an empty recipe steps view.
+         * 
+         */
+        recipe_steps() : plan_(nullptr), offset_(0) {
+        }
+
+        /**
+         * @brief Constructs a view of the plan's steps starting at the offset.
+         * 
+         * @param _plan the viewed plan.
+         * @param _offset the offset of the first remaining step, clamped to the plan size.
+         */
+        recipe_steps(const recipe_plan* _plan, size_t _offset) : plan_(_plan), offset_(std::min(_offset, _plan->size())) {
+        }
+
+        /**
+         * @brief Returns whether no steps remain.
+         * 
+         * @return true if no steps remain.
+         * @return false if steps remain.
+         */
+        bool empty() const {
+            return size() == 0;
+        }
+
+        /**
+         * @brief Returns the remaining steps count.
+         * 
+         * @return size_t the remaining steps count.
+         */
+        size_t size() const {
+            return plan_ == nullptr ? 0 : plan_->size() - offset_;
+        }
+
+        /**
+         * @brief Returns the next remaining step. Must not be called on an empty view.
+         * 
+         * @return const robot_action& the next step.
+         */
+        const robot_action& front() const {
+            return (*plan_)[offset_];
+        }
+
+        /**
+         * @brief Returns the remaining step at the given index. The index must be less than size().
+         * 
+         * @param _index the index relative to the next remaining step.
+         * @return const robot_action& the step.
+         */
+        const robot_action& operator[](size_t _index) const {
+            return (*plan_)[offset_ + _index];
+        }
+
+        /**
+         * @brief Removes the next step from the view.
+         * 
+         */
+        void pop() {
+            offset_ = std::min(offset_ + 1, plan_->size());
+        }
+
+        /**
+         * @brief Returns a view without the given count of next steps.
+         * 
+         * @param _count the count of steps to skip.
+         * @return recipe_steps the view of the steps after the skipped ones.
+         */
+        recipe_steps drop_front(size_t _count) const {
+            return plan_ == nullptr ? recipe_steps() : recipe_steps(plan_, offset_ + _count);
+        }
+
+        /**
+         * @brief Returns the offset of the next step within the plan, i.e. the processed steps.
+         * 
+         * @return size_t the offset.
+         */
+        size_t get_offset() const {
+            return offset_;
+        }
+
+        /**
+         * @brief Returns the address of the next step for range-based iteration.
+         * 
+         * @return const robot_action* the begin iterator.
+         */
+        const robot_action* begin() const {
+            return plan_ == nullptr ? nullptr : plan_->data() + offset_;
+        }
+
+        /**
+         * @brief Returns the address past the last step for range-based iteration.
+         * 
+         * @return const robot_action* the end iterator.
+         */
+        const robot_action* end() const {
+            return plan_ == nullptr ? nullptr : plan_->data() + plan_->size();
+        }
+};
+
 /**
  * @brief A recipe object representing a recipe's details.
  * 
@@ -24,11 +141,15 @@ struct recipe {
     private:
         recipe_id_t recipe_id_; /**< the recipe id. */
         std::string dish_name_; /**< the dish name. */
-        std::queue<robot_action> action_queue_; /**< the action queue. */
+        std::shared_ptr<const recipe_plan> plan_; /**< the immutable steps shared by all copies of the recipe. */
         duration_t cooking_time_; /**< the cooking time. */
         duration_t retooling_time_; /**< the retooling time. */
+        capability_mask_t required_capabilities_; /**< the capability mask of all actions. */
     public:
-        recipe(recipe_id_t _recipe_id, std::string _dish_name, std::queue<robot_action> _action_queue, duration_t _cooking_time, duration_t _retooling_time) : recipe_id_(_recipe_id), dish_name_(_dish_name), action_queue_(_action_queue), cooking_time_(_cooking_time), retooling_time_(_retooling_time){
+        recipe(recipe_id_t _recipe_id, std::string _dish_name, recipe_plan _plan, duration_t _cooking_time, duration_t _retooling_time) : recipe_id_(_recipe_id), dish_name_(_dish_name), plan_(std::make_shared<const recipe_plan>(std::move(_plan))), cooking_time_(_cooking_time), retooling_time_(_retooling_time), required_capabilities_(0) {
+            for (const robot_action& step : *plan_) {
+                required_capabilities_ |= step.get_action_mask();
+            }
         }
 
         /**
@@ -50,12 +171,32 @@ struct recipe {
         }
 
         /**
-         * @brief Returns the action queue.
+         * @brief Returns the remaining steps after the processed ones.
+         * 
+         * @param _processed_steps the count of already processed steps.
+         * @return recipe_steps the view of the remaining steps.
+         */
+        recipe_steps get_steps(size_t _processed_steps = 0) const {
+            return recipe_steps(plan_.get(), _processed_steps);
+        }
+
+        /**
+         * @brief Returns the total steps count.
          * 
-         * @return std::queue<robot_action> the action queue.
+         * @return size_t the steps count.
          */
-        std::queue<robot_action> get_action_queue() const {
-            return action_queue_;
+        size_t get_step_count() const {
+            return plan_->size();
+        }
+
+        /**
+         * @brief Returns the capability mask of all actions, a robot group can cook the recipe if the union of
+         * their capability masks contains it.
+         * 
+         * @return capability_mask_t the required capability mask.
+         */
+        capability_mask_t get_required_capabilities() const {
+            return required_capabilities_;
         }
 
         /**
@@ -87,9 +228,11 @@ struct recipe {
 
 };
 
+typedef std::unordered_map<cps_kitchen::recipe_id_t, recipe> recipe_catalog; /**< the recipes by id. */
+
 class recipe_parser {
     private:
-        std::unordered_map<cps_kitchen::recipe_id_t, std::unique_ptr<recipe>> recipe_map_; /**< the recipe map.  */
+        std::shared_ptr<const recipe_catalog> recipe_map_; /**< the recipe map shared by all recipe parsers of the process. */
     public:
         /**
          * @brief Constructs a new recipe parser object.
@@ -116,9 +259,18 @@ class recipe_parser {
          * @brief Returns the recipe object for the given recipe id.
          * 
          * @param _recipe_id the recipe id.
-         * @return recipe the recipe for the given id.
+         * @return const recipe& the recipe for the given id.
+         */
+        const recipe& get_recipe(cps_kitchen::recipe_id_t _recipe_id) const;
+
+        /**
+         * @brief Returns the remaining steps of a recipe without copying any step.
+         * 
+         * @param _recipe_id the recipe id.
+         * @param _processed_steps the count of already processed steps.
+         * @return recipe_steps the view of the remaining steps.
          */
-        recipe get_recipe(cps_kitchen::recipe_id_t _recipe_id);
+        recipe_steps get_remaining_steps(cps_kitchen::recipe_id_t _recipe_id, size_t _processed_steps) const;
 
         /**
          * @brief Returns the recipe count.
@@ -8,6 +8,7 @@
 #include <limits.h>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
 
 #include "types.hpp"
 
@@ -17,14 +18,23 @@
 #define INGREDIENTS_KEY "ingredients"
 #define DURATION_KEY "duration"
 
+static std::mutex shared_catalog_mutex; /**< the mutex protecting the shared catalog. */
+static std::weak_ptr<const recipe_catalog> shared_catalog; /**< the catalog shared while any recipe parser exists. */
 
-recipe_parser::recipe_parser() {
+/**
+ * @brief Parses and validates the recipes file.
+ * 
+ * @return std::shared_ptr<const recipe_catalog> the parsed recipes.
+ */
+static std::shared_ptr<const recipe_catalog>
+parse_recipes() {
+    std::shared_ptr<recipe_catalog> catalog = std::make_shared<recipe_catalog>();
     robot_actions* actions = robot_actions::get_instance();
     char buffer[PATH_MAX + 1];  // +1 for the null terminator
     ssize_t len = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
     if (len == -1) {
         perror("readlink");
-        return;
+        return catalog;
     }
     buffer[len] = '\0';  // null terminate
     std::filesystem::path exe_path(buffer);
@@ -40,7 +50,7 @@ recipe_parser::recipe_parser() {
         if (!recipes.isMember(std::to_string(recipe_id)))
             continue;
         std::string dish_name = recipes[std::to_string(recipe_id)][DISH_NAME_KEY].asString();
-        std::queue<robot_action> action_queue;
+        recipe_plan plan;
         duration_t cooking_time = 0;
         duration_t retooling_time = 0;
         for (auto instruction : recipes[std::to_string(recipe_id)][INSTRUCTIONS_KEY]) {
@@ -78,12 +88,22 @@ recipe_parser::recipe_parser() {
                 required_tool = recipe_timed_act->get_required_tool();
             }
             cooking_time += action_time;
-            if (!action_queue.empty()) {
-                retooling_time += required_tool != action_queue.back().get_required_tool() ? RETOOLING_TIME : 0;
+            if (!plan.empty()) {
+                retooling_time += required_tool != plan.back().get_required_tool() ? RETOOLING_TIME : 0;
             }
-            action_queue.push(robot_action(action_name, required_tool, instruction[INGREDIENTS_KEY].asString(), action_time));
+            plan.push_back(robot_action(action_name, actions->get_action_id(action_name), required_tool, instruction[INGREDIENTS_KEY].asString(), action_time));
         }
-        recipe_map_[recipe_id] = std::make_unique<recipe>(recipe_id, dish_name, action_queue, cooking_time, retooling_time);
+        catalog->emplace(recipe_id, recipe(recipe_id, dish_name, std::move(plan), cooking_time, retooling_time));
+    }
+    return catalog;
+}
+
+recipe_parser::recipe_parser() {
+    std::lock_guard<std::mutex> lock(shared_catalog_mutex);
+    recipe_map_ = shared_catalog.lock();
+    if (recipe_map_ == nullptr) {
+        recipe_map_ = parse_recipes();
+        shared_catalog = recipe_map_;
     }
 }
 
@@ -91,13 +111,17 @@ recipe_parser::~recipe_parser() {
 }
 
 bool recipe_parser::has_recipe(const cps_kitchen::recipe_id_t _recipe_id) const {
-    return recipe_map_.find(_recipe_id) != recipe_map_.end();
+    return recipe_map_->find(_recipe_id) != recipe_map_->end();
+}
+
+const recipe& recipe_parser::get_recipe(cps_kitchen::recipe_id_t _recipe_id) const {
+    return recipe_map_->at(_recipe_id);
 }
 
-recipe recipe_parser::get_recipe(cps_kitchen::recipe_id_t _recipe_id) {
-    return recipe_map_.at(_recipe_id).operator*();
+recipe_steps recipe_parser::get_remaining_steps(cps_kitchen::recipe_id_t _recipe_id, size_t _processed_steps) const {
+    return recipe_map_->at(_recipe_id).get_steps(_processed_steps);
 }
 
 size_t recipe_parser::get_recipe_count() {
-    return recipe_map_.size();
+    return recipe_map_->size();
 }
\ No newline at end of file
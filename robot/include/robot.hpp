@@ -20,6 +20,8 @@
 #include <queue>
 #include <boost/asio.hpp>
 #include <atomic>
+#include <chrono>
+#include <mutex>
 #include <random>
 
 #include "method_node_caller.hpp"
@@ -31,6 +33,8 @@
 #include "node_browser_helper.hpp"
 #include "discovery_util.hpp"
 #include "robot_state.hpp"
+#include "kitchen_clock.hpp"
+#include "route_plan.hpp"
 
 using namespace cps_kitchen;
 
@@ -44,7 +48,8 @@ struct order {
         UA_UInt32 overall_processed_steps_; /**< the already processed steps on the dish. */
         UA_UInt32 overall_processing_steps_; /**< the overall steps to be processed on the dish. */
         UA_UInt32 processable_steps_; /**< the processable steps on the current robot. */
-        std::queue<robot_action> action_queue_; /**< the open actions for the dish to be finished w/o the actions already performed. */
+        recipe_steps action_queue_; /**< the open actions for the dish to be finished w/o the actions already performed. */
+        route_plan remaining_route_; /**< the planned robots after this robot, empty if the next robot is chosen on handover. */
     public:
         /**
          * @brief Constructs a new order object.
@@ -53,10 +58,12 @@ struct order {
          * @param _overall_processed_steps the already processed steps on the recipe.
          * @param _overall_processing_steps the total processing steps to complete the recipe.
          * @param _processable_steps the steps count this robot is able to do.
-         * @param _action_queue the action queue containing the remaining steps.
+         * @param _action_queue the view of the remaining steps.
+         * @param _remaining_route the planned robots after this robot.
          */
-        order(recipe_id_t _recipe_id, UA_UInt32 _overall_processed_steps, UA_UInt32 _overall_processing_steps, UA_UInt32 _processable_steps, std::queue<robot_action> _action_queue) :
-            recipe_id_(_recipe_id), overall_processed_steps_(_overall_processed_steps), overall_processing_steps_(_overall_processing_steps), processable_steps_(_processable_steps), action_queue_(_action_queue) {
+        order(recipe_id_t _recipe_id, UA_UInt32 _overall_processed_steps, UA_UInt32 _overall_processing_steps, UA_UInt32 _processable_steps, recipe_steps _action_queue, route_plan _remaining_route) :
+            recipe_id_(_recipe_id), overall_processed_steps_(_overall_processed_steps), overall_processing_steps_(_overall_processing_steps), processable_steps_(_processable_steps), action_queue_(_action_queue),
+            remaining_route_(std::move(_remaining_route)) {
         }
 
         /**
@@ -98,11 +105,20 @@ struct order {
         /**
          * @brief Returns the open actions for the order to be finished.
          * 
-         * @return std::queue<robot_action> the open actions to be done for this order.
+         * @return recipe_steps the open actions to be done for this order.
          */
-        std::queue<robot_action> get_action_queue() const {
+        recipe_steps get_action_queue() const {
             return action_queue_;
         }
+
+        /**
+         * @brief Returns the planned robots after this robot.
+         * 
+         * @return const route_plan& the remaining route, empty if the next robot is chosen on handover.
+         */
+        const route_plan& get_remaining_route() const {
+            return remaining_route_;
+        }
 };
 
 class robot {
@@ -114,10 +130,18 @@ private:
     std::string robot_uri_; /**< the robot's uniform resource identifier. */
     UA_String server_endpoint_; /**< the robot's endpoint address. */
     object_type_node_inserter robot_type_inserter_; /**< the robot type inserter for adding the robot's attributes and methods to the address space. */
+    attribute_handle processed_steps_handle_; /**< the resolved handle of the processed steps attribute. */
+    std::atomic<recipe_id_t> recipe_id_in_process_; /**< the recipe id in process, served through the recipe id data source. */
+    UA_UInt32 overall_time_; /**< the overall time of all queued actions excluding the timed phase in process. */
+    kitchen_clock::time_point phase_deadline_; /**< the completion deadline of the action or retooling in process. */
+    std::mutex overall_time_mutex_; /**< the mutex to synchronize the overall time between the worker and the overall time data source. */
+    std::atomic<UA_UInt32> last_equipped_tool_; /**< the last tool equipped by the queued actions, served through the last equipped tool data source. */
+    std::atomic<UA_UInt32> overall_processed_steps_; /**< the overall processed steps of the recipe in process, served through the overall processed steps data source. */
     robot_tool current_tool_; /**< the current tool the robot is equipped with. */
     std::queue<order> order_queue_; /**< the queue holding all the assigned orders. */
     duration_t current_action_duration_; /**< the current action duration. */
-    std::queue<robot_action> action_queue_in_process_; /**< the current actions in process. */
+    recipe_steps action_queue_in_process_; /**< the current actions in process. */
+    route_plan remaining_route_in_process_; /**< the planned robots after this robot for the dish in process, handed over with the dish. */
     bool preparing_dish_; /**< flag to indicate whether the robot is busy preparing a dish. */
     bool already_rearranging_; /**< flag to indicate whether the worker thread is already rearranging the robot. */
     bool already_reconfiguring_; /**< flag to indicate whether the worker thread is already reconfiguring the robot. */
@@ -136,7 +160,7 @@ private:
     std::thread worker_thread_; /**< the worker thread for preparing dishes. */
     boost::asio::io_context io_context_; /**< the io context managing the worker thread. */
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type, void, void> work_guard_; /**< the work guard for the io_context_. */
-    boost::asio::steady_timer steady_timer_; /**< the steady timer for action time simulation. */
+    kitchen_timer steady_timer_; /**< the timer for action time simulation. */
     std::mutex client_mutex_; /**< the mutex to synchronize client method calls. */
     std::thread client_iterate_thread_; /**< the client iteration thread. */
     /* controller related member variables. */
@@ -145,6 +169,7 @@ private:
     UA_Client* conveyor_client_; /**< the OPC UA conveyor client pointer. */
     std::condition_variable conveyor_connected_condition_; /**< the condition variable to wait for the conveyor connection to be restored. */
     position_t conveyor_size_; /**< the total count of conveyor positions. */
+    duration_t overall_time_publish_rate_; /**< the time units the published overall time is rounded up to, 1 for exact values. */
     /* random distribution. */
     std::random_device random_device_; /**< the random number generator device. */
     std::mt19937 mersenne_twister_; /**< the mersenne twister for uniform pseudo-random number generation. */
@@ -168,7 +193,7 @@ private:
     set_current_and_last_equipped_tool();
 
     /**
-     * @brief Sets the capabilities node in the address space.
+     * @brief Sets the capabilities and capabilities mask nodes in the address space.
      * 
      */
     void
@@ -203,9 +228,10 @@ private:
      * 
      * @param _recipe_id the recipe ID of the dish to prepare.
      * @param _overall_processed_steps the overall processed steps of the recipe ID so far.
+     * @param _remaining_route the planned robots after this robot.
      */
     void
-    handle_receive_task(recipe_id_t _recipe_id, UA_UInt32 _overall_processed_steps);
+    handle_receive_task(recipe_id_t _recipe_id, UA_UInt32 _overall_processed_steps, route_plan _remaining_route);
 
     /**
      * @brief Cooks the next order in the order queue.
@@ -218,11 +244,11 @@ private:
      * @brief Computes the overall time and determines the last equipped tool according to the actions the robot is capable to
      * and the processable steps count.
      * 
-     * @param _action_queue the action queue.
+     * @param _action_queue the view of the remaining steps.
      * @return UA_UInt32 the processable steps count.
      */
     UA_UInt32
-    compute_overall_time_and_determine_last_tool(std::queue<robot_action> _action_queue);
+    compute_overall_time_and_determine_last_tool(recipe_steps _action_queue);
 
     /**
      * @brief Initiates the handover of the finished order.
@@ -281,11 +307,27 @@ private:
     receive_finished_order_notification_called(size_t _output_size, UA_Variant* _output);
 
     /**
-     * @brief Passes the time for the current action.
+     * @brief Computes the overall time from the queued actions and the deadline of the timed phase in process.
+     * 
+     * @return UA_UInt32 the overall time in time units, rounded up to the publish rate.
+     */
+    UA_UInt32
+    get_overall_time();
+
+    /**
+     * @brief Starts a timed phase (action or retooling) by moving its duration from the overall time to a deadline.
+     * 
+     * @param _duration the phase duration in time units.
+     */
+    void
+    start_timed_phase(duration_t _duration);
+
+    /**
+     * @brief Finishes the timed phase in process.
      * 
      */
     void
-    pass_time();
+    finish_timed_phase();
 
     /**
      * @brief Callback to indicate the current action completion.
@@ -423,8 +465,10 @@ public:
      * @param _position the position of the robot at the conveyor.
      * @param _capabilities_file_name the capabilities file name.
      * @param _conveyor_size the total count of conveyor positions. 
+     * @param _overall_time_publish_rate the time units the published overall time is rounded up to, coarser values
+     * spare subscription updates at the cost of a less exact load. Defaults to exact values.
      */
-    robot(position_t _position, std::string _capabilities_file_name, position_t _conveyor_size);
+    robot(position_t _position, std::string _capabilities_file_name, position_t _conveyor_size, duration_t _overall_time_publish_rate = 1);
 
     /**
      * @brief Destroys the robot object.
@@ -7,21 +7,20 @@
 #include <string>
 #include <chrono>
 #include <set>
+#include <algorithm>
 #include "client_connection_establisher.hpp"
 #include "time_unit.hpp"
+#include "agent_timings.hpp"
 #include "filtered_logger.hpp"
 #include "browsenames.h"
 #include "discovery_and_connection.hpp"
 
 #define INSTANCE_NAME "KitchenRobot"
-#define TIME_UNIT_UPDATE_RATE 1LL
-#define MOVE_TIME 5LL
-#define RECONFIGURATION_TIME 5LL
 
-robot::robot(position_t _position, std::string _capabilities_file_name, position_t _conveyor_size) :
-        server_(UA_Server_new()), position_(_position), robot_uri_("urn:kitchen:robot:" + std::to_string(position_)), robot_type_inserter_(server_, ROBOT_TYPE), preparing_dish_(false), already_rearranging_(false), already_reconfiguring_(false),
+robot::robot(position_t _position, std::string _capabilities_file_name, position_t _conveyor_size, duration_t _overall_time_publish_rate) :
+        server_(UA_Server_new()), position_(_position), robot_uri_("urn:kitchen:robot:" + std::to_string(position_)), robot_type_inserter_(server_, ROBOT_TYPE), recipe_id_in_process_(0), overall_time_(0), phase_deadline_(), last_equipped_tool_(0), overall_processed_steps_(0), preparing_dish_(false), already_rearranging_(false), already_reconfiguring_(false),
         is_dish_finished_(false), running_(true), current_action_duration_(0), recipe_parser_(), capability_parser_(_capabilities_file_name), work_guard_(boost::asio::make_work_guard(io_context_)), steady_timer_(io_context_), controller_client_(nullptr),
-        conveyor_client_(nullptr), conveyor_size_(_conveyor_size), pending_pickup_(false), robot_state_(robot_state::AVAILABLE), new_target_position_(0), new_capabilities_profile_(""), mersenne_twister_(random_device_()), uniform_int_distribution_(0, capability_parser_.get_capabilities().size()-1) {
+        conveyor_client_(nullptr), conveyor_size_(_conveyor_size), overall_time_publish_rate_(std::max<duration_t>(1, _overall_time_publish_rate)), pending_pickup_(false), robot_state_(robot_state::AVAILABLE), new_target_position_(0), new_capabilities_profile_(""), mersenne_twister_(random_device_()), uniform_int_distribution_(0, capability_parser_.get_capabilities().size()-1) {
     /* Setup robot */
     UA_StatusCode status = UA_STATUSCODE_GOOD;
     UA_ServerConfig* server_config = UA_Server_getConfig(server_);
@@ -45,6 +44,7 @@ robot::robot(position_t _position, std::string _capabilities_file_name, position
     robot_type_inserter_.add_attribute(ROBOT_TYPE, CURRENT_TOOL);
     robot_type_inserter_.add_attribute(ROBOT_TYPE, LAST_EQUIPPED_TOOL);
     robot_type_inserter_.add_attribute(ROBOT_TYPE, CAPABILITIES);
+    robot_type_inserter_.add_attribute(ROBOT_TYPE, CAPABILITIES_MASK);
     robot_type_inserter_.add_attribute(ROBOT_TYPE, PROCESSED_STEPS);
     robot_type_inserter_.add_attribute(ROBOT_TYPE, PROCESSABLE_STEPS);
     robot_type_inserter_.add_attribute(ROBOT_TYPE, OVERALL_PROCESSED_STEPS);
@@ -56,6 +56,8 @@ robot::robot(position_t _position, std::string _capabilities_file_name, position
     receive_task_method_arguments.add_input_argument("the recipe id", "recipe_id", UA_TYPES_UINT32);
     receive_task_method_arguments.add_input_argument("the processed steps", "processed_steps", UA_TYPES_UINT32);
     receive_task_method_arguments.add_input_argument("the position the client adresses", "addressed_position", UA_TYPES_UINT32);
+    receive_task_method_arguments.add_input_argument("the positions of the planned robots after this robot", "route_positions", UA_TYPES_UINT32);
+    receive_task_method_arguments.add_input_argument("the endpoints of the planned robots after this robot", "route_endpoints", UA_TYPES_STRING);
     receive_task_method_arguments.add_output_argument("the robot position", "robot_position", UA_TYPES_UINT32);
     receive_task_method_arguments.add_output_argument("the result", "result", UA_TYPES_BOOLEAN);
     status = robot_type_inserter_.add_method(ROBOT_TYPE, RECEIVE_TASK, receive_task, receive_task_method_arguments, this);
@@ -71,6 +73,8 @@ robot::robot(position_t _position, std::string _capabilities_file_name, position
     handover_finished_order_method_arguments.add_output_argument("the recipe id", "recipe_id", UA_TYPES_UINT32);
     handover_finished_order_method_arguments.add_output_argument("the processed steps", "processed_steps", UA_TYPES_UINT32);
     handover_finished_order_method_arguments.add_output_argument("is dish finished", "is_dish_finished", UA_TYPES_BOOLEAN);
+    handover_finished_order_method_arguments.add_output_argument("the positions of the planned next robots", "route_positions", UA_TYPES_UINT32);
+    handover_finished_order_method_arguments.add_output_argument("the endpoints of the planned next robots", "route_endpoints", UA_TYPES_STRING);
     status = robot_type_inserter_.add_method(ROBOT_TYPE, HANDOVER_FINISHED_ORDER, handover_finished_order, handover_finished_order_method_arguments, this);
     if(status != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error adding the %s method node", __FUNCTION__, HANDOVER_FINISHED_ORDER);
@@ -105,12 +109,29 @@ robot::robot(position_t _position, std::string _capabilities_file_name, position
     robot_type_inserter_.add_object_type_constructor(server_, robot_type_inserter_.get_object_type_id(ROBOT_TYPE));
     /* Instantiate robot type */
     robot_type_inserter_.add_object_instance(INSTANCE_NAME, ROBOT_TYPE);
+    /* Resolve frequently accessed attributes */
+    status = robot_type_inserter_.resolve_attribute(INSTANCE_NAME, PROCESSED_STEPS, processed_steps_handle_);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error resolving attribute handles", __FUNCTION__);
+        running_.store(false);
+        return;
+    }
+    /* Bind attributes served from native members */
+    status = robot_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, RECIPE_ID, recipe_id_in_process_, UA_TYPES_UINT32);
+    status |= robot_type_inserter_.bind_attribute(INSTANCE_NAME, OVERALL_TIME, [this](UA_Variant& _value) {
+        UA_UInt32 overall_time = get_overall_time();
+        return UA_Variant_setScalarCopy(&_value, &overall_time, &UA_TYPES[UA_TYPES_UINT32]);
+    });
+    status |= robot_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, LAST_EQUIPPED_TOOL, last_equipped_tool_, UA_TYPES_UINT32);
+    status |= robot_type_inserter_.bind_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, overall_processed_steps_, UA_TYPES_UINT32);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error binding attribute data sources", __FUNCTION__);
+        running_.store(false);
+        return;
+    }
     /* Set attribute values */
     /* Set position at conveyor */
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, POSITION, &position_, UA_TYPES_UINT32);
-    /* Set recipe id in process */
-    UA_UInt32 recipe_id_in_process = 0;
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, RECIPE_ID, &recipe_id_in_process, UA_TYPES_UINT32);
     /* Set dish name in process */
     UA_String dish_in_process = UA_STRING(const_cast<char*>("None"));
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, DISH_NAME, &dish_in_process, UA_TYPES_STRING);
@@ -120,9 +141,6 @@ robot::robot(position_t _position, std::string _capabilities_file_name, position
     /* Set ingredients in process*/
     UA_String ingredients_in_process = UA_STRING(const_cast<char*>("None"));
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, INGREDIENTS, &ingredients_in_process, UA_TYPES_STRING);
-    /* Set overall time */
-    UA_UInt32 overall_time = 0;
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_TIME, &overall_time, UA_TYPES_UINT32);
     /* Set current and last equipped tool */
     set_current_and_last_equipped_tool();
     /* Set capabilities */
@@ -132,8 +150,6 @@ robot::robot(position_t _position, std::string _capabilities_file_name, position
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, PROCESSED_STEPS, &initial_progress, UA_TYPES_UINT32);
     /* Set processable steps */
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, PROCESSABLE_STEPS, &initial_progress, UA_TYPES_UINT32);
-    /* Set overall processed steps */
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, &initial_progress, UA_TYPES_UINT32);
     /* Set overall processing steps */
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSING_STEPS, &initial_progress, UA_TYPES_UINT32);
     /* Set availability */
@@ -222,7 +238,7 @@ robot::set_current_and_last_equipped_tool() {
     UA_String current_tool = UA_STRING(const_cast<char*>(robot_tool_to_string(current_tool_)));
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, CURRENT_TOOL, &current_tool, UA_TYPES_STRING);
     /* Set last equipped tool */
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, LAST_EQUIPPED_TOOL, &current_tool_, UA_TYPES_UINT32);
+    last_equipped_tool_.store(static_cast<UA_UInt32>(current_tool_));
 }
 
 void
@@ -240,6 +256,8 @@ robot::set_capabilities_node() {
     for (size_t i = 0; i < capabilities.size(); i++) {
         UA_String_clear(&(ua_capabilities[i]));
     }
+    capability_mask_t capabilities_mask = capability_parser_.get_capabilities_mask();
+    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, CAPABILITIES_MASK, &capabilities_mask, UA_TYPES_UINT64);
 }
 
 void
@@ -273,14 +291,16 @@ robot::receive_task(UA_Server *_server,
             size_t _input_size, const UA_Variant *_input,
             size_t _output_size, UA_Variant *_output) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    if(_input_size != 3) {
+    if(_input_size != 5) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input size", __FUNCTION__);
         return UA_STATUSCODE_BAD;
     }
 
+    route_plan remaining_route;
     if (!UA_Variant_hasScalarType(&_input[0], &UA_TYPES[UA_TYPES_UINT32])
       ||!UA_Variant_hasScalarType(&_input[1], &UA_TYPES[UA_TYPES_UINT32])
-      ||!UA_Variant_hasScalarType(&_input[2], &UA_TYPES[UA_TYPES_UINT32])) {
+      ||!UA_Variant_hasScalarType(&_input[2], &UA_TYPES[UA_TYPES_UINT32])
+      || route_from_variants(_input[3], _input[4], remaining_route) != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Bad input argument type", __FUNCTION__);
         return UA_STATUSCODE_BAD;
     }
@@ -301,13 +321,8 @@ robot::receive_task(UA_Server *_server,
         }
     }
     if (task_received) {
-        recipe incoming_recipe = self->recipe_parser_.get_recipe(recipe_id);
-        std::queue<robot_action> action_queue = incoming_recipe.get_action_queue();
-        // Remove already processed steps
-        for (size_t i = 0; i < overall_processed_steps; i++) {
-            action_queue.pop();
-        }
-        if (!self->capability_parser_.is_capable_to(action_queue.front().get_name()))
+        recipe_steps action_queue = self->recipe_parser_.get_remaining_steps(recipe_id, overall_processed_steps);
+        if (action_queue.empty() || !self->capability_parser_.is_capable_to(action_queue.front().get_action_mask()))
             task_received = false;
     }
     // Set output parameters
@@ -319,30 +334,26 @@ robot::receive_task(UA_Server *_server,
         return UA_STATUSCODE_BAD;
     }
     if (task_received)
-        self->io_context_.post([self, recipe_id, overall_processed_steps] {
-            self->handle_receive_task(recipe_id, overall_processed_steps);
-        });
+        self->io_context_.post(kitchen_clock::tracked([self, recipe_id, overall_processed_steps, remaining_route] {
+            self->handle_receive_task(recipe_id, overall_processed_steps, remaining_route);
+        }));
     return UA_STATUSCODE_GOOD;
 }
 
 void
-robot::handle_receive_task(recipe_id_t _recipe_id, UA_UInt32 _overall_processed_steps) {
+robot::handle_receive_task(recipe_id_t _recipe_id, UA_UInt32 _overall_processed_steps, route_plan _remaining_route) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "INSTRUCTIONS: Received instruction to cook recipe_id=%d with already %d processed steps", _recipe_id, _overall_processed_steps);
     if (!recipe_parser_.has_recipe(_recipe_id)) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Unknown recipe ID", __FUNCTION__);
         return;
     }
-    recipe incoming_recipe = recipe_parser_.get_recipe(_recipe_id);
-    std::queue<robot_action> action_queue = incoming_recipe.get_action_queue();
-    UA_UInt32 overall_processing_steps = action_queue.size();
-    // Remove already processed steps
-    for (size_t i = 0; i < _overall_processed_steps; i++) {
-        action_queue.pop();
-    }
+    const recipe& incoming_recipe = recipe_parser_.get_recipe(_recipe_id);
+    UA_UInt32 overall_processing_steps = incoming_recipe.get_step_count();
+    recipe_steps action_queue = incoming_recipe.get_steps(_overall_processed_steps);
     UA_UInt32 processable_steps = compute_overall_time_and_determine_last_tool(action_queue);
     // Setup incoming order
-    order_queue_.push(order(_recipe_id, _overall_processed_steps, overall_processing_steps, processable_steps, action_queue));
+    order_queue_.push(order(_recipe_id, _overall_processed_steps, overall_processing_steps, processable_steps, action_queue, std::move(_remaining_route)));
     if (!preparing_dish_) {
         cook_next_order();
     }
@@ -371,19 +382,13 @@ robot::cook_next_order() {
     order_queue_.pop();
     // Update recipe id in process
     recipe_id_t recipe_id_in_process = next_order.get_recipe_id();
-    UA_StatusCode status = robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, RECIPE_ID, &recipe_id_in_process, UA_TYPES_UINT32);
-    if (status != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Setting %s failed", __FUNCTION__, RECIPE_ID);
-    }
+    recipe_id_in_process_.store(recipe_id_in_process);
     // Update recipe progress attributes
     UA_UInt32 overall_processed_steps = next_order.get_overall_processed_steps();
     UA_UInt32 overall_processing_steps = next_order.get_overall_processing_steps();
     UA_UInt32 processable_steps = next_order.get_processable_steps();
-    status = robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, &overall_processed_steps, UA_TYPES_UINT32);
-    if (status != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Setting %s failed", __FUNCTION__, OVERALL_PROCESSED_STEPS);
-    }
-    status = robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSING_STEPS, &overall_processing_steps, UA_TYPES_UINT32);
+    overall_processed_steps_.store(overall_processed_steps);
+    UA_StatusCode status = robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSING_STEPS, &overall_processing_steps, UA_TYPES_UINT32);
     if (status != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Setting %s failed", __FUNCTION__, OVERALL_PROCESSING_STEPS);
     }
@@ -392,7 +397,7 @@ robot::cook_next_order() {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Setting %s failed", __FUNCTION__, PROCESSABLE_STEPS);
     }
     // Update dish name
-    recipe current_recipe = recipe_parser_.get_recipe(recipe_id_in_process);
+    const recipe& current_recipe = recipe_parser_.get_recipe(recipe_id_in_process);
     UA_String dish_in_process = UA_STRING_ALLOC(current_recipe.get_dish_name().c_str());
     status = robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, DISH_NAME, &dish_in_process, UA_TYPES_STRING);
     UA_String_clear(&dish_in_process);
@@ -400,26 +405,19 @@ robot::cook_next_order() {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Setting %s failed", __FUNCTION__, DISH_NAME);
     }
     action_queue_in_process_ = next_order.get_action_queue();
+    /* Handed over once the pickup is pending, the worker does not touch it until then */
+    remaining_route_in_process_ = next_order.get_remaining_route();
     determine_next_action();
 }
 
 UA_UInt32
-robot::compute_overall_time_and_determine_last_tool(std::queue<robot_action> _action_queue) {
+robot::compute_overall_time_and_determine_last_tool(recipe_steps _action_queue) {
     // UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s called", __FUNCTION__);
-    /* Get overall time */
-    UA_Variant overall_time_var;
-    UA_Variant_init(&overall_time_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, OVERALL_TIME, overall_time_var);
-    UA_UInt32 overall_time = *(UA_UInt32*) overall_time_var.data;
-    UA_Variant_clear(&overall_time_var);
-    /* Get last equipped tool */
-    UA_Variant last_equipped_tool_var;
-    UA_Variant_init(&last_equipped_tool_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, LAST_EQUIPPED_TOOL, last_equipped_tool_var);
-    robot_tool last_equipped_tool = *(robot_tool*) last_equipped_tool_var.data;
-    UA_Variant_clear(&last_equipped_tool_var);
+    std::lock_guard<std::mutex> lock(overall_time_mutex_);
+    UA_UInt32 overall_time = overall_time_;
+    robot_tool last_equipped_tool = static_cast<robot_tool>(last_equipped_tool_.load());
     UA_UInt32 processable_steps = 0;
-    while (!_action_queue.empty() && capability_parser_.is_capable_to(_action_queue.front().get_name())) {
+    while (!_action_queue.empty() && capability_parser_.is_capable_to(_action_queue.front().get_action_mask())) {
         overall_time += last_equipped_tool != _action_queue.front().get_required_tool() ? RETOOLING_TIME : 0;
         overall_time += _action_queue.front().get_action_duration();
         last_equipped_tool = _action_queue.front().get_required_tool();
@@ -427,9 +425,9 @@ robot::compute_overall_time_and_determine_last_tool(std::queue<robot_action> _ac
         processable_steps++;
     }
     /* Update overall time */
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_TIME, &overall_time, UA_TYPES_UINT32);
+    overall_time_ = overall_time;
     /* Update last equipped tool time */
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, LAST_EQUIPPED_TOOL, &last_equipped_tool, UA_TYPES_UINT32);
+    last_equipped_tool_.store(static_cast<UA_UInt32>(last_equipped_tool));
     return processable_steps;
 }
 
@@ -469,6 +467,7 @@ robot::handle_handover_finished_order(UA_Variant* _output) {
             status |= UA_Variant_setScalarCopy(&_output[2], &recipe_id, &UA_TYPES[UA_TYPES_UINT32]);
             status |= UA_Variant_setScalarCopy(&_output[3], &processed_steps, &UA_TYPES[UA_TYPES_UINT32]);
             status |= UA_Variant_setScalarCopy(&_output[4], &is_dish_finished, &UA_TYPES[UA_TYPES_BOOLEAN]);
+            status |= route_to_variants(route_plan(), &_output[5], &_output[6]);
             if(status != UA_STATUSCODE_GOOD) {
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting output parameters", __FUNCTION__);
                 stop();
@@ -480,47 +479,37 @@ robot::handle_handover_finished_order(UA_Variant* _output) {
             pending_pickup_.store(false);
         }
     }
-    /* Get recipe id in process */
-    UA_Variant recipe_id_in_process_var;
-    UA_Variant_init(&recipe_id_in_process_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, RECIPE_ID, recipe_id_in_process_var);
-    UA_UInt32 recipe_id_in_process = *(UA_UInt32*)recipe_id_in_process_var.data;
-    UA_Variant_clear(&recipe_id_in_process_var);
-    /* Get overall processed steps */
-    UA_Variant overall_processed_steps_var;
-    UA_Variant_init(&overall_processed_steps_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, overall_processed_steps_var);
-    UA_UInt32 overall_processed_steps =  *(UA_UInt32*) overall_processed_steps_var.data;
-    UA_Variant_clear(&overall_processed_steps_var);
+    UA_UInt32 recipe_id_in_process = recipe_id_in_process_.load();
+    UA_UInt32 overall_processed_steps = overall_processed_steps_.load();
     /* Set output values */
     UA_StatusCode status = UA_Variant_setScalarCopy(&_output[0], &server_endpoint_, &UA_TYPES[UA_TYPES_STRING]);
     status |= UA_Variant_setScalarCopy(&_output[1], &position_, &UA_TYPES[UA_TYPES_UINT32]);
     status |= UA_Variant_setScalarCopy(&_output[2], &recipe_id_in_process, &UA_TYPES[UA_TYPES_UINT32]);
     status |= UA_Variant_setScalarCopy(&_output[3], &overall_processed_steps, &UA_TYPES[UA_TYPES_UINT32]);
     status |= UA_Variant_setScalarCopy(&_output[4], &is_dish_finished_, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    status |= route_to_variants(remaining_route_in_process_, &_output[5], &_output[6]);
     if(status != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting output parameters", __FUNCTION__);
         stop();
         return;
     }
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "HANDOVER: Pass finished recipe_id=%d from position %d", recipe_id_in_process, position_);
-    /* Set recipe id in process*/
-    recipe_id_in_process = 0;
     is_dish_finished_ = false;
+    remaining_route_in_process_.clear();
     /* Reset recipe progress */
     UA_UInt32 initial_progress = 0;
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, PROCESSED_STEPS, &initial_progress, UA_TYPES_UINT32);
+    robot_type_inserter_.set_scalar_attribute(processed_steps_handle_, &initial_progress, UA_TYPES_UINT32);
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, PROCESSABLE_STEPS, &initial_progress, UA_TYPES_UINT32);
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, &initial_progress, UA_TYPES_UINT32);
+    overall_processed_steps_.store(0);
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSING_STEPS, &initial_progress, UA_TYPES_UINT32);
     /* Update recipe id in process */
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, RECIPE_ID, &recipe_id_in_process, UA_TYPES_UINT32);
+    recipe_id_in_process_.store(0);
     /* Update dish in process */
     UA_String dish_in_process = UA_STRING(const_cast<char*>("None"));
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, DISH_NAME, &dish_in_process, UA_TYPES_STRING);
-    io_context_.post([this] {
+    io_context_.post(kitchen_clock::tracked([this] {
         cook_next_order();
-    });
+    }));
 }
 
 robot::~robot() {
@@ -538,23 +527,13 @@ robot::~robot() {
 
 void
 robot::determine_next_action() {
-    /* Get recipe id in process */
-    UA_Variant recipe_id_in_process_var;
-    UA_Variant_init(&recipe_id_in_process_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, RECIPE_ID, recipe_id_in_process_var);
-    UA_UInt32 recipe_id_in_process = *(UA_UInt32*)recipe_id_in_process_var.data;
-    UA_Variant_clear(&recipe_id_in_process_var);
-    /* Get overall processed steps */
-    UA_Variant overall_processed_steps_var;
-    UA_Variant_init(&overall_processed_steps_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, overall_processed_steps_var);
-    UA_UInt32 overall_processed_steps =  *(UA_UInt32*) overall_processed_steps_var.data;
-    UA_Variant_clear(&overall_processed_steps_var);
+    UA_UInt32 recipe_id_in_process = recipe_id_in_process_.load();
+    UA_UInt32 overall_processed_steps = overall_processed_steps_.load();
     /* Process remaining actions */
     if (action_queue_in_process_.size()) {
-        robot_action robot_act = action_queue_in_process_.front();
+        const robot_action& robot_act = action_queue_in_process_.front();
         /* Request next robot if not capable to process the action */
-        if (!capability_parser_.is_capable_to(robot_act.get_name())) {
+        if (!capability_parser_.is_capable_to(robot_act.get_action_mask())) {
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Robot is not capable to %s", __FUNCTION__, robot_act.get_name().c_str());
             reset_in_process_fields();
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "COOK: Recipe_id=%d finished with %d processed steps, send partially finished order notification", recipe_id_in_process, overall_processed_steps);
@@ -600,6 +579,7 @@ robot::determine_next_action() {
         robot_tool required_tool = robot_act.get_required_tool();
         if (required_tool != current_tool_) {
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RETOOL: Retooling current tool %s to %s", robot_tool_to_string(current_tool_), robot_tool_to_string(required_tool));
+            start_timed_phase(RETOOLING_TIME);
             steady_timer_.expires_from_now(std::chrono::milliseconds(RETOOLING_TIME * TIME_UNIT));
             steady_timer_.async_wait([this](const boost::system::error_code& _error) {
                 if (_error) {
@@ -622,24 +602,20 @@ robot::determine_next_action() {
             /* Schedule next action */
             current_action_duration_ = robot_act.get_action_duration();
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "COOK: Performing %s on recipe_id=%d with ingredients=%s for %ld time units", robot_act.get_name().c_str(), recipe_id_in_process, robot_act.get_ingredients().c_str(), current_action_duration_);
-            steady_timer_.expires_from_now(std::chrono::milliseconds(TIME_UNIT_UPDATE_RATE * TIME_UNIT));
+            start_timed_phase(current_action_duration_);
+            steady_timer_.expires_from_now(std::chrono::milliseconds(current_action_duration_ * TIME_UNIT));
             steady_timer_.async_wait([this](const boost::system::error_code& _error) {
                 if (_error) {
-                    UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling pass time (%s)", __FUNCTION__, _error.what().c_str());
+                    UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling action completion (%s)", __FUNCTION__, _error.what().c_str());
                     stop();
                     return;
                 }
-                pass_time();
+                action_performed();
             });
         }
     } else {
         reset_in_process_fields();
-        /* Get overall processed steps */
-        UA_Variant overall_processed_steps_var;
-        UA_Variant_init(&overall_processed_steps_var);
-        robot_type_inserter_.get_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, overall_processed_steps_var);
-        UA_UInt32 overall_processed_steps =  *(UA_UInt32*) overall_processed_steps_var.data;
-        UA_Variant_clear(&overall_processed_steps_var);
+        UA_UInt32 overall_processed_steps = overall_processed_steps_.load();
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "COOK: Recipe_id=%d finished with %d processed steps, send finished order notification", recipe_id_in_process, overall_processed_steps);
         is_dish_finished_ = true;
         /* Notify conveyor about finished order */
@@ -716,59 +692,49 @@ robot::receive_finished_order_notification_called(size_t _output_size, UA_Varian
         UA_Array_delete(_output, _output_size, &UA_TYPES[UA_TYPES_VARIANT]);
 }
 
+UA_UInt32
+robot::get_overall_time() {
+    std::lock_guard<std::mutex> lock(overall_time_mutex_);
+    UA_UInt32 overall_time = overall_time_;
+    /* Add the remaining time units of the timed phase in process */
+    auto remaining = phase_deadline_ - kitchen_clock::now();
+    if (remaining > kitchen_clock::duration::zero()) {
+        auto remaining_ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        overall_time += (remaining_ms + TIME_UNIT - 1) / TIME_UNIT;
+    }
+    /* Round up to the publish rate so that subscribers see coarse changes only */
+    return ((overall_time + overall_time_publish_rate_ - 1) / overall_time_publish_rate_) * overall_time_publish_rate_;
+}
+
 void
-robot::pass_time() {
-    /* Get overall time */
-    UA_Variant overall_time_var;
-    UA_Variant_init(&overall_time_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, OVERALL_TIME, overall_time_var);
-    UA_UInt32 overall_time = *(UA_UInt32*) overall_time_var.data;
-    UA_Variant_clear(&overall_time_var);
-    overall_time -= TIME_UNIT_UPDATE_RATE;
-    /* Update overall time */
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_TIME, &overall_time, UA_TYPES_UINT32);
-    current_action_duration_ -= TIME_UNIT_UPDATE_RATE;
-    if (current_action_duration_ != 0) {
-        steady_timer_.expires_from_now(std::chrono::milliseconds(TIME_UNIT_UPDATE_RATE * TIME_UNIT));
-        steady_timer_.async_wait([this](const boost::system::error_code& _error) {
-            if (_error) {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling pass time (%s)", __FUNCTION__, _error.what().c_str());
-                stop();
-                return;
-            }
-            pass_time();
-        });
-    } else {
-        action_performed();
-    }
+robot::start_timed_phase(duration_t _duration) {
+    std::lock_guard<std::mutex> lock(overall_time_mutex_);
+    overall_time_ -= _duration;
+    phase_deadline_ = kitchen_clock::now() + std::chrono::milliseconds(_duration * TIME_UNIT);
+}
+
+void
+robot::finish_timed_phase() {
+    std::lock_guard<std::mutex> lock(overall_time_mutex_);
+    phase_deadline_ = kitchen_clock::time_point();
 }
 
 void
 robot::action_performed() {
-    robot_action robot_act = action_queue_in_process_.front();
+    const robot_action& robot_act = action_queue_in_process_.front();
     duration_t action_duration = robot_act.get_action_duration();
+    finish_timed_phase();
     /* Update overall processed steps */
-    UA_Variant overall_processed_steps_var;
-    UA_Variant_init(&overall_processed_steps_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, overall_processed_steps_var);
-    UA_UInt32 overall_processed_steps = *(UA_UInt32*) overall_processed_steps_var.data;
-    UA_Variant_clear(&overall_processed_steps_var);
-    overall_processed_steps++;
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_PROCESSED_STEPS, &overall_processed_steps, UA_TYPES_UINT32);
+    overall_processed_steps_++;
     /* Update local processed steps */
     UA_Variant locally_processed_steps_var;
     UA_Variant_init(&locally_processed_steps_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, PROCESSED_STEPS, locally_processed_steps_var);
+    robot_type_inserter_.get_attribute(processed_steps_handle_, locally_processed_steps_var);
     UA_UInt32 locally_processed_steps = *(UA_UInt32*) locally_processed_steps_var.data;
     UA_Variant_clear(&locally_processed_steps_var);
     locally_processed_steps++;
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, PROCESSED_STEPS, &locally_processed_steps, UA_TYPES_UINT32);
-    /* Get recipe id in process */
-    UA_Variant recipe_id_in_process_var;
-    UA_Variant_init(&recipe_id_in_process_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, RECIPE_ID, recipe_id_in_process_var);
-    UA_UInt32 recipe_id_in_process = *(UA_UInt32*)recipe_id_in_process_var.data;
-    UA_Variant_clear(&recipe_id_in_process_var);
+    robot_type_inserter_.set_scalar_attribute(processed_steps_handle_, &locally_processed_steps, UA_TYPES_UINT32);
+    UA_UInt32 recipe_id_in_process = recipe_id_in_process_.load();
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "COOK: Performed %s on recipe_id=%d with ingredients=%s for %ld time units", robot_act.get_name().c_str(), recipe_id_in_process, robot_act.get_ingredients().c_str(), action_duration);
     action_queue_in_process_.pop();
     determine_next_action();
@@ -780,15 +746,8 @@ robot::retool() {
     UA_String current_tool = UA_STRING(const_cast<char*>(robot_tool_to_string(current_tool_)));
     /* Update current tool */
     robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, CURRENT_TOOL, &current_tool, UA_TYPES_STRING);
-    /* Get overall time */
-    UA_Variant overall_time_var;
-    UA_Variant_init(&overall_time_var);
-    robot_type_inserter_.get_attribute(INSTANCE_NAME, OVERALL_TIME, overall_time_var);
-    UA_UInt32 overall_time = *(UA_UInt32*) overall_time_var.data;
-    UA_Variant_clear(&overall_time_var);
-    overall_time -= RETOOLING_TIME;
     /* Update overall time */
-    robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_TIME, &overall_time, UA_TYPES_UINT32);
+    finish_timed_phase();
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "RETOOL: Current tool now is %s", robot_tool_to_string(current_tool_));
     determine_next_action();
 }
@@ -839,12 +798,12 @@ robot::switch_position(UA_Server *_server,
             && self->robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, AVAILABILITY, &availability, UA_TYPES_BOOLEAN) == UA_STATUSCODE_GOOD) {
             self->robot_state_ = robot_state::REARRANGING;
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "REARRANGING: Robot at position %d will switch to its new position %d", self->position_, self->new_target_position_);
-            self->io_context_.post([self, new_position] {
+            self->io_context_.post(kitchen_clock::tracked([self, new_position] {
                 self->new_target_position_ = new_position;
                 if (!self->preparing_dish_) {
                     self->handle_switch_position();
                 }
-            });
+            }));
         } else {
             result = false;
         }
@@ -867,7 +826,7 @@ robot::handle_switch_position() {
     uint32_t cw  = (new_target_position_ - position_ + conveyor_size_) % conveyor_size_;
     uint32_t ccw = (position_ - new_target_position_ + conveyor_size_) % conveyor_size_;
     uint32_t distance = std::min(cw, ccw);
-    steady_timer_.expires_from_now(std::chrono::milliseconds(distance * MOVE_TIME * TIME_UNIT));
+    steady_timer_.expires_from_now(std::chrono::milliseconds(distance * ROBOT_MOVE_TIME * TIME_UNIT));
     steady_timer_.async_wait([this](const boost::system::error_code& _error) {
         if (_error) {
             UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling switch position (%s)", __FUNCTION__, _error.what().c_str());
@@ -928,9 +887,9 @@ robot::commit_new_position(UA_Server *_server,
             return UA_STATUSCODE_GOOD;
         }
     }
-    self->io_context_.post([self] {
+    self->io_context_.post(kitchen_clock::tracked([self] {
         self->handle_new_position_commit();
-    });
+    }));
     UA_StatusCode status = UA_Variant_setScalarCopy(&_output[0], &result, &UA_TYPES[UA_TYPES_BOOLEAN]);
     if(status != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error setting output parameters", __FUNCTION__);
@@ -984,7 +943,7 @@ robot::reconfigure(UA_Server *_server,
     UA_Boolean result = true;
     robot* self = static_cast<robot*>(_method_context);
     capability_parser cp(std::string((char*) new_capabilities_profile.data, new_capabilities_profile.length));
-    if(cp.get_capabilities() == self->capability_parser_.get_capabilities()) {
+    if(cp.get_capabilities_mask() == self->capability_parser_.get_capabilities_mask()) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Requested capabilities profile is already is set. Will not reconfigure", __FUNCTION__);
         result = false;
         UA_StatusCode status = UA_Variant_setScalarCopy(&_output[0], &result, &UA_TYPES[UA_TYPES_BOOLEAN]);
@@ -1002,11 +961,11 @@ robot::reconfigure(UA_Server *_server,
             && self->robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, AVAILABILITY, &availability, UA_TYPES_BOOLEAN) == UA_STATUSCODE_GOOD) {
             self->robot_state_ = robot_state::RECONFIGURING;
             self->new_capabilities_profile_ = std::string((char*) new_capabilities_profile.data, new_capabilities_profile.length);
-            self->io_context_.post([self] {
+            self->io_context_.post(kitchen_clock::tracked([self] {
                 if (!self->preparing_dish_) {
                     self->handle_reconfiguration();
                 }
-            });
+            }));
         } else {
             result = false;
         }
@@ -1026,7 +985,7 @@ robot::handle_reconfiguration() {
     if (already_reconfiguring_)
         return;
     already_reconfiguring_ = true;
-    steady_timer_.expires_from_now(std::chrono::milliseconds(RECONFIGURATION_TIME * TIME_UNIT));
+    steady_timer_.expires_from_now(std::chrono::milliseconds(ROBOT_RECONFIGURATION_TIME * TIME_UNIT));
     steady_timer_.async_wait([this](const boost::system::error_code& _error) {
         if (_error) {
             UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Failed scheduling reconfiguration (%s)", __FUNCTION__, _error.what().c_str());
@@ -1047,8 +1006,10 @@ robot::complete_reconfiguration() {
         set_capabilities_node();
         set_current_and_last_equipped_tool();
         /* Reset overall time */
-        UA_UInt32 overall_time = 0;
-        robot_type_inserter_.set_scalar_attribute(INSTANCE_NAME, OVERALL_TIME, &overall_time, UA_TYPES_UINT32);
+        {
+            std::lock_guard<std::mutex> overall_time_lock(overall_time_mutex_);
+            overall_time_ = 0;
+        }
         /* Recalculate order queue */
         std::queue<order> pending_orders; 
         std::swap(pending_orders, order_queue_);
@@ -1057,7 +1018,8 @@ robot::complete_reconfiguration() {
             recipe_id_t recipe_id = o.get_recipe_id();
             UA_UInt32 overall_processed_steps = o.get_overall_processed_steps();
             pending_orders.pop();
-            handle_receive_task(recipe_id, overall_processed_steps);
+            /* The new profile covers other steps, so the planned route of the order is void and the next robot is chosen on handover */
+            handle_receive_task(recipe_id, overall_processed_steps, route_plan());
         }
         already_reconfiguring_ = false;
         robot_state_ = robot_state::AVAILABLE;
@@ -1109,6 +1071,7 @@ robot::start() {
     robot_type_inserter_.get_attribute(INSTANCE_NAME, CAPABILITIES, capabilities);
     register_robot_caller.add_array_input_argument(capabilities.data, capabilities.arrayLength, UA_TYPES_STRING);
     UA_Variant_clear(&capabilities);
+    register_robot_caller.add_scalar_input_argument(&conveyor_size_, UA_TYPES_UINT32);
     object_method_info omi = method_id_map_[REGISTER_ROBOT];
     size_t output_size = 0;
     UA_Variant* output = nullptr;
@@ -0,0 +1,94 @@
+/**
+ * @file route_plan.hpp
+ * @brief Planned sequence of robots for the remaining steps of an order and its method argument encoding.
+ *
+ * @details
+ * The controller plans the route when an order is placed. The route travels with the order, in the robot's
+ * order queue and on the conveyor's plate, so the next robot is known without asking the controller. Every
+ * hop names the robot by position and endpoint, a hop whose robot moved or left invalidates the route.
+ * On the wire a route is a pair of equally long arrays, the positions (UInt32[]) and the endpoints (String[]).
+ */
+#ifndef ROUTE_PLAN_HPP
+#define ROUTE_PLAN_HPP
+
+#include <open62541/types.h>
+#include <string>
+#include <vector>
+#include "types.hpp"
+#include "method_node_caller.hpp"
+
+using namespace cps_kitchen;
+
+/**
+ * @brief A planned robot of a route.
+ */
+struct route_hop {
+    position_t position_; /**< the planned position of the robot. */
+    std::string endpoint_; /**< the endpoint of the robot. */
+};
+
+typedef std::vector<route_hop> route_plan; /**< the planned robots in processing order, one per run of steps. */
+
+/**
+ * @brief Adds a route as the positions and endpoints array arguments to a method call.
+ *
+ * @param _caller the method call.
+ * @param _route the route.
+ */
+inline void
+add_route_input_arguments(method_node_caller& _caller, const route_plan& _route) {
+    std::vector<position_t> positions;
+    std::vector<UA_String> endpoints;
+    for (const route_hop& hop : _route) {
+        positions.push_back(hop.position_);
+        endpoints.push_back(UA_STRING(const_cast<char*>(hop.endpoint_.c_str())));
+    }
+    /* The arguments copy the arrays */
+    _caller.add_array_input_argument(positions.data(), positions.size(), UA_TYPES_UINT32);
+    _caller.add_array_input_argument(endpoints.data(), endpoints.size(), UA_TYPES_STRING);
+}
+
+/**
+ * @brief Sets a route as the positions and endpoints array values of two variants.
+ *
+ * @param _route the route.
+ * @param _positions the variant receiving the positions.
+ * @param _endpoints the variant receiving the endpoints.
+ * @return UA_StatusCode the status code.
+ */
+inline UA_StatusCode
+route_to_variants(const route_plan& _route, UA_Variant* _positions, UA_Variant* _endpoints) {
+    std::vector<position_t> positions;
+    std::vector<UA_String> endpoints;
+    for (const route_hop& hop : _route) {
+        positions.push_back(hop.position_);
+        endpoints.push_back(UA_STRING(const_cast<char*>(hop.endpoint_.c_str())));
+    }
+    UA_StatusCode status = UA_Variant_setArrayCopy(_positions, positions.data(), positions.size(), &UA_TYPES[UA_TYPES_UINT32]);
+    status |= UA_Variant_setArrayCopy(_endpoints, endpoints.data(), endpoints.size(), &UA_TYPES[UA_TYPES_STRING]);
+    return status;
+}
+
+/**
+ * @brief Reads a route from the positions and endpoints array values of two variants.
+ *
+ * @param _positions the variant holding the positions.
+ * @param _endpoints the variant holding the endpoints.
+ * @param _route the read route.
+ * @return UA_StatusCode the status code, bad if the arrays are malformed.
+ */
+inline UA_StatusCode
+route_from_variants(const UA_Variant& _positions, const UA_Variant& _endpoints, route_plan& _route) {
+    _route.clear();
+    if (!UA_Variant_hasArrayType(&_positions, &UA_TYPES[UA_TYPES_UINT32])
+        || !UA_Variant_hasArrayType(&_endpoints, &UA_TYPES[UA_TYPES_STRING])
+        || _positions.arrayLength != _endpoints.arrayLength)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    for (size_t hop = 0; hop < _positions.arrayLength; hop++) {
+        UA_String endpoint = ((UA_String*) _endpoints.data)[hop];
+        _route.push_back({((position_t*) _positions.data)[hop], std::string((char*) endpoint.data, endpoint.length)});
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif // ROUTE_PLAN_HPP
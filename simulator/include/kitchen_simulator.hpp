@@ -0,0 +1,317 @@
+/**
+ * @file kitchen_simulator.hpp
+ * @brief Offline discrete event simulation of the kitchen that replays an order trace against a MAPE implementation.
+ *
+ * @details
+ * The simulator mirrors the agents without OPC UA and without waiting for real time. The kitchen places the
+ * traced orders through its placing gate, the controller decides on a registry snapshot with the given MAPE,
+ * robots work off their order queues with retooling, hold finished dishes until the conveyor picks them up and
+ * perform the swaps and reconfigurations the MAPE triggers, and the conveyor moves its plates in lockstep,
+ * retrieves dishes on free plates, requests the next robots and delivers to robots and the output. The timing
+ * constants match robot.cpp, conveyor.cpp and kitchen.cpp. Decisions are not cached and robots start with the
+ * first tool instead of a random one, so replays are deterministic.
+ */
+#ifndef KITCHEN_SIMULATOR_HPP
+#define KITCHEN_SIMULATOR_HPP
+
+#include <open62541/types.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+#include "mape.hpp"
+#include "robot_state.hpp"
+
+/**
+ * @brief An order of a trace.
+ */
+struct trace_order {
+    duration_t arrival_; /**< the time units after the start of the trace the order arrives at the kitchen. */
+    recipe_id_t recipe_id_; /**< the recipe id. */
+};
+
+/**
+ * @brief The outcome of a replayed trace. Times are given in time units, see time_unit.hpp.
+ */
+struct simulation_report {
+    size_t orders_ = 0; /**< the count of traced orders. */
+    size_t completed_orders_ = 0; /**< the count of orders delivered at the output. */
+    size_t dropped_orders_ = 0; /**< the count of orders without a capable robot. */
+    size_t unfinished_orders_ = 0; /**< the count of orders still in the kitchen when the simulation horizon was reached. */
+    duration_t makespan_ = 0; /**< the time the last completed order was delivered. */
+    double mean_latency_ = 0; /**< the mean time from arrival to delivery of the completed orders. */
+    duration_t p99_latency_ = 0; /**< the 99th percentile of the time from arrival to delivery of the completed orders. */
+    size_t decisions_ = 0; /**< the count of robot decisions of the MAPE. */
+    size_t requested_swaps_ = 0; /**< the count of swaps the MAPE triggered. */
+    size_t performed_swaps_ = 0; /**< the count of swaps the robots accepted. */
+    size_t requested_reconfigurations_ = 0; /**< the count of reconfigurations the MAPE triggered. */
+    size_t performed_reconfigurations_ = 0; /**< the count of reconfigurations the robots accepted. */
+    double cpu_time_ = 0; /**< the CPU milliseconds of the whole replay. */
+    double decision_cpu_time_ = 0; /**< the CPU milliseconds spent in MAPE decisions. */
+    double review_cpu_time_ = 0; /**< the CPU milliseconds spent in MAPE layout reviews. */
+};
+
+class kitchen_simulator {
+private:
+    /**
+     * @brief An order in a robot's order queue or on a plate.
+     */
+    struct simulated_task {
+        size_t order_; /**< the index of the order in the trace. */
+        UA_UInt32 processed_steps_; /**< the processed steps of the recipe. */
+    };
+
+    /**
+     * @brief The simulated state of a robot.
+     */
+    struct simulated_robot {
+        std::string endpoint_; /**< the name the robot is reported with in snapshots. */
+        position_t position_; /**< the position, updated when a swap is committed. */
+        capability_parser capabilities_; /**< the capabilities profile. */
+        robot_tool current_tool_; /**< the currently equipped tool. */
+        std::deque<simulated_task> order_queue_; /**< the received orders waiting to be processed. */
+        bool preparing_dish_ = false; /**< flag to indicate whether a dish is processed or waits for pickup. */
+        bool pending_pickup_ = false; /**< flag to indicate whether the processed dish waits for pickup. */
+        simulated_task task_in_process_ = {0, 0}; /**< the dish in process with the steps processed after the current run. */
+        duration_t run_finish_ = 0; /**< the time the current run of steps finishes. */
+        robot_state state_ = robot_state::AVAILABLE; /**< the adaptation state. */
+        position_t new_position_ = 0; /**< the position to switch to while rearranging. */
+        position_t swap_partner_ = 0; /**< the old position of the robot swapping with this robot, 0 if it switches alone. */
+        bool arrived_ = false; /**< flag to indicate whether the robot arrived at its new position. */
+        std::string new_capabilities_profile_; /**< the capabilities profile to reconfigure to. */
+    };
+
+    /**
+     * @brief The simulated state of a plate.
+     */
+    struct simulated_plate {
+        bool occupied_ = false; /**< flag to indicate whether the plate carries a dish. */
+        simulated_task task_ = {0, 0}; /**< the dish on the plate. */
+        bool is_dish_finished_ = false; /**< flag to indicate whether the dish goes to the output. */
+        position_t target_position_ = 0; /**< the position of the next robot, 0 if it is to be requested. */
+    };
+
+    /**
+     * @brief A scheduled simulation event.
+     */
+    struct simulated_event {
+        duration_t time_; /**< the time the event happens. */
+        uint64_t sequence_; /**< the scheduling sequence, breaking ties in scheduling order. */
+        std::function<void()> handler_; /**< the handler of the event. */
+
+        bool operator>(const simulated_event& _other) const {
+            return time_ != _other.time_ ? time_ > _other.time_ : sequence_ > _other.sequence_;
+        }
+    };
+
+    mape& mape_; /**< the MAPE deciding the robots. */
+    std::vector<std::string> position_capabilities_; /**< the capabilities files of the robots by initial position - 1. */
+    recipe_parser recipe_parser_; /**< the recipes of the orders. */
+    std::vector<simulated_robot> robots_; /**< the robots by their initial position - 1. */
+    std::vector<size_t> position_robot_; /**< the index of the robot at every conveyor position, robots_.size() for the output. */
+    std::vector<simulated_plate> plates_; /**< the plates by their current position. */
+    std::set<position_t> notifications_; /**< the positions of robots holding a dish for pickup. */
+    bool conveyor_moving_ = false; /**< flag to indicate whether the conveyor is moving. */
+    std::priority_queue<simulated_event, std::vector<simulated_event>, std::greater<simulated_event>> events_; /**< the scheduled events. */
+    uint64_t event_sequence_ = 0; /**< the sequence of the next scheduled event. */
+    duration_t now_ = 0; /**< the simulated time. */
+    std::vector<trace_order> trace_; /**< the replayed trace. */
+    std::vector<duration_t> latencies_; /**< the times from arrival to delivery of the completed orders. */
+    simulation_report report_; /**< the report of the replay in progress. */
+
+    /**
+     * @brief Schedules an event.
+     *
+     * @param _delay the time units from now.
+     * @param _handler the handler of the event.
+     */
+    void
+    schedule(duration_t _delay, std::function<void()> _handler);
+
+    /**
+     * @brief Returns the robot at a position.
+     *
+     * @param _position the conveyor position.
+     * @return simulated_robot* the robot, nullptr for the output position.
+     */
+    simulated_robot*
+    robot_at(position_t _position);
+
+    /**
+     * @brief Determines the run of steps a robot processes on an order, as the robot does on receiving a task.
+     *
+     * @param _robot the robot.
+     * @param _task the order and its processed steps.
+     * @param _tool the equipped tool before the run, updated to the equipped tool after the run.
+     * @param _steps the count of processable steps.
+     * @return duration_t the processing time including retooling.
+     */
+    duration_t
+    determine_run(const simulated_robot& _robot, const simulated_task& _task, robot_tool& _tool, UA_UInt32& _steps);
+
+    /**
+     * @brief Takes the snapshot of the robots the controller decides on.
+     *
+     * @return robot_registry_snapshot the snapshot with the remaining queued work as overall time.
+     */
+    robot_registry_snapshot
+    take_snapshot();
+
+    /**
+     * @brief Decides the next robot of an order with the MAPE, as the controller does.
+     *
+     * @param _task the order and its processed steps.
+     * @param _plate_position the conveyor position of the order's plate, 0 for new orders.
+     * @return position_t the position of the next robot, 0 if no robot without pending adaptation was chosen.
+     */
+    position_t
+    choose_next_robot(const simulated_task& _task, position_t _plate_position);
+
+    /**
+     * @brief Indicates whether any robot, adapting or not, is capable of the next step of an order.
+     *
+     * @param _task the order and its processed steps.
+     * @return true if a robot is capable.
+     * @return false if the order can never be finished.
+     */
+    bool
+    is_processable(const simulated_task& _task);
+
+    /**
+     * @brief Places an order and hands it to the chosen robot, as the kitchen does when its placing gate opens.
+     *
+     * @param _order the index of the order in the trace.
+     */
+    void
+    place_order(size_t _order);
+
+    /**
+     * @brief Hands an order to a robot and starts it if the robot is idle.
+     *
+     * @param _robot the robot.
+     * @param _task the order and its processed steps.
+     */
+    void
+    receive_task(simulated_robot& _robot, simulated_task _task);
+
+    /**
+     * @brief Starts a pending adaptation or the next queued order of a robot.
+     *
+     * @param _robot the robot.
+     */
+    void
+    cook_next_order(simulated_robot& _robot);
+
+    /**
+     * @brief Notifies the conveyor that a robot holds a dish for pickup.
+     *
+     * @param _robot the robot.
+     */
+    void
+    notify_finished_order(simulated_robot& _robot);
+
+    /**
+     * @brief Swaps the positions of two robots, as the controller does on the swap callback.
+     *
+     * @param _from the position of the first robot.
+     * @param _to the position of the second robot, which may be empty.
+     */
+    void
+    swap_robot_positions(position_t _from, position_t _to);
+
+    /**
+     * @brief Reconfigures a robot, as the controller does on the reconfigure callback.
+     *
+     * @param _position the position of the robot.
+     * @param _new_capabilities_profile the new capabilities profile.
+     */
+    void
+    reconfigure_robot(position_t _position, std::string _new_capabilities_profile);
+
+    /**
+     * @brief Moves a rearranging robot to its new position and commits the swap once all robots of the swap arrived.
+     *
+     * @param _robot the robot.
+     */
+    void
+    switch_position(simulated_robot& _robot);
+
+    /**
+     * @brief Applies the new capabilities profile of a reconfiguring robot after the reconfiguration time.
+     *
+     * @param _robot the robot.
+     */
+    void
+    reconfigure(simulated_robot& _robot);
+
+    /**
+     * @brief Retrieves the dishes of notifying robots onto free plates and requests the next robots.
+     *
+     */
+    void
+    retrieve_finished_orders();
+
+    /**
+     * @brief Requests the next robots of the unfinished dishes without target and moves the conveyor by one position.
+     *
+     */
+    void
+    request_next_robots();
+
+    /**
+     * @brief Delivers finished dishes at the output and partially prepared dishes to their target robots.
+     *
+     */
+    void
+    deliver_finished_orders();
+
+    /**
+     * @brief Idles if there are no notifications and occupied plates, otherwise continues retrieving or moving.
+     *
+     */
+    void
+    determine_next_movement();
+
+    /**
+     * @brief Reviews the layout with the MAPE, as the controller does periodically, and schedules the next review
+     * while other events are pending.
+     */
+    void
+    review_layout();
+
+public:
+    /**
+     * @brief Constructs a new kitchen simulator object.
+     *
+     * @param _mape the MAPE deciding the robots, its adaptation callbacks are set to the simulated controller.
+     * @param _position_capabilities the capabilities files of the robots by position - 1.
+     */
+    kitchen_simulator(mape& _mape, const std::vector<std::string>& _position_capabilities);
+
+    /**
+     * @brief Replays a trace in a fresh kitchen.
+     *
+     * @param _trace the orders sorted by arrival.
+     * @param _horizon the time units after the last arrival after which orders still in the kitchen count as unfinished.
+     * @param _verbose flag to indicate whether the log output of the MAPE is kept during the replay.
+     * @return simulation_report the report of the replay.
+     */
+    simulation_report
+    replay(const std::vector<trace_order>& _trace, duration_t _horizon, bool _verbose = false);
+
+    /**
+     * @brief Reads a trace with one order per line, the arrival in time units followed by the recipe id. Empty lines and lines
+     * starting with # are skipped.
+     *
+     * @param _trace_file_path the path of the trace file.
+     * @param _trace the orders sorted by arrival.
+     * @return UA_StatusCode the status code, bad if the file cannot be read or names unknown recipes.
+     */
+    static UA_StatusCode
+    load_trace(const std::string& _trace_file_path, std::vector<trace_order>& _trace);
+};
+
+#endif // KITCHEN_SIMULATOR_HPP
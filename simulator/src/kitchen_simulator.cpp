@@ -0,0 +1,435 @@
+#include "../include/kitchen_simulator.hpp"
+#include <open62541/plugin/log_stdout.h>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include "agent_timings.hpp"
+
+#define OUTPUT_POSITION 0
+
+/**
+ * @brief Returns the CPU milliseconds between two clock readings.
+ *
+ * @param _start the first reading.
+ * @param _end the second reading.
+ * @return double the CPU milliseconds.
+ */
+static double
+cpu_milliseconds(std::clock_t _start, std::clock_t _end) {
+    return 1000.0 * (_end - _start) / CLOCKS_PER_SEC;
+}
+
+kitchen_simulator::kitchen_simulator(mape& _mape, const std::vector<std::string>& _position_capabilities) : mape_(_mape), position_capabilities_(_position_capabilities) {
+    mape_.set_swap_robot_positions_callback([this](position_t _from, position_t _to) {
+        swap_robot_positions(_from, _to);
+    });
+    mape_.set_reconfigure_robot_callback([this](position_t _position, std::string _new_capabilities_profile) {
+        reconfigure_robot(_position, _new_capabilities_profile);
+    });
+}
+
+void
+kitchen_simulator::schedule(duration_t _delay, std::function<void()> _handler) {
+    events_.push({now_ + _delay, event_sequence_++, std::move(_handler)});
+}
+
+kitchen_simulator::simulated_robot*
+kitchen_simulator::robot_at(position_t _position) {
+    size_t robot = position_robot_[_position];
+    return robot < robots_.size() ? &robots_[robot] : nullptr;
+}
+
+duration_t
+kitchen_simulator::determine_run(const simulated_robot& _robot, const simulated_task& _task, robot_tool& _tool, UA_UInt32& _steps) {
+    recipe_steps remaining_steps = recipe_parser_.get_remaining_steps(trace_[_task.order_].recipe_id_, _task.processed_steps_);
+    duration_t run_time = 0;
+    _steps = 0;
+    while (!remaining_steps.empty() && _robot.capabilities_.is_capable_to(remaining_steps.front().get_action_mask())) {
+        run_time += _tool != remaining_steps.front().get_required_tool() ? RETOOLING_TIME : 0;
+        run_time += remaining_steps.front().get_action_duration();
+        _tool = remaining_steps.front().get_required_tool();
+        remaining_steps.pop();
+        _steps++;
+    }
+    return run_time;
+}
+
+robot_registry_snapshot
+kitchen_simulator::take_snapshot() {
+    robot_registry_snapshot snapshot;
+    snapshot.conveyor_size_ = position_robot_.size();
+    for (const simulated_robot& robot : robots_) {
+        duration_t overall_time = robot.preparing_dish_ && !robot.pending_pickup_ ? robot.run_finish_ - now_ : 0;
+        robot_tool last_equipped_tool = robot.current_tool_;
+        for (const simulated_task& task : robot.order_queue_) {
+            UA_UInt32 steps = 0;
+            overall_time += determine_run(robot, task, last_equipped_tool, steps);
+        }
+        snapshot.robots_.emplace(robot.position_, robot_descriptor{robot.endpoint_, robot.position_, robot.capabilities_.get_capabilities_mask(), overall_time,
+            last_equipped_tool, robot.state_ != robot_state::AVAILABLE});
+    }
+    return snapshot;
+}
+
+position_t
+kitchen_simulator::choose_next_robot(const simulated_task& _task, position_t _plate_position) {
+    robot_registry_snapshot snapshot = take_snapshot();
+    recipe_steps remaining_steps = recipe_parser_.get_remaining_steps(trace_[_task.order_].recipe_id_, _task.processed_steps_);
+    std::clock_t decision_start = std::clock();
+    const robot_descriptor* next_robot = mape_.on_new_order(snapshot, remaining_steps, _plate_position);
+    report_.decision_cpu_time_ += cpu_milliseconds(decision_start, std::clock());
+    report_.decisions_++;
+    if (next_robot == nullptr)
+        return 0;
+    /* Adaptations triggered by the decision make the robot unavailable, so the controller returns no robot */
+    simulated_robot* robot = robot_at(next_robot->get_position());
+    if (robot == nullptr || robot->state_ != robot_state::AVAILABLE)
+        return 0;
+    return next_robot->get_position();
+}
+
+bool
+kitchen_simulator::is_processable(const simulated_task& _task) {
+    recipe_steps remaining_steps = recipe_parser_.get_remaining_steps(trace_[_task.order_].recipe_id_, _task.processed_steps_);
+    if (remaining_steps.empty())
+        return true;
+    capability_mask_t action_mask = remaining_steps.front().get_action_mask();
+    for (const simulated_robot& robot : robots_) {
+        if (robot.capabilities_.is_capable_to(action_mask))
+            return true;
+        if (robot.state_ == robot_state::RECONFIGURING && capability_parser(robot.new_capabilities_profile_).is_capable_to(action_mask))
+            return true;
+    }
+    return false;
+}
+
+void
+kitchen_simulator::place_order(size_t _order) {
+    simulated_task task = {_order, 0};
+    position_t position = choose_next_robot(task, 0);
+    simulated_robot* robot = position == 0 ? nullptr : robot_at(position);
+    if (robot == nullptr) {
+        report_.dropped_orders_++;
+        return;
+    }
+    receive_task(*robot, task);
+}
+
+void
+kitchen_simulator::receive_task(simulated_robot& _robot, simulated_task _task) {
+    _robot.order_queue_.push_back(_task);
+    if (!_robot.preparing_dish_ && _robot.state_ == robot_state::AVAILABLE)
+        cook_next_order(_robot);
+}
+
+void
+kitchen_simulator::cook_next_order(simulated_robot& _robot) {
+    if (_robot.state_ == robot_state::REARRANGING) {
+        _robot.preparing_dish_ = false;
+        switch_position(_robot);
+        return;
+    }
+    if (_robot.state_ == robot_state::RECONFIGURING) {
+        _robot.preparing_dish_ = false;
+        reconfigure(_robot);
+        return;
+    }
+    if (_robot.order_queue_.empty()) {
+        _robot.preparing_dish_ = false;
+        return;
+    }
+    _robot.preparing_dish_ = true;
+    simulated_task task = _robot.order_queue_.front();
+    _robot.order_queue_.pop_front();
+    UA_UInt32 steps = 0;
+    duration_t run_time = determine_run(_robot, task, _robot.current_tool_, steps);
+    _robot.task_in_process_ = {task.order_, task.processed_steps_ + steps};
+    _robot.run_finish_ = now_ + run_time;
+    schedule(run_time, [this, &_robot] {
+        notify_finished_order(_robot);
+    });
+}
+
+void
+kitchen_simulator::notify_finished_order(simulated_robot& _robot) {
+    _robot.pending_pickup_ = true;
+    notifications_.insert(_robot.position_);
+    if (conveyor_moving_)
+        return;
+    conveyor_moving_ = true;
+    schedule(CONVEYOR_DEBOUNCE_TIME, [this] {
+        retrieve_finished_orders();
+    });
+}
+
+void
+kitchen_simulator::swap_robot_positions(position_t _from, position_t _to) {
+    report_.requested_swaps_++;
+    if (_from == _to || _from >= position_robot_.size() || _to >= position_robot_.size() || _to == OUTPUT_POSITION)
+        return;
+    simulated_robot* first = robot_at(_from);
+    simulated_robot* second = robot_at(_to);
+    if (first == nullptr || first->state_ != robot_state::AVAILABLE || (second != nullptr && second->state_ != robot_state::AVAILABLE))
+        return;
+    report_.performed_swaps_++;
+    first->state_ = robot_state::REARRANGING;
+    first->new_position_ = _to;
+    first->swap_partner_ = second == nullptr ? 0 : _to;
+    if (!first->preparing_dish_)
+        switch_position(*first);
+    if (second == nullptr)
+        return;
+    second->state_ = robot_state::REARRANGING;
+    second->new_position_ = _from;
+    second->swap_partner_ = _from;
+    if (!second->preparing_dish_)
+        switch_position(*second);
+}
+
+void
+kitchen_simulator::reconfigure_robot(position_t _position, std::string _new_capabilities_profile) {
+    report_.requested_reconfigurations_++;
+    simulated_robot* robot = _position < position_robot_.size() ? robot_at(_position) : nullptr;
+    if (robot == nullptr || robot->state_ != robot_state::AVAILABLE)
+        return;
+    report_.performed_reconfigurations_++;
+    robot->state_ = robot_state::RECONFIGURING;
+    robot->new_capabilities_profile_ = _new_capabilities_profile;
+    if (!robot->preparing_dish_)
+        reconfigure(*robot);
+}
+
+void
+kitchen_simulator::switch_position(simulated_robot& _robot) {
+    position_t conveyor_size = position_robot_.size();
+    position_t cw = (_robot.new_position_ + conveyor_size - _robot.position_) % conveyor_size;
+    position_t ccw = (_robot.position_ + conveyor_size - _robot.new_position_) % conveyor_size;
+    schedule(std::min(cw, ccw) * ROBOT_MOVE_TIME, [this, &_robot] {
+        _robot.arrived_ = true;
+        simulated_robot* partner = _robot.swap_partner_ == 0 ? nullptr : robot_at(_robot.swap_partner_);
+        if (partner != nullptr && !partner->arrived_)
+            return;
+        /* All robots of the swap arrived, so the controller commits the new positions */
+        std::swap(position_robot_[_robot.position_], position_robot_[_robot.new_position_]);
+        for (simulated_robot* robot : {&_robot, partner}) {
+            if (robot == nullptr)
+                continue;
+            robot->position_ = robot->new_position_;
+            robot->new_position_ = 0;
+            robot->swap_partner_ = 0;
+            robot->arrived_ = false;
+            robot->state_ = robot_state::AVAILABLE;
+        }
+        for (simulated_robot* robot : {&_robot, partner}) {
+            if (robot != nullptr)
+                cook_next_order(*robot);
+        }
+    });
+}
+
+void
+kitchen_simulator::reconfigure(simulated_robot& _robot) {
+    schedule(ROBOT_RECONFIGURATION_TIME, [this, &_robot] {
+        /* The queued orders are kept and their runs are determined with the new profile when they are cooked */
+        _robot.capabilities_ = capability_parser(_robot.new_capabilities_profile_);
+        _robot.new_capabilities_profile_ = "";
+        _robot.state_ = robot_state::AVAILABLE;
+        cook_next_order(_robot);
+    });
+}
+
+void
+kitchen_simulator::retrieve_finished_orders() {
+    for (auto notification = notifications_.begin(); notification != notifications_.end();) {
+        simulated_plate& plate = plates_[*notification];
+        if (plate.occupied_) {
+            notification++;
+            continue;
+        }
+        simulated_robot* robot = robot_at(*notification);
+        notification = notifications_.erase(notification);
+        if (robot == nullptr)
+            continue;
+        plate.occupied_ = true;
+        plate.task_ = robot->task_in_process_;
+        plate.is_dish_finished_ = plate.task_.processed_steps_ == recipe_parser_.get_recipe(trace_[plate.task_.order_].recipe_id_).get_step_count();
+        plate.target_position_ = 0;
+        robot->pending_pickup_ = false;
+        cook_next_order(*robot);
+    }
+    request_next_robots();
+}
+
+void
+kitchen_simulator::request_next_robots() {
+    for (position_t position = 0; position < plates_.size(); position++) {
+        simulated_plate& plate = plates_[position];
+        if (!plate.occupied_ || plate.is_dish_finished_ || plate.target_position_ != 0)
+            continue;
+        /* A plate whose next step no robot is capable of would circle forever */
+        if (!is_processable(plate.task_)) {
+            report_.dropped_orders_++;
+            plate = simulated_plate();
+            continue;
+        }
+        plate.target_position_ = choose_next_robot(plate.task_, position);
+    }
+    schedule(CONVEYOR_MOVE_TIME, [this] {
+        std::rotate(plates_.rbegin(), plates_.rbegin() + 1, plates_.rend());
+        deliver_finished_orders();
+        determine_next_movement();
+    });
+}
+
+void
+kitchen_simulator::deliver_finished_orders() {
+    for (position_t position = 0; position < plates_.size(); position++) {
+        simulated_plate& plate = plates_[position];
+        if (!plate.occupied_)
+            continue;
+        if (plate.is_dish_finished_ && position == OUTPUT_POSITION) {
+            latencies_.push_back(now_ - trace_[plate.task_.order_].arrival_);
+            report_.makespan_ = now_;
+            report_.completed_orders_++;
+            plate = simulated_plate();
+            continue;
+        }
+        if (plate.is_dish_finished_ || plate.target_position_ != position)
+            continue;
+        simulated_robot* robot = robot_at(position);
+        if (robot == nullptr || robot->state_ != robot_state::AVAILABLE) {
+            plate.target_position_ = 0;
+            continue;
+        }
+        receive_task(*robot, plate.task_);
+        plate = simulated_plate();
+    }
+}
+
+void
+kitchen_simulator::determine_next_movement() {
+    if (!notifications_.empty()) {
+        retrieve_finished_orders();
+        return;
+    }
+    for (const simulated_plate& plate : plates_) {
+        if (plate.occupied_) {
+            request_next_robots();
+            return;
+        }
+    }
+    conveyor_moving_ = false;
+}
+
+void
+kitchen_simulator::review_layout() {
+    robot_registry_snapshot snapshot = take_snapshot();
+    std::clock_t review_start = std::clock();
+    mape_.on_layout_review(snapshot);
+    report_.review_cpu_time_ += cpu_milliseconds(review_start, std::clock());
+    if (events_.empty())
+        return;
+    schedule(mape_.get_layout_review_period(), [this] {
+        review_layout();
+    });
+}
+
+simulation_report
+kitchen_simulator::replay(const std::vector<trace_order>& _trace, duration_t _horizon, bool _verbose) {
+    std::clock_t replay_start = std::clock();
+    const UA_Logger* stdout_logger = UA_Log_Stdout;
+    UA_Logger silent_logger = {nullptr, nullptr, nullptr};
+    if (!_verbose)
+        UA_Log_Stdout = &silent_logger;
+
+    /* Start from an empty kitchen with the robots at their initial positions */
+    robots_.clear();
+    position_robot_.assign(position_capabilities_.size() + 1, position_capabilities_.size());
+    for (position_t position = 1; position <= position_capabilities_.size(); position++) {
+        robots_.push_back({"robot " + std::to_string(position), position, capability_parser(position_capabilities_[position - 1]), static_cast<robot_tool>(0)});
+        position_robot_[position] = position - 1;
+    }
+    plates_.assign(position_robot_.size(), simulated_plate());
+    notifications_.clear();
+    conveyor_moving_ = false;
+    events_ = {};
+    event_sequence_ = 0;
+    now_ = 0;
+    trace_ = _trace;
+    latencies_.clear();
+    report_ = simulation_report();
+    report_.orders_ = trace_.size();
+
+    /* The kitchen queues the orders and places one per placing rate */
+    duration_t placing_gate = 0;
+    for (size_t order = 0; order < trace_.size(); order++) {
+        duration_t placed = std::max<duration_t>(trace_[order].arrival_, placing_gate);
+        placing_gate = placed + KITCHEN_PLACING_RATE;
+        events_.push({placed, event_sequence_++, [this, order] {
+            place_order(order);
+        }});
+    }
+    if (mape_.get_layout_review_period() != 0) {
+        schedule(mape_.get_layout_review_period(), [this] {
+            review_layout();
+        });
+    }
+    duration_t end = (trace_.empty() ? 0 : trace_.back().arrival_) + _horizon;
+    while (!events_.empty() && events_.top().time_ <= end) {
+        simulated_event event = events_.top();
+        events_.pop();
+        now_ = event.time_;
+        event.handler_();
+    }
+
+    report_.unfinished_orders_ = report_.orders_ - report_.completed_orders_ - report_.dropped_orders_;
+    if (!latencies_.empty()) {
+        std::sort(latencies_.begin(), latencies_.end());
+        double latency_sum = 0;
+        for (duration_t latency : latencies_) {
+            latency_sum += latency;
+        }
+        report_.mean_latency_ = latency_sum / latencies_.size();
+        report_.p99_latency_ = latencies_[static_cast<size_t>(std::ceil(0.99 * latencies_.size())) - 1];
+    }
+    UA_Log_Stdout = stdout_logger;
+    report_.cpu_time_ = cpu_milliseconds(replay_start, std::clock());
+    return report_;
+}
+
+UA_StatusCode
+kitchen_simulator::load_trace(const std::string& _trace_file_path, std::vector<trace_order>& _trace) {
+    _trace.clear();
+    std::ifstream trace_file(_trace_file_path);
+    if (!trace_file.is_open()) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Cannot open trace file %s", __FUNCTION__, _trace_file_path.c_str());
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    recipe_parser recipes;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(trace_file, line)) {
+        line_number++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+        std::istringstream fields(line);
+        trace_order order;
+        std::string rest;
+        if (!(fields >> order.arrival_ >> order.recipe_id_) || (fields >> rest)) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Malformed order in line %zu of %s", __FUNCTION__, line_number, _trace_file_path.c_str());
+            return UA_STATUSCODE_BADDECODINGERROR;
+        }
+        if (!recipes.has_recipe(order.recipe_id_)) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Unknown recipe id %u in line %zu of %s", __FUNCTION__, order.recipe_id_, line_number, _trace_file_path.c_str());
+            return UA_STATUSCODE_BADINVALIDARGUMENT;
+        }
+        _trace.push_back(order);
+    }
+    std::stable_sort(_trace.begin(), _trace.end(), [](const trace_order& _first, const trace_order& _second) {
+        return _first.arrival_ < _second.arrival_;
+    });
+    return UA_STATUSCODE_GOOD;
+}
@@ -1,8 +1,10 @@
 #include <signal.h>
 #include <iostream>
+#include <string>
 
 #include "controller.hpp"
 #include "kitchen_mape.hpp"
+#include "async_logger.hpp"
 
 controller* controller_instance_;
 
@@ -14,9 +16,26 @@ static void stop_handler(int sig) {
 int main(int argc, char* argv[]) {
     signal(SIGINT, stop_handler);
     signal(SIGTERM, stop_handler);
+    kitchen_mape_strategy strategy = kitchen_mape_strategy::SIMPLE_RECONFIGURATION;
+    monitoring_parameters overall_time_parameters;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--earliest-completion-time")
+            strategy = kitchen_mape_strategy::EARLIEST_COMPLETION_TIME;
+        if (std::string(argv[i]) == "--demand-driven-reconfiguration")
+            strategy = kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION;
+        if (std::string(argv[i]) == "--layout-optimization")
+            strategy = kitchen_mape_strategy::LAYOUT_OPTIMIZATION;
+        /* Coarse load updates are opt-in, by default every change of the overall time is reported */
+        if (std::string(argv[i]) == "--overall-time-deadband" && i + 1 < argc) {
+            overall_time_parameters.deadband_type_ = UA_DEADBANDTYPE_ABSOLUTE;
+            overall_time_parameters.deadband_value_ = atof(argv[++i]);
+        }
+    }
+    async_logger::get_instance()->install();
 
-    controller controller_instance(std::make_unique<kitchen_mape>());
+    controller controller_instance(std::make_unique<kitchen_mape>(strategy), overall_time_parameters);
     controller_instance_ = &controller_instance;
     controller_instance.start();
+    async_logger::get_instance()->uninstall();
     return 0;
 }
\ No newline at end of file
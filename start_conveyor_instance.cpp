@@ -1,7 +1,9 @@
 #include <signal.h>
 #include <iostream>
+#include <string>
 
 #include "conveyor.hpp"
+#include "async_logger.hpp"
 
 conveyor* conveyor_instance_;
 
@@ -13,14 +15,17 @@ static void stop_handler(int sig) {
 int main(int argc, char* argv[]) {
     signal(SIGINT, stop_handler);
     signal(SIGTERM, stop_handler);
+    async_logger::get_instance()->install();
     
     if (argc < 2) {
-        std::cout << "Usage: " << argv[0] << "<robots_count>" << std::endl;
+        std::cout << "Usage: " << argv[0] << "<robots_count> [--batch-calls]" << std::endl;
         return 0;
     }
 
-    conveyor conveyor_instance(atoi(argv[1]));
+    bool batch_calls = argc > 2 && std::string(argv[2]) == "--batch-calls";
+    conveyor conveyor_instance(atoi(argv[1]), batch_calls);
     conveyor_instance_ = &conveyor_instance;
     conveyor_instance.start();
+    async_logger::get_instance()->uninstall();
     return 0;
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <signal.h>
 #include <iostream>
+#include <string>
 
 #include "kitchen.hpp"
+#include "async_logger.hpp"
 
 kitchen* kitchen_instance_;
 
@@ -13,13 +15,21 @@ static void stop_handler(int sig) {
 int main(int argc, char* argv[]) {
     signal(SIGINT, stop_handler);
     signal(SIGTERM, stop_handler);
+    async_logger::get_instance()->install();
     
     if (argc < 2) {
-        std::cout << "Usage: " << argv[0] << "<robots_count>" << std::endl;
+        std::cout << "Usage: " << argv[0] << "<robots_count> [--batch-orders] [--plan-routes]" << std::endl;
         return 0;
     }
-    kitchen kitchen_instance(atoi(argv[1]));
+    bool batch_orders = false;
+    bool plan_routes = false;
+    for (int i = 2; i < argc; i++) {
+        batch_orders |= std::string(argv[i]) == "--batch-orders";
+        plan_routes |= std::string(argv[i]) == "--plan-routes";
+    }
+    kitchen kitchen_instance(atoi(argv[1]), batch_orders, plan_routes);
     kitchen_instance_ = &kitchen_instance;
     kitchen_instance.start();
+    async_logger::get_instance()->uninstall();
     return 0;
 }
\ No newline at end of file
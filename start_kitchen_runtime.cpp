@@ -0,0 +1,153 @@
+#include <signal.h>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller.hpp"
+#include "kitchen_mape.hpp"
+#include "conveyor.hpp"
+#include "robot.hpp"
+#include "kitchen.hpp"
+#include "async_logger.hpp"
+#include "discovery_util.hpp"
+#include "kitchen_clock.hpp"
+
+#define STOP_POLL_INTERVAL 100
+
+/**
+ * @brief The capabilities files of the first robot positions as mapped in start_robots.bash, repeated for further positions.
+ */
+static const char* position_capabilities[] = {"r4.json", "r3.json", "r2.json", "r1.json"};
+
+static std::mutex agents_mutex_;
+static std::vector<std::function<void()>> agent_stoppers_;
+static std::atomic<bool> stopping_(false);
+static std::atomic<bool> stop_requested_(false);
+static std::atomic<size_t> running_agents_(0);
+
+static_assert(std::atomic<bool>::is_always_lock_free, "the stop request must be async-signal-safe");
+
+static void
+stop_agents() {
+    std::lock_guard<std::mutex> lock(agents_mutex_);
+    stopping_.store(true);
+    for (std::function<void()>& stop_agent : agent_stoppers_) {
+        stop_agent();
+    }
+}
+
+static void stop_handler(int sig) {
+    /* Only async-signal-safe operations, the agents are stopped from the main thread */
+    stop_requested_.store(true);
+}
+
+/**
+ * @brief Constructs and starts an agent on its own thread. The agent is stopped along with all other agents
+ * and destructed by release_agents.
+ *
+ * @param _construct_agent the factory of the agent.
+ * @return std::thread the thread running the agent until it is stopped.
+ */
+template<typename T>
+static std::thread
+run_agent(std::function<std::unique_ptr<T>()> _construct_agent) {
+    running_agents_++;
+    return std::thread([_construct_agent]() {
+        std::shared_ptr<T> agent = _construct_agent();
+        {
+            std::lock_guard<std::mutex> lock(agents_mutex_);
+            agent_stoppers_.push_back([agent]() {
+                agent->stop();
+            });
+            if (stopping_.load())
+                agent->stop();
+        }
+        agent->start();
+        running_agents_--;
+    });
+}
+
+/**
+ * @brief Destructs the agents in reverse order of their construction. Must be called after all agent threads exited.
+ *
+ */
+static void
+release_agents() {
+    std::lock_guard<std::mutex> lock(agents_mutex_);
+    stopping_.store(true);
+    while (!agent_stoppers_.empty()) {
+        agent_stoppers_.pop_back();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    signal(SIGINT, stop_handler);
+    signal(SIGTERM, stop_handler);
+
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << "<robots_count> [--virtual-time] [--batch-calls] [--earliest-completion-time] [--demand-driven-reconfiguration] [--layout-optimization] [--batch-orders] [--plan-routes]" << std::endl;
+        return 0;
+    }
+    size_t robots_count = atoi(argv[1]);
+    if (robots_count < 1) {
+        std::cout << "robots count must be >= 1" << std::endl;
+        return 0;
+    }
+    bool virtual_time = false;
+    bool batch_calls = false;
+    bool batch_orders = false;
+    bool plan_routes = false;
+    kitchen_mape_strategy strategy = kitchen_mape_strategy::SIMPLE_RECONFIGURATION;
+    for (int i = 2; i < argc; i++) {
+        virtual_time |= std::string(argv[i]) == "--virtual-time";
+        batch_calls |= std::string(argv[i]) == "--batch-calls";
+        batch_orders |= std::string(argv[i]) == "--batch-orders";
+        plan_routes |= std::string(argv[i]) == "--plan-routes";
+        if (std::string(argv[i]) == "--earliest-completion-time")
+            strategy = kitchen_mape_strategy::EARLIEST_COMPLETION_TIME;
+        if (std::string(argv[i]) == "--demand-driven-reconfiguration")
+            strategy = kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION;
+        if (std::string(argv[i]) == "--layout-optimization")
+            strategy = kitchen_mape_strategy::LAYOUT_OPTIMIZATION;
+    }
+    async_logger::get_instance()->install();
+    discovery_util::use_in_process_directory();
+    if (virtual_time)
+        kitchen_clock::use_virtual_time();
+
+    std::vector<std::thread> agent_threads;
+    agent_threads.push_back(run_agent<controller>([strategy]() {
+        return std::make_unique<controller>(std::make_unique<kitchen_mape>(strategy));
+    }));
+    agent_threads.push_back(run_agent<conveyor>([robots_count, batch_calls]() {
+        return std::make_unique<conveyor>(robots_count, batch_calls);
+    }));
+    for (size_t position = 1; position <= robots_count; position++) {
+        agent_threads.push_back(run_agent<robot>([position, robots_count]() {
+            size_t profile_count = sizeof(position_capabilities) / sizeof(position_capabilities[0]);
+            return std::make_unique<robot>(position, position_capabilities[(position - 1) % profile_count], robots_count + 1);
+        }));
+    }
+    agent_threads.push_back(run_agent<kitchen>([robots_count, batch_orders, plan_routes]() {
+        return std::make_unique<kitchen>(robots_count, batch_orders, plan_routes);
+    }));
+    /* Waits for a stop request unless all agents stopped on their own */
+    while (!stop_requested_.load() && running_agents_.load() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(STOP_POLL_INTERVAL));
+    }
+    if (stop_requested_.load())
+        std::cout << "received ctrl-c" << std::endl;
+    stop_agents();
+    for (std::thread& agent_thread : agent_threads) {
+        agent_thread.join();
+    }
+    release_agents();
+    async_logger::get_instance()->uninstall();
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "kitchen_mape.hpp"
+#include "kitchen_simulator.hpp"
+#include "time_unit.hpp"
+
+/* The time units after the last arrival after which orders still in the kitchen count as unfinished */
+#define DEFAULT_HORIZON 100000ULL
+
+/**
+ * @brief The capabilities files by robot position, as mapped in start_robots.bash.
+ */
+static const char* position_capabilities[] = {"r4.json", "r3.json", "r2.json", "r1.json"};
+
+/**
+ * @brief The replayed strategies and their names.
+ */
+static const std::pair<kitchen_mape_strategy, const char*> strategies[] = {
+    {kitchen_mape_strategy::SIMPLE_CAPABILITY_CHECK, "simple capability check"},
+    {kitchen_mape_strategy::SIMPLE_REARRANGING, "simple rearranging"},
+    {kitchen_mape_strategy::SIMPLE_RECONFIGURATION, "simple reconfiguration"},
+    {kitchen_mape_strategy::EARLIEST_COMPLETION_TIME, "earliest completion time"},
+    {kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION, "demand-driven reconfiguration"},
+    {kitchen_mape_strategy::LAYOUT_OPTIMIZATION, "layout optimization"}
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <trace_file> [--robots <capabilities files by position, comma separated>] [--horizon <time units>] [--verbose]" << std::endl;
+        return 0;
+    }
+    std::vector<std::string> robots(std::begin(position_capabilities), std::end(position_capabilities));
+    duration_t horizon = DEFAULT_HORIZON;
+    bool verbose = false;
+    for (int i = 2; i < argc; i++) {
+        std::string argument(argv[i]);
+        verbose |= argument == "--verbose";
+        if (argument == "--robots" && i + 1 < argc) {
+            robots.clear();
+            std::istringstream files(argv[++i]);
+            for (std::string file; std::getline(files, file, ',');) {
+                robots.push_back(file);
+            }
+        } else if (argument == "--horizon" && i + 1 < argc) {
+            horizon = std::strtoull(argv[++i], nullptr, 10);
+        }
+    }
+    if (robots.empty()) {
+        std::cout << "at least one robot is required" << std::endl;
+        return 0;
+    }
+    std::vector<trace_order> trace;
+    if (kitchen_simulator::load_trace(argv[1], trace) != UA_STATUSCODE_GOOD)
+        return 1;
+
+    std::printf("%zu orders on %zu robots, times in ms, CPU in ms per thousand orders\n", trace.size(), robots.size());
+    std::printf("%-30s %10s %10s %10s %9s %8s %10s %14s %18s %10s %12s %12s\n", "strategy", "makespan", "mean", "p99", "completed", "dropped", "unfinished",
+        "swaps", "reconfigurations", "cpu", "mape cpu", "review cpu");
+    for (const auto& [strategy, name] : strategies) {
+        kitchen_mape mape(strategy);
+        kitchen_simulator simulator(mape, robots);
+        simulation_report report = simulator.replay(trace, horizon, verbose);
+        double per_thousand_orders = report.orders_ == 0 ? 0 : 1000.0 / report.orders_;
+        std::string swaps = std::to_string(report.performed_swaps_) + "/" + std::to_string(report.requested_swaps_);
+        std::string reconfigurations = std::to_string(report.performed_reconfigurations_) + "/" + std::to_string(report.requested_reconfigurations_);
+        std::printf("%-30s %10llu %10.0f %10llu %9zu %8zu %10zu %14s %18s %10.2f %12.2f %12.2f\n", name,
+            (unsigned long long) report.makespan_ * TIME_UNIT, report.mean_latency_ * TIME_UNIT, (unsigned long long) report.p99_latency_ * TIME_UNIT,
+            report.completed_orders_, report.dropped_orders_, report.unfinished_orders_, swaps.c_str(), reconfigurations.c_str(),
+            report.cpu_time_ * per_thousand_orders, report.decision_cpu_time_ * per_thousand_orders, report.review_cpu_time_ * per_thousand_orders);
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <iostream>
 
 #include "robot.hpp"
+#include "async_logger.hpp"
 
 robot* robot_instance_;
 
@@ -13,14 +14,17 @@ static void stop_handler(int sig) {
 int main(int argc, char* argv[]) {
     signal(SIGINT, stop_handler);
     signal(SIGTERM, stop_handler);
+    async_logger::get_instance()->install();
     
     // _position
     if (argc < 4) {
-        std::cout << "Usage: " << argv[0] << "<position> <capabilities_file_name> <conveyor_size>" << std::endl;
+        std::cout << "Usage: " << argv[0] << "<position> <capabilities_file_name> <conveyor_size> [<overall_time_publish_rate>]" << std::endl;
         return 0;
     }
-    robot robot_instance(atoi(argv[1]), argv[2], atoi(argv[3]));
+    duration_t overall_time_publish_rate = argc > 4 ? atoi(argv[4]) : 1;
+    robot robot_instance(atoi(argv[1]), argv[2], atoi(argv[3]), overall_time_publish_rate);
     robot_instance_ = &robot_instance;
     robot_instance.start();
+    async_logger::get_instance()->uninstall();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <open62541/plugin/log_stdout.h>
+#include <stdio.h>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "async_logger.hpp"
+
+#define assertm(exp, msg) assert(((void)msg, exp))
+
+#define THREAD_COUNT 8
+#define MESSAGES_PER_THREAD 100000
+
+/**
+ * @brief Counts the records and dropped records written to the sink.
+ */
+static void
+count_sink_lines(FILE* _sink, size_t& _records, size_t& _dropped) {
+    rewind(_sink);
+    char line[ASYNC_LOG_MESSAGE_SIZE + 64];
+    _records = 0;
+    _dropped = 0;
+    while (fgets(line, sizeof(line), _sink) != nullptr) {
+        unsigned long dropped = 0;
+        if (sscanf(line, "async_logger: dropped %lu", &dropped) == 1)
+            _dropped += dropped;
+        else
+            _records++;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    FILE* sink = tmpfile();
+    assertm(sink != nullptr, "Temporary sink should be created");
+    double max_log_us = 0.0;
+    {
+        async_logger logger(sink, UA_LOGLEVEL_INFO);
+        logger.install();
+        std::vector<std::thread> threads;
+        std::vector<double> thread_max_log_us(THREAD_COUNT, 0.0);
+        for (size_t t = 0; t < THREAD_COUNT; t++) {
+            threads.emplace_back([t, &thread_max_log_us]() {
+                for (size_t i = 0; i < MESSAGES_PER_THREAD; i++) {
+                    auto start = std::chrono::steady_clock::now();
+                    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "thread %zu message %zu", t, i);
+                    UA_LOG_DEBUG(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "filtered by level");
+                    double log_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                    if (log_us > thread_max_log_us[t])
+                        thread_max_log_us[t] = log_us;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        logger.uninstall();
+        assertm(UA_Log_Stdout == &UA_Log_Stdout_, "Uninstall should restore the stdout logger");
+        size_t records = 0, dropped = 0;
+        count_sink_lines(sink, records, dropped);
+        assertm(dropped == logger.get_dropped(), "Every dropped record should be reported");
+        assertm(records + dropped == THREAD_COUNT * MESSAGES_PER_THREAD, "Every record should be written or dropped");
+        for (double log_us : thread_max_log_us) {
+            max_log_us = log_us > max_log_us ? log_us : max_log_us;
+        }
+        printf("%zu records written, %zu dropped, slowest log call %.1f us\n", records, dropped, max_log_us);
+    }
+    fclose(sink);
+    return 0;
+}
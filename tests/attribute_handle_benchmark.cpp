@@ -0,0 +1,90 @@
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+#include <chrono>
+#include <cassert>
+#include "object_type_node_inserter.hpp"
+
+#define assertm(exp, msg) assert(((void)msg, exp))
+
+#define BENCHMARK_TYPE "BenchmarkType"
+#define BENCHMARK_INSTANCE "BenchmarkInstance"
+#define BENCHMARK_ATTRIBUTE "OverallTime"
+#define WRITE_ITERATIONS 100000
+
+/**
+ * @brief Writes the attribute by translating the browse path on every write as before the handle cache.
+ */
+static UA_StatusCode
+write_with_browse_path_translation(UA_Server* _server, UA_NodeId _instance_id, UA_UInt32* _value) {
+    UA_RelativePathElement rpe;
+    UA_RelativePathElement_init(&rpe);
+    rpe.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+    rpe.isInverse = false;
+    rpe.includeSubtypes = false;
+    rpe.targetName = UA_QUALIFIEDNAME(1, const_cast<char*>(BENCHMARK_ATTRIBUTE));
+    UA_BrowsePath bp;
+    UA_BrowsePath_init(&bp);
+    bp.startingNode = _instance_id;
+    bp.relativePath.elementsSize = 1;
+    bp.relativePath.elements = &rpe;
+    UA_BrowsePathResult bpr = UA_Server_translateBrowsePathToNodeIds(_server, &bp);
+    if (bpr.statusCode != UA_STATUSCODE_GOOD || bpr.targetsSize < 1) {
+        UA_BrowsePathResult_clear(&bpr);
+        return UA_STATUSCODE_BAD;
+    }
+    UA_Variant value;
+    UA_Variant_setScalar(&value, _value, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode status = UA_Server_writeValue(_server, bpr.targets[0].targetId.nodeId, value);
+    UA_BrowsePathResult_clear(&bpr);
+    return status;
+}
+
+template<typename F>
+static double
+nanoseconds_per_write(F _write) {
+    auto start = std::chrono::steady_clock::now();
+    for (UA_UInt32 i = 0; i < WRITE_ITERATIONS; i++) {
+        _write(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / WRITE_ITERATIONS;
+}
+
+int main(int argc, char* argv[]) {
+    UA_Server* server = UA_Server_new();
+    UA_ServerConfig* server_config = UA_Server_getConfig(server);
+    UA_StatusCode status = UA_ServerConfig_setMinimal(server_config, 0, NULL);
+    assertm(status == UA_STATUSCODE_GOOD, "Server config should be set up");
+    {
+        object_type_node_inserter inserter(server, BENCHMARK_TYPE);
+        inserter.add_attribute(BENCHMARK_TYPE, BENCHMARK_ATTRIBUTE);
+        inserter.add_object_instance(BENCHMARK_INSTANCE, BENCHMARK_TYPE);
+        UA_NodeId instance_id = inserter.get_instance_id(BENCHMARK_INSTANCE);
+
+        double translated = nanoseconds_per_write([&](UA_UInt32 _i) {
+            write_with_browse_path_translation(server, instance_id, &_i);
+        });
+        double by_name = nanoseconds_per_write([&](UA_UInt32 _i) {
+            inserter.set_scalar_attribute(BENCHMARK_INSTANCE, BENCHMARK_ATTRIBUTE, &_i, UA_TYPES_UINT32);
+        });
+        attribute_handle handle;
+        status = inserter.resolve_attribute(BENCHMARK_INSTANCE, BENCHMARK_ATTRIBUTE, handle);
+        assertm(status == UA_STATUSCODE_GOOD && handle.is_resolved(), "Attribute handle should be resolved");
+        double by_handle = nanoseconds_per_write([&](UA_UInt32 _i) {
+            inserter.set_scalar_attribute(handle, &_i, UA_TYPES_UINT32);
+        });
+
+        UA_Variant value;
+        UA_Variant_init(&value);
+        status = inserter.get_attribute(handle, value);
+        assertm(status == UA_STATUSCODE_GOOD && *(UA_UInt32*) value.data == WRITE_ITERATIONS - 1, "Handle read should return the last written value");
+        UA_Variant_clear(&value);
+
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Browse path translation per write: %.1f ns", translated);
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Cached lookup by name per write: %.1f ns", by_name);
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Resolved handle per write: %.1f ns", by_handle);
+    }
+    UA_Server_delete(server);
+    return 0;
+}
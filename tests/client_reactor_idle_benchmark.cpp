@@ -0,0 +1,142 @@
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "client_connection_establisher.hpp"
+#include "client_reactor.hpp"
+#include "node_value_subscriber.hpp"
+
+#define assertm(exp, msg) assert(((void)msg, exp))
+
+#define SERVER_PORT 4850
+#define SERVER_ENDPOINT "opc.tcp://localhost:4850"
+#define IDLE_WINDOW_MS 5000
+
+/**
+ * @brief Returns the user and system CPU time consumed by this process in microseconds.
+ */
+static long
+process_cpu_time_us() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000L + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/**
+ * @brief Measures the CPU utilization in percent of one core over the idle window.
+ */
+static double
+idle_cpu_percent() {
+    long cpu_start = process_cpu_time_us();
+    std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_WINDOW_MS));
+    return 100.0 * (process_cpu_time_us() - cpu_start) / (IDLE_WINDOW_MS * 1000.0);
+}
+
+static void
+current_time_changed(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context,
+    UA_UInt32 _mon_id, void* _mon_context, UA_DataValue* _value) {
+}
+
+/**
+ * @brief Remote agent proxy as before the reactor: one client with its own iterate thread polling every millisecond.
+ */
+struct polling_remote_agent {
+    UA_Client* client_ = nullptr;
+    std::unique_ptr<node_value_subscriber> nv_subscriber_;
+    std::atomic<bool> running_{true};
+    std::mutex client_mutex_;
+    std::thread client_iterate_thread_;
+
+    bool start() {
+        if (!client_connection_establisher().establish_connection(client_, SERVER_ENDPOINT))
+            return false;
+        nv_subscriber_ = std::make_unique<node_value_subscriber>(client_);
+        if (nv_subscriber_->subscribe_node_value(UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME), current_time_changed, this) != UA_STATUSCODE_GOOD)
+            return false;
+        client_iterate_thread_ = std::thread([this]() {
+            while (running_.load()) {
+                {
+                    std::lock_guard<std::mutex> lock(client_mutex_);
+                    UA_Client_run_iterate(client_, 1);
+                }
+                usleep(1*1000);
+            }
+        });
+        return true;
+    }
+
+    ~polling_remote_agent() {
+        running_.store(false);
+        if (client_iterate_thread_.joinable())
+            client_iterate_thread_.join();
+        nv_subscriber_.reset();
+        UA_Client_delete(client_);
+    }
+};
+
+/**
+ * @brief Remote agent proxy on the shared client reactor.
+ */
+struct reactor_remote_agent {
+    UA_Client* client_ = nullptr;
+    std::unique_ptr<node_value_subscriber> nv_subscriber_;
+
+    bool start() {
+        client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+        if (!client_reactor::get_instance()->connect(client_, SERVER_ENDPOINT, nullptr))
+            return false;
+        nv_subscriber_ = std::make_unique<node_value_subscriber>(client_);
+        return nv_subscriber_->subscribe_node_value(UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME), current_time_changed, this) == UA_STATUSCODE_GOOD;
+    }
+
+    ~reactor_remote_agent() {
+        client_reactor::loop_lock lock = client_reactor::get_instance()->lock();
+        nv_subscriber_.reset();
+        client_reactor::get_instance()->delete_client(client_);
+    }
+};
+
+template<typename T>
+static double
+measure_idle_cpu(size_t _agent_count) {
+    std::vector<std::unique_ptr<T>> agents;
+    for (size_t i = 0; i < _agent_count; i++) {
+        agents.push_back(std::make_unique<T>());
+        assertm(agents.back()->start(), "Remote agent should connect and subscribe");
+    }
+    return idle_cpu_percent();
+}
+
+int main(int argc, char* argv[]) {
+    UA_Server* server = UA_Server_new();
+    UA_ServerConfig* server_config = UA_Server_getConfig(server);
+    UA_StatusCode status = UA_ServerConfig_setMinimal(server_config, SERVER_PORT, NULL);
+    assertm(status == UA_STATUSCODE_GOOD, "Server config should be set up");
+    volatile UA_Boolean server_running = true;
+    std::thread server_thread([&]() {
+        UA_Server_run(server, &server_running);
+    });
+    sleep(1);
+
+    double baseline = idle_cpu_percent();
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Idle CPU without remote agents: %.2f%%", baseline);
+    for (size_t agent_count : {4, 16, 64}) {
+        double polling = measure_idle_cpu<polling_remote_agent>(agent_count);
+        double reactor = measure_idle_cpu<reactor_remote_agent>(agent_count);
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Idle CPU with %zu remote agents: %.2f%% with iterate threads, %.2f%% with the client reactor", agent_count, polling, reactor);
+    }
+
+    server_running = false;
+    server_thread.join();
+    UA_Server_delete(server);
+    return 0;
+}
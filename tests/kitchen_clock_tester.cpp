@@ -0,0 +1,192 @@
+#include <open62541/plugin/log_stdout.h>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "kitchen_clock.hpp"
+
+#define assertm(exp, msg) assert(((void)msg, exp))
+
+#define AGENT_COUNT 4
+#define STEPS_PER_AGENT 200
+#define STEP_DURATION_MS 1000
+#define ORDER_COUNT 20
+#define PLACING_DURATION_MS 1000
+#define COOKING_DURATION_MS 1500
+#define COOKING_PREPARATION_MS 20
+
+/**
+ * @brief Simulated agent waiting a staggered duration per step, recording the virtual completion times.
+ */
+struct simulated_agent {
+    kitchen_timer timer_;
+    size_t index_;
+    size_t steps_;
+    std::vector<kitchen_clock::time_point> completions_;
+
+    simulated_agent(boost::asio::io_context& _io_context, size_t _index) : timer_(_io_context), index_(_index), steps_(0) {
+    }
+
+    void
+    step() {
+        timer_.expires_after(std::chrono::milliseconds(STEP_DURATION_MS * (index_ + 1)));
+        timer_.async_wait([this](const boost::system::error_code& _error) {
+            assertm(!_error, "Timer should expire without error");
+            completions_.push_back(kitchen_clock::now());
+            if (++steps_ < STEPS_PER_AGENT)
+                step();
+        });
+    }
+};
+
+/**
+ * @brief Schedule of events of interacting agents, recorded with their virtual time.
+ */
+struct simulated_schedule {
+    std::mutex mutex_;
+    std::vector<std::pair<long, std::string>> events_;
+
+    void
+    record(kitchen_clock::time_point _start, std::string _event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back({std::chrono::duration_cast<std::chrono::milliseconds>(kitchen_clock::now() - _start).count(), _event});
+    }
+};
+
+/**
+ * @brief Simulated cook preparing orders concurrently on its own thread. The preparation takes real time before
+ * the cooking is timed, so the virtual time must not advance meanwhile.
+ */
+struct simulated_cook {
+    boost::asio::io_context& io_context_;
+    std::vector<std::unique_ptr<kitchen_timer>> timers_;
+    simulated_schedule& schedule_;
+    kitchen_clock::time_point start_;
+
+    simulated_cook(boost::asio::io_context& _io_context, simulated_schedule& _schedule, kitchen_clock::time_point _start) :
+        io_context_(_io_context), schedule_(_schedule), start_(_start) {
+    }
+
+    void
+    receive_order(size_t _order, boost::asio::io_context& _reply_context, std::function<void(size_t)> _served) {
+        boost::asio::post(io_context_, kitchen_clock::tracked([this, _order, &_reply_context, _served] {
+            schedule_.record(start_, "received " + std::to_string(_order));
+            std::this_thread::sleep_for(std::chrono::milliseconds(COOKING_PREPARATION_MS));
+            timers_.push_back(std::make_unique<kitchen_timer>(io_context_));
+            timers_.back()->expires_after(std::chrono::milliseconds(COOKING_DURATION_MS));
+            timers_.back()->async_wait([this, _order, &_reply_context, _served](const boost::system::error_code& _error) {
+                assertm(!_error, "Cooking should complete without error");
+                schedule_.record(start_, "cooked " + std::to_string(_order));
+                boost::asio::post(_reply_context, kitchen_clock::tracked([_order, _served] {
+                    _served(_order);
+                }));
+            });
+        }));
+    }
+};
+
+/**
+ * @brief Simulated kitchen placing an order per period at the cook and recording when it is served.
+ */
+struct simulated_kitchen {
+    boost::asio::io_context& io_context_;
+    kitchen_timer timer_;
+    simulated_cook& cook_;
+    simulated_schedule& schedule_;
+    kitchen_clock::time_point start_;
+    size_t placed_;
+    size_t served_;
+    std::function<void()> all_served_;
+
+    simulated_kitchen(boost::asio::io_context& _io_context, simulated_cook& _cook, simulated_schedule& _schedule, kitchen_clock::time_point _start,
+                      std::function<void()> _all_served) :
+        io_context_(_io_context), timer_(_io_context), cook_(_cook), schedule_(_schedule), start_(_start), placed_(0), served_(0), all_served_(_all_served) {
+    }
+
+    void
+    place_next_order() {
+        timer_.expires_after(std::chrono::milliseconds(PLACING_DURATION_MS));
+        timer_.async_wait([this](const boost::system::error_code& _error) {
+            assertm(!_error, "Placing should complete without error");
+            size_t order = placed_++;
+            schedule_.record(start_, "placed " + std::to_string(order));
+            cook_.receive_order(order, io_context_, [this](size_t _order) {
+                schedule_.record(start_, "served " + std::to_string(_order));
+                if (++served_ == ORDER_COUNT)
+                    all_served_();
+            });
+            if (placed_ < ORDER_COUNT)
+                place_next_order();
+        });
+    }
+};
+
+/**
+ * @brief Tests that interacting agents on separate threads follow the same schedule in virtual time as in real time,
+ * even if they take longer than the timer polling to react to each other.
+ */
+void
+test_interacting_agents() {
+    boost::asio::io_context kitchen_context;
+    boost::asio::io_context cook_context;
+    auto kitchen_work = boost::asio::make_work_guard(kitchen_context);
+    auto cook_work = boost::asio::make_work_guard(cook_context);
+    simulated_schedule schedule;
+    kitchen_clock::time_point start = kitchen_clock::now();
+    simulated_cook cook(cook_context, schedule, start);
+    simulated_kitchen kitchen(kitchen_context, cook, schedule, start, [&kitchen_work, &cook_work] {
+        kitchen_work.reset();
+        cook_work.reset();
+    });
+    kitchen.place_next_order();
+    std::thread cook_thread([&cook_context] {
+        cook_context.run();
+    });
+    kitchen_context.run();
+    cook_thread.join();
+
+    std::vector<std::pair<long, std::string>> expected;
+    for (size_t order = 0; order < ORDER_COUNT; order++) {
+        long placed = (order + 1) * PLACING_DURATION_MS;
+        expected.push_back({placed, "placed " + std::to_string(order)});
+        expected.push_back({placed, "received " + std::to_string(order)});
+        expected.push_back({placed + COOKING_DURATION_MS, "cooked " + std::to_string(order)});
+        expected.push_back({placed + COOKING_DURATION_MS, "served " + std::to_string(order)});
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(schedule.events_.begin(), schedule.events_.end());
+    assertm(schedule.events_ == expected, "Interacting agents should follow the real time schedule");
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Interacting agents followed the schedule of %zu events", expected.size());
+}
+
+int main(int argc, char* argv[]) {
+    kitchen_clock::use_virtual_time();
+    boost::asio::io_context io_context;
+    std::vector<std::unique_ptr<simulated_agent>> agents;
+    kitchen_clock::time_point virtual_start = kitchen_clock::now();
+    auto real_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < AGENT_COUNT; i++) {
+        agents.push_back(std::make_unique<simulated_agent>(io_context, i));
+        agents.back()->step();
+    }
+    io_context.run();
+    double real_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start).count();
+    double virtual_seconds = std::chrono::duration<double>(kitchen_clock::now() - virtual_start).count();
+
+    for (const std::unique_ptr<simulated_agent>& agent : agents) {
+        assertm(agent->completions_.size() == STEPS_PER_AGENT, "Every step should complete");
+        for (size_t step = 0; step < STEPS_PER_AGENT; step++) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(agent->completions_[step] - virtual_start).count();
+            assertm(elapsed == (long) ((step + 1) * STEP_DURATION_MS * (agent->index_ + 1)), "Steps should complete at their exact virtual time");
+        }
+    }
+    assertm(real_seconds < virtual_seconds, "Virtual time should run faster than real time");
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Simulated %.0f s in %.2f s", virtual_seconds, real_seconds);
+
+    test_interacting_agents();
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <open62541/plugin/log_stdout.h>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "kitchen_mape.hpp"
+#include "kitchen_simulator.hpp"
+
+#define assertm(exp, msg) assert(((void)msg, exp))
+
+#define ORDERS_PER_RECIPE 20
+#define ARRIVAL_RATE 3
+#define HORIZON 100000
+
+/**
+ * @brief The capabilities files by robot position, every profile is available twice.
+ */
+static const std::vector<std::string> position_capabilities = {"r4.json", "r3.json", "r2.json", "r1.json", "r4.json", "r3.json", "r2.json", "r1.json"};
+
+/**
+ * @brief Replays a trace with a fresh MAPE of the given strategy.
+ *
+ * @param _strategy the robot selection strategy.
+ * @param _trace the orders.
+ * @return simulation_report the report of the replay.
+ */
+static simulation_report
+replay(kitchen_mape_strategy _strategy, const std::vector<trace_order>& _trace) {
+    kitchen_mape mape(_strategy);
+    kitchen_simulator simulator(mape, position_capabilities);
+    return simulator.replay(_trace, HORIZON);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<trace_order> trace;
+    for (size_t order = 0; order < 3 * ORDERS_PER_RECIPE; order++) {
+        trace.push_back({order * ARRIVAL_RATE, static_cast<recipe_id_t>(order % 3 + 1)});
+    }
+
+    /* Every order is accounted for and replays are deterministic */
+    for (kitchen_mape_strategy strategy : {kitchen_mape_strategy::SIMPLE_CAPABILITY_CHECK, kitchen_mape_strategy::SIMPLE_REARRANGING,
+                                           kitchen_mape_strategy::SIMPLE_RECONFIGURATION, kitchen_mape_strategy::EARLIEST_COMPLETION_TIME,
+                                           kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION, kitchen_mape_strategy::LAYOUT_OPTIMIZATION}) {
+        simulation_report report = replay(strategy, trace);
+        assertm(report.orders_ == trace.size(), "The report should cover the trace");
+        assertm(report.completed_orders_ + report.dropped_orders_ + report.unfinished_orders_ == report.orders_, "Every order should be completed, dropped or unfinished");
+        assertm(report.performed_swaps_ <= report.requested_swaps_, "Only requested swaps should be performed");
+        assertm(report.performed_reconfigurations_ <= report.requested_reconfigurations_, "Only requested reconfigurations should be performed");
+        assertm(report.completed_orders_ == 0 || (report.mean_latency_ <= report.p99_latency_ && report.p99_latency_ <= report.makespan_), "Latencies should be bounded by the makespan");
+        simulation_report repeated = replay(strategy, trace);
+        assertm(repeated.makespan_ == report.makespan_ && repeated.completed_orders_ == report.completed_orders_ && repeated.p99_latency_ == report.p99_latency_
+            && repeated.requested_swaps_ == report.requested_swaps_ && repeated.requested_reconfigurations_ == report.requested_reconfigurations_, "Replays should be deterministic");
+    }
+
+    /* Without adaptations every order is completed, and choosing by completion time does not slow the kitchen down */
+    simulation_report simple = replay(kitchen_mape_strategy::SIMPLE_CAPABILITY_CHECK, trace);
+    simulation_report earliest = replay(kitchen_mape_strategy::EARLIEST_COMPLETION_TIME, trace);
+    assertm(simple.completed_orders_ == trace.size() && earliest.completed_orders_ == trace.size(), "Every order should be completed");
+    assertm(simple.requested_swaps_ == 0 && simple.requested_reconfigurations_ == 0, "The simple capability check should not adapt the kitchen");
+    assertm(earliest.makespan_ <= simple.makespan_, "Earliest completion time should not increase the makespan");
+    assertm(earliest.mean_latency_ <= simple.mean_latency_, "Earliest completion time should not increase the mean latency");
+
+    /* The demand-driven planner reorders the reversed layout along the recipes, once */
+    kitchen_mape demand_driven_mape(kitchen_mape_strategy::DEMAND_DRIVEN_RECONFIGURATION);
+    simulation_report demand_driven = kitchen_simulator(demand_driven_mape, {"r4.json", "r3.json", "r2.json", "r1.json"}).replay(trace, HORIZON);
+    assertm(demand_driven.requested_reconfigurations_ > 0, "The reversed layout should be reconfigured");
+    assertm(demand_driven.requested_reconfigurations_ <= 4, "The hysteresis should keep the planned layout");
+
+    /* The layout optimization rearranges the reversed layout with the fewest swaps, a swap places two robots each */
+    kitchen_mape layout_mape(kitchen_mape_strategy::LAYOUT_OPTIMIZATION);
+    simulation_report layout = kitchen_simulator(layout_mape, {"r4.json", "r3.json", "r2.json", "r1.json"}).replay(trace, HORIZON);
+    assertm(layout.requested_swaps_ == 2 && layout.performed_swaps_ == 2, "The reversed layout should be rearranged by two swaps");
+    std::vector<std::pair<position_t, position_t>> rotation = capability_planner::get_arrangement_swaps({0, 1, 2, 4}, {0, 2, 4, 1});
+    assertm(rotation.size() == 2, "A rotation of three robots should take two swaps");
+    assertm(capability_planner::get_arrangement_swaps({0, 1, 2}, {0, 1, 4}).empty(), "Layouts with other robots should not be rearranged");
+
+    /* Orders of a recipe no robot is capable of are dropped */
+    kitchen_mape single_robot_mape(kitchen_mape_strategy::SIMPLE_CAPABILITY_CHECK);
+    simulation_report incapable = kitchen_simulator(single_robot_mape, {"r4.json"}).replay(trace, HORIZON);
+    assertm(incapable.completed_orders_ + incapable.dropped_orders_ == trace.size() && incapable.dropped_orders_ > 0, "Orders without capable robot should be dropped");
+
+    /* Traces are read sorted by arrival */
+    std::string trace_file_path = "kitchen_simulator_tester_trace.txt";
+    {
+        std::ofstream trace_file(trace_file_path);
+        trace_file << "# arrival recipe\n10 2\n\n0 1\n10 3\n";
+    }
+    std::vector<trace_order> loaded;
+    assertm(kitchen_simulator::load_trace(trace_file_path, loaded) == UA_STATUSCODE_GOOD, "The trace should be read");
+    assertm(loaded.size() == 3 && loaded[0].recipe_id_ == 1 && loaded[1].recipe_id_ == 2 && loaded[2].recipe_id_ == 3, "The orders should be sorted by arrival");
+    {
+        std::ofstream trace_file(trace_file_path);
+        trace_file << "0 1 2\n";
+    }
+    assertm(kitchen_simulator::load_trace(trace_file_path, loaded) != UA_STATUSCODE_GOOD, "Malformed traces should be rejected");
+    std::remove(trace_file_path.c_str());
+
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Simulated %zu orders: makespan %lu and mean latency %.1f with simple capability check, makespan %lu and mean latency %.1f with earliest completion time",
+        trace.size(), (unsigned long) simple.makespan_, simple.mean_latency_, (unsigned long) earliest.makespan_, earliest.mean_latency_);
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include <open62541/plugin/log_stdout.h>
+#include <cassert>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+#include "kitchen_mape.hpp"
+#include "agent_timings.hpp"
+
+#define assertm(exp, msg) assert(((void)msg, exp))
+
+#define ROBOT_COUNT 8
+#define CONVEYOR_SIZE (ROBOT_COUNT + 1)
+#define ORDERS_PER_RECIPE 6
+#define ORDER_BATCH_SIZE 16
+
+/**
+ * @brief The capabilities files by robot position, every profile is available twice.
+ */
+static const char* position_capabilities[ROBOT_COUNT] = {"r4.json", "r3.json", "r2.json", "r1.json", "r4.json", "r3.json", "r2.json", "r1.json"};
+
+/**
+ * @brief The simulated state of a robot.
+ */
+struct simulated_robot {
+    capability_mask_t capabilities_mask_; /**< the capability mask. */
+    duration_t busy_until_; /**< the time the robot finishes its queued work. */
+    robot_tool last_equipped_tool_; /**< the tool equipped for the last queued step. */
+};
+
+/**
+ * @brief An order waiting for its next robot.
+ */
+struct order_event {
+    duration_t ready_; /**< the time the order requests its next robot. */
+    size_t order_; /**< the order number, breaking ties in placement order. */
+    recipe_id_t recipe_id_; /**< the recipe id. */
+    UA_UInt32 processed_steps_; /**< the processed steps. */
+    position_t plate_position_; /**< the plate position, 0 for new orders. */
+    bool batch_ = false; /**< flag to indicate whether the event places the batch of new orders starting at the order number. */
+    std::vector<position_t> route_ = {}; /**< the planned positions of the next robots, empty if the next robot is chosen on request. */
+
+    bool operator>(const order_event& _other) const {
+        return ready_ != _other.ready_ ? ready_ > _other.ready_ : order_ > _other.order_;
+    }
+};
+
+/**
+ * @brief Returns the registry snapshot of the simulated robots at the given time.
+ *
+ * @param _robots the simulated robots by position - 1.
+ * @param _now the simulated time.
+ * @return robot_registry_snapshot the snapshot with the remaining queued work as overall time.
+ */
+static robot_registry_snapshot
+take_snapshot(const std::vector<simulated_robot>& _robots, duration_t _now) {
+    robot_registry_snapshot snapshot;
+    snapshot.conveyor_size_ = CONVEYOR_SIZE;
+    for (position_t position = 1; position <= _robots.size(); position++) {
+        const simulated_robot& robot = _robots[position - 1];
+        duration_t overall_time = robot.busy_until_ > _now ? robot.busy_until_ - _now : 0;
+        snapshot.robots_.emplace(position, robot_descriptor{"robot " + std::to_string(position), position, robot.capabilities_mask_, overall_time, robot.last_equipped_tool_, false});
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Simulates the kitchen for a burst of orders and returns the time the last dish reaches the output. The kitchen places
+ * one order or one batch of orders per KITCHEN_PLACING_RATE. Robots work off their queued steps in request order, plates move one
+ * position per CONVEYOR_MOVE_TIME and adaptations are not simulated.
+ *
+ * @param _strategy the robot selection strategy.
+ * @param _recipe_ids the recipe ids of the orders in placement order.
+ * @param _batch_new_orders flag to indicate whether the first robots of the orders are assigned jointly in batches.
+ * @param _plan_routes flag to indicate whether the whole route of an order is planned when it is placed and followed afterwards.
+ * @return duration_t the makespan.
+ */
+static duration_t
+simulate(kitchen_mape_strategy _strategy, const std::vector<recipe_id_t>& _recipe_ids, bool _batch_new_orders = false, bool _plan_routes = false) {
+    kitchen_mape mape(_strategy);
+    mape.set_swap_robot_positions_callback([](position_t, position_t) {});
+    mape.set_reconfigure_robot_callback([](position_t, std::string) {});
+    recipe_parser recipes;
+    std::vector<simulated_robot> robots;
+    for (position_t position = 1; position <= ROBOT_COUNT; position++) {
+        robots.push_back({capability_parser(position_capabilities[position - 1]).get_capabilities_mask(), 0, static_cast<robot_tool>(0)});
+    }
+    std::priority_queue<order_event, std::vector<order_event>, std::greater<order_event>> events;
+    for (size_t order = 0; order < _recipe_ids.size(); order += _batch_new_orders ? ORDER_BATCH_SIZE : 1) {
+        duration_t placed = (_batch_new_orders ? order / ORDER_BATCH_SIZE : order) * KITCHEN_PLACING_RATE;
+        events.push({placed, order, _recipe_ids[order], 0, 0, _batch_new_orders});
+    }
+    /* Queues the run of steps the chosen robot is capable of and schedules the order's next request */
+    auto dispatch = [&robots, &events](const order_event& _event, recipe_steps _remaining_steps, const robot_descriptor* _chosen, std::vector<position_t> _remaining_route = {}) {
+        simulated_robot& robot = robots[_chosen->get_position() - 1];
+        duration_t arrival = _event.ready_ + ((_chosen->get_position() + CONVEYOR_SIZE - _event.plate_position_) % CONVEYOR_SIZE) * CONVEYOR_MOVE_TIME;
+        duration_t finish = std::max<duration_t>(arrival, robot.busy_until_);
+        UA_UInt32 processed_steps = _event.processed_steps_;
+        while (!_remaining_steps.empty() && _chosen->is_capable_to(_remaining_steps.front().get_action_mask())) {
+            finish += robot.last_equipped_tool_ != _remaining_steps.front().get_required_tool() ? RETOOLING_TIME : 0;
+            finish += _remaining_steps.front().get_action_duration();
+            robot.last_equipped_tool_ = _remaining_steps.front().get_required_tool();
+            _remaining_steps.pop();
+            processed_steps++;
+        }
+        robot.busy_until_ = finish;
+        events.push({finish, _event.order_, _event.recipe_id_, processed_steps, _chosen->get_position(), false, std::move(_remaining_route)});
+    };
+    duration_t makespan = 0;
+    while (!events.empty()) {
+        order_event event = events.top();
+        events.pop();
+        robot_registry_snapshot snapshot = take_snapshot(robots, event.ready_);
+        if (event.batch_) {
+            /* The whole batch is assigned on the current snapshot and instructed in the returned sequence */
+            size_t last_order = std::min(event.order_ + ORDER_BATCH_SIZE, _recipe_ids.size());
+            std::vector<recipe_steps> recipe_action_queues;
+            for (size_t order = event.order_; order < last_order; order++) {
+                recipe_action_queues.push_back(recipes.get_remaining_steps(_recipe_ids[order], 0));
+            }
+            std::vector<order_assignment> assignments = mape.on_new_orders(snapshot, recipe_action_queues);
+            assertm(assignments.size() == recipe_action_queues.size(), "Every order should be assigned");
+            for (const order_assignment& assignment : assignments) {
+                assertm(assignment.robot_ != nullptr, "Every order should have a capable robot");
+                size_t order = event.order_ + assignment.order_;
+                dispatch({event.ready_, order, _recipe_ids[order], 0, 0}, recipe_action_queues[assignment.order_], assignment.robot_);
+            }
+            continue;
+        }
+        recipe_steps remaining_steps = recipes.get_remaining_steps(event.recipe_id_, event.processed_steps_);
+        if (remaining_steps.empty()) {
+            makespan = std::max<duration_t>(makespan, event.ready_ + ((CONVEYOR_SIZE - event.plate_position_) % CONVEYOR_SIZE) * CONVEYOR_MOVE_TIME);
+            continue;
+        }
+        if (_plan_routes && event.processed_steps_ == 0) {
+            /* The route is planned once on placement and the order follows it without asking again */
+            for (const robot_descriptor* planned : mape.on_new_route(snapshot, remaining_steps, event.plate_position_)) {
+                event.route_.push_back(planned->get_position());
+            }
+            assertm(!event.route_.empty(), "Every order should have a planned route");
+        }
+        if (!event.route_.empty()) {
+            const robot_descriptor* planned = &snapshot.robots_.at(event.route_.front());
+            dispatch(event, remaining_steps, planned, std::vector<position_t>(event.route_.begin() + 1, event.route_.end()));
+            continue;
+        }
+        const robot_descriptor* chosen = mape.on_new_order(snapshot, remaining_steps, event.plate_position_);
+        assertm(chosen != nullptr, "Every step should have a capable robot");
+        dispatch(event, remaining_steps, chosen);
+    }
+    return makespan;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::vector<recipe_id_t>> workloads;
+    for (recipe_id_t recipe_id = 1; recipe_id <= 3; recipe_id++) {
+        workloads.push_back(std::vector<recipe_id_t>(ORDERS_PER_RECIPE, recipe_id));
+    }
+    std::vector<recipe_id_t> mixed;
+    for (size_t order = 0; order < ORDERS_PER_RECIPE; order++) {
+        for (recipe_id_t recipe_id = 1; recipe_id <= 3; recipe_id++) {
+            mixed.push_back(recipe_id);
+        }
+    }
+    workloads.push_back(mixed);
+
+    std::vector<std::tuple<duration_t, duration_t, duration_t, duration_t>> makespans;
+    for (const std::vector<recipe_id_t>& workload : workloads) {
+        duration_t simple = simulate(kitchen_mape_strategy::SIMPLE_RECONFIGURATION, workload);
+        duration_t earliest = simulate(kitchen_mape_strategy::EARLIEST_COMPLETION_TIME, workload);
+        duration_t batched = simulate(kitchen_mape_strategy::EARLIEST_COMPLETION_TIME, workload, true);
+        assertm(earliest <= simple, "Earliest completion time routing should not increase the makespan");
+        duration_t routed = simulate(kitchen_mape_strategy::EARLIEST_COMPLETION_TIME, workload, false, true);
+        assertm(batched <= earliest, "Batch assignment should not increase the makespan");
+        assertm(routed <= simple, "Planned routes should not increase the makespan over the first capable robot");
+        makespans.emplace_back(simple, earliest, batched, routed);
+    }
+    for (size_t workload = 0; workload < workloads.size(); workload++) {
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s of %zu orders: makespan %lu with first capable robot, %lu with earliest completion time, %lu with batch assignment and earliest completion time, %lu with planned routes",
+            workload < 3 ? ("Recipe " + std::to_string(workload + 1)).c_str() : "Mix", workloads[workload].size(),
+            (unsigned long) std::get<0>(makespans[workload]), (unsigned long) std::get<1>(makespans[workload]), (unsigned long) std::get<2>(makespans[workload]), (unsigned long) std::get<3>(makespans[workload]));
+    }
+    return 0;
+}
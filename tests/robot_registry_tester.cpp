@@ -0,0 +1,112 @@
+#include <open62541/plugin/log_stdout.h>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "robot_registry.hpp"
+
+#define assertm(exp, msg) assert(((void)msg, exp))
+
+#define ROBOT_COUNT 4
+#define UPDATES_PER_ROBOT 10000
+
+static robot_descriptor
+make_descriptor(position_t _position, duration_t _overall_time) {
+    return {"opc.tcp://localhost:" + std::to_string(7000 + _position), _position, action_mask(_position), _overall_time, robot_tool::PAN, false};
+}
+
+int main(int argc, char* argv[]) {
+    robot_registry registry;
+    std::shared_ptr<const robot_registry_snapshot> empty = registry.get_snapshot();
+    assertm(empty->robots_.empty(), "The initial snapshot should be empty");
+
+    robot_descriptor_map robots;
+    for (position_t position = 1; position <= ROBOT_COUNT; position++) {
+        robots.emplace(position, make_descriptor(position, 0));
+    }
+    registry.replace_robots(robots);
+    std::shared_ptr<const robot_registry_snapshot> registered = registry.get_snapshot();
+    assertm(registered->robots_.size() == ROBOT_COUNT, "All robots should be published");
+    assertm(registered->robots_.begin()->first == ROBOT_COUNT, "The last position should come first");
+    assertm(registered->registry_version_ == empty->registry_version_ + 1, "Registrations should bump the registry version");
+    assertm(empty->robots_.empty(), "Published snapshots should never change");
+    assertm(registered->get_conveyor_size() == ROBOT_COUNT + 1, "An unknown conveyor size should cover the last robot position");
+
+    /* The reported conveyor size may exceed the robot positions */
+    registry.set_conveyor_size(ROBOT_COUNT + 3);
+    std::shared_ptr<const robot_registry_snapshot> sized = registry.get_snapshot();
+    assertm(sized->get_conveyor_size() == ROBOT_COUNT + 3, "The reported conveyor size should be published");
+    assertm(sized->registry_version_ == registered->registry_version_ + 1, "Conveyor size changes should bump the registry version");
+    registry.set_conveyor_size(ROBOT_COUNT + 3);
+    assertm(registry.get_snapshot()->epoch_ == sized->epoch_, "An unchanged conveyor size should not be published");
+    registered = sized;
+
+    /* Load changes are published without invalidating routing decisions */
+    registry.update_robot(make_descriptor(1, 42));
+    std::shared_ptr<const robot_registry_snapshot> loaded = registry.get_snapshot();
+    assertm(loaded->epoch_ > registered->epoch_, "Every publication should advance the epoch");
+    assertm(loaded->registry_version_ == registered->registry_version_, "Load changes should keep the registry version");
+    assertm(loaded->find(1)->get_overall_time() == 42, "The changed descriptor should be published");
+    assertm(registered->find(1)->get_overall_time() == 0, "Published snapshots should never change");
+
+    robot_descriptor reconfigured = make_descriptor(2, 0);
+    reconfigured.capabilities_mask_ = action_mask(3);
+    registry.update_robot(reconfigured);
+    assertm(registry.get_snapshot()->registry_version_ == loaded->registry_version_ + 1, "Capability changes should bump the registry version");
+    assertm(registry.get_snapshot()->find(2)->is_capable_to(action_mask(3)), "The reconfigured capabilities should be published");
+
+    registry.remove_robot(make_descriptor(3, 0).get_endpoint());
+    assertm(registry.get_snapshot()->find(3) == nullptr, "Removed robots should not be published anymore");
+    assertm(registry.get_snapshot()->robots_.size() == ROBOT_COUNT - 1, "Only the removed robot should be unpublished");
+
+    /* Readers observe consistent snapshots while writers publish concurrently */
+    std::atomic<bool> writing(true);
+    std::thread reader([&registry, &writing]() {
+        uint64_t last_epoch = 0;
+        while (writing.load()) {
+            std::shared_ptr<const robot_registry_snapshot> snapshot = registry.get_snapshot();
+            assertm(snapshot->epoch_ >= last_epoch, "Epochs should never go backwards");
+            assertm(snapshot->robots_.size() == ROBOT_COUNT - 1, "Load changes should not add or remove robots");
+            last_epoch = snapshot->epoch_;
+        }
+    });
+    std::vector<std::thread> writers;
+    for (position_t position : {1, 2, 4}) {
+        writers.emplace_back([&registry, position]() {
+            robot_descriptor descriptor = registry.get_snapshot()->find(position) != nullptr ? *registry.get_snapshot()->find(position) : make_descriptor(position, 0);
+            for (duration_t overall_time = 1; overall_time <= UPDATES_PER_ROBOT; overall_time++) {
+                descriptor.overall_time_ = overall_time;
+                registry.update_robot(descriptor);
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    writing.store(false);
+    reader.join();
+    for (position_t position : {1, 2, 4}) {
+        assertm(registry.get_snapshot()->find(position)->get_overall_time() == UPDATES_PER_ROBOT, "No update should be lost");
+    }
+    /* Descriptors built in the writer lock are published in the order of their source changes */
+    std::atomic<duration_t> source_overall_time(0);
+    std::vector<std::thread> rebuilders;
+    for (size_t i = 0; i < 2; i++) {
+        rebuilders.emplace_back([&registry, &source_overall_time]() {
+            for (size_t update = 0; update < UPDATES_PER_ROBOT; update++) {
+                source_overall_time++;
+                registry.replace_robots([&source_overall_time] {
+                    robot_descriptor_map robots;
+                    robots.emplace(1, make_descriptor(1, source_overall_time.load()));
+                    return robots;
+                });
+            }
+        });
+    }
+    for (std::thread& rebuilder : rebuilders) {
+        rebuilder.join();
+    }
+    assertm(registry.get_snapshot()->find(1)->get_overall_time() == 2 * UPDATES_PER_ROBOT, "The latest source change should be published last");
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Published %lu snapshots", (unsigned long) registry.get_snapshot()->epoch_);
+    return 0;
+}
@@ -10,5 +10,7 @@ namespace cps_kitchen {
     typedef UA_UInt32 steps_t;
     typedef UA_UInt32 recipe_id_t;
     typedef UA_UInt64 duration_t;
+    typedef UA_Byte action_id_t;
+    typedef UA_UInt64 capability_mask_t;
 };
 #endif // TYPES_HPP
\ No newline at end of file
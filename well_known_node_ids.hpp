@@ -0,0 +1,179 @@
+/**
+ * @file well_known_node_ids.hpp
+ * @brief Compile-time table of stable numeric node ids for the agent types, their members and main instances.
+ *
+ * Every agent type in the table owns a block of node ids in the application namespace. Type members are
+ * numbered by their offset within the block and the main instance and its members follow at
+ * WELL_KNOWN_INSTANCE_OFFSET. Methods are not copied on instantiation, so instances reference the type's
+ * method nodes. All ids lie below the range open62541 assigns randomly.
+ */
+#ifndef WELL_KNOWN_NODE_IDS_HPP
+#define WELL_KNOWN_NODE_IDS_HPP
+
+#include <open62541/types.h>
+#include <string_view>
+#include "browsenames.h"
+
+#define WELL_KNOWN_NAMESPACE 1
+#define WELL_KNOWN_BLOCK_SIZE 1000
+#define WELL_KNOWN_INSTANCE_OFFSET 100
+
+/**
+ * @brief Maps a browse name to its well-known id or id offset.
+ */
+struct well_known_name {
+    std::string_view name_; /**< the browse name. */
+    UA_UInt32 id_; /**< the id (types) or offset (members). */
+};
+
+/**
+ * @brief Agent types with a well-known id block. Types with several instances per server are not listed.
+ */
+constexpr well_known_name WELL_KNOWN_TYPES[] = {
+    {ROBOT_TYPE, 1 * WELL_KNOWN_BLOCK_SIZE},
+    {CONVEYOR_TYPE, 2 * WELL_KNOWN_BLOCK_SIZE},
+    {CONTROLLER_TYPE, 3 * WELL_KNOWN_BLOCK_SIZE},
+    {KITCHEN_TYPE, 4 * WELL_KNOWN_BLOCK_SIZE}
+};
+
+/**
+ * @brief Member offsets within a type's id block, shared by all types.
+ */
+constexpr well_known_name WELL_KNOWN_MEMBERS[] = {
+    /* robot */
+    {POSITION, 1},
+    {RECIPE_ID, 2},
+    {DISH_NAME, 3},
+    {ACTION_NAME, 4},
+    {INGREDIENTS, 5},
+    {OVERALL_TIME, 6},
+    {CURRENT_TOOL, 7},
+    {LAST_EQUIPPED_TOOL, 8},
+    {CAPABILITIES, 9},
+    {PROCESSED_STEPS, 10},
+    {PROCESSABLE_STEPS, 11},
+    {OVERALL_PROCESSED_STEPS, 12},
+    {OVERALL_PROCESSING_STEPS, 13},
+    {AVAILABILITY, 14},
+    {NEW_POSITION_COMMIT_IS_PENDING, 15},
+    {CAPABILITIES_MASK, 16},
+    {RECEIVE_TASK, 20},
+    {HANDOVER_FINISHED_ORDER, 21},
+    {SWITCH_POSITION, 22},
+    {RECONFIGURE, 23},
+    {COMMIT_NEW_POSITION, 24},
+    /* conveyor */
+    {TOTAL_PLATES, 30},
+    {OCCUPIED_PLATES, 31},
+    {FINISHED_ORDER_NOTIFICATION, 32},
+    /* controller */
+    {REGISTERED_ROBOTS, 40},
+    {REGISTER_ROBOT, 41},
+    {CHOOSE_NEXT_ROBOT, 42},
+    {ROUTING_CACHE_HIT_RATE, 43},
+    {CHOOSE_NEXT_ROBOTS, 44},
+    {PLAN_ROUTE, 45},
+    /* kitchen */
+    {CONNECTIVITY, 50},
+    {RECEIVED_ORDERS, 51},
+    {ASSIGNED_ORDERS, 52},
+    {DROPPED_ORDERS, 53},
+    {COMPLETED_ORDERS, 54},
+    {PLACE_RANDOM_ORDER, 55},
+    {RECEIVE_COMPLETED_ORDER, 56},
+    /* next robot receiver */
+    {RECEIVE_NEXT_ROBOT, 60}
+};
+
+/**
+ * @brief Returns the well-known id of an object type.
+ *
+ * @param _type_name the object type browsename.
+ * @return constexpr UA_UInt32 the id, 0 if the type has no well-known id.
+ */
+constexpr UA_UInt32
+well_known_type_id(std::string_view _type_name) {
+    for (const well_known_name& type : WELL_KNOWN_TYPES) {
+        if (type.name_ == _type_name)
+            return type.id_;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the offset of a member within a type's id block.
+ *
+ * @param _member_name the attribute or method browsename.
+ * @return constexpr UA_UInt32 the offset, 0 if the member has no well-known offset.
+ */
+constexpr UA_UInt32
+well_known_member_offset(std::string_view _member_name) {
+    for (const well_known_name& member : WELL_KNOWN_MEMBERS) {
+        if (member.name_ == _member_name)
+            return member.id_;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the well-known id of a type's attribute or method node.
+ *
+ * @param _type_name the object type browsename.
+ * @param _member_name the attribute or method browsename.
+ * @return constexpr UA_UInt32 the id, 0 if there is no well-known id.
+ */
+constexpr UA_UInt32
+well_known_type_member_id(std::string_view _type_name, std::string_view _member_name) {
+    UA_UInt32 type_id = well_known_type_id(_type_name);
+    UA_UInt32 offset = well_known_member_offset(_member_name);
+    return type_id == 0 || offset == 0 ? 0 : type_id + offset;
+}
+
+/**
+ * @brief Returns the well-known id of a type's main instance.
+ *
+ * @param _type_name the object type browsename.
+ * @return constexpr UA_UInt32 the id, 0 if there is no well-known id.
+ */
+constexpr UA_UInt32
+well_known_instance_id(std::string_view _type_name) {
+    UA_UInt32 type_id = well_known_type_id(_type_name);
+    return type_id == 0 ? 0 : type_id + WELL_KNOWN_INSTANCE_OFFSET;
+}
+
+/**
+ * @brief Returns the well-known id of a main instance's attribute node.
+ *
+ * @param _type_name the object type browsename.
+ * @param _attribute_name the attribute browsename.
+ * @return constexpr UA_UInt32 the id, 0 if there is no well-known id.
+ */
+constexpr UA_UInt32
+well_known_instance_attribute_id(std::string_view _type_name, std::string_view _attribute_name) {
+    UA_UInt32 type_member_id = well_known_type_member_id(_type_name, _attribute_name);
+    return type_member_id == 0 ? 0 : type_member_id + WELL_KNOWN_INSTANCE_OFFSET;
+}
+
+/**
+ * @brief Returns the well-known id of a node copied from a type member into a main instance.
+ *
+ * @param _type_member_id the id of the type member node.
+ * @param _instance_id the id of the instance the node is copied into.
+ * @return constexpr UA_UInt32 the id, 0 if the copy has no well-known id.
+ */
+constexpr UA_UInt32
+well_known_instance_child_id(UA_UInt32 _type_member_id, UA_UInt32 _instance_id) {
+    UA_UInt32 type_id = _instance_id - WELL_KNOWN_INSTANCE_OFFSET;
+    if (_instance_id % WELL_KNOWN_BLOCK_SIZE != WELL_KNOWN_INSTANCE_OFFSET || _type_member_id <= type_id || _type_member_id >= _instance_id)
+        return 0;
+    for (const well_known_name& type : WELL_KNOWN_TYPES) {
+        if (type.id_ == type_id)
+            return _type_member_id + WELL_KNOWN_INSTANCE_OFFSET;
+    }
+    return 0;
+}
+
+static_assert(well_known_instance_attribute_id(ROBOT_TYPE, POSITION) == well_known_instance_child_id(well_known_type_member_id(ROBOT_TYPE, POSITION), well_known_instance_id(ROBOT_TYPE)),
+    "Instance attribute ids must match the ids assigned on instantiation");
+
+#endif // WELL_KNOWN_NODE_IDS_HPP
@@ -0,0 +1,194 @@
+/**
+ * @file async_logger.hpp
+ * @brief open62541 logger that formats into per-thread lock-free ring buffers and writes on a background thread.
+ *
+ * Logging threads only format the message into a fixed size record of their own single producer ring
+ * buffer, they never block on the sink. A drain thread collects the records of all rings in time order
+ * and writes them to the sink. Records that do not fit into a full ring are dropped and counted.
+ */
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <open62541/plugin/log.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define ASYNC_LOG_RING_CAPACITY 1024
+#define ASYNC_LOG_MESSAGE_SIZE 256
+
+/**
+ * @brief A formatted log message waiting to be written.
+ */
+struct log_record {
+    std::chrono::system_clock::time_point time_; /**< the time the message was logged. */
+    UA_LogLevel level_; /**< the log level. */
+    UA_LogCategory category_; /**< the log category. */
+    char message_[ASYNC_LOG_MESSAGE_SIZE]; /**< the formatted and possibly truncated message. */
+};
+
+/**
+ * @brief Single producer single consumer ring of log records owned by one logging thread at a time.
+ */
+class log_ring {
+private:
+    std::array<log_record, ASYNC_LOG_RING_CAPACITY> records_; /**< the record slots. */
+    std::atomic<size_t> head_; /**< the count of records written by the producer. */
+    std::atomic<size_t> tail_; /**< the count of records read by the consumer. */
+    std::atomic<bool> owned_; /**< flag to indicate whether a thread produces into this ring. */
+public:
+    /**
+     * @brief Constructs a new empty log ring object.
+     *
+     */
+    log_ring();
+
+    /**
+     * @brief Claims the ring for the calling thread.
+     *
+     * @return true if the ring was unowned and is claimed now.
+     * @return false if another thread owns the ring.
+     */
+    bool
+    try_acquire();
+
+    /**
+     * @brief Releases the ring on exit of the owning thread, unread records are still drained.
+     *
+     */
+    void
+    release();
+
+    /**
+     * @brief Formats a message into the next free slot. Must only be called by the owning thread.
+     *
+     * @param _level the log level.
+     * @param _category the log category.
+     * @param _msg the message format.
+     * @param _args the message format args.
+     * @return true if the message was queued.
+     * @return false if the ring is full.
+     */
+    bool
+    try_push(UA_LogLevel _level, UA_LogCategory _category, const char* _msg, va_list _args);
+
+    /**
+     * @brief Moves all queued records to the given vector. Must only be called by the drain thread.
+     *
+     * @param _records the vector the records are appended to.
+     */
+    void
+    pop_all(std::vector<log_record>& _records);
+};
+
+/**
+ * @brief UA_Logger implementation writing through log rings and a drain thread.
+ */
+class async_logger {
+private:
+    static async_logger* instance_; /**< the process-wide logger instance. */
+    static std::mutex instance_mutex_; /**< the mutex ensuring the singleton instance. */
+    static std::atomic<uint64_t> next_id_; /**< the id of the next constructed logger. */
+    uint64_t id_; /**< the id identifying this logger's rings in the threads' leases. */
+    FILE* sink_; /**< the file the records are written to. */
+    UA_LogLevel min_level_; /**< the minimum log level forwarded to the sink. */
+    UA_Logger logger_; /**< the open62541 logger dispatching to this object. */
+    std::vector<std::shared_ptr<log_ring>> rings_; /**< the rings of all threads that logged so far, shared with the threads' leases. */
+    std::mutex rings_mutex_; /**< the mutex protecting the ring list. */
+    std::atomic<uint64_t> dropped_; /**< the count of records dropped on full rings. */
+    uint64_t reported_dropped_; /**< the dropped count already reported by the drain thread. */
+    std::vector<log_record> pending_records_; /**< the records collected by the current drain. */
+    std::atomic<bool> running_; /**< flag to indicate whether the drain thread should run. */
+    std::mutex drain_mutex_; /**< the mutex serializing drains, rings have a single consumer. */
+    std::condition_variable drain_condition_; /**< the condition to wake the drain thread on shutdown. */
+    std::thread drain_thread_; /**< the thread writing records to the sink. */
+
+    /**
+     * @brief Returns the calling thread's ring, acquiring a released or new one on first use.
+     *
+     * @return log_ring* the ring of the calling thread.
+     */
+    log_ring*
+    thread_ring();
+
+    /**
+     * @brief Writes all queued records to the sink in time order. Must be called while holding the drain mutex.
+     *
+     */
+    void
+    drain();
+
+    /**
+     * @brief Log callback of the UA_Logger.
+     *
+     * @param _log_context the async logger.
+     * @param _level the log level.
+     * @param _category the log category.
+     * @param _msg the message.
+     * @param _args the message format args.
+     */
+    static void
+    log_message(void* _log_context, UA_LogLevel _level, UA_LogCategory _category, const char* _msg, va_list _args);
+
+public:
+    /**
+     * @brief Constructs a new async logger object and starts its drain thread.
+     *
+     * @param _sink the file the records are written to.
+     * @param _min_level the minimum log level forwarded to the sink.
+     */
+    async_logger(FILE* _sink = stdout, UA_LogLevel _min_level = UA_LOGLEVEL_INFO);
+
+    /**
+     * @brief Stops the drain thread after writing all queued records.
+     *
+     */
+    ~async_logger();
+
+    /**
+     * @brief Returns the process-wide async logger writing to stdout.
+     *
+     * @return async_logger* the async logger address.
+     */
+    static async_logger*
+    get_instance();
+
+    /**
+     * @brief Returns the UA_Logger to pass to UA_LOG_* calls and open62541 configs.
+     *
+     * @return const UA_Logger* the logger, valid for the lifetime of this object.
+     */
+    const UA_Logger*
+    get_logger() const;
+
+    /**
+     * @brief Redirects the UA_Log_Stdout shorthand, used by all UA_LOG_* calls of the agents, to this logger.
+     *
+     */
+    void
+    install();
+
+    /**
+     * @brief Restores the synchronous UA_Log_Stdout and writes all queued records.
+     *
+     */
+    void
+    uninstall();
+
+    /**
+     * @brief Returns the count of records dropped because a ring was full.
+     *
+     * @return uint64_t the dropped record count.
+     */
+    uint64_t
+    get_dropped() const;
+};
+
+#endif // ASYNC_LOGGER_HPP
@@ -0,0 +1,171 @@
+/**
+ * @file client_reactor.hpp
+ * @brief Process-wide reactor multiplexing OPC UA clients on one shared EventLoop.
+ *
+ * Every client created through the reactor is attached to the same open62541 EventLoop,
+ * which a single reactor thread drives by blocking until network events or the next timer
+ * are due. Synchronous client services (method calls, reads, browsing, subscriptions) run
+ * the EventLoop themselves, so they must be issued while holding the reactor's loop lock.
+ * Threads acquiring the lock interrupt the blocking run by writing to a loopback wakeup
+ * connection of the EventLoop, as EventLoop::cancel is only available since open62541 1.4.12.
+ */
+#ifndef CLIENT_REACTOR_HPP
+#define CLIENT_REACTOR_HPP
+
+#include <open62541/client.h>
+#include <open62541/plugin/eventloop.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <string>
+
+typedef std::function<void()> disconnected_callback_t; /**< the callback declaration to notify about a lost client connection. */
+
+/**
+ * @brief Singleton reactor running all registered clients of a process on one thread.
+ */
+class client_reactor {
+    public:
+        /**
+         * @brief Exclusive access to the shared EventLoop, released on destruction.
+         */
+        class loop_lock {
+            private:
+                client_reactor* reactor_; /**< the reactor whose EventLoop is locked. */
+                std::unique_lock<std::mutex> lock_; /**< the held loop mutex. */
+            public:
+                /**
+                 * @brief Constructs a new loop lock object.
+                 *
+                 * @param _reactor the reactor whose EventLoop is locked.
+                 * @param _lock the held loop mutex.
+                 */
+                loop_lock(client_reactor* _reactor, std::unique_lock<std::mutex>&& _lock);
+
+                /**
+                 * @brief Moves a loop lock.
+                 *
+                 * @param _other the loop lock to take over.
+                 */
+                loop_lock(loop_lock&& _other) = default;
+
+                /**
+                 * @brief Releases the loop mutex and lets the reactor thread resume.
+                 *
+                 */
+                ~loop_lock();
+        };
+
+        /**
+         * @brief Returns the singleton client_reactor instance and starts it on first use.
+         *
+         * @return client_reactor* the client reactor address.
+         */
+        static client_reactor* get_instance();
+
+        /**
+         * @brief Interrupts the reactor thread and acquires exclusive access to the shared EventLoop.
+         * Hold the returned lock for every synchronous service on a reactor client.
+         *
+         * @return loop_lock the lock on the shared EventLoop.
+         */
+        loop_lock
+        lock();
+
+        /**
+         * @brief Establishes a connection with a new client attached to the shared EventLoop.
+         * Must be called while holding the loop lock. Ensure the pointer is deleted and is null.
+         *
+         * @param _client the client pointer where the new created one's adress is stored.
+         * @param _server_endpoint the server endpoint.
+         * @param _disconnected_callback the callback invoked on the reactor thread when the connection is lost.
+         * @return true if connection is established successfully.
+         * @return false if connection could not be established, _client is set to nullptr.
+         */
+        bool
+        connect(UA_Client*& _client, std::string _server_endpoint, disconnected_callback_t _disconnected_callback);
+
+        /**
+         * @brief Disconnects and deletes a client created by this reactor. Must be called while holding the loop lock.
+         *
+         * @param _client the client pointer, set to nullptr afterwards.
+         */
+        void
+        delete_client(UA_Client*& _client);
+
+    private:
+        /**
+         * @brief Constructs a new client reactor object and starts the shared EventLoop and reactor thread.
+         *
+         */
+        client_reactor();
+
+        /**
+         * @brief Destroys the client reactor object.
+         *
+         */
+        ~client_reactor();
+
+        /**
+         * @brief Runs the shared EventLoop until the reactor is stopped, yielding to waiting lock holders.
+         *
+         */
+        void
+        run();
+
+        /**
+         * @brief State callback of reactor clients forwarding lost connections to the disconnected callback.
+         *
+         * @param _client the client whose state changed.
+         * @param _channel_state the secure channel state.
+         * @param _session_state the session state.
+         * @param _connect_status the connection status.
+         */
+        static void
+        client_state_changed(UA_Client* _client, UA_SecureChannelState _channel_state, UA_SessionState _session_state, UA_StatusCode _connect_status);
+
+        /**
+         * @brief Opens the wakeup connection: the EventLoop connects to a loopback socket whose accepted end is kept for wakeups.
+         *
+         * @param _tcp_connection_manager the TCP connection manager of the shared EventLoop.
+         * @return UA_StatusCode the status code.
+         */
+        UA_StatusCode
+        open_wakeup_connection(UA_ConnectionManager* _tcp_connection_manager);
+
+        /**
+         * @brief Connection callback of the wakeup connection, discarding the received wakeups.
+         *
+         * @param _connection_manager the TCP connection manager.
+         * @param _connection_id the connection id.
+         * @param _application the client reactor.
+         * @param _connection_context the connection context.
+         * @param _state the connection state.
+         * @param _params the connection parameters.
+         * @param _msg the received bytes.
+         */
+        static void
+        wakeup_connection_changed(UA_ConnectionManager* _connection_manager, uintptr_t _connection_id, void* _application, void** _connection_context,
+                UA_ConnectionState _state, const UA_KeyValueMap* _params, UA_ByteString _msg);
+
+        /**
+         * @brief Interrupts a blocking run of the shared EventLoop. Wakeups before the run make it return immediately.
+         *
+         */
+        void
+        wake_up();
+
+        static client_reactor* instance_; /**< the singleton client_reactor instance pointer. */
+        static std::mutex instance_mutex_; /**< the mutex ensuring the singleton instance. */
+        UA_EventLoop* event_loop_; /**< the EventLoop shared by all reactor clients. */
+        int wakeup_socket_; /**< the socket writing wakeups to the EventLoop's wakeup connection, -1 if not connected. */
+        std::mutex loop_mutex_; /**< the mutex serializing runs of the shared EventLoop. */
+        std::condition_variable loop_condition_; /**< the condition the reactor thread waits on while lock holders are pending. */
+        std::atomic<size_t> pending_lock_holders_; /**< the number of threads waiting for the loop lock. */
+        std::atomic<bool> running_; /**< flag to indicate whether the reactor thread should run. */
+        std::thread reactor_thread_; /**< the reactor thread driving the shared EventLoop. */
+};
+
+#endif // CLIENT_REACTOR_HPP
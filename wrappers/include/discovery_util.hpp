@@ -12,6 +12,8 @@
 #include <thread>
 #include <condition_variable>
 #include <atomic>
+#include <map>
+#include <mutex>
 
 /**
  * @brief Utility managing discovery-related operations and repeated registration thread.
@@ -22,7 +24,18 @@ private:
     std::condition_variable discovery_cv_; /**< condition variable to wait for next registration interval. */
     std::mutex discovery_mutex_; /**< mutex for synchronizing state changes. */
     std::atomic<bool> running_; /**< indicates if the discovery thread should run. */
+    static std::atomic<bool> in_process_; /**< indicates if servers are registered in the in-process directory instead of the discovery server. */
+    static std::mutex directory_mutex_; /**< mutex protecting the in-process directory. */
+    static std::map<std::string, std::string> directory_; /**< the in-process directory mapping application uris to discovery urls. */
 public:
+    /**
+     * @brief Registers and looks up the servers of all discovery utilities in an in-process directory instead
+     * of the discovery server. The calls and reads to registered servers are dispatched directly, see in_process_transport.
+     * Must be called before any agent starts, all agents have to run in this process.
+     */
+    static void
+    use_in_process_directory();
+
     /**
      * @brief Registers the server on the discovery server.
      * 
@@ -0,0 +1,77 @@
+/**
+ * @file in_process_transport.hpp
+ * @brief Direct dispatch of client calls and reads to servers running in the same process.
+ */
+#ifndef IN_PROCESS_TRANSPORT_HPP
+#define IN_PROCESS_TRANSPORT_HPP
+
+#include <open62541/client.h>
+#include <open62541/server.h>
+#include <map>
+#include <shared_mutex>
+#include <string>
+
+/**
+ * @brief Directory of the servers in this process by endpoint url. Calls and reads of clients connected to
+ * a registered endpoint are executed directly on the server with UA_Server_call and UA_Server_read, so
+ * they skip encoding, the loopback connection and both EventLoops. The client session is only used to
+ * look up its endpoint, the server executes the operations in its admin session.
+ */
+class in_process_transport {
+private:
+    static std::shared_mutex servers_mutex_; /**< mutex protecting the servers, held shared during direct operations. */
+    static std::map<std::string, UA_Server*> servers_; /**< the servers in this process by endpoint url. */
+public:
+    /**
+     * @brief Registers a server for direct dispatch.
+     * 
+     * @param _endpoint the endpoint url clients connect to.
+     * @param _server the server.
+     */
+    static void
+    register_server(const std::string& _endpoint, UA_Server* _server);
+
+    /**
+     * @brief Deregisters a server, waiting for its direct operations in progress. Must be called before the server is deleted.
+     * 
+     * @param _server the server.
+     */
+    static void
+    deregister_server(UA_Server* _server);
+
+    /**
+     * @brief Returns the endpoint of a client if it is served in this process.
+     * 
+     * @param _client the connected client.
+     * @return std::string the endpoint url, empty if the server is not registered.
+     */
+    static std::string
+    find_endpoint(UA_Client* _client);
+
+    /**
+     * @brief Executes a call request directly on the server of an endpoint.
+     * 
+     * @param _endpoint the endpoint url.
+     * @param _request the call request.
+     * @param _response stores the call response with one result per method call, which the receiver clears.
+     * @return true if the request was executed.
+     * @return false if the server is not registered.
+     */
+    static bool
+    call(const std::string& _endpoint, const UA_CallRequest& _request, UA_CallResponse& _response);
+
+    /**
+     * @brief Reads the value of a variable node directly on the server of an endpoint.
+     * 
+     * @param _endpoint the endpoint url.
+     * @param _node_id the node id.
+     * @param _value stores the read value.
+     * @param _status stores the status of the read.
+     * @return true if the value was read.
+     * @return false if the server is not registered.
+     */
+    static bool
+    read_value(const std::string& _endpoint, UA_NodeId _node_id, UA_Variant& _value, UA_StatusCode& _status);
+};
+
+#endif // IN_PROCESS_TRANSPORT_HPP
@@ -28,7 +28,7 @@ public:
     ~information_node_reader();
 
     /**
-     * @brief Reads an information node of a remote OPC UA host.
+     * @brief Reads an information node of a remote OPC UA host, directly on its server if it runs in this process.
      * 
      * @param _client the client.
      * @param _node_id the node id.
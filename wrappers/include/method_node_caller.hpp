@@ -6,13 +6,29 @@
 #define METHOD_NODE_CALLER_HPP
 
 #include <vector>
+#include <deque>
+#include <string>
+#include <utility>
+#include <boost/asio.hpp>
 #include <open62541/client_highlevel_async.h>
 #include <open62541/client_highlevel.h>
+#include "kitchen_clock.hpp"
+#include "in_process_transport.hpp"
+
+/**
+ * @brief Decoded outputs of an asynchronous method call. The receiver owns the output array.
+ */
+struct method_call_result {
+    UA_StatusCode status_; /**< the service or method result status. */
+    size_t output_size_; /**< the count of returned output values. */
+    UA_Variant* output_; /**< the returned output values, nullptr if the call failed. */
+};
 
 /**
  * @brief Prepares and invokes method node calls with scalar or array input arguments.
  */
 class method_node_caller {
+    friend class method_call_batch;
 private:
     std::vector<UA_Variant> input_arguments_; /**< Prepared input argument variants. */
 public:
@@ -48,7 +64,8 @@ public:
     add_array_input_argument(void* _argument_value, size_t _array_size, UA_UInt32 _type_index);
 
     /**
-     * @brief Calls a method on another OPC UA host asynchronously.
+     * @brief Calls a method on another OPC UA host asynchronously. If the host runs in this process, the method
+     * is executed directly and the callback is invoked before returning.
      * 
      * @param _client the client.
      * @param _object_id the parent object id.
@@ -61,7 +78,7 @@ public:
     call_method_node(UA_Client* _client, UA_NodeId _object_id, UA_NodeId _method_id, UA_ClientAsyncCallCallback _callback, void* _userdata);
 
     /**
-     * @brief Calls a method on another OPC UA host synchronously.
+     * @brief Calls a method on another OPC UA host synchronously, directly on its server if it runs in this process.
      * 
      * @param _client the client.
      * @param _object_id the parent object id.
@@ -73,10 +90,357 @@ public:
     UA_StatusCode
     call_method_node(UA_Client* _client, UA_NodeId _object_id, UA_NodeId _method_id, size_t* _output_size, UA_Variant** _output);
 
+    /**
+     * @brief Calls a method on another OPC UA host asynchronously and completes the token with the decoded outputs,
+     * e.g. co_await caller.async_call(client, object_id, method_id, acquire_client, boost::asio::use_awaitable).
+     * The completion is dispatched on the executor associated with the token, the client pointer is read and
+     * the call is sent while holding the guard returned by _acquire_client and the client's iterate loop delivers the response.
+     * Calls to a host in this process are executed directly after releasing the guard.
+     * 
+     * @tparam AcquireClient callable returning a guard that grants exclusive access to the client.
+     * @tparam CompletionToken the completion token with signature void(method_call_result).
+     * @param _client the client, which may be reconnected or reset to nullptr by the guarded owner.
+     * @param _object_id the parent object id.
+     * @param _method_id the method id.
+     * @param _acquire_client the callable returning the client guard.
+     * @param _token the completion token.
+     * @return the token's result, an awaitable<method_call_result> for boost::asio::use_awaitable.
+     */
+    template<typename AcquireClient, typename CompletionToken = boost::asio::use_awaitable_t<>>
+    auto
+    async_call(UA_Client* const& _client, UA_NodeId _object_id, UA_NodeId _method_id, AcquireClient _acquire_client, CompletionToken&& _token = {}) {
+        return boost::asio::async_initiate<CompletionToken, void(method_call_result)>(
+            [this, &_client, _object_id, _method_id, _acquire_client](auto _handler) mutable {
+                typedef decltype(_handler) handler_t;
+                /* The call is outstanding for the kitchen clock until its completion handler returned */
+                kitchen_clock::begin_activity();
+                handler_t* handler = new handler_t(std::move(_handler));
+                UA_StatusCode status = UA_STATUSCODE_BADCONNECTIONCLOSED;
+                std::string endpoint;
+                {
+                    auto guard = _acquire_client();
+                    endpoint = in_process_transport::find_endpoint(_client);
+                    if (_client != nullptr && endpoint.empty())
+                        status = call_method_node(_client, _object_id, _method_id, async_call_completed<handler_t>, handler);
+                }
+                if (!endpoint.empty())
+                    complete_async_call(handler, call_in_process(endpoint, _object_id, _method_id));
+                else if (status != UA_STATUSCODE_GOOD)
+                    complete_async_call(handler, method_call_result{status, 0, nullptr});
+            }, _token);
+    }
+
 private:
     void
     clear_input_arguments();
+
+    /**
+     * @brief Returns a call method request referencing the input arguments.
+     * 
+     * @param _object_id the parent object id.
+     * @param _method_id the method id.
+     * @return UA_CallMethodRequest the request, which must not be cleared.
+     */
+    UA_CallMethodRequest
+    prepare_method_request(UA_NodeId _object_id, UA_NodeId _method_id);
+
+    /**
+     * @brief Executes the method directly on the server of an endpoint in this process.
+     * 
+     * @param _endpoint the endpoint url.
+     * @param _object_id the parent object id.
+     * @param _method_id the method id.
+     * @return method_call_result the decoded outputs.
+     */
+    method_call_result
+    call_in_process(const std::string& _endpoint, UA_NodeId _object_id, UA_NodeId _method_id);
+
+    /**
+     * @brief Posts the result to the handler's associated executor and releases the handler.
+     * 
+     * @param _handler the heap allocated completion handler.
+     * @param _result the method call result.
+     */
+    template<typename Handler>
+    static void
+    complete_async_call(Handler* _handler, method_call_result _result) {
+        auto executor = boost::asio::get_associated_executor(*_handler);
+        boost::asio::post(executor, [handler = std::move(*_handler), _result]() mutable {
+            std::move(handler)(_result);
+            kitchen_clock::end_activity();
+        });
+        delete _handler;
+    }
+
+    /**
+     * @brief Client callback decoding the call response and taking over its output arguments.
+     * 
+     * @param _client the client.
+     * @param _userdata the heap allocated completion handler.
+     * @param _request_id the request id.
+     * @param _response the call response.
+     */
+    template<typename Handler>
+    static void
+    async_call_completed(UA_Client* _client, void* _userdata, UA_UInt32 _request_id, UA_CallResponse* _response) {
+        method_call_result result = {UA_STATUSCODE_BADUNEXPECTEDERROR, 0, nullptr};
+        if (_response != nullptr) {
+            result.status_ = _response->responseHeader.serviceResult;
+            if (result.status_ == UA_STATUSCODE_GOOD && _response->resultsSize != 1)
+                result.status_ = UA_STATUSCODE_BADUNEXPECTEDERROR;
+            if (result.status_ == UA_STATUSCODE_GOOD)
+                result.status_ = _response->results[0].statusCode;
+            if (result.status_ == UA_STATUSCODE_GOOD) {
+                result.output_size_ = _response->results[0].outputArgumentsSize;
+                result.output_ = _response->results[0].outputArguments;
+                _response->results[0].outputArgumentsSize = 0;
+                _response->results[0].outputArguments = nullptr;
+            }
+        }
+        complete_async_call(static_cast<Handler*>(_userdata), result);
+    }
 };
 
 
+/**
+ * @brief Collects several method calls on one session and sends them with a single Call service request.
+ * The server executes the calls in the order they were added.
+ */
+class method_call_batch {
+private:
+    std::deque<method_node_caller> callers_; /**< the input arguments of each call, stable on growth. */
+    std::vector<UA_CallMethodRequest> requests_; /**< the call requests referencing the callers' arguments. */
+public:
+    /**
+     * @brief Constructs a new empty method call batch object.
+     * 
+     */
+    method_call_batch();
+
+    /**
+     * @brief Destroys the method call batch object.
+     * 
+     */
+    ~method_call_batch();
+
+    method_call_batch(const method_call_batch&) = delete;
+    method_call_batch& operator=(const method_call_batch&) = delete;
+
+    /**
+     * @brief Adds a call to the batch.
+     * 
+     * @param _object_id the parent object id.
+     * @param _method_id the method id.
+     * @return method_node_caller& the caller to add the call's input arguments to.
+     */
+    method_node_caller&
+    add_call(UA_NodeId _object_id, UA_NodeId _method_id);
+
+    /**
+     * @brief Returns the number of calls in the batch.
+     * 
+     * @return size_t the number of calls.
+     */
+    size_t
+    size() const;
+
+    /**
+     * @brief Sends all calls in one request and waits for the response, directly to the server if it runs in this process.
+     * 
+     * @param _client the client.
+     * @param _results the results in the order the calls were added, the receiver owns their outputs.
+     * @return UA_StatusCode the service result.
+     */
+    UA_StatusCode
+    call(UA_Client* _client, std::vector<method_call_result>& _results);
+
+    /**
+     * @brief Sends all calls in one request asynchronously and completes the token with the results in the order
+     * the calls were added. The client is read and the request is sent while holding the guard returned by _acquire_client.
+     * Batches to a host in this process are executed directly after releasing the guard.
+     * 
+     * @tparam AcquireClient callable returning a guard that grants exclusive access to the client.
+     * @tparam CompletionToken the completion token with signature void(std::vector<method_call_result>).
+     * @param _client the client, which may be reconnected or reset to nullptr by the guarded owner.
+     * @param _acquire_client the callable returning the client guard.
+     * @param _token the completion token.
+     * @return the token's result, an awaitable<std::vector<method_call_result>> for boost::asio::use_awaitable.
+     */
+    template<typename AcquireClient, typename CompletionToken = boost::asio::use_awaitable_t<>>
+    auto
+    async_call(UA_Client* const& _client, AcquireClient _acquire_client, CompletionToken&& _token = {}) {
+        return boost::asio::async_initiate<CompletionToken, void(std::vector<method_call_result>)>(
+            [this, &_client, _acquire_client](auto _handler) mutable {
+                typedef decltype(_handler) handler_t;
+                /* The batch is outstanding for the kitchen clock until its completion handler returned */
+                kitchen_clock::begin_activity();
+                std::pair<handler_t, size_t>* pending = new std::pair<handler_t, size_t>(std::move(_handler), requests_.size());
+                UA_StatusCode status = UA_STATUSCODE_BADCONNECTIONCLOSED;
+                std::string endpoint;
+                {
+                    auto guard = _acquire_client();
+                    endpoint = in_process_transport::find_endpoint(_client);
+                    if (_client != nullptr && endpoint.empty()) {
+                        UA_CallRequest request = prepare_request();
+                        status = __UA_Client_AsyncService(_client, &request, &UA_TYPES[UA_TYPES_CALLREQUEST], async_call_completed<handler_t>,
+                                                          &UA_TYPES[UA_TYPES_CALLRESPONSE], pending, NULL);
+                    }
+                }
+                if (!endpoint.empty())
+                    complete_async_call(pending, call_in_process(endpoint));
+                else if (status != UA_STATUSCODE_GOOD)
+                    complete_async_call(pending, take_results(nullptr, status, pending->second));
+            }, _token);
+    }
+
+private:
+    /**
+     * @brief Executes all calls directly on the server of an endpoint in this process.
+     * 
+     * @param _endpoint the endpoint url.
+     * @return std::vector<method_call_result> the results in the order the calls were added.
+     */
+    std::vector<method_call_result>
+    call_in_process(const std::string& _endpoint);
+
+    /**
+     * @brief Returns a call request referencing the batched call requests.
+     * 
+     * @return UA_CallRequest the call request, which must not be cleared.
+     */
+    UA_CallRequest
+    prepare_request();
+
+    /**
+     * @brief Decodes a call response into one result per batched call and takes over the output arguments.
+     * 
+     * @param _response the call response, nullptr if the request failed.
+     * @param _status the status reported for all calls if the response carries no results.
+     * @param _call_count the number of batched calls.
+     * @return std::vector<method_call_result> the results in the order the calls were added.
+     */
+    static std::vector<method_call_result>
+    take_results(UA_CallResponse* _response, UA_StatusCode _status, size_t _call_count);
+
+    /**
+     * @brief Posts the results to the handler's associated executor and releases the pending call.
+     * 
+     * @param _pending the heap allocated completion handler and call count.
+     * @param _results the results.
+     */
+    template<typename Handler>
+    static void
+    complete_async_call(std::pair<Handler, size_t>* _pending, std::vector<method_call_result> _results) {
+        auto executor = boost::asio::get_associated_executor(_pending->first);
+        boost::asio::post(executor, [handler = std::move(_pending->first), results = std::move(_results)]() mutable {
+            std::move(handler)(std::move(results));
+            kitchen_clock::end_activity();
+        });
+        delete _pending;
+    }
+
+    /**
+     * @brief Client callback decoding the call response of a batch.
+     * 
+     * @param _client the client.
+     * @param _userdata the heap allocated completion handler and call count.
+     * @param _request_id the request id.
+     * @param _response the call response.
+     */
+    template<typename Handler>
+    static void
+    async_call_completed(UA_Client* _client, void* _userdata, UA_UInt32 _request_id, void* _response) {
+        std::pair<Handler, size_t>* pending = static_cast<std::pair<Handler, size_t>*>(_userdata);
+        UA_CallResponse* response = static_cast<UA_CallResponse*>(_response);
+        complete_async_call(pending, take_results(response, UA_STATUSCODE_BADUNEXPECTEDERROR, pending->second));
+    }
+};
+
+/**
+ * @brief Method call prepared once and invoked repeatedly with in-place updated input arguments.
+ * The object and method ids and the argument types are bound on preparation. Updating arguments of
+ * pointer-free types (numbers, booleans, ...) only overwrites the preallocated argument storage, so
+ * steady-state calls only allocate what open62541 needs for sending and decoding.
+ */
+class prepared_method_call {
+private:
+    UA_CallMethodRequest request_; /**< the prepared call request referencing the argument storage. */
+    std::vector<UA_Variant> input_arguments_; /**< the preallocated input argument variants. */
+public:
+    /**
+     * @brief Constructs a new prepared method call object without bound method.
+     * 
+     */
+    prepared_method_call();
+
+    /**
+     * @brief Destroys the prepared method call object and its argument storage.
+     * 
+     */
+    ~prepared_method_call();
+
+    prepared_method_call(const prepared_method_call&) = delete;
+    prepared_method_call& operator=(const prepared_method_call&) = delete;
+
+    /**
+     * @brief Binds the object and method to call.
+     * 
+     * @param _object_id the object id.
+     * @param _method_id the method id.
+     */
+    void
+    set_method(UA_NodeId _object_id, UA_NodeId _method_id);
+
+    /**
+     * @brief Returns whether a method is bound.
+     * 
+     * @return true if a method is bound.
+     * @return false if no method is bound.
+     */
+    bool
+    is_prepared() const;
+
+    /**
+     * @brief Adds a scalar input argument and allocates its storage.
+     * 
+     * @param _argument_value the pointer to the initial value.
+     * @param _type_index the type descriptor of the value.
+     * @return size_t the argument index for later updates.
+     */
+    size_t
+    add_scalar_input_argument(const void* _argument_value, UA_UInt32 _type_index);
+
+    /**
+     * @brief Updates a scalar input argument in place.
+     * 
+     * @param _index the argument index.
+     * @param _argument_value the pointer to the new value of the argument's type.
+     */
+    void
+    set_scalar_input_argument(size_t _index, const void* _argument_value);
+
+    /**
+     * @brief Calls the bound method synchronously, directly on the server if it runs in this process.
+     * 
+     * @param _client the client.
+     * @param _output_size the count of returned output values.
+     * @param _output the returned output values owned by the caller.
+     * @return UA_StatusCode the service or method result status.
+     */
+    UA_StatusCode
+    call(UA_Client* _client, size_t* _output_size, UA_Variant** _output);
+
+    /**
+     * @brief Calls the bound method asynchronously. If the server runs in this process, the method is executed
+     * directly and the callback is invoked before returning.
+     * 
+     * @param _client the client.
+     * @param _callback the callback receiving the call response.
+     * @param _userdata the callback's user data.
+     * @return UA_StatusCode the status code of sending the request.
+     */
+    UA_StatusCode
+    call_async(UA_Client* _client, UA_ClientAsyncCallCallback _callback, void* _userdata);
+};
+
 #endif // METHOD_NODE_CALLER_HPP
\ No newline at end of file
@@ -7,6 +7,8 @@
 
 #include <open62541/client_highlevel.h>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 /**
  * @brief Holds object and method ids for a discovered method.
@@ -60,6 +62,21 @@ const object_method_info OBJECT_METHOD_INFO_NULL = object_method_info(); /**< NU
  */
 class node_browser_helper {
 private:
+    /**
+     * @brief Resolves the attribute and method ids of a type's main instance from the well-known id table.
+     * The ids are verified by reading their browse names with a single Read request.
+     * 
+     * @param _client the client.
+     * @param _object_type_name the object type browsename.
+     * @param _attribute_names the attribute browsenames.
+     * @param _method_names the method browsenames.
+     * @param _attribute_ids the table where the attribute ids are stored by browsename.
+     * @param _method_ids the table where the object and method ids are stored by browsename.
+     * @return UA_StatusCode UA_STATUSCODE_GOOD if the server uses the well-known ids for all names.
+     */
+    UA_StatusCode resolve_well_known_ids(UA_Client* _client, std::string _object_type_name, const std::vector<std::string>& _attribute_names,
+        const std::vector<std::string>& _method_names, std::unordered_map<std::string, UA_NodeId>& _attribute_ids,
+        std::unordered_map<std::string, object_method_info>& _method_ids);
 public:
     /**
      * @brief Constructs a new node browser helper object.
@@ -103,6 +120,24 @@ public:
      */
     bool has_instance(UA_Client* _client, std::string _object_type_name);
 
+    /**
+     * @brief Resolves the attribute and method ids of the first instance with the given object type in bulk.
+     * Uses the well-known ids if enabled and the server assigned them, otherwise locates the instance once and
+     * translates all browse names with a single TranslateBrowsePathsToNodeIds request,
+     * so the number of round trips does not grow with the number of names.
+     * 
+     * @param _client the client.
+     * @param _object_type_name the object type browsename.
+     * @param _attribute_names the attribute browsenames.
+     * @param _method_names the method browsenames.
+     * @param _attribute_ids the table where the attribute ids are stored by browsename.
+     * @param _method_ids the table where the object and method ids are stored by browsename.
+     * @return UA_StatusCode UA_STATUSCODE_GOOD if all names are resolved, else the first failure.
+     */
+    UA_StatusCode resolve_ids(UA_Client* _client, std::string _object_type_name, const std::vector<std::string>& _attribute_names,
+        const std::vector<std::string>& _method_names, std::unordered_map<std::string, UA_NodeId>& _attribute_ids,
+        std::unordered_map<std::string, object_method_info>& _method_ids);
+
     /**
      * @brief Returns the method and object id of the first instance with the given object type.
      * 
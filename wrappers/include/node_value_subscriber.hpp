@@ -6,6 +6,30 @@
 #define NODE_VALUE_SUBSCRIBER_HPP
 
 #include <open62541/client_subscriptions.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+/**
+ * @brief Per monitored item sampling, queueing and filtering parameters. The defaults report every change immediately.
+ */
+struct monitoring_parameters {
+    UA_Double sampling_interval_ = 0.0; /**< the sampling interval in milliseconds, 0 for the fastest rate of the server. */
+    UA_UInt32 queue_size_ = 1; /**< the number of notifications queued between publishes. */
+    bool discard_oldest_ = true; /**< flag to indicate whether a full queue discards the oldest or newest notification. */
+    UA_DeadbandType deadband_type_ = UA_DEADBANDTYPE_NONE; /**< the deadband type, percent requires an EURange property on the server. */
+    UA_Double deadband_value_ = 0.0; /**< the absolute value or percent of the EURange a change must exceed. */
+};
+
+/**
+ * @brief A node to monitor with its notification callback and parameters.
+ */
+struct monitored_node_request {
+    UA_NodeId node_id_; /**< the node to monitor. */
+    UA_Client_DataChangeNotificationCallback notification_callback_; /**< the callback invoked on data change. */
+    void* context_; /**< the user context pointer. */
+    monitoring_parameters parameters_; /**< the sampling, queueing and filtering parameters. */
+};
 
 /**
  * @brief Encapsulates subscription creation for monitoring a client's node values.
@@ -14,14 +38,58 @@ class node_value_subscriber {
 private:
     UA_Client* client_; /**< the client. */
     UA_UInt32 subscription_id_; /**< the subscription id. */
+    std::atomic<bool> healthy_; /**< flag to indicate whether the subscription is alive. */
+    std::atomic<std::chrono::steady_clock::rep> last_heartbeat_; /**< the time of the last heartbeat notification. */
+    std::chrono::milliseconds staleness_bound_; /**< the maximum time since the last heartbeat for fresh values. */
+    UA_Double publishing_interval_; /**< the requested publishing interval. */
+
+    /**
+     * @brief Creates the subscription if not created yet.
+     * 
+     * @return UA_StatusCode the status code.
+     */
+    UA_StatusCode
+    create_subscription();
+
+    /**
+     * @brief Fills a monitored item create request from the monitoring parameters.
+     * 
+     * @param _node_id the node to monitor.
+     * @param _parameters the monitoring parameters.
+     * @param _request the request to fill.
+     * @param _filter the filter storage referenced by the request if a deadband is set.
+     */
+    static void
+    fill_monitor_request(const UA_NodeId& _node_id, const monitoring_parameters& _parameters,
+        UA_MonitoredItemCreateRequest& _request, UA_DataChangeFilter& _filter);
+
+    /**
+     * @brief Heartbeat callback recording the time of the last notification.
+     */
+    static void
+    heartbeat_received(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context,
+        UA_UInt32 _mon_id, void* _mon_context, UA_DataValue* _value);
+
+    /**
+     * @brief Status change callback marking the subscription unhealthy on bad status.
+     */
+    static void
+    subscription_status_changed(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context, UA_StatusChangeNotification* _notification);
+
+    /**
+     * @brief Delete and inactivity callback marking the subscription unhealthy.
+     */
+    static void
+    subscription_lost(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context);
 public:
 
     /**
      * @brief Constructs a new node value subscriber object.
      * 
-     * @param _client 
+     * @param _client the client.
+     * @param _publishing_interval the requested publishing interval in milliseconds, 0 for the fastest rate of the server.
      */
-    node_value_subscriber(UA_Client* _client);
+    node_value_subscriber(UA_Client* _client, UA_Double _publishing_interval = 0.0);
 
     /**
      * @brief Destroys the node value subscriber object.
@@ -35,11 +103,41 @@ public:
      * @param _monitored_node_id the node to monitor.
      * @param _notification_callback callback invoked on data change.
      * @param _context user context pointer.
+     * @param _parameters the sampling, queueing and filtering parameters.
      * @return UA_StatusCode the status code.
      */
     UA_StatusCode
-    subscribe_node_value(UA_NodeId _monitored_node_id, UA_Client_DataChangeNotificationCallback _notification_callback, void* _context);
+    subscribe_node_value(UA_NodeId _monitored_node_id, UA_Client_DataChangeNotificationCallback _notification_callback, void* _context,
+        const monitoring_parameters& _parameters = monitoring_parameters());
+
+    /**
+     * @brief Subscribes to value changes of several nodes with one CreateMonitoredItems request.
+     * 
+     * @param _requests the nodes to monitor.
+     * @return UA_StatusCode the status code, the first bad item status if an item could not be created.
+     */
+    UA_StatusCode
+    subscribe_node_values(const std::vector<monitored_node_request>& _requests);
+
+    /**
+     * @brief Subscribes to the server's current time as heartbeat, proving the subscription delivers notifications.
+     * Notifications only arrive on value changes, so the heartbeat bounds the staleness of unchanged cached values.
+     * Subscribe the heartbeat after the monitored values to receive their initial values first.
+     * 
+     * @return UA_StatusCode the status code.
+     */
+    UA_StatusCode
+    subscribe_heartbeat();
+
+    /**
+     * @brief Returns whether the values delivered by this subscription are fresh.
+     * 
+     * @return true if the subscription is alive and sent a heartbeat within the staleness bound.
+     * @return false if the monitored values must be read synchronously.
+     */
+    bool
+    is_fresh() const;
 };
 
 
-#endif // NODE_VALUE_SUBSCRIBER_HPP
\ No newline at end of file
+#endif // NODE_VALUE_SUBSCRIBER_HPP
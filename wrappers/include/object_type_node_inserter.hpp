@@ -9,6 +9,10 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
 
 /**
  * @brief Holds prepared input & output argument definitions for a method.
@@ -99,6 +103,25 @@ struct method_arguments {
         }
 };
 
+/**
+ * @brief Resolved handle of an instance's attribute to access its value without translating the browse path on every access.
+ */
+struct attribute_handle {
+    UA_NodeId node_id_ = UA_NODEID_NULL; /**< the resolved attribute node id. */
+
+    /**
+     * @brief Returns whether the handle has been resolved.
+     * 
+     * @return true if resolved.
+     * @return false if not resolved.
+     */
+    bool is_resolved() const {
+        return !UA_NodeId_isNull(&node_id_);
+    }
+};
+
+typedef std::function<UA_StatusCode(UA_Variant&)> attribute_reader_t; /**< the reader filling a variant with the current native value of a bound attribute. */
+
 /**
  * @brief High-level builder for object types and instances with attributes and methods.
  */
@@ -125,6 +148,24 @@ class object_type_node_inserter {
          */
         std::unordered_map<std::string, UA_NodeId> instance_ids_;
 
+        /**
+         * @brief The child ids map caching the node ids of already looked up instance children, keyed by instance and child name.
+         * 
+         */
+        std::unordered_map<std::string, UA_NodeId> child_node_ids_;
+
+        /**
+         * @brief The mutex guarding the child ids map since attributes are accessed from the server and worker threads.
+         * 
+         */
+        std::mutex child_node_ids_mutex_;
+
+        /**
+         * @brief The readers of all bound attributes serving as the node context of their data sources.
+         * 
+         */
+        std::vector<std::unique_ptr<attribute_reader_t>> attribute_readers_;
+
         /**
          * @brief Makes an attribute or method mandatory by its node id.
          * 
@@ -134,6 +175,25 @@ class object_type_node_inserter {
         UA_StatusCode
         make_mandatory(UA_NodeId _node_id);
 
+        /**
+         * @brief Node lifecycle callback assigning the well-known ids to the attributes copied into a main instance.
+         * Other copied nodes get a server assigned id in the namespace of their parent.
+         * 
+         * @param _server the server.
+         * @param _session_id the session id.
+         * @param _session_context the session context.
+         * @param _source_node_id the type member node being copied.
+         * @param _target_parent_node_id the instance the node is copied into.
+         * @param _reference_type_id the reference type from the instance to the copy.
+         * @param _target_node_id where the id of the copy is stored.
+         * @return UA_StatusCode the status code.
+         */
+        static UA_StatusCode
+        generate_child_node_id(UA_Server* _server,
+                               const UA_NodeId* _session_id, void* _session_context,
+                               const UA_NodeId* _source_node_id, const UA_NodeId* _target_parent_node_id,
+                               const UA_NodeId* _reference_type_id, UA_NodeId* _target_node_id);
+
         /**
          * @brief Constructor called when a new object type is instantiated.
          * 
@@ -193,6 +253,26 @@ class object_type_node_inserter {
         UA_StatusCode
         set_attribute(std::string _instance_name, const char* _attribute_name, UA_Variant& _value);
 
+        /**
+         * @brief Data source read callback pulling the current value of a bound attribute from its reader.
+         * 
+         * @param _server the server.
+         * @param _session_id the session id.
+         * @param _session_context the session context.
+         * @param _node_id the node id of the bound attribute.
+         * @param _node_context the node context holding the attribute reader.
+         * @param _include_source_timestamp flag to indicate whether the source timestamp is requested.
+         * @param _range the numeric range (unused as only scalars are bound).
+         * @param _value where the current value is stored.
+         * @return UA_StatusCode the status code.
+         */
+        static UA_StatusCode
+        read_bound_attribute(UA_Server* _server,
+                             const UA_NodeId* _session_id, void* _session_context,
+                             const UA_NodeId* _node_id, void* _node_context,
+                             UA_Boolean _include_source_timestamp, const UA_NumericRange* _range,
+                             UA_DataValue* _value);
+
     public:
         /**
          * @brief Constructs a new object type node inserter.
@@ -316,6 +396,81 @@ class object_type_node_inserter {
          */
         UA_StatusCode
         get_attribute(std::string _instance_name, const char* _attribute_name, UA_Variant& _value);
+
+        /**
+         * @brief Resolves the attribute of the given instance once into a handle for subsequent accesses.
+         * 
+         * @param _instance_name the instance name.
+         * @param _attribute_name the attribute name.
+         * @param _handle the handle to be resolved.
+         * @return UA_StatusCode the status code.
+         */
+        UA_StatusCode
+        resolve_attribute(std::string _instance_name, const char* _attribute_name, attribute_handle& _handle);
+
+        /**
+         * @brief Sets the scalar attribute referenced by the resolved handle.
+         * 
+         * @param _handle the resolved attribute handle.
+         * @param _value the value.
+         * @param _type_index the type descriptor index.
+         * @return UA_StatusCode the status code.
+         */
+        UA_StatusCode
+        set_scalar_attribute(const attribute_handle& _handle, void* _value, UA_UInt32 _type_index);
+
+        /**
+         * @brief Sets the array attribute referenced by the resolved handle.
+         * 
+         * @param _handle the resolved attribute handle.
+         * @param _array the array.
+         * @param _array_size the array size.
+         * @param _type_index the type descriptor index.
+         * @return UA_StatusCode the status code.
+         */
+        UA_StatusCode
+        set_array_attribute(const attribute_handle& _handle, void* _array, size_t _array_size, UA_UInt32 _type_index);
+
+        /**
+         * @brief Gets the attribute referenced by the resolved handle.
+         * 
+         * @param _handle the resolved attribute handle.
+         * @param _value where the attribute value is stored.
+         * @return UA_StatusCode the status code.
+         */
+        UA_StatusCode
+        get_attribute(const attribute_handle& _handle, UA_Variant& _value);
+
+        /**
+         * @brief Binds the attribute of the given instance to a reader, so OPC UA reads and subscriptions pull the native value on demand.
+         * Bound attributes are read-only, writing them through set_scalar_attribute fails.
+         * 
+         * @param _instance_name the instance name.
+         * @param _attribute_name the attribute name.
+         * @param _reader the reader filling the variant with the current value.
+         * @return UA_StatusCode the status code.
+         */
+        UA_StatusCode
+        bind_attribute(std::string _instance_name, const char* _attribute_name, attribute_reader_t _reader);
+
+        /**
+         * @brief Binds the attribute of the given instance to a native atomic which must outlive the server.
+         * 
+         * @tparam T the native value type matching the type descriptor.
+         * @param _instance_name the instance name.
+         * @param _attribute_name the attribute name.
+         * @param _value the atomic holding the authoritative value.
+         * @param _type_index the type descriptor index.
+         * @return UA_StatusCode the status code.
+         */
+        template<typename T>
+        UA_StatusCode
+        bind_scalar_attribute(std::string _instance_name, const char* _attribute_name, const std::atomic<T>& _value, UA_UInt32 _type_index) {
+            return bind_attribute(_instance_name, _attribute_name, [&_value, _type_index](UA_Variant& _variant) {
+                T value = _value.load();
+                return UA_Variant_setScalarCopy(&_variant, &value, &UA_TYPES[_type_index]);
+            });
+        }
 };
 
 #endif // OBJECT_TYPE_NODE_INSERTER_HPP
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "../include/async_logger.hpp"
+#include <open62541/plugin/log_stdout.h>
+#include <algorithm>
+#include <time.h>
+
+#define ASYNC_LOG_DRAIN_INTERVAL 50
+
+/**
+ * @brief A thread's claim on the ring it produces into for one logger.
+ */
+struct ring_lease {
+    uint64_t logger_id_; /**< the id of the logger owning the ring. */
+    std::shared_ptr<log_ring> ring_; /**< the claimed ring. */
+};
+
+/**
+ * @brief The ring leases of a thread, released on thread exit so that new threads reuse the rings.
+ */
+struct thread_ring_leases {
+    std::vector<ring_lease> leases_; /**< the leases, one per logger the thread logged to. */
+
+    ~thread_ring_leases() {
+        for (ring_lease& lease : leases_) {
+            lease.ring_->release();
+        }
+    }
+};
+
+static thread_local thread_ring_leases thread_leases;
+
+static const char* level_names[] = {"trace", "debug", "info", "warn", "error", "fatal"};
+static const char* category_names[] = {"network", "channel", "session", "server", "client", "userland", "securitypolicy", "eventloop", "pubsub", "discovery"};
+
+log_ring::log_ring() : head_(0), tail_(0), owned_(false) {
+}
+
+bool
+log_ring::try_acquire() {
+    return !owned_.exchange(true, std::memory_order_acq_rel);
+}
+
+void
+log_ring::release() {
+    owned_.store(false, std::memory_order_release);
+}
+
+bool
+log_ring::try_push(UA_LogLevel _level, UA_LogCategory _category, const char* _msg, va_list _args) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= ASYNC_LOG_RING_CAPACITY)
+        return false;
+    log_record& record = records_[head % ASYNC_LOG_RING_CAPACITY];
+    record.time_ = std::chrono::system_clock::now();
+    record.level_ = _level;
+    record.category_ = _category;
+    vsnprintf(record.message_, ASYNC_LOG_MESSAGE_SIZE, _msg, _args);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void
+log_ring::pop_all(std::vector<log_record>& _records) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    for (; tail != head; tail++) {
+        _records.push_back(records_[tail % ASYNC_LOG_RING_CAPACITY]);
+    }
+    tail_.store(tail, std::memory_order_release);
+}
+
+async_logger* async_logger::instance_;
+std::mutex async_logger::instance_mutex_;
+std::atomic<uint64_t> async_logger::next_id_(1);
+
+async_logger::async_logger(FILE* _sink, UA_LogLevel _min_level) : id_(next_id_++), sink_(_sink), min_level_(_min_level), dropped_(0), reported_dropped_(0), running_(true) {
+    logger_.log = log_message;
+    logger_.context = this;
+    logger_.clear = NULL;
+    drain_thread_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(drain_mutex_);
+        while (running_.load()) {
+            drain_condition_.wait_for(lock, std::chrono::milliseconds(ASYNC_LOG_DRAIN_INTERVAL), [this] {
+                return !running_.load();
+            });
+            drain();
+        }
+    });
+}
+
+async_logger::~async_logger() {
+    if (UA_Log_Stdout == &logger_)
+        UA_Log_Stdout = &UA_Log_Stdout_;
+    running_.store(false);
+    drain_condition_.notify_all();
+    if (drain_thread_.joinable())
+        drain_thread_.join();
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    drain();
+}
+
+async_logger*
+async_logger::get_instance() {
+    std::lock_guard<std::mutex> lockguard(instance_mutex_);
+    if (instance_ == nullptr) {
+        instance_ = new async_logger();
+    }
+    return instance_;
+}
+
+const UA_Logger*
+async_logger::get_logger() const {
+    return &logger_;
+}
+
+void
+async_logger::install() {
+    UA_Log_Stdout = &logger_;
+}
+
+void
+async_logger::uninstall() {
+    if (UA_Log_Stdout == &logger_)
+        UA_Log_Stdout = &UA_Log_Stdout_;
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    drain();
+}
+
+uint64_t
+async_logger::get_dropped() const {
+    return dropped_.load();
+}
+
+log_ring*
+async_logger::thread_ring() {
+    for (ring_lease& lease : thread_leases.leases_) {
+        if (lease.logger_id_ == id_)
+            return lease.ring_.get();
+    }
+    /* First message of this thread, reuse a ring of an exited thread if possible */
+    std::shared_ptr<log_ring> ring;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (std::shared_ptr<log_ring>& released_ring : rings_) {
+            if (released_ring->try_acquire()) {
+                ring = released_ring;
+                break;
+            }
+        }
+        if (ring == nullptr) {
+            ring = std::make_shared<log_ring>();
+            ring->try_acquire();
+            rings_.push_back(ring);
+        }
+    }
+    thread_leases.leases_.push_back({id_, ring});
+    return ring.get();
+}
+
+void
+async_logger::drain() {
+    pending_records_.clear();
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (std::shared_ptr<log_ring>& ring : rings_) {
+            ring->pop_all(pending_records_);
+        }
+    }
+    std::stable_sort(pending_records_.begin(), pending_records_.end(), [](const log_record& _a, const log_record& _b) {
+        return _a.time_ < _b.time_;
+    });
+    for (const log_record& record : pending_records_) {
+        time_t seconds = std::chrono::system_clock::to_time_t(record.time_);
+        long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(record.time_.time_since_epoch()).count() % 1000;
+        struct tm local_time;
+        localtime_r(&seconds, &local_time);
+        char time_str[32];
+        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &local_time);
+        size_t level_index = std::min<size_t>(std::max<int>(record.level_ / 100 - 1, 0), 5);
+        size_t category_index = std::min<size_t>(record.category_, 9);
+        fprintf(sink_, "[%s.%03ld] %s/%s\t%s\n", time_str, milliseconds, level_names[level_index], category_names[category_index], record.message_);
+    }
+    uint64_t dropped = dropped_.load();
+    if (dropped != reported_dropped_) {
+        fprintf(sink_, "async_logger: dropped %lu log messages on full buffers\n", (unsigned long) (dropped - reported_dropped_));
+        reported_dropped_ = dropped;
+    }
+    if (!pending_records_.empty())
+        fflush(sink_);
+}
+
+void
+async_logger::log_message(void* _log_context, UA_LogLevel _level, UA_LogCategory _category, const char* _msg, va_list _args) {
+    async_logger* self = static_cast<async_logger*>(_log_context);
+    if (_level < self->min_level_)
+        return;
+    if (!self->running_.load()) {
+        UA_Log_Stdout_.log(UA_Log_Stdout_.context, _level, _category, _msg, _args);
+        return;
+    }
+    if (!self->thread_ring()->try_push(_level, _category, _msg, _args))
+        self->dropped_.fetch_add(1, std::memory_order_relaxed);
+}
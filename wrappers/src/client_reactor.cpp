@@ -0,0 +1,200 @@
+#include "../include/client_reactor.hpp"
+#include <open62541/client_config_default.h>
+#include <open62541/plugin/log_stdout.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+/* A blocking run returns on network events, client timers or the wakeup connection, the timeout only bounds it */
+#define RUN_TIMEOUT 1000
+#define CLIENT_TIMEOUT 1000
+#define WAKEUP_ADDRESS "127.0.0.1"
+#define WAKEUP_CONNECT_TIMEOUT 1000
+
+client_reactor* client_reactor::instance_;
+std::mutex client_reactor::instance_mutex_;
+
+client_reactor::loop_lock::loop_lock(client_reactor* _reactor, std::unique_lock<std::mutex>&& _lock) : reactor_(_reactor), lock_(std::move(_lock)) {
+}
+
+client_reactor::loop_lock::~loop_lock() {
+    if (!lock_.owns_lock())
+        return;
+    lock_.unlock();
+    reactor_->loop_condition_.notify_all();
+}
+
+client_reactor*
+client_reactor::get_instance() {
+    std::lock_guard<std::mutex> lockguard(instance_mutex_);
+    if (instance_ == nullptr) {
+        instance_ = new client_reactor();
+    }
+    return instance_;
+}
+
+client_reactor::client_reactor() : event_loop_(UA_EventLoop_new_POSIX(UA_Log_Stdout)), wakeup_socket_(-1), pending_lock_holders_(0), running_(true) {
+    UA_ConnectionManager* tcp_connection_manager = UA_ConnectionManager_new_POSIX_TCP(UA_STRING(const_cast<char*>("tcp connection manager")));
+    UA_StatusCode status = event_loop_->registerEventSource(event_loop_, (UA_EventSource*) tcp_connection_manager);
+    if (status == UA_STATUSCODE_GOOD)
+        status = event_loop_->start(event_loop_);
+    if (status == UA_STATUSCODE_GOOD)
+        status = open_wakeup_connection(tcp_connection_manager);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error starting the shared client event loop (%s)", __FUNCTION__, UA_StatusCode_name(status));
+        running_.store(false);
+        return;
+    }
+    reactor_thread_ = std::thread([this]() {
+        run();
+    });
+}
+
+client_reactor::~client_reactor() {
+    running_.store(false);
+    wake_up();
+    loop_condition_.notify_all();
+    if (reactor_thread_.joinable())
+        reactor_thread_.join();
+    event_loop_->stop(event_loop_);
+    while (event_loop_->state != UA_EVENTLOOPSTATE_FRESH && event_loop_->state != UA_EVENTLOOPSTATE_STOPPED) {
+        event_loop_->run(event_loop_, 100);
+    }
+    event_loop_->free(event_loop_);
+    if (wakeup_socket_ >= 0)
+        close(wakeup_socket_);
+}
+
+UA_StatusCode
+client_reactor::open_wakeup_connection(UA_ConnectionManager* _tcp_connection_manager) {
+    /* Listen on an ephemeral loopback port for the EventLoop's connection */
+    int listen_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_socket < 0)
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    sockaddr_in listen_address;
+    memset(&listen_address, 0, sizeof(listen_address));
+    listen_address.sin_family = AF_INET;
+    listen_address.sin_addr.s_addr = inet_addr(WAKEUP_ADDRESS);
+    listen_address.sin_port = 0;
+    socklen_t address_length = sizeof(listen_address);
+    if (bind(listen_socket, (sockaddr*) &listen_address, sizeof(listen_address)) != 0 || listen(listen_socket, 1) != 0
+        || getsockname(listen_socket, (sockaddr*) &listen_address, &address_length) != 0) {
+        close(listen_socket);
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    }
+    UA_String address = UA_STRING(const_cast<char*>(WAKEUP_ADDRESS));
+    UA_UInt16 port = ntohs(listen_address.sin_port);
+    UA_KeyValuePair params[2];
+    params[0].key = UA_QUALIFIEDNAME(0, const_cast<char*>("address"));
+    UA_Variant_setScalar(&params[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, const_cast<char*>("port"));
+    UA_Variant_setScalar(&params[1].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_KeyValueMap param_map = {2, params};
+    UA_StatusCode status = _tcp_connection_manager->openConnection(_tcp_connection_manager, &param_map, this, nullptr, wakeup_connection_changed);
+    /* The non-blocking connect completes in the kernel, so the connection is accepted without running the EventLoop */
+    pollfd listen_poll = {listen_socket, POLLIN, 0};
+    if (status == UA_STATUSCODE_GOOD && poll(&listen_poll, 1, WAKEUP_CONNECT_TIMEOUT) == 1)
+        wakeup_socket_ = accept(listen_socket, nullptr, nullptr);
+    close(listen_socket);
+    if (status == UA_STATUSCODE_GOOD && wakeup_socket_ < 0)
+        status = UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    if (status != UA_STATUSCODE_GOOD)
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error opening the wakeup connection (%s)", __FUNCTION__, UA_StatusCode_name(status));
+    return status;
+}
+
+void
+client_reactor::wakeup_connection_changed(UA_ConnectionManager* _connection_manager, uintptr_t _connection_id, void* _application, void** _connection_context,
+        UA_ConnectionState _state, const UA_KeyValueMap* _params, UA_ByteString _msg) {
+    /* The received wakeup bytes only interrupt a blocking run and are discarded */
+}
+
+void
+client_reactor::wake_up() {
+    if (wakeup_socket_ < 0)
+        return;
+    char wakeup = 0;
+    /* A full socket buffer already holds pending wakeups */
+    send(wakeup_socket_, &wakeup, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+void
+client_reactor::run() {
+    while (running_.load()) {
+        std::unique_lock<std::mutex> lock(loop_mutex_);
+        loop_condition_.wait(lock, [this] {
+            return pending_lock_holders_.load() == 0 || !running_.load();
+        });
+        if (!running_.load())
+            break;
+        /* Blocks until network events, the next client timer, a wakeup or the run timeout */
+        UA_StatusCode status = event_loop_->run(event_loop_, RUN_TIMEOUT);
+        if (status != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error running the shared client event loop (%s)", __FUNCTION__, UA_StatusCode_name(status));
+        }
+    }
+}
+
+client_reactor::loop_lock
+client_reactor::lock() {
+    pending_lock_holders_++;
+    wake_up();
+    std::unique_lock<std::mutex> lock(loop_mutex_);
+    pending_lock_holders_--;
+    return loop_lock(this, std::move(lock));
+}
+
+bool
+client_reactor::connect(UA_Client*& _client, std::string _server_endpoint, disconnected_callback_t _disconnected_callback) {
+    if (_client != nullptr)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: If passed client pointer is not deleted then memory leaks will occur!", __FUNCTION__);
+    UA_ClientConfig client_config;
+    memset(&client_config, 0, sizeof(UA_ClientConfig));
+    /* Attach to the shared EventLoop before the default config creates a dedicated one */
+    client_config.eventLoop = event_loop_;
+    client_config.externalEventLoop = true;
+    UA_ClientConfig_setDefault(&client_config);
+    client_config.securityMode = UA_MESSAGESECURITYMODE_NONE;
+    client_config.timeout = CLIENT_TIMEOUT;
+    _client = UA_Client_newWithConfig(&client_config);
+    if (_client == nullptr) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error creating the client", __FUNCTION__);
+        return false;
+    }
+    UA_StatusCode status = UA_Client_connect(_client, _server_endpoint.c_str());
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Connection attempt failed", __FUNCTION__);
+        UA_Client_delete(_client);
+        _client = nullptr;
+        return false;
+    }
+    UA_ClientConfig* connected_config = UA_Client_getConfig(_client);
+    connected_config->clientContext = new disconnected_callback_t(_disconnected_callback);
+    connected_config->stateCallback = client_state_changed;
+    return true;
+}
+
+void
+client_reactor::delete_client(UA_Client*& _client) {
+    if (_client == nullptr)
+        return;
+    UA_ClientConfig* client_config = UA_Client_getConfig(_client);
+    disconnected_callback_t* disconnected_callback = static_cast<disconnected_callback_t*>(client_config->clientContext);
+    client_config->stateCallback = NULL;
+    client_config->clientContext = NULL;
+    UA_Client_delete(_client);
+    _client = nullptr;
+    delete disconnected_callback;
+}
+
+void
+client_reactor::client_state_changed(UA_Client* _client, UA_SecureChannelState _channel_state, UA_SessionState _session_state, UA_StatusCode _connect_status) {
+    if (_connect_status == UA_STATUSCODE_GOOD)
+        return;
+    disconnected_callback_t* disconnected_callback = static_cast<disconnected_callback_t*>(UA_Client_getContext(_client));
+    if (disconnected_callback != nullptr && *disconnected_callback)
+        (*disconnected_callback)();
+}
@@ -3,13 +3,23 @@
 #include <open62541/plugin/log_stdout.h>
 #include <string>
 #include "../include/client_connection_establisher.hpp"
+#include "../include/in_process_transport.hpp"
 
 #define DISCOVERY_SERVER_ENDPOINT "opc.tcp://localhost:4840"
 #define REGISTER_INTERVAL 300
 
+std::atomic<bool> discovery_util::in_process_(false);
+std::mutex discovery_util::directory_mutex_;
+std::map<std::string, std::string> discovery_util::directory_;
+
 discovery_util::discovery_util() : running_(true) {
 }
 
+void
+discovery_util::use_in_process_directory() {
+    in_process_.store(true);
+}
+
 discovery_util::~discovery_util() {
     {
         std::lock_guard<std::mutex> lock(discovery_mutex_);
@@ -22,6 +32,16 @@ discovery_util::~discovery_util() {
 
 UA_StatusCode
 discovery_util::register_server(UA_Server* _server) {
+    if (in_process_.load()) {
+        UA_ApplicationDescription* description = &UA_Server_getConfig(_server)->applicationDescription;
+        if (description->discoveryUrlsSize == 0)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        std::string discovery_url((char*) description->discoveryUrls[0].data, description->discoveryUrls[0].length);
+        in_process_transport::register_server(discovery_url, _server);
+        std::lock_guard<std::mutex> lock(directory_mutex_);
+        directory_[std::string((char*) description->applicationUri.data, description->applicationUri.length)] = discovery_url;
+        return UA_STATUSCODE_GOOD;
+    }
     if (!client_connection_establisher::test_connection(DISCOVERY_SERVER_ENDPOINT))
         return UA_STATUSCODE_BAD;
     UA_ClientConfig cc;
@@ -32,6 +52,13 @@ discovery_util::register_server(UA_Server* _server) {
 
 UA_StatusCode
 discovery_util::deregister_server(UA_Server* _server) {
+    if (in_process_.load()) {
+        UA_String* application_uri = &UA_Server_getConfig(_server)->applicationDescription.applicationUri;
+        in_process_transport::deregister_server(_server);
+        std::lock_guard<std::mutex> lock(directory_mutex_);
+        directory_.erase(std::string((char*) application_uri->data, application_uri->length));
+        return UA_STATUSCODE_GOOD;
+    }
     UA_ClientConfig cc;
     memset(&cc, 0, sizeof(UA_ClientConfig));
     UA_ClientConfig_setDefault(&cc);
@@ -40,6 +67,14 @@ discovery_util::deregister_server(UA_Server* _server) {
 
 UA_StatusCode
 discovery_util::lookup_endpoints(std::vector<std::string>& _endpoints, std::string _application_uri) {
+    if (in_process_.load()) {
+        std::lock_guard<std::mutex> lock(directory_mutex_);
+        for (const std::pair<const std::string, std::string>& entry : directory_) {
+            if (_application_uri.empty() || entry.first == _application_uri)
+                _endpoints.push_back(entry.second);
+        }
+        return UA_STATUSCODE_GOOD;
+    }
     /* Example for calling FindServers */
     UA_ApplicationDescription* application_description_array = NULL;
     size_t application_description_array_size = 0;
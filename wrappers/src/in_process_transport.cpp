@@ -0,0 +1,62 @@
+#include "../include/in_process_transport.hpp"
+#include <mutex>
+
+std::shared_mutex in_process_transport::servers_mutex_;
+std::map<std::string, UA_Server*> in_process_transport::servers_;
+
+void
+in_process_transport::register_server(const std::string& _endpoint, UA_Server* _server) {
+    std::unique_lock<std::shared_mutex> lock(servers_mutex_);
+    servers_[_endpoint] = _server;
+}
+
+void
+in_process_transport::deregister_server(UA_Server* _server) {
+    std::unique_lock<std::shared_mutex> lock(servers_mutex_);
+    for (auto endpoint_server = servers_.begin(); endpoint_server != servers_.end();) {
+        if (endpoint_server->second == _server)
+            endpoint_server = servers_.erase(endpoint_server);
+        else
+            endpoint_server++;
+    }
+}
+
+std::string
+in_process_transport::find_endpoint(UA_Client* _client) {
+    if (_client == nullptr)
+        return "";
+    const UA_String& endpoint_url = UA_Client_getConfig(_client)->endpointUrl;
+    std::string endpoint((char*) endpoint_url.data, endpoint_url.length);
+    std::shared_lock<std::shared_mutex> lock(servers_mutex_);
+    return servers_.find(endpoint) != servers_.end() ? endpoint : "";
+}
+
+bool
+in_process_transport::call(const std::string& _endpoint, const UA_CallRequest& _request, UA_CallResponse& _response) {
+    std::shared_lock<std::shared_mutex> lock(servers_mutex_);
+    auto endpoint_server = servers_.find(_endpoint);
+    if (endpoint_server == servers_.end())
+        return false;
+    UA_CallResponse_init(&_response);
+    _response.results = (UA_CallMethodResult*) UA_Array_new(_request.methodsToCallSize, &UA_TYPES[UA_TYPES_CALLMETHODRESULT]);
+    if (_response.results == nullptr && _request.methodsToCallSize > 0) {
+        _response.responseHeader.serviceResult = UA_STATUSCODE_BADOUTOFMEMORY;
+        return true;
+    }
+    _response.resultsSize = _request.methodsToCallSize;
+    /* Executed in the order of the request like the Call service */
+    for (size_t i = 0; i < _request.methodsToCallSize; i++) {
+        _response.results[i] = UA_Server_call(endpoint_server->second, &_request.methodsToCall[i]);
+    }
+    return true;
+}
+
+bool
+in_process_transport::read_value(const std::string& _endpoint, UA_NodeId _node_id, UA_Variant& _value, UA_StatusCode& _status) {
+    std::shared_lock<std::shared_mutex> lock(servers_mutex_);
+    auto endpoint_server = servers_.find(_endpoint);
+    if (endpoint_server == servers_.end())
+        return false;
+    _status = UA_Server_readValue(endpoint_server->second, _node_id, &_value);
+    return true;
+}
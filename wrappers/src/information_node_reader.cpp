@@ -1,4 +1,5 @@
 #include "../include/information_node_reader.hpp"
+#include "../include/in_process_transport.hpp"
 
 
 information_node_reader::information_node_reader() {
@@ -13,6 +14,10 @@ UA_StatusCode
 information_node_reader::read_information_node(UA_Client* _client, UA_NodeId _node_id) {
     UA_Variant_clear(&variant_);
     UA_Variant_init(&variant_);
+    UA_StatusCode status = UA_STATUSCODE_GOOD;
+    std::string endpoint = in_process_transport::find_endpoint(_client);
+    if (!endpoint.empty() && in_process_transport::read_value(endpoint, _node_id, variant_, status))
+        return status;
     return UA_Client_readValueAttribute(_client, _node_id, &variant_);
 }
 
@@ -1,6 +1,71 @@
 #include "../include/method_node_caller.hpp"
 
 #include <open62541/plugin/log_stdout.h>
+#include <cstring>
+#include "../include/in_process_transport.hpp"
+
+/**
+ * @brief Sends a call request and waits for the response, directly to the server if it runs in this process.
+ * 
+ * @param _client the client.
+ * @param _request the call request.
+ * @return UA_CallResponse the call response, which the receiver clears.
+ */
+static UA_CallResponse
+send_call_request(UA_Client* _client, const UA_CallRequest& _request) {
+    UA_CallResponse response;
+    std::string endpoint = in_process_transport::find_endpoint(_client);
+    if (!endpoint.empty() && in_process_transport::call(endpoint, _request, response))
+        return response;
+    return UA_Client_Service_call(_client, _request);
+}
+
+/**
+ * @brief Sends a call request asynchronously. The request is executed directly on the server if it runs in this process,
+ * then the callback is invoked before returning.
+ * 
+ * @param _client the client.
+ * @param _request the call request.
+ * @param _callback the callback receiving the call response.
+ * @param _userdata the callback's user data.
+ * @return UA_StatusCode the status code of sending the request.
+ */
+static UA_StatusCode
+send_call_request_async(UA_Client* _client, const UA_CallRequest& _request, UA_ClientAsyncServiceCallback _callback, void* _userdata) {
+    UA_CallResponse response;
+    std::string endpoint = in_process_transport::find_endpoint(_client);
+    if (!endpoint.empty() && in_process_transport::call(endpoint, _request, response)) {
+        _callback(_client, _userdata, 0, &response);
+        UA_CallResponse_clear(&response);
+        return UA_STATUSCODE_GOOD;
+    }
+    return __UA_Client_AsyncService(_client, &_request, &UA_TYPES[UA_TYPES_CALLREQUEST], _callback, &UA_TYPES[UA_TYPES_CALLRESPONSE], _userdata, NULL);
+}
+
+/**
+ * @brief Decodes the response of a single method call and takes over its output arguments.
+ * 
+ * @param _response the call response.
+ * @param _output_size the count of returned output values, may be nullptr to discard them.
+ * @param _output the returned output values owned by the caller, may be nullptr to discard them.
+ * @return UA_StatusCode the service or method result status.
+ */
+static UA_StatusCode
+take_single_result(UA_CallResponse& _response, size_t* _output_size, UA_Variant** _output) {
+    UA_StatusCode status = _response.responseHeader.serviceResult;
+    if (status == UA_STATUSCODE_GOOD && _response.resultsSize != 1)
+        status = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    if (status == UA_STATUSCODE_GOOD)
+        status = _response.results[0].statusCode;
+    if (status == UA_STATUSCODE_GOOD && _output != nullptr && _output_size != nullptr) {
+        /* Take over the output arguments instead of copying them */
+        *_output = _response.results[0].outputArguments;
+        *_output_size = _response.results[0].outputArgumentsSize;
+        _response.results[0].outputArguments = nullptr;
+        _response.results[0].outputArgumentsSize = 0;
+    }
+    return status;
+}
 
 method_node_caller::method_node_caller() {
 }
@@ -27,16 +92,52 @@ method_node_caller::add_array_input_argument(void* _argument_value, size_t _arra
 
 UA_StatusCode
 method_node_caller::call_method_node(UA_Client* _client, UA_NodeId _object_id, UA_NodeId _method_id, UA_ClientAsyncCallCallback _callback, void* _userdata) {
-    UA_StatusCode status_code = UA_STATUSCODE_BAD;
-    status_code = UA_Client_call_async(_client, _object_id, _method_id, input_arguments_.size(), input_arguments_.data(), _callback, _userdata, NULL);
-    return status_code;
+    UA_CallMethodRequest method_request = prepare_method_request(_object_id, _method_id);
+    UA_CallRequest request;
+    UA_CallRequest_init(&request);
+    request.methodsToCall = &method_request;
+    request.methodsToCallSize = 1;
+    return send_call_request_async(_client, request, (UA_ClientAsyncServiceCallback) _callback, _userdata);
 }
 
 UA_StatusCode
 method_node_caller::call_method_node(UA_Client* _client, UA_NodeId _object_id, UA_NodeId _method_id, size_t* _output_size, UA_Variant** _output) {
-    UA_StatusCode status_code = UA_STATUSCODE_BAD;
-    status_code = UA_Client_call(_client, _object_id, _method_id, input_arguments_.size(), input_arguments_.data(), _output_size, _output);
-    return status_code;
+    UA_CallMethodRequest method_request = prepare_method_request(_object_id, _method_id);
+    UA_CallRequest request;
+    UA_CallRequest_init(&request);
+    request.methodsToCall = &method_request;
+    request.methodsToCallSize = 1;
+    UA_CallResponse response = send_call_request(_client, request);
+    UA_StatusCode status = take_single_result(response, _output_size, _output);
+    UA_CallResponse_clear(&response);
+    return status;
+}
+
+method_call_result
+method_node_caller::call_in_process(const std::string& _endpoint, UA_NodeId _object_id, UA_NodeId _method_id) {
+    UA_CallMethodRequest method_request = prepare_method_request(_object_id, _method_id);
+    UA_CallRequest request;
+    UA_CallRequest_init(&request);
+    request.methodsToCall = &method_request;
+    request.methodsToCallSize = 1;
+    UA_CallResponse response;
+    if (!in_process_transport::call(_endpoint, request, response))
+        return method_call_result{UA_STATUSCODE_BADCONNECTIONCLOSED, 0, nullptr};
+    method_call_result result = {UA_STATUSCODE_GOOD, 0, nullptr};
+    result.status_ = take_single_result(response, &result.output_size_, &result.output_);
+    UA_CallResponse_clear(&response);
+    return result;
+}
+
+UA_CallMethodRequest
+method_node_caller::prepare_method_request(UA_NodeId _object_id, UA_NodeId _method_id) {
+    UA_CallMethodRequest method_request;
+    UA_CallMethodRequest_init(&method_request);
+    method_request.objectId = _object_id;
+    method_request.methodId = _method_id;
+    method_request.inputArguments = input_arguments_.data();
+    method_request.inputArgumentsSize = input_arguments_.size();
+    return method_request;
 }
 
 void
@@ -44,4 +145,159 @@ method_node_caller::clear_input_arguments() {
     for (UA_Variant& variant : input_arguments_) {
         UA_Variant_clear(&variant);
     }
+}
+
+method_call_batch::method_call_batch() {
+}
+
+method_call_batch::~method_call_batch() {
+    for (UA_CallMethodRequest& request : requests_) {
+        UA_NodeId_clear(&request.objectId);
+        UA_NodeId_clear(&request.methodId);
+    }
+}
+
+method_node_caller&
+method_call_batch::add_call(UA_NodeId _object_id, UA_NodeId _method_id) {
+    UA_CallMethodRequest request;
+    UA_CallMethodRequest_init(&request);
+    UA_NodeId_copy(&_object_id, &request.objectId);
+    UA_NodeId_copy(&_method_id, &request.methodId);
+    requests_.push_back(request);
+    return callers_.emplace_back();
+}
+
+size_t
+method_call_batch::size() const {
+    return requests_.size();
+}
+
+UA_StatusCode
+method_call_batch::call(UA_Client* _client, std::vector<method_call_result>& _results) {
+    UA_CallRequest request = prepare_request();
+    UA_CallResponse response = send_call_request(_client, request);
+    UA_StatusCode status = response.responseHeader.serviceResult;
+    _results = take_results(&response, UA_STATUSCODE_BADUNEXPECTEDERROR, requests_.size());
+    UA_CallResponse_clear(&response);
+    return status;
+}
+
+std::vector<method_call_result>
+method_call_batch::call_in_process(const std::string& _endpoint) {
+    UA_CallRequest request = prepare_request();
+    UA_CallResponse response;
+    if (!in_process_transport::call(_endpoint, request, response))
+        return take_results(nullptr, UA_STATUSCODE_BADCONNECTIONCLOSED, requests_.size());
+    std::vector<method_call_result> results = take_results(&response, UA_STATUSCODE_BADUNEXPECTEDERROR, requests_.size());
+    UA_CallResponse_clear(&response);
+    return results;
+}
+
+UA_CallRequest
+method_call_batch::prepare_request() {
+    for (size_t i = 0; i < requests_.size(); i++) {
+        requests_[i].inputArguments = callers_[i].input_arguments_.data();
+        requests_[i].inputArgumentsSize = callers_[i].input_arguments_.size();
+    }
+    UA_CallRequest request;
+    UA_CallRequest_init(&request);
+    request.methodsToCall = requests_.data();
+    request.methodsToCallSize = requests_.size();
+    return request;
+}
+
+std::vector<method_call_result>
+method_call_batch::take_results(UA_CallResponse* _response, UA_StatusCode _status, size_t _call_count) {
+    std::vector<method_call_result> results(_call_count, method_call_result{_status, 0, nullptr});
+    if (_response == nullptr)
+        return results;
+    UA_StatusCode service_result = _response->responseHeader.serviceResult;
+    if (service_result == UA_STATUSCODE_GOOD && _response->resultsSize != _call_count)
+        service_result = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    for (size_t i = 0; i < _call_count; i++) {
+        if (service_result != UA_STATUSCODE_GOOD) {
+            results[i].status_ = service_result;
+            continue;
+        }
+        UA_CallMethodResult& method_result = _response->results[i];
+        results[i].status_ = method_result.statusCode;
+        if (method_result.statusCode != UA_STATUSCODE_GOOD)
+            continue;
+        results[i].output_size_ = method_result.outputArgumentsSize;
+        results[i].output_ = method_result.outputArguments;
+        method_result.outputArgumentsSize = 0;
+        method_result.outputArguments = nullptr;
+    }
+    return results;
+}
+
+prepared_method_call::prepared_method_call() {
+    UA_CallMethodRequest_init(&request_);
+}
+
+prepared_method_call::~prepared_method_call() {
+    UA_NodeId_clear(&request_.objectId);
+    UA_NodeId_clear(&request_.methodId);
+    for (UA_Variant& variant : input_arguments_) {
+        UA_Variant_clear(&variant);
+    }
+}
+
+void
+prepared_method_call::set_method(UA_NodeId _object_id, UA_NodeId _method_id) {
+    UA_NodeId_clear(&request_.objectId);
+    UA_NodeId_clear(&request_.methodId);
+    UA_NodeId_copy(&_object_id, &request_.objectId);
+    UA_NodeId_copy(&_method_id, &request_.methodId);
+}
+
+bool
+prepared_method_call::is_prepared() const {
+    return !UA_NodeId_isNull(&request_.methodId);
+}
+
+size_t
+prepared_method_call::add_scalar_input_argument(const void* _argument_value, UA_UInt32 _type_index) {
+    UA_Variant input_argument;
+    UA_Variant_init(&input_argument);
+    UA_Variant_setScalarCopy(&input_argument, _argument_value, &UA_TYPES[_type_index]);
+    input_arguments_.push_back(input_argument);
+    return input_arguments_.size() - 1;
+}
+
+void
+prepared_method_call::set_scalar_input_argument(size_t _index, const void* _argument_value) {
+    UA_Variant& input_argument = input_arguments_[_index];
+    const UA_DataType* type = input_argument.type;
+    if (type->pointerFree) {
+        memcpy(input_argument.data, _argument_value, type->memSize);
+        return;
+    }
+    UA_clear(input_argument.data, type);
+    UA_copy(_argument_value, input_argument.data, type);
+}
+
+UA_StatusCode
+prepared_method_call::call(UA_Client* _client, size_t* _output_size, UA_Variant** _output) {
+    request_.inputArguments = input_arguments_.data();
+    request_.inputArgumentsSize = input_arguments_.size();
+    UA_CallRequest request;
+    UA_CallRequest_init(&request);
+    request.methodsToCall = &request_;
+    request.methodsToCallSize = 1;
+    UA_CallResponse response = send_call_request(_client, request);
+    UA_StatusCode status = take_single_result(response, _output_size, _output);
+    UA_CallResponse_clear(&response);
+    return status;
+}
+
+UA_StatusCode
+prepared_method_call::call_async(UA_Client* _client, UA_ClientAsyncCallCallback _callback, void* _userdata) {
+    request_.inputArguments = input_arguments_.data();
+    request_.inputArgumentsSize = input_arguments_.size();
+    UA_CallRequest request;
+    UA_CallRequest_init(&request);
+    request.methodsToCall = &request_;
+    request.methodsToCallSize = 1;
+    return send_call_request_async(_client, request, (UA_ClientAsyncServiceCallback) _callback, _userdata);
 }
\ No newline at end of file
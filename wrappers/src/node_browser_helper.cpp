@@ -1,6 +1,7 @@
 #include "../include/node_browser_helper.hpp"
 #include "../include/node_browser.hpp"
 #include "../include/client_connection_establisher.hpp"
+#include "well_known_node_ids.hpp"
 
 node_browser_helper::node_browser_helper() {
 }
@@ -101,6 +102,139 @@ node_browser_helper::has_instance(UA_Client* _client, std::string _object_type_n
     return has_instance;
 }
 
+UA_StatusCode
+node_browser_helper::resolve_ids(UA_Client* _client, std::string _object_type_name, const std::vector<std::string>& _attribute_names,
+    const std::vector<std::string>& _method_names, std::unordered_map<std::string, UA_NodeId>& _attribute_ids,
+    std::unordered_map<std::string, object_method_info>& _method_ids) {
+#ifdef WELL_KNOWN_NODE_IDS
+    if (resolve_well_known_ids(_client, _object_type_name, _attribute_names, _method_names, _attribute_ids, _method_ids) == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOOD;
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Server does not use the well-known ids of %s, falling back to browsing", __FUNCTION__, _object_type_name.c_str());
+#endif
+    node_browser nb;
+    UA_NodeId object_type_id = nb.browse_object_type(_client, UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE), _object_type_name);
+    if (UA_NodeId_equal(&object_type_id, &UA_NODEID_NULL)) {
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: There is no object type with the browse name %s", __FUNCTION__, _object_type_name.c_str());
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    UA_BrowseResult browse_objects_result;
+    nb.browse_objects(_client, browse_objects_result);
+    const UA_ReferenceDescription* instance_reference_description = nullptr;
+    for (size_t i = 0; i < browse_objects_result.referencesSize; i++) {
+        if (UA_NodeId_equal(&browse_objects_result.references[i].typeDefinition.nodeId, &object_type_id)) {
+            instance_reference_description = &browse_objects_result.references[i];
+            break;
+        }
+    }
+    if (instance_reference_description == nullptr) {
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: There is no instance of the object type %s", __FUNCTION__, _object_type_name.c_str());
+        UA_BrowseResult_clear(&browse_objects_result);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    /* Children are added in the namespace of their instance */
+    std::vector<std::string> names(_attribute_names);
+    names.insert(names.end(), _method_names.begin(), _method_names.end());
+    std::vector<UA_RelativePathElement> path_elements(names.size());
+    std::vector<UA_BrowsePath> browse_paths(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        UA_RelativePathElement_init(&path_elements[i]);
+        path_elements[i].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+        path_elements[i].isInverse = false;
+        path_elements[i].includeSubtypes = true;
+        path_elements[i].targetName = UA_QUALIFIEDNAME(instance_reference_description->browseName.namespaceIndex, const_cast<char*>(names[i].c_str()));
+        UA_BrowsePath_init(&browse_paths[i]);
+        browse_paths[i].startingNode = instance_reference_description->nodeId.nodeId;
+        browse_paths[i].relativePath.elementsSize = 1;
+        browse_paths[i].relativePath.elements = &path_elements[i];
+    }
+    UA_TranslateBrowsePathsToNodeIdsRequest request;
+    UA_TranslateBrowsePathsToNodeIdsRequest_init(&request);
+    request.browsePathsSize = browse_paths.size();
+    request.browsePaths = browse_paths.data();
+    UA_TranslateBrowsePathsToNodeIdsResponse response = UA_Client_Service_translateBrowsePathsToNodeIds(_client, request);
+    UA_StatusCode status = response.responseHeader.serviceResult;
+    if (status == UA_STATUSCODE_GOOD && response.resultsSize != names.size())
+        status = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    for (size_t i = 0; status == UA_STATUSCODE_GOOD && i < names.size(); i++) {
+        UA_BrowsePathResult* result = &response.results[i];
+        if (result->statusCode != UA_STATUSCODE_GOOD || result->targetsSize < 1) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Could not find the %s id of %s", __FUNCTION__, names[i].c_str(), _object_type_name.c_str());
+            status = result->statusCode != UA_STATUSCODE_GOOD ? result->statusCode : UA_STATUSCODE_BADNOTFOUND;
+            break;
+        }
+        /* Take over the target id so that it outlives the response */
+        UA_NodeId target_id = result->targets[0].targetId.nodeId;
+        UA_NodeId_init(&result->targets[0].targetId.nodeId);
+        if (i < _attribute_names.size()) {
+            _attribute_ids[names[i]] = target_id;
+        } else {
+            object_method_info omi;
+            UA_NodeId_copy(&instance_reference_description->nodeId.nodeId, &omi.object_id_);
+            omi.method_id_ = target_id;
+            _method_ids[names[i]] = omi;
+        }
+    }
+    if (status != UA_STATUSCODE_GOOD)
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Error resolving the ids of %s (%s)", __FUNCTION__, _object_type_name.c_str(), UA_StatusCode_name(status));
+    UA_TranslateBrowsePathsToNodeIdsResponse_clear(&response);
+    UA_BrowseResult_clear(&browse_objects_result);
+    return status;
+}
+
+UA_StatusCode
+node_browser_helper::resolve_well_known_ids(UA_Client* _client, std::string _object_type_name, const std::vector<std::string>& _attribute_names,
+    const std::vector<std::string>& _method_names, std::unordered_map<std::string, UA_NodeId>& _attribute_ids,
+    std::unordered_map<std::string, object_method_info>& _method_ids) {
+    UA_UInt32 instance_id = well_known_instance_id(_object_type_name);
+    if (instance_id == 0)
+        return UA_STATUSCODE_BADNOTFOUND;
+    std::vector<std::string> names(_attribute_names);
+    names.insert(names.end(), _method_names.begin(), _method_names.end());
+    std::vector<UA_ReadValueId> read_value_ids(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        UA_UInt32 id = i < _attribute_names.size() ? well_known_instance_attribute_id(_object_type_name, names[i]) :
+            well_known_type_member_id(_object_type_name, names[i]);
+        if (id == 0)
+            return UA_STATUSCODE_BADNOTFOUND;
+        UA_ReadValueId_init(&read_value_ids[i]);
+        read_value_ids[i].nodeId = UA_NODEID_NUMERIC(WELL_KNOWN_NAMESPACE, id);
+        read_value_ids[i].attributeId = UA_ATTRIBUTEID_BROWSENAME;
+    }
+    /* Verify the ids by their browse names, servers without the table assign random ids */
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = read_value_ids.data();
+    request.nodesToReadSize = read_value_ids.size();
+    UA_ReadResponse response = UA_Client_Service_read(_client, request);
+    UA_StatusCode status = response.responseHeader.serviceResult;
+    if (status == UA_STATUSCODE_GOOD && response.resultsSize != names.size())
+        status = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    for (size_t i = 0; status == UA_STATUSCODE_GOOD && i < names.size(); i++) {
+        const UA_DataValue* result = &response.results[i];
+        if (!result->hasValue || !UA_Variant_hasScalarType(&result->value, &UA_TYPES[UA_TYPES_QUALIFIEDNAME])) {
+            status = UA_STATUSCODE_BADNOTFOUND;
+            break;
+        }
+        const UA_QualifiedName* browse_name = (const UA_QualifiedName*) result->value.data;
+        if (names[i].compare(0, std::string::npos, (char*) browse_name->name.data, browse_name->name.length))
+            status = UA_STATUSCODE_BADNOTFOUND;
+    }
+    UA_ReadResponse_clear(&response);
+    if (status != UA_STATUSCODE_GOOD)
+        return status;
+    for (size_t i = 0; i < names.size(); i++) {
+        if (i < _attribute_names.size()) {
+            _attribute_ids[names[i]] = read_value_ids[i].nodeId;
+        } else {
+            object_method_info omi;
+            omi.object_id_ = UA_NODEID_NUMERIC(WELL_KNOWN_NAMESPACE, instance_id);
+            omi.method_id_ = read_value_ids[i].nodeId;
+            _method_ids[names[i]] = omi;
+        }
+    }
+    return status;
+}
+
 object_method_info
 node_browser_helper::get_method_id(std::string _server_endpoint, std::string _object_type_name, std::string _method_name) {
     UA_Client* client = nullptr;
@@ -1,35 +1,148 @@
 #include "../include/node_value_subscriber.hpp"
 #include <open62541/plugin/log_stdout.h>
 
-node_value_subscriber::node_value_subscriber(UA_Client* _client) : client_(_client), subscription_id_(0) {
+#define HEARTBEAT_INTERVAL 250.0
+#define HEARTBEAT_STALENESS_BOUND 1000
 
+node_value_subscriber::node_value_subscriber(UA_Client* _client, UA_Double _publishing_interval) : client_(_client), subscription_id_(0), healthy_(false),
+    last_heartbeat_(0), staleness_bound_(HEARTBEAT_STALENESS_BOUND), publishing_interval_(_publishing_interval) {
+    if (client_ != nullptr)
+        UA_Client_getConfig(client_)->subscriptionInactivityCallback = subscription_lost;
 }
 
 node_value_subscriber::~node_value_subscriber() {
     UA_Client_Subscriptions_deleteSingle(client_, subscription_id_);
 }
 
-UA_StatusCode node_value_subscriber::subscribe_node_value(UA_NodeId _monitored_node_id, UA_Client_DataChangeNotificationCallback _notification_callback, void* _context) {
+UA_StatusCode
+node_value_subscriber::create_subscription() {
     if (client_ == nullptr)
         return UA_STATUSCODE_BAD;
+    if (subscription_id_ != 0)
+        return UA_STATUSCODE_GOOD;
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    request.requestedPublishingInterval = publishing_interval_;
+    UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(client_, request, this, subscription_status_changed, subscription_lost);
+
+    if(response.responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+        return response.responseHeader.serviceResult;
+    subscription_id_ = response.subscriptionId;
+    healthy_.store(true);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+node_value_subscriber::fill_monitor_request(const UA_NodeId& _node_id, const monitoring_parameters& _parameters,
+    UA_MonitoredItemCreateRequest& _request, UA_DataChangeFilter& _filter) {
+    _request = UA_MonitoredItemCreateRequest_default(_node_id);
+    _request.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    _request.requestedParameters.samplingInterval = _parameters.sampling_interval_;
+    _request.requestedParameters.queueSize = _parameters.queue_size_;
+    _request.requestedParameters.discardOldest = _parameters.discard_oldest_;
+    if (_parameters.deadband_type_ == UA_DEADBANDTYPE_NONE)
+        return;
+    UA_DataChangeFilter_init(&_filter);
+    _filter.trigger = UA_DATACHANGETRIGGER_STATUSVALUE;
+    _filter.deadbandType = _parameters.deadband_type_;
+    _filter.deadbandValue = _parameters.deadband_value_;
+    UA_ExtensionObject_setValueNoDelete(&_request.requestedParameters.filter, &_filter, &UA_TYPES[UA_TYPES_DATACHANGEFILTER]);
+}
+
+UA_StatusCode node_value_subscriber::subscribe_node_value(UA_NodeId _monitored_node_id, UA_Client_DataChangeNotificationCallback _notification_callback, void* _context,
+    const monitoring_parameters& _parameters) {
     /* Create a subscription */
-    if (subscription_id_ == 0) {
-        UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
-        request.requestedPublishingInterval = 0.0;
-        UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(client_, request, NULL, NULL, NULL);
-
-        if(response.responseHeader.serviceResult != UA_STATUSCODE_GOOD)
-            return response.responseHeader.serviceResult;
-        subscription_id_ = response.subscriptionId;
-    }
+    UA_StatusCode status = create_subscription();
+    if (status != UA_STATUSCODE_GOOD)
+        return status;
 
     /* Add a MonitoredItem */
-    UA_MonitoredItemCreateRequest monitor_request = UA_MonitoredItemCreateRequest_default(_monitored_node_id);
-    monitor_request.monitoringMode = UA_MONITORINGMODE_REPORTING;
-    monitor_request.requestedParameters.samplingInterval = 0.0;
+    UA_MonitoredItemCreateRequest monitor_request;
+    UA_DataChangeFilter filter;
+    fill_monitor_request(_monitored_node_id, _parameters, monitor_request, filter);
 
     UA_MonitoredItemCreateResult monitor_response = UA_Client_MonitoredItems_createDataChange(client_, subscription_id_,
                                                     UA_TIMESTAMPSTORETURN_BOTH, monitor_request,
                                                     _context, _notification_callback, NULL);
     return monitor_response.statusCode;
 }
+
+UA_StatusCode
+node_value_subscriber::subscribe_node_values(const std::vector<monitored_node_request>& _requests) {
+    UA_StatusCode status = create_subscription();
+    if (status != UA_STATUSCODE_GOOD || _requests.empty())
+        return status;
+
+    /* Add all MonitoredItems with one request, the filters are referenced and not copied */
+    std::vector<UA_MonitoredItemCreateRequest> items(_requests.size());
+    std::vector<UA_DataChangeFilter> filters(_requests.size());
+    std::vector<void*> contexts(_requests.size());
+    std::vector<UA_Client_DataChangeNotificationCallback> callbacks(_requests.size());
+    std::vector<UA_Client_DeleteMonitoredItemCallback> delete_callbacks(_requests.size(), nullptr);
+    for (size_t i = 0; i < _requests.size(); i++) {
+        fill_monitor_request(_requests[i].node_id_, _requests[i].parameters_, items[i], filters[i]);
+        contexts[i] = _requests[i].context_;
+        callbacks[i] = _requests[i].notification_callback_;
+    }
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscription_id_;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    request.itemsToCreate = items.data();
+    request.itemsToCreateSize = items.size();
+
+    UA_CreateMonitoredItemsResponse response = UA_Client_MonitoredItems_createDataChanges(client_, request,
+                                                contexts.data(), callbacks.data(), delete_callbacks.data());
+    status = response.responseHeader.serviceResult;
+    for (size_t i = 0; status == UA_STATUSCODE_GOOD && i < response.resultsSize; i++) {
+        status = response.results[i].statusCode;
+    }
+    if (status == UA_STATUSCODE_GOOD && response.resultsSize != _requests.size())
+        status = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    UA_CreateMonitoredItemsResponse_clear(&response);
+    return status;
+}
+
+UA_StatusCode
+node_value_subscriber::subscribe_heartbeat() {
+    UA_StatusCode status = create_subscription();
+    if (status != UA_STATUSCODE_GOOD)
+        return status;
+    UA_MonitoredItemCreateRequest monitor_request = UA_MonitoredItemCreateRequest_default(UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME));
+    monitor_request.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    monitor_request.requestedParameters.samplingInterval = HEARTBEAT_INTERVAL;
+
+    UA_MonitoredItemCreateResult monitor_response = UA_Client_MonitoredItems_createDataChange(client_, subscription_id_,
+                                                    UA_TIMESTAMPSTORETURN_NEITHER, monitor_request,
+                                                    this, heartbeat_received, NULL);
+    return monitor_response.statusCode;
+}
+
+bool
+node_value_subscriber::is_fresh() const {
+    if (!healthy_.load())
+        return false;
+    std::chrono::steady_clock::duration since_heartbeat = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::steady_clock::duration(last_heartbeat_.load());
+    return since_heartbeat <= staleness_bound_;
+}
+
+void
+node_value_subscriber::heartbeat_received(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context,
+    UA_UInt32 _mon_id, void* _mon_context, UA_DataValue* _value) {
+    node_value_subscriber* self = static_cast<node_value_subscriber*>(_mon_context);
+    self->last_heartbeat_.store(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+void
+node_value_subscriber::subscription_status_changed(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context, UA_StatusChangeNotification* _notification) {
+    if (_sub_context == nullptr || _notification->status == UA_STATUSCODE_GOOD)
+        return;
+    UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Subscription %d changed status to %s", __FUNCTION__, _sub_id, UA_StatusCode_name(_notification->status));
+    static_cast<node_value_subscriber*>(_sub_context)->healthy_.store(false);
+}
+
+void
+node_value_subscriber::subscription_lost(UA_Client* _client, UA_UInt32 _sub_id, void* _sub_context) {
+    if (_sub_context == nullptr)
+        return;
+    static_cast<node_value_subscriber*>(_sub_context)->healthy_.store(false);
+}
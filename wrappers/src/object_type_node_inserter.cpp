@@ -1,12 +1,28 @@
 #include "../include/object_type_node_inserter.hpp"
 #include <open62541/plugin/log_stdout.h>
+#include "well_known_node_ids.hpp"
+
+/**
+ * @brief Returns the requested node id for a well-known id, or UA_NODEID_NULL to let the server assign one.
+ */
+static UA_NodeId
+requested_node_id(UA_UInt32 _well_known_id) {
+#ifdef WELL_KNOWN_NODE_IDS
+    if (_well_known_id != 0)
+        return UA_NODEID_NUMERIC(WELL_KNOWN_NAMESPACE, _well_known_id);
+#endif
+    return UA_NODEID_NULL;
+}
 
 object_type_node_inserter::object_type_node_inserter(UA_Server* _server, const char* _parent_object_type_name) : server_(_server) {
     UA_NodeId parent_object_type_id;
     UA_StatusCode status;
     UA_ObjectTypeAttributes attribute = UA_ObjectTypeAttributes_default;
     attribute.displayName = UA_LOCALIZEDTEXT(const_cast<char*>("en-US"), const_cast<char*>(_parent_object_type_name));
-    status = UA_Server_addObjectTypeNode(server_, UA_NODEID_NULL,
+#ifdef WELL_KNOWN_NODE_IDS
+    UA_Server_getConfig(server_)->nodeLifecycle.generateChildNodeId = generate_child_node_id;
+#endif
+    status = UA_Server_addObjectTypeNode(server_, requested_node_id(well_known_type_id(_parent_object_type_name)),
                                 UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE), UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
                                 UA_QUALIFIEDNAME(1, const_cast<char*>(_parent_object_type_name)), attribute,
                                 NULL, &parent_object_type_id);
@@ -19,6 +35,9 @@ object_type_node_inserter::object_type_node_inserter(UA_Server* _server, const c
 }
 
 object_type_node_inserter::~object_type_node_inserter() {
+    for (auto& child_node_id : child_node_ids_) {
+        UA_NodeId_clear(&child_node_id.second);
+    }
 }
 
 UA_StatusCode
@@ -30,7 +49,8 @@ object_type_node_inserter::add_attribute(std::string _parent_object_type_name, c
     UA_VariableAttributes attribute = UA_VariableAttributes_default;
     attribute.displayName = UA_LOCALIZEDTEXT(const_cast<char*>("en-US"), const_cast<char*>(_attribute_name));
     UA_NodeId attribute_id;
-    UA_StatusCode status = UA_Server_addVariableNode(server_, UA_NODEID_NULL, object_type_ids_[_parent_object_type_name],
+    UA_StatusCode status = UA_Server_addVariableNode(server_, requested_node_id(well_known_type_member_id(_parent_object_type_name, _attribute_name)),
+                            object_type_ids_[_parent_object_type_name],
                             UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
                             UA_QUALIFIEDNAME(1, const_cast<char*>(_attribute_name)),
                             UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
@@ -56,7 +76,8 @@ object_type_node_inserter::add_method(std::string _parent_object_type_name, cons
     method_attributes.executable = true;
     method_attributes.userExecutable = true;
     UA_NodeId method_id;
-    UA_StatusCode status = UA_Server_addMethodNode(server_, UA_NODEID_NULL, object_type_ids_[_parent_object_type_name],
+    UA_StatusCode status = UA_Server_addMethodNode(server_, requested_node_id(well_known_type_member_id(_parent_object_type_name, _method_name)),
+                            object_type_ids_[_parent_object_type_name],
                             UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
                             UA_QUALIFIEDNAME(1, const_cast<char*>(_method_name)),
                             method_attributes, _method_callback,
@@ -107,11 +128,20 @@ object_type_node_inserter::add_object_instance(const char* _instance_name, const
     UA_NodeId node_id;
     UA_ObjectAttributes object_attribute = UA_ObjectAttributes_default;
     object_attribute.displayName = UA_LOCALIZEDTEXT(const_cast<char*>("en-US"), const_cast<char*>(_instance_name));
-    UA_StatusCode status = UA_Server_addObjectNode(server_, UA_NODEID_NULL,
+    UA_NodeId requested_id = requested_node_id(well_known_instance_id(_object_type_name));
+    UA_StatusCode status = UA_Server_addObjectNode(server_, requested_id,
+                            _parent_node_id, _reference_type,
+                            UA_QUALIFIEDNAME(1, const_cast<char*>(_instance_name)),
+                            object_type_ids_[std::string(_object_type_name)],
+                            object_attribute, NULL, &node_id);
+    if (status == UA_STATUSCODE_BADNODEIDEXISTS && !UA_NodeId_isNull(&requested_id)) {
+        /* Only the main instance of a type gets the well-known id */
+        status = UA_Server_addObjectNode(server_, UA_NODEID_NULL,
                             _parent_node_id, _reference_type,
                             UA_QUALIFIEDNAME(1, const_cast<char*>(_instance_name)),
                             object_type_ids_[std::string(_object_type_name)],
                             object_attribute, NULL, &node_id);
+    }
     if (status != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Adding object instance %s failed", _instance_name);
         return status;
@@ -120,6 +150,21 @@ object_type_node_inserter::add_object_instance(const char* _instance_name, const
     return status;
 }
 
+UA_StatusCode
+object_type_node_inserter::generate_child_node_id(UA_Server* _server,
+                        const UA_NodeId* _session_id, void* _session_context,
+                        const UA_NodeId* _source_node_id, const UA_NodeId* _target_parent_node_id,
+                        const UA_NodeId* _reference_type_id, UA_NodeId* _target_node_id) {
+    *_target_node_id = UA_NODEID_NUMERIC(_target_parent_node_id->namespaceIndex, 0);
+    if (_source_node_id->namespaceIndex != WELL_KNOWN_NAMESPACE || _source_node_id->identifierType != UA_NODEIDTYPE_NUMERIC ||
+        _target_parent_node_id->namespaceIndex != WELL_KNOWN_NAMESPACE || _target_parent_node_id->identifierType != UA_NODEIDTYPE_NUMERIC)
+        return UA_STATUSCODE_GOOD;
+    UA_UInt32 child_id = well_known_instance_child_id(_source_node_id->identifier.numeric, _target_parent_node_id->identifier.numeric);
+    if (child_id != 0)
+        _target_node_id->identifier.numeric = child_id;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 object_type_node_inserter::object_type_constructor(UA_Server* _server,
                         const UA_NodeId* _session_id, void* _session_context,
@@ -195,6 +240,13 @@ object_type_node_inserter::find_child_node_id(std::string _instance_name, const
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Unknown instance. Attribute can not be found");
         return UA_STATUSCODE_BAD;
     }
+    std::string child_key = _instance_name + "." + _child_name;
+    std::lock_guard<std::mutex> lock(child_node_ids_mutex_);
+    auto cached_child = child_node_ids_.find(child_key);
+    if (cached_child != child_node_ids_.end()) {
+        _node_id = cached_child->second;
+        return UA_STATUSCODE_GOOD;
+    }
 
     UA_RelativePathElement rpe;
     UA_RelativePathElement_init(&rpe);
@@ -212,10 +264,17 @@ object_type_node_inserter::find_child_node_id(std::string _instance_name, const
     UA_BrowsePathResult bpr = UA_Server_translateBrowsePathToNodeIds(server_, &bp);
     if(bpr.statusCode != UA_STATUSCODE_GOOD || bpr.targetsSize < 1) {
         UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Failed to find child %s for instance %s", _child_name, _instance_name.c_str());
+        UA_BrowsePathResult_clear(&bpr);
         return UA_STATUSCODE_BAD;
     }
-    _node_id = bpr.targets[0].targetId.nodeId;
-    UA_BrowsePathResult_clear(&bpr); // NOTE: may be a problem if node identifier is not numeric(?)
+    UA_NodeId child_node_id;
+    UA_StatusCode status = UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, &child_node_id);
+    UA_BrowsePathResult_clear(&bpr);
+    if (status != UA_STATUSCODE_GOOD) {
+        return status;
+    }
+    child_node_ids_[child_key] = child_node_id;
+    _node_id = child_node_id;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -253,4 +312,89 @@ object_type_node_inserter::get_attribute(std::string _instance_name, const char*
         return status_code;
     }
     return UA_Server_readValue(server_, attribute_node_id, &_value);
+}
+
+UA_StatusCode
+object_type_node_inserter::resolve_attribute(std::string _instance_name, const char* _attribute_name, attribute_handle& _handle) {
+    UA_StatusCode status_code = find_child_node_id(_instance_name, _attribute_name, _handle.node_id_);
+    if (status_code != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not resolve the attribute %s for instance %s", _attribute_name, _instance_name.c_str());
+        _handle.node_id_ = UA_NODEID_NULL;
+    }
+    return status_code;
+}
+
+UA_StatusCode
+object_type_node_inserter::set_scalar_attribute(const attribute_handle& _handle, void* _value, UA_UInt32 _type_index) {
+    if (!_handle.is_resolved())
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    UA_Variant value;
+    UA_Variant_setScalar(&value, _value, &UA_TYPES[_type_index]);
+    return UA_Server_writeValue(server_, _handle.node_id_, value);
+}
+
+UA_StatusCode
+object_type_node_inserter::set_array_attribute(const attribute_handle& _handle, void* _array, size_t _array_size, UA_UInt32 _type_index) {
+    if (!_handle.is_resolved())
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    UA_Variant value;
+    UA_Variant_setArray(&value, _array, _array_size, &UA_TYPES[_type_index]);
+    return UA_Server_writeValue(server_, _handle.node_id_, value);
+}
+
+UA_StatusCode
+object_type_node_inserter::get_attribute(const attribute_handle& _handle, UA_Variant& _value) {
+    if (!_handle.is_resolved())
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    return UA_Server_readValue(server_, _handle.node_id_, &_value);
+}
+
+UA_StatusCode
+object_type_node_inserter::read_bound_attribute(UA_Server* _server,
+                        const UA_NodeId* _session_id, void* _session_context,
+                        const UA_NodeId* _node_id, void* _node_context,
+                        UA_Boolean _include_source_timestamp, const UA_NumericRange* _range,
+                        UA_DataValue* _value) {
+    if (_node_context == NULL) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%s: Node context is NULL", __FUNCTION__);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    attribute_reader_t* reader = static_cast<attribute_reader_t*>(_node_context);
+    UA_StatusCode status = (*reader)(_value->value);
+    if (status != UA_STATUSCODE_GOOD) {
+        return status;
+    }
+    _value->hasValue = true;
+    if (_include_source_timestamp) {
+        _value->sourceTimestamp = UA_DateTime_now();
+        _value->hasSourceTimestamp = true;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+object_type_node_inserter::bind_attribute(std::string _instance_name, const char* _attribute_name, attribute_reader_t _reader) {
+    UA_NodeId attribute_node_id;
+    UA_StatusCode status = find_child_node_id(_instance_name, _attribute_name, attribute_node_id);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not bind the attribute %s for instance %s", _attribute_name, _instance_name.c_str());
+        return status;
+    }
+    std::unique_ptr<attribute_reader_t> reader = std::make_unique<attribute_reader_t>(std::move(_reader));
+    status = UA_Server_setNodeContext(server_, attribute_node_id, reader.get());
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Setting the node context of attribute %s for instance %s failed", _attribute_name, _instance_name.c_str());
+        return status;
+    }
+    UA_DataSource data_source;
+    data_source.read = read_bound_attribute;
+    data_source.write = NULL;
+    status = UA_Server_setVariableNode_dataSource(server_, attribute_node_id, data_source);
+    if (status != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Setting the data source of attribute %s for instance %s failed", _attribute_name, _instance_name.c_str());
+        UA_Server_setNodeContext(server_, attribute_node_id, NULL);
+        return status;
+    }
+    attribute_readers_.push_back(std::move(reader));
+    return status;
 }
\ No newline at end of file